@@ -0,0 +1,412 @@
+/*
+** FAAD2 - Freeware Advanced Audio (AAC) Decoder including SBR decoding
+** Copyright (C) 2003-2005 M. Bakker, Nero AG, http://www.nero.com
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+**
+** Any non-GPL usage of this software or parts of this software is strictly
+** forbidden.
+**
+** The "appropriate copyright message" mentioned in section 2c of the GPLv2
+** must read: "Code from FAAD2 is copyright (c) Nero AG, www.nero.com"
+**
+** Commercial non-GPL licensing of this software is possible.
+** For more info contact Nero AG through Mpeg4AAClicense@nero.com.
+**
+** $Id$
+**/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#include <x86intrin.h>
+#define HAVE_TICKS
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>
+#define HAVE_TICKS
+#endif
+
+#include "neaacdec.h"
+#include "bench.h"
+
+#define BENCH_MAX_ITERS (1 << 30)
+
+
+double bench_now_ns(void)
+{
+#ifdef _WIN32
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER now;
+
+    if (freq.QuadPart == 0)
+        QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+
+    return (double)now.QuadPart * 1e9 / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+#endif
+}
+
+/* time stamp counter, 0 when there is none */
+double bench_ticks(void)
+{
+#ifdef HAVE_TICKS
+    return (double)__rdtsc();
+#else
+    return 0;
+#endif
+}
+
+unsigned int bench_rand(unsigned int *state)
+{
+    /* xorshift32, never returns 0 for a non-zero state */
+    unsigned int x = *state ? *state : 0x9E3779B9;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+
+    return x;
+}
+
+double bench_randf(unsigned int *state)
+{
+    return (double)(bench_rand(state) >> 8) / (double)(1 << 23) - 1.0;
+}
+
+static const char *level_names[FAAD_CPU_AVX512 + 1] =
+{
+    "scalar", "sse2", "ssse3", "avx2", "avx512"
+};
+
+const char *bench_level_name(int level)
+{
+    if (level < 0 || level > FAAD_CPU_AVX512)
+        return "?";
+    return level_names[level];
+}
+
+int bench_parse_level(const char *s)
+{
+    int i;
+
+    if (!strcmp(s, "all"))
+        return -1;
+    if (!strcmp(s, "auto"))
+        return FAAD_CPU_AUTO;
+    for (i = 0; i <= FAAD_CPU_AVX512; i++)
+    {
+        if (!strcmp(s, level_names[i]) || (s[0] == '0' + i && s[1] == '\0'))
+            return i;
+    }
+
+    return -2;
+}
+
+void bench_default_opts(bench_opts *opts)
+{
+    memset(opts, 0, sizeof(bench_opts));
+    opts->min_time = 0.02;
+    opts->reps = 5;
+    opts->threshold = 5.0;
+}
+
+void bench_usage(const char *extra)
+{
+    fprintf(stderr, "common options:\n");
+    fprintf(stderr, "  -f <str>   only run benchmarks whose name contains <str>\n");
+    fprintf(stderr, "  -t <ms>    minimum time per run (default 20)\n");
+    fprintf(stderr, "  -r <n>     runs per measurement, fastest is kept (default 5)\n");
+    fprintf(stderr, "  -s <file>  save the results as a baseline\n");
+    fprintf(stderr, "  -b <file>  compare against a saved baseline\n");
+    fprintf(stderr, "  -T <pct>   regression threshold in percent (default 5)\n");
+    fprintf(stderr, "  -v         verbose\n");
+    if (extra)
+        fprintf(stderr, "%s", extra);
+}
+
+int bench_parse_opts(bench_opts *opts, int argc, char **argv, int first)
+{
+    int i = first;
+
+    while (i < argc)
+    {
+        const char *a = argv[i];
+        const char *v = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (a[0] != '-' || a[1] == '\0' || a[2] != '\0')
+            return i;
+
+        switch (a[1])
+        {
+        case 'v':
+            opts->verbose = 1;
+            i++;
+            continue;
+        case 'f': case 't': case 'r': case 's': case 'b': case 'T':
+            if (v == NULL)
+            {
+                fprintf(stderr, "option %s needs an argument\n", a);
+                return -1;
+            }
+            break;
+        case 'h':
+            return -1;
+        default:
+            return i;
+        }
+
+        switch (a[1])
+        {
+        case 'f': opts->filter = v; break;
+        case 't': opts->min_time = atof(v) / 1000.0; break;
+        case 'r': opts->reps = atoi(v); break;
+        case 's': opts->save = v; break;
+        case 'b': opts->base = v; break;
+        case 'T': opts->threshold = atof(v); break;
+        }
+        i += 2;
+    }
+
+    if (opts->reps < 1)
+        opts->reps = 1;
+    if (opts->min_time <= 0)
+        opts->min_time = 0.001;
+
+    return i;
+}
+
+static int load_baseline(bench_ctx *b, const char *path)
+{
+    FILE *f = fopen(path, "r");
+    char line[256];
+    int max = 0;
+
+    if (f == NULL)
+    {
+        fprintf(stderr, "cannot open baseline %s\n", path);
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), f))
+    {
+        bench_result r;
+
+        if (line[0] == '#')
+            continue;
+
+        memset(&r, 0, sizeof(r));
+        if (sscanf(line, "%63s %15s %lf %lf", r.name, r.variant, &r.ns, &r.ticks) < 3)
+            continue;
+
+        if (b->num_base == max)
+        {
+            max = max ? 2 * max : 64;
+            b->base = (bench_result*)realloc(b->base, max * sizeof(bench_result));
+        }
+        b->base[b->num_base++] = r;
+    }
+    fclose(f);
+
+    return 0;
+}
+
+int bench_init(bench_ctx *b, const bench_opts *opts)
+{
+    memset(b, 0, sizeof(bench_ctx));
+    b->opts = *opts;
+
+    if (opts->base && load_baseline(b, opts->base) < 0)
+        return -1;
+
+    printf("%-32s %-8s %12s %10s %10s\n", "benchmark", "variant",
+        "ns/call", "tick/smp", opts->base ? "vs base" : "");
+
+    return 0;
+}
+
+int bench_match(const bench_ctx *b, const char *name)
+{
+    return (b->opts.filter == NULL || strstr(name, b->opts.filter) != NULL);
+}
+
+static const bench_result *find_base(const bench_ctx *b, const char *name,
+                                     const char *variant)
+{
+    int i;
+
+    for (i = 0; i < b->num_base; i++)
+    {
+        if (!strcmp(b->base[i].name, name) && !strcmp(b->base[i].variant, variant))
+            return &b->base[i];
+    }
+
+    return NULL;
+}
+
+void bench_add(bench_ctx *b, const char *name, const char *variant,
+               double ns, double ticks, double samples, const char *extra)
+{
+    bench_result *r;
+    const bench_result *base;
+    char cmp[32] = "";
+
+    if (b->num_res == b->max_res)
+    {
+        b->max_res = b->max_res ? 2 * b->max_res : 64;
+        b->res = (bench_result*)realloc(b->res, b->max_res * sizeof(bench_result));
+    }
+    r = &b->res[b->num_res++];
+    memset(r, 0, sizeof(bench_result));
+    strncpy(r->name, name, sizeof(r->name) - 1);
+    strncpy(r->variant, variant ? variant : "-", sizeof(r->variant) - 1);
+    r->ns = ns;
+    r->ticks = ticks;
+    r->samples = samples;
+
+    base = find_base(b, r->name, r->variant);
+    if (base && base->ns > 0)
+    {
+        double diff = 100.0 * (ns - base->ns) / base->ns;
+
+        sprintf(cmp, "%+.1f%%", diff);
+        if (diff > b->opts.threshold)
+        {
+            strcat(cmp, " SLOWER");
+            b->regressions++;
+        }
+    }
+
+    if (ticks > 0 && samples > 0)
+    {
+        printf("%-32s %-8s %12.1f %10.2f %10s", r->name, r->variant,
+            ns, ticks / samples, cmp);
+    } else {
+        printf("%-32s %-8s %12.1f %10s %10s", r->name, r->variant,
+            ns, "-", cmp);
+    }
+    if (extra)
+        printf("  %s", extra);
+    printf("\n");
+    fflush(stdout);
+}
+
+void bench_measure(bench_ctx *b, const char *name, bench_fn fn, void *ctx,
+                   double *ns, double *ticks)
+{
+    double best_ns = 0, best_ticks = 0;
+    long iters = 1, i;
+    int rep;
+
+    /* warm up caches and branch predictors, then calibrate */
+    fn(ctx);
+    for (;;)
+    {
+        double t0 = bench_now_ns();
+
+        for (i = 0; i < iters; i++)
+            fn(ctx);
+
+        if (bench_now_ns() - t0 >= b->opts.min_time * 1e9 || iters >= BENCH_MAX_ITERS)
+            break;
+        iters *= 2;
+    }
+
+    for (rep = 0; rep < b->opts.reps; rep++)
+    {
+        double t0 = bench_now_ns();
+        double c0 = bench_ticks();
+        double run_ns, run_ticks;
+
+        for (i = 0; i < iters; i++)
+            fn(ctx);
+
+        run_ticks = (bench_ticks() - c0) / iters;
+        run_ns = (bench_now_ns() - t0) / iters;
+
+        if (rep == 0 || run_ns < best_ns)
+        {
+            best_ns = run_ns;
+            best_ticks = run_ticks;
+        }
+    }
+
+    if (b->opts.verbose)
+        fprintf(stderr, "%s: %ld iterations x %d runs\n", name, iters, b->opts.reps);
+
+    *ns = best_ns;
+    *ticks = best_ticks;
+}
+
+void bench_run(bench_ctx *b, const char *name, const char *variant,
+               double samples, bench_fn fn, void *ctx)
+{
+    double ns, ticks;
+
+    bench_measure(b, name, fn, ctx, &ns, &ticks);
+    bench_add(b, name, variant, ns, ticks, samples, NULL);
+}
+
+int bench_finish(bench_ctx *b)
+{
+    int i;
+
+    if (b->opts.save)
+    {
+        FILE *f = fopen(b->opts.save, "w");
+
+        if (f == NULL)
+        {
+            fprintf(stderr, "cannot write %s\n", b->opts.save);
+        } else {
+            fprintf(f, "# name variant ns/call ticks/call\n");
+            for (i = 0; i < b->num_res; i++)
+            {
+                fprintf(f, "%s %s %.2f %.2f\n", b->res[i].name,
+                    b->res[i].variant, b->res[i].ns, b->res[i].ticks);
+            }
+            fclose(f);
+        }
+    }
+
+    if (b->opts.base)
+    {
+        if (b->regressions)
+        {
+            printf("%d regression(s) above %.1f%%\n", b->regressions,
+                b->opts.threshold);
+        } else {
+            printf("no regressions above %.1f%%\n", b->opts.threshold);
+        }
+    }
+
+    free(b->res);
+    free(b->base);
+
+    return b->regressions;
+}
@@ -0,0 +1,119 @@
+/*
+** FAAD2 - Freeware Advanced Audio (AAC) Decoder including SBR decoding
+** Copyright (C) 2003-2005 M. Bakker, Nero AG, http://www.nero.com
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+**
+** Any non-GPL usage of this software or parts of this software is strictly
+** forbidden.
+**
+** The "appropriate copyright message" mentioned in section 2c of the GPLv2
+** must read: "Code from FAAD2 is copyright (c) Nero AG, www.nero.com"
+**
+** Commercial non-GPL licensing of this software is possible.
+** For more info contact Nero AG through Mpeg4AAClicense@nero.com.
+**
+** $Id$
+**/
+
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Small timing harness shared by the benchmark programs.
+ *
+ * A measurement calibrates the number of iterations so one run takes at
+ * least the requested time, repeats the run a few times and keeps the
+ * fastest one, which is the most stable figure on a busy machine.
+ */
+
+typedef void (*bench_fn)(void *ctx);
+
+typedef struct
+{
+    double min_time;    /* seconds per run */
+    int reps;           /* runs per measurement */
+    double threshold;   /* regression threshold in percent */
+    const char *filter; /* only run entries containing this string */
+    const char *save;   /* write the results to this file */
+    const char *base;   /* compare against this baseline file */
+    int verbose;
+} bench_opts;
+
+typedef struct
+{
+    char name[64];
+    char variant[16];   /* CPU level or other variant, "-" if none */
+    double ns;          /* per call */
+    double ticks;       /* per call, 0 when no cycle counter */
+    double samples;     /* samples per call, for the per sample figure */
+} bench_result;
+
+typedef struct
+{
+    bench_opts opts;
+    bench_result *res;
+    int num_res;
+    int max_res;
+    bench_result *base;
+    int num_base;
+    int regressions;
+} bench_ctx;
+
+void bench_default_opts(bench_opts *opts);
+
+/* parses the options common to all benchmarks, returns the index of the
+   first argument it did not understand or -1 when the usage should be
+   printed */
+int bench_parse_opts(bench_opts *opts, int argc, char **argv, int first);
+void bench_usage(const char *extra);
+
+int bench_init(bench_ctx *b, const bench_opts *opts);
+int bench_match(const bench_ctx *b, const char *name);
+
+/* times fn(ctx), stores and prints the result */
+void bench_run(bench_ctx *b, const char *name, const char *variant,
+               double samples, bench_fn fn, void *ctx);
+
+/* times fn(ctx) without recording it, ns and ticks are per call */
+void bench_measure(bench_ctx *b, const char *name, bench_fn fn, void *ctx,
+                   double *ns, double *ticks);
+
+/* records a result measured by the caller */
+void bench_add(bench_ctx *b, const char *name, const char *variant,
+               double ns, double ticks, double samples, const char *extra);
+
+/* writes the results, returns the number of regressions found */
+int bench_finish(bench_ctx *b);
+
+double bench_now_ns(void);
+double bench_ticks(void);
+
+/* CPU level names as used by FAAD_CPU_LEVEL; bench_parse_level() returns
+   a FAAD_CPU_* value, -1 for "all" or -2 when the name is unknown */
+const char *bench_level_name(int level);
+int bench_parse_level(const char *s);
+
+/* deterministic pseudo random numbers for the synthetic inputs */
+unsigned int bench_rand(unsigned int *state);
+double bench_randf(unsigned int *state); /* [-1, 1) */
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,791 @@
+/*
+** FAAD2 - Freeware Advanced Audio (AAC) Decoder including SBR decoding
+** Copyright (C) 2003-2005 M. Bakker, Nero AG, http://www.nero.com
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+**
+** Any non-GPL usage of this software or parts of this software is strictly
+** forbidden.
+**
+** The "appropriate copyright message" mentioned in section 2c of the GPLv2
+** must read: "Code from FAAD2 is copyright (c) Nero AG, www.nero.com"
+**
+** Commercial non-GPL licensing of this software is possible.
+** For more info contact Nero AG through Mpeg4AAClicense@nero.com.
+**
+** $Id$
+**/
+
+/* End to end decoder benchmark.
+ *
+ * Generates a small synthetic corpus (see streamgen.h) covering the
+ * supported object types in mono, stereo and 5.1 and times
+ * NeAACDecDecode() over each stream, then the same stream in LOAS/LATM
+ * frames through the LATM demultiplexer (NeAACDecLATMDemux() and
+ * NeAACDecLATMDecode()). Besides the time per frame it reports the
+ * realtime factor, frames per second, peak resident memory and the number
+ * of heap allocations made per decoded frame. Everything is
+ * generated in memory, no input files are needed.
+ *
+ * Allocations are counted by wrapping faad_malloc() and faad_free() at
+ * link time (-Wl,--wrap), which needs a GNU compatible linker.
+ */
+
+#include "common.h"
+#include "structs.h"
+#include "latm.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+
+#include "bench.h"
+#include "streamgen.h"
+
+#define DEFAULT_FRAMES 400
+
+/* frames per range for -k, as in faad -p but shorter */
+#define RANGE_CHECK_FRAMES 37
+
+/* allocation counting */
+
+void *__real_faad_malloc(size_t size);
+void __real_faad_free(void *b);
+
+static unsigned long num_allocs = 0;
+static unsigned long num_frees = 0;
+
+void *__wrap_faad_malloc(size_t size)
+{
+    num_allocs++;
+    return __real_faad_malloc(size);
+}
+
+void __wrap_faad_free(void *b)
+{
+    if (b)
+        num_frees++;
+    __real_faad_free(b);
+}
+
+/* peak resident set size */
+
+static void reset_peak_rss(void)
+{
+    FILE *f = fopen("/proc/self/clear_refs", "w");
+
+    if (f)
+    {
+        /* "5" resets the high water mark, needs Linux 4.0 or newer */
+        fputs("5", f);
+        fclose(f);
+    }
+}
+
+static long peak_rss_kb(void)
+{
+    FILE *f = fopen("/proc/self/status", "r");
+    char line[128];
+    long kb = -1;
+
+    if (f)
+    {
+        while (fgets(line, sizeof(line), f))
+        {
+            if (!strncmp(line, "VmHWM:", 6))
+            {
+                kb = strtol(line + 6, NULL, 10);
+                break;
+            }
+        }
+        fclose(f);
+    }
+
+    if (kb < 0)
+    {
+        struct rusage ru;
+
+        if (getrusage(RUSAGE_SELF, &ru) == 0)
+            kb = ru.ru_maxrss;
+    }
+
+    return kb;
+}
+
+
+typedef struct
+{
+    gen_stream *s;
+    NeAACDecHandle hDecoder;
+    NeAACDecLATMHandle hLatm;   /* LOAS streams, hDecoder is its decoder */
+    int level;
+    unsigned long errors;
+    int first_error;
+    unsigned char first_error_code;
+} decode_ctx;
+
+static int open_decoder(decode_ctx *c)
+{
+    NeAACDecConfigurationPtr config;
+    unsigned long samplerate;
+    unsigned char channels;
+
+    /* the demultiplexer sets up its decoder from the first frame, the
+       default configuration has 16 bit output */
+    if (c->s->latm)
+    {
+        c->hLatm = NeAACDecLATMOpen(NULL);
+        return (c->hLatm == NULL) ? -1 : 0;
+    }
+
+    c->hDecoder = NeAACDecOpen();
+    if (c->hDecoder == NULL)
+        return -1;
+
+    if (c->level != FAAD_CPU_AUTO)
+        NeAACDecSetCpuLevel(c->hDecoder, (unsigned char)c->level);
+
+    config = NeAACDecGetCurrentConfiguration(c->hDecoder);
+    config->outputFormat = FAAD_FMT_16BIT;
+    NeAACDecSetConfiguration(c->hDecoder, config);
+
+    if (c->s->adts)
+    {
+        if (NeAACDecInit(c->hDecoder, c->s->data, c->s->size,
+            &samplerate, &channels) < 0)
+        {
+            return -1;
+        }
+    } else {
+        if (NeAACDecInit2(c->hDecoder, c->s->asc, c->s->asc_len,
+            &samplerate, &channels) < 0)
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static void close_decoder(decode_ctx *c)
+{
+    if (c->hLatm)
+        NeAACDecLATMClose(c->hLatm);
+    else if (c->hDecoder)
+        NeAACDecClose(c->hDecoder);
+}
+
+/* decodes frame i, a LOAS frame goes through the demultiplexer and holds
+   one access unit */
+static void decode_frame(decode_ctx *c, int i, NeAACDecFrameInfo *frameInfo)
+{
+    const gen_stream *s = c->s;
+    unsigned long size = s->offset[i + 1] - s->offset[i];
+
+    if (c->hLatm)
+    {
+        unsigned char error;
+
+        NeAACDecLATMDemux(c->hLatm, s->data + s->offset[i], size, &error);
+        if (error)
+        {
+            memset(frameInfo, 0, sizeof(NeAACDecFrameInfo));
+            frameInfo->error = error;
+            return;
+        }
+        NeAACDecLATMDecode(c->hLatm, 0, frameInfo);
+        return;
+    }
+
+    NeAACDecDecode(c->hDecoder, frameInfo, s->data + s->offset[i], size);
+}
+
+/* decodes the whole stream once, the decoder is kept between runs so
+   the stream just loops */
+static void run_decode(void *ctx)
+{
+    decode_ctx *c = (decode_ctx*)ctx;
+    NeAACDecFrameInfo frameInfo;
+    int i;
+
+    for (i = 0; i < c->s->num_frames; i++)
+        decode_frame(c, i, &frameInfo);
+}
+
+/* same as run_decode() but checks every frame */
+static void check_decode(decode_ctx *c)
+{
+    const gen_stream *s = c->s;
+    NeAACDecFrameInfo frameInfo;
+    int i;
+
+    c->errors = 0;
+    c->first_error = -1;
+    for (i = 0; i < s->num_frames; i++)
+    {
+        decode_frame(c, i, &frameInfo);
+        if (frameInfo.error)
+        {
+            if (c->errors++ == 0)
+            {
+                c->first_error = i;
+                c->first_error_code = frameInfo.error;
+            }
+        }
+    }
+}
+
+static const char *layout_name(int channels)
+{
+    switch (channels)
+    {
+    case 1: return "mono";
+    case 2: return "stereo";
+    default: return "5.1";
+    }
+}
+
+static void print_stats(decode_ctx *c)
+{
+    static const char *stage_names[FAAD_STAGE_COUNT] = {
+        "parse", "huffman", "requant", "tools", "tns",
+        "filterbank", "sbr", "ps", "output"
+    };
+    NeAACDecStats stats;
+    int i;
+
+    if (!NeAACDecGetStats(c->hDecoder, &stats) || stats.total_ns == 0)
+        return;
+
+    printf("   ");
+    for (i = 0; i < FAAD_STAGE_COUNT; i++)
+    {
+        if (stats.stage_calls[i] == 0)
+            continue;
+        printf(" %s %.1f%%", stage_names[i],
+            100.0 * (double)stats.stage_ns[i] / (double)stats.total_ns);
+    }
+    printf("\n");
+}
+
+static void bench_stream(bench_ctx *b, const gen_config *cfg, int level,
+                         const char *dump_dir, int show_stats)
+{
+    decode_ctx c;
+    char name[64], extra[128];
+    unsigned long init_allocs, run_allocs;
+    double ns, ticks, duration, rt;
+    long rss;
+
+    sprintf(name, "%s/%s/%s", cfg->latm ? "latm" : "decode",
+        gen_profile_name(cfg->profile), layout_name(cfg->channels));
+    if (!bench_match(b, name))
+        return;
+
+    memset(&c, 0, sizeof(decode_ctx));
+    c.level = level;
+    c.s = gen_stream_create(cfg);
+    if (c.s == NULL)
+    {
+        fprintf(stderr, "%s: cannot generate stream\n", name);
+        return;
+    }
+
+    if (dump_dir)
+    {
+        char path[512];
+
+        sprintf(path, "%s/%s_%s.%s", dump_dir, gen_profile_name(cfg->profile),
+            layout_name(cfg->channels),
+            c.s->latm ? "loas" : (c.s->adts ? "aac" : "m4a"));
+        if (gen_stream_write(c.s, path) < 0)
+            fprintf(stderr, "cannot write %s\n", path);
+    }
+
+    reset_peak_rss();
+
+    num_allocs = 0;
+    if (open_decoder(&c) < 0)
+    {
+        fprintf(stderr, "%s: decoder initialisation failed\n", name);
+        close_decoder(&c);
+        gen_stream_free(c.s);
+        return;
+    }
+
+    /* the first pass allocates the delayed buffers, count the steady
+       state allocations on the second one */
+    check_decode(&c);
+    if (c.hLatm)
+    {
+        c.hDecoder = ((latm_demux*)c.hLatm)->decoder[0];
+        if (c.hDecoder == NULL)
+        {
+            fprintf(stderr, "%s: no access unit decoded\n", name);
+            close_decoder(&c);
+            gen_stream_free(c.s);
+            return;
+        }
+        if (c.level != FAAD_CPU_AUTO)
+            NeAACDecSetCpuLevel(c.hDecoder, (unsigned char)c.level);
+    }
+    init_allocs = num_allocs;
+    check_decode(&c);
+    run_allocs = num_allocs - init_allocs;
+    if (c.errors && b->opts.verbose)
+    {
+        fprintf(stderr, "%s: frame %d: %s\n", name, c.first_error,
+            NeAACDecGetErrorMessage(c.first_error_code));
+    }
+
+    if (show_stats)
+        NeAACDecEnableStats(c.hDecoder, 1);
+    bench_measure(b, name, run_decode, &c, &ns, &ticks);
+    rss = peak_rss_kb();
+
+    duration = (double)c.s->num_frames * c.s->frame_len / c.s->samplerate;
+    rt = duration / (ns * 1e-9);
+    sprintf(extra, "rt %.1fx  %.0f fps  rss %ld kB  alloc/frame %.2f  init %lu",
+        rt, 1e9 * c.s->num_frames / ns, rss,
+        (double)run_allocs / c.s->num_frames, init_allocs);
+    if (c.errors)
+    {
+        sprintf(extra + strlen(extra), "  ERRORS %lu/%d",
+            c.errors, c.s->num_frames);
+    }
+
+    bench_add(b, name, bench_level_name(NeAACDecGetCpuLevel(c.hDecoder)),
+        ns / c.s->num_frames, ticks / c.s->num_frames,
+        (double)c.s->frame_len * c.s->channels, extra);
+
+    if (show_stats)
+        print_stats(&c);
+
+    close_decoder(&c);
+    gen_stream_free(c.s);
+}
+
+/* profiles whose output after a seek or in ranges is that of a decode from
+   the start */
+static int seek_exact(int profile)
+{
+    return (profile == GEN_LC || profile == GEN_HE || profile == GEN_HEV2);
+}
+
+/* decodes the frames from first to the end into a new buffer, returns
+   the number of samples (all channels) */
+static unsigned long decode_all(decode_ctx *c, const NeAACDecADTSIndex *index,
+                                unsigned long first, short **out,
+                                int *channels)
+{
+    NeAACDecFrameInfo frameInfo;
+    unsigned long i, len = 0, size = 0;
+    short *buf = NULL;
+
+    for (i = first; i < index->frames; i++)
+    {
+        short *samples = (short*)NeAACDecDecode(c->hDecoder, &frameInfo,
+            c->s->data + index->offset[i], index->length[i]);
+
+        if (samples && frameInfo.samples)
+        {
+            /* mono may come out as stereo, see PS */
+            if (len + frameInfo.samples > size)
+            {
+                size = (index->frames - i) * frameInfo.samples + len;
+                buf = (short*)realloc(buf, size * sizeof(short));
+            }
+            memcpy(buf + len, samples, frameInfo.samples * sizeof(short));
+            len += frameInfo.samples;
+            *channels = frameInfo.channels;
+        }
+    }
+
+    *out = buf;
+    return len;
+}
+
+/* seeks to a few positions with a decoder that has been used before and
+   compares the output up to the end with a decode from the start */
+static int check_seek(bench_ctx *b, const gen_config *cfg, int level)
+{
+    static const int frames[8] = { 0, 1, 2, 3, 9, 17, 50, -2 };
+    decode_ctx c;
+    NeAACDecADTSIndex *index;
+    char name[64], extra[128];
+    short *ref, *out;
+    unsigned long ref_len, out_len, total, pos, skip, n, j;
+    int channels, i, differs, checked = 0, failed = 0, maxdiff = 0;
+    long frame;
+
+    sprintf(name, "seek/%s/%s", gen_profile_name(cfg->profile),
+        layout_name(cfg->channels));
+    if (!bench_match(b, name))
+        return 0;
+
+    memset(&c, 0, sizeof(decode_ctx));
+    c.level = level;
+    c.s = gen_stream_create(cfg);
+    if (c.s == NULL)
+    {
+        fprintf(stderr, "%s: cannot generate stream\n", name);
+        return 1;
+    }
+    index = NeAACDecIndexADTS(c.s->data, c.s->size, 0);
+    if (index == NULL || open_decoder(&c) < 0)
+    {
+        fprintf(stderr, "%s: decoder initialisation failed\n", name);
+        if (c.hDecoder)
+            NeAACDecClose(c.hDecoder);
+        NeAACDecFreeADTSIndex(index);
+        gen_stream_free(c.s);
+        return 1;
+    }
+
+    channels = 1;
+    ref_len = decode_all(&c, index, 0, &ref, &channels);
+    total = ref_len / channels;
+
+    for (i = 0; i < 8; i++)
+    {
+        frame = (frames[i] < 0) ? (long)index->frames + frames[i] : frames[i];
+        if (frame < 0)
+            continue;
+        /* also positions inside of a frame */
+        pos = frame * c.s->frame_len + (i * 333) % c.s->frame_len;
+        if (pos >= total)
+            continue;
+
+        checked++;
+        frame = NeAACDecSeekADTS(c.hDecoder, index, c.s->data, c.s->size,
+            pos, &skip);
+        if (frame < 0)
+        {
+            fprintf(stderr, "%s: cannot seek to %lu\n", name, pos);
+            failed++;
+            continue;
+        }
+
+        out_len = decode_all(&c, index, frame, &out, &channels);
+        n = (total - pos) * channels;
+        if (out_len != skip * channels + n)
+        {
+            differs = 1;
+        } else {
+            differs = 0;
+            for (j = 0; j < n; j++)
+            {
+                int d = abs(out[skip * channels + j] - ref[pos * channels + j]);
+
+                if (d > 0)
+                    differs = 1;
+                if (d > maxdiff)
+                    maxdiff = d;
+            }
+        }
+        if (differs)
+        {
+            failed++;
+            if (b->opts.verbose)
+                fprintf(stderr, "%s: seek to %lu differs\n", name, pos);
+        }
+        free(out);
+    }
+
+    sprintf(extra, "%d/%d positions exact, max diff %d",
+        checked - failed, checked, maxdiff);
+    printf("%-32s %-8s %s\n", name,
+        bench_level_name(NeAACDecGetCpuLevel(c.hDecoder)), extra);
+
+    free(ref);
+    NeAACDecClose(c.hDecoder);
+    NeAACDecFreeADTSIndex(index);
+    gen_stream_free(c.s);
+
+    return failed ? 1 : 0;
+}
+
+/* decodes the stream in ranges, each on a new decoder as when they are
+   spread over threads, and compares the joined output with a decode from
+   the start */
+static int check_range(bench_ctx *b, const gen_config *cfg, int level)
+{
+    decode_ctx c, r;
+    NeAACDecADTSIndex *index;
+    NeAACDecFrameInfo frameInfo;
+    char name[64];
+    short *ref, *out = NULL;
+    unsigned long ref_len, out_len = 0, first, count, size;
+    int channels, failed = 0;
+
+    sprintf(name, "range/%s/%s", gen_profile_name(cfg->profile),
+        layout_name(cfg->channels));
+    if (!bench_match(b, name))
+        return 0;
+
+    memset(&c, 0, sizeof(decode_ctx));
+    c.level = level;
+    c.s = gen_stream_create(cfg);
+    if (c.s == NULL)
+    {
+        fprintf(stderr, "%s: cannot generate stream\n", name);
+        return 1;
+    }
+    index = NeAACDecIndexADTS(c.s->data, c.s->size, 0);
+    if (index == NULL || open_decoder(&c) < 0)
+    {
+        fprintf(stderr, "%s: decoder initialisation failed\n", name);
+        if (c.hDecoder)
+            NeAACDecClose(c.hDecoder);
+        NeAACDecFreeADTSIndex(index);
+        gen_stream_free(c.s);
+        return 1;
+    }
+
+    channels = 1;
+    ref_len = decode_all(&c, index, 0, &ref, &channels);
+
+    /* mono may come out as stereo, see PS */
+    size = RANGE_CHECK_FRAMES * c.s->frame_len * max(c.s->channels, 2);
+    out = (short*)malloc((ref_len + size) * sizeof(short));
+    for (first = 0; first < index->frames && !failed; first += count)
+    {
+        long samples;
+
+        count = min(RANGE_CHECK_FRAMES, index->frames - first);
+        r = c;
+        if (open_decoder(&r) < 0)
+        {
+            failed = 1;
+            break;
+        }
+        samples = NeAACDecDecodeRange(r.hDecoder, &frameInfo, index,
+            c.s->data, c.s->size, first, count, out + out_len,
+            size * sizeof(short));
+        NeAACDecClose(r.hDecoder);
+
+        if (samples < 0 || frameInfo.error ||
+            out_len + samples > ref_len ||
+            memcmp(out + out_len, ref + out_len, samples * sizeof(short)))
+        {
+            if (b->opts.verbose)
+                fprintf(stderr, "%s: range at frame %lu differs\n", name, first);
+            failed = 1;
+        } else {
+            out_len += samples;
+        }
+    }
+    if (out_len != ref_len)
+        failed = 1;
+
+    printf("%-32s %-8s %s\n", name,
+        bench_level_name(NeAACDecGetCpuLevel(c.hDecoder)),
+        failed ? "differs from a decode from the start" :
+        "same as a decode from the start");
+
+    free(out);
+    free(ref);
+    NeAACDecClose(c.hDecoder);
+    NeAACDecFreeADTSIndex(index);
+    gen_stream_free(c.s);
+
+    return failed;
+}
+
+static int parse_list(const char *arg, const char *(*name_of)(int), int count,
+                      int *enabled)
+{
+    char buf[128], *tok;
+    int i;
+
+    memset(enabled, 0, count * sizeof(int));
+    strncpy(buf, arg, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = 0;
+
+    for (tok = strtok(buf, ","); tok; tok = strtok(NULL, ","))
+    {
+        for (i = 0; i < count; i++)
+        {
+            if (!strcmp(tok, name_of(i)))
+                break;
+        }
+        if (i == count)
+        {
+            fprintf(stderr, "unknown name %s\n", tok);
+            return -1;
+        }
+        enabled[i] = 1;
+    }
+
+    return 0;
+}
+
+static const int layouts[3] = { 1, 2, 6 };
+
+static const char *layout_index_name(int i)
+{
+    return layout_name(layouts[i]);
+}
+
+int main(int argc, char *argv[])
+{
+    bench_opts opts;
+    bench_ctx b;
+    gen_config cfg;
+    int profiles[GEN_NUM_PROFILES];
+    int layout[3];
+    int level = FAAD_CPU_AUTO;
+    int frames = DEFAULT_FRAMES;
+    int show_stats = 0;
+    int check = 0, check_failed = 0;
+    const char *dump_dir = NULL;
+    int first = 1, lo, hi, l, p, i;
+
+    bench_default_opts(&opts);
+    for (p = 0; p < GEN_NUM_PROFILES; p++)
+        profiles[p] = 1;
+    for (i = 0; i < 3; i++)
+        layout[i] = 1;
+
+    for (;;)
+    {
+        first = bench_parse_opts(&opts, argc, argv, first);
+        if (first < 0 || first >= argc)
+            break;
+
+        if (!strcmp(argv[first], "-S"))
+        {
+            show_stats = 1;
+            first++;
+            continue;
+        }
+        if (!strcmp(argv[first], "-k"))
+        {
+            check = 1;
+            first++;
+            continue;
+        }
+        if (first + 1 >= argc)
+        {
+            first = -1;
+            break;
+        }
+
+        if (!strcmp(argv[first], "-c"))
+        {
+            level = bench_parse_level(argv[first + 1]);
+            if (level == -2)
+            {
+                fprintf(stderr, "unknown CPU level %s\n", argv[first + 1]);
+                return 2;
+            }
+        } else if (!strcmp(argv[first], "-p")) {
+            if (parse_list(argv[first + 1], gen_profile_name,
+                GEN_NUM_PROFILES, profiles) < 0)
+            {
+                return 2;
+            }
+        } else if (!strcmp(argv[first], "-C")) {
+            if (parse_list(argv[first + 1], layout_index_name, 3, layout) < 0)
+                return 2;
+        } else if (!strcmp(argv[first], "-n")) {
+            frames = atoi(argv[first + 1]);
+            if (frames < 1)
+                frames = 1;
+        } else if (!strcmp(argv[first], "-w")) {
+            dump_dir = argv[first + 1];
+        } else {
+            first = -1;
+            break;
+        }
+        first += 2;
+    }
+    if (first < 0)
+    {
+        fprintf(stderr, "usage: %s [options]\n", argv[0]);
+        bench_usage("  -c <lvl>   CPU level: scalar, sse2, ssse3, avx2, avx512,\n"
+                    "             auto (default) or all\n"
+                    "  -p <list>  profiles: lc, main, ltp, he, hev2, er-lc, ld\n"
+                    "  -C <list>  channel layouts: mono, stereo, 5.1\n"
+                    "  -n <num>   frames per stream (default 400)\n"
+                    "  -w <dir>   also write the streams to this directory\n"
+                    "  -S         show the time spent per decoder stage\n"
+                    "  -k         instead check that seeking in the LC and\n"
+                    "             HE streams and decoding them in ranges\n"
+                    "             gives the output of a decode from the start\n");
+        return 2;
+    }
+
+    hi = dsp_detect_level();
+    if (level == -1)
+    {
+        lo = FAAD_CPU_SCALAR;
+    } else {
+        lo = hi = level;
+    }
+
+    printf("faad decoder benchmarks, CPU level %s, %d frames per stream\n",
+        bench_level_name(dsp_detect_level()), frames);
+    if (bench_init(&b, &opts) < 0)
+        return 2;
+
+    for (l = lo; l <= hi; l++)
+    {
+        for (p = 0; p < GEN_NUM_PROFILES; p++)
+        {
+            if (!profiles[p])
+                continue;
+
+            for (i = 0; i < 3; i++)
+            {
+                if (!layout[i] || !gen_profile_supports(p, layouts[i]))
+                    continue;
+
+                memset(&cfg, 0, sizeof(gen_config));
+                cfg.profile = p;
+                cfg.channels = layouts[i];
+                cfg.frames = frames;
+                cfg.seed = 0x1234567 + 17 * p + i;
+                if (check)
+                {
+                    /* PNS noise does not continue after a seek */
+                    if (!seek_exact(p))
+                        continue;
+                    cfg.no_pns = 1;
+                    check_failed += check_seek(&b, &cfg, l);
+                    check_failed += check_range(&b, &cfg, l);
+                    continue;
+                }
+                bench_stream(&b, &cfg, l, (l == lo) ? dump_dir : NULL,
+                    show_stats);
+
+                /* the same stream in LOAS frames */
+                cfg.latm = 1;
+                bench_stream(&b, &cfg, l, (l == lo) ? dump_dir : NULL,
+                    show_stats);
+            }
+        }
+    }
+
+    if (check)
+    {
+        if (check_failed)
+            printf("%d check(s) failed\n", check_failed);
+        return check_failed ? 1 : 0;
+    }
+
+    return bench_finish(&b) ? 1 : 0;
+}
@@ -0,0 +1,1037 @@
+/*
+** FAAD2 - Freeware Advanced Audio (AAC) Decoder including SBR decoding
+** Copyright (C) 2003-2005 M. Bakker, Nero AG, http://www.nero.com
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+**
+** Any non-GPL usage of this software or parts of this software is strictly
+** forbidden.
+**
+** The "appropriate copyright message" mentioned in section 2c of the GPLv2
+** must read: "Code from FAAD2 is copyright (c) Nero AG, www.nero.com"
+**
+** Commercial non-GPL licensing of this software is possible.
+** For more info contact Nero AG through Mpeg4AAClicense@nero.com.
+**
+** $Id$
+**/
+
+/* Micro benchmarks for the individual decoder kernels.
+ *
+ * Every kernel is fed synthetic input at each frame length it supports and
+ * timed in isolation. Kernels that have runtime selected variants (see
+ * libfaad/dsp.h) are timed at each requested CPU level. Links against the
+ * static library since it needs the internal functions.
+ */
+
+#include "common.h"
+#include "structs.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "adts.h"
+#include "bits.h"
+#include "cfft.h"
+#include "mdct.h"
+#include "filtbank.h"
+#include "huffman.h"
+#include "output.h"
+#include "specrec.h"
+#include "tns.h"
+#include "pns.h"
+#ifdef MAIN_DEC
+#include "ic_predict.h"
+#endif
+#ifdef SBR_DEC
+#include "sbr_dec.h"
+#include "sbr_syntax.h"
+#include "sbr_qmf.h"
+#include "sbr_hfgen.h"
+#include "sbr_hfadj.h"
+#include "sbr_fbt.h"
+#include "sbr_tf_grid.h"
+#include "sbr_e_nf.h"
+#endif
+#ifdef PS_DEC
+#include "ps_dec.h"
+#endif
+
+#include "bench.h"
+
+/* frame lengths of the long window, LD uses half of these */
+static const uint16_t frame_lengths[] =
+{
+    1024,
+#ifdef ALLOW_SMALL_FRAMELENGTH
+    960,
+#endif
+};
+#define NUM_FRAME_LENGTHS (sizeof(frame_lengths)/sizeof(frame_lengths[0]))
+
+static unsigned int seed = 1;
+
+static real_t rand_real(double scale)
+{
+#ifdef FIXED_POINT
+    return (real_t)(bench_randf(&seed) * scale * (double)(1 << REAL_BITS));
+#else
+    return (real_t)(bench_randf(&seed) * scale);
+#endif
+}
+
+static void fill_real(real_t *x, uint32_t n, double scale)
+{
+    uint32_t i;
+
+    for (i = 0; i < n; i++)
+        x[i] = rand_real(scale);
+}
+
+static void fill_qmf(qmf_t *x, uint32_t n, double scale)
+{
+    uint32_t i;
+
+    for (i = 0; i < n; i++)
+    {
+        QMF_RE(x[i]) = rand_real(scale);
+#ifndef SBR_LOW_POWER
+        QMF_IM(x[i]) = rand_real(scale);
+#endif
+    }
+}
+
+
+/* faad_imdct() */
+
+typedef struct
+{
+    mdct_info *mdct;
+    ALIGN real_t in[2048];
+    ALIGN real_t out[2048];
+} imdct_ctx;
+
+static void run_imdct(void *p)
+{
+    imdct_ctx *c = (imdct_ctx*)p;
+
+    faad_imdct(c->mdct, c->in, c->out);
+}
+
+/* cfftb(), the transform is in place so the input is restored every call */
+
+typedef struct
+{
+    cfft_info *cfft;
+    uint16_t n;
+    ALIGN complex_t src[512];
+    ALIGN complex_t buf[512];
+} cfft_ctx;
+
+static void run_cfftb(void *p)
+{
+    cfft_ctx *c = (cfft_ctx*)p;
+
+    memcpy(c->buf, c->src, c->n * sizeof(complex_t));
+    cfftb(c->cfft, c->buf);
+}
+
+static void bench_transforms(bench_ctx *b, uint8_t level, uint8_t plain)
+{
+    /* all transform sizes used by the long, short and LD windows */
+    uint16_t sizes[3 * NUM_FRAME_LENGTHS];
+    uint8_t num_sizes = 0;
+    uint8_t i;
+    char name[64];
+
+    for (i = 0; i < NUM_FRAME_LENGTHS; i++)
+    {
+        sizes[num_sizes++] = 2 * frame_lengths[i];
+#ifdef LD_DEC
+        sizes[num_sizes++] = frame_lengths[i];
+#endif
+        sizes[num_sizes++] = frame_lengths[i] / 4;
+    }
+
+    for (i = 0; i < num_sizes; i++)
+    {
+        imdct_ctx *c;
+
+        sprintf(name, "imdct/%d", sizes[i]);
+        if (!bench_match(b, name))
+            continue;
+
+        c = (imdct_ctx*)faad_malloc(sizeof(imdct_ctx));
+        c->mdct = faad_mdct_init(sizes[i]);
+        c->mdct->dsp = dsp_select(level);
+        fill_real(c->in, sizes[i] / 2, 1000.0);
+
+        bench_run(b, name, bench_level_name(level), sizes[i], run_imdct, c);
+
+        faad_mdct_end(c->mdct);
+        faad_free(c);
+    }
+
+    /* the FFT is not dispatched, only time it once */
+    if (!plain)
+        return;
+
+    for (i = 0; i < num_sizes; i++)
+    {
+        cfft_ctx *c;
+        uint16_t n = sizes[i] / 4;
+
+        sprintf(name, "cfftb/%d", n);
+        if (!bench_match(b, name))
+            continue;
+
+        c = (cfft_ctx*)faad_malloc(sizeof(cfft_ctx));
+        c->cfft = cffti(n);
+        c->n = n;
+        fill_real((real_t*)c->src, 2 * n, 1000.0);
+
+        bench_run(b, name, "-", n, run_cfftb, c);
+
+        cfftu(c->cfft);
+        faad_free(c);
+    }
+}
+
+
+/* ifilter_bank() */
+
+typedef struct
+{
+    fb_info *fb;
+    uint8_t window_sequence;
+    uint8_t object_type;
+    uint16_t frame_len;
+    ALIGN real_t spec[1024];
+    ALIGN real_t time[1024];
+    ALIGN real_t overlap[1024];
+} fb_ctx;
+
+static void run_filterbank(void *p)
+{
+    fb_ctx *c = (fb_ctx*)p;
+
+    ifilter_bank(c->fb, c->window_sequence, 1, 1, c->spec, c->time,
+        c->overlap, c->object_type, c->frame_len);
+}
+
+static void bench_filterbank(bench_ctx *b, uint8_t level, uint8_t plain)
+{
+    static const struct
+    {
+        const char *name;
+        uint8_t window_sequence;
+        uint8_t object_type;
+    } modes[] = {
+        { "long", ONLY_LONG_SEQUENCE, LC },
+        { "start", LONG_START_SEQUENCE, LC },
+        { "short", EIGHT_SHORT_SEQUENCE, LC },
+#ifdef LD_DEC
+        { "ld", ONLY_LONG_SEQUENCE, LD },
+#endif
+    };
+    uint8_t i, m;
+    char name[64];
+
+    for (i = 0; i < NUM_FRAME_LENGTHS; i++)
+    {
+        for (m = 0; m < sizeof(modes)/sizeof(modes[0]); m++)
+        {
+            fb_ctx *c;
+            uint16_t frame_len = frame_lengths[i];
+
+            /* LD runs the filterbank at half the frame length */
+            if (modes[m].object_type == LD)
+                frame_len /= 2;
+
+            sprintf(name, "ifilter_bank/%s/%d", modes[m].name, frame_len);
+            if (!bench_match(b, name))
+                continue;
+
+            c = (fb_ctx*)faad_malloc(sizeof(fb_ctx));
+            memset(c, 0, sizeof(fb_ctx));
+            c->fb = filter_bank_init(frame_lengths[i]);
+            filter_bank_set_dsp(c->fb, dsp_select(level));
+            c->window_sequence = modes[m].window_sequence;
+            c->object_type = modes[m].object_type;
+            c->frame_len = frame_len;
+            fill_real(c->spec, frame_len, 1000.0);
+
+            bench_run(b, name, bench_level_name(level), frame_len, run_filterbank, c);
+
+            filter_bank_end(c->fb);
+            faad_free(c);
+        }
+    }
+}
+
+
+#ifdef SBR_DEC
+
+/* Sets up an SBR channel the way sbr_extension_data() would after
+ * reading a header and one FIXFIX frame with two envelopes, so that
+ * hf_generation() and hf_adjustment() see realistic tables. */
+static sbr_info *bench_sbr_init(uint16_t frame_len, uint8_t level)
+{
+    sbr_info *sbr;
+    uint8_t k2, l, k;
+
+    sbr = sbrDecodeInit(frame_len, ID_SCE, 44100, 0
+#ifdef DRM
+        , 0
+#endif
+        );
+    if (sbr == NULL)
+        return NULL;
+
+    sbr->dsp = dsp_select(level);
+
+    sbr->header_count = 1;
+    sbr->bs_amp_res = 1;
+    sbr->bs_start_freq = 5;
+    sbr->bs_stop_freq = 9;
+    sbr->bs_xover_band = 0;
+    sbr->bs_freq_scale = 2;
+    sbr->bs_alter_scale = 1;
+    sbr->bs_noise_bands = 2;
+    sbr->bs_limiter_bands = 2;
+    sbr->bs_limiter_gains = 2;
+    sbr->bs_interpol_freq = 1;
+    sbr->bs_smoothing_mode = 1;
+    sbr->Reset = 1;
+
+    sbr->k0 = qmf_start_channel(sbr->bs_start_freq, sbr->bs_samplerate_mode,
+        sbr->sample_rate);
+    k2 = qmf_stop_channel(sbr->bs_stop_freq, sbr->sample_rate, sbr->k0);
+    if (master_frequency_table(sbr, sbr->k0, k2, sbr->bs_freq_scale,
+        sbr->bs_alter_scale) ||
+        derived_frequency_table(sbr, sbr->bs_xover_band, k2))
+    {
+        sbrDecodeEnd(sbr);
+        return NULL;
+    }
+
+    /* FIXFIX grid with 2 envelopes at high frequency resolution */
+    sbr->bs_frame_class[0] = FIXFIX;
+    sbr->L_E[0] = 2;
+    sbr->L_Q[0] = 2;
+    sbr->f[0][0] = sbr->f[0][1] = 1;
+    sbr->abs_bord_lead[0] = 0;
+    sbr->abs_bord_trail[0] = sbr->numTimeSlots;
+    sbr->n_rel_lead[0] = 1;
+    sbr->n_rel_trail[0] = 0;
+    if (envelope_time_border_vector(sbr, 0))
+    {
+        sbrDecodeEnd(sbr);
+        return NULL;
+    }
+    noise_floor_time_border_vector(sbr, 0);
+
+    sbr->amp_res[0] = 1;
+    for (l = 0; l < sbr->L_E[0]; l++)
+    {
+        for (k = 0; k < sbr->n[sbr->f[0][l]]; k++)
+            sbr->E[0][k][l] = 20 + (bench_rand(&seed) & 7);
+    }
+    for (l = 0; l < sbr->L_Q[0]; l++)
+    {
+        for (k = 0; k < sbr->N_Q; k++)
+            sbr->Q[0][k][l] = 6 + (bench_rand(&seed) & 3);
+    }
+    for (k = 0; k < sbr->N_Q; k++)
+        sbr->bs_invf_mode[0][k] = 2;
+#ifndef FIXED_POINT
+    envelope_noise_dequantisation(sbr, 0);
+#endif
+
+    fill_qmf(&sbr->Xsbr[0][0][0], MAX_NTSRHFG*64, 1000.0);
+
+    return sbr;
+}
+
+typedef struct
+{
+    sbr_info *sbr;
+    ALIGN real_t time[2048];
+    ALIGN qmf_t X[MAX_NTSRHFG][64];
+#ifdef SBR_LOW_POWER
+    ALIGN real_t deg[64];
+#endif
+} sbr_ctx;
+
+static void run_qmfa(void *p)
+{
+    sbr_ctx *c = (sbr_ctx*)p;
+
+    sbr_qmf_analysis_32(c->sbr, c->sbr->qmfa[0], c->time, c->sbr->Xsbr[0],
+        c->sbr->tHFGen, 32);
+}
+
+static void run_qmfs64(void *p)
+{
+    sbr_ctx *c = (sbr_ctx*)p;
+
+    sbr_qmf_synthesis_64(c->sbr, c->sbr->qmfs[0], c->X, c->time);
+}
+
+static void run_qmfs32(void *p)
+{
+    sbr_ctx *c = (sbr_ctx*)p;
+
+    sbr_qmf_synthesis_32(c->sbr, c->sbr->qmfs[0], c->X, c->time);
+}
+
+static void run_hfgen(void *p)
+{
+    sbr_ctx *c = (sbr_ctx*)p;
+
+    hf_generation(c->sbr, c->sbr->Xsbr[0], c->sbr->Xsbr[0]
+#ifdef SBR_LOW_POWER
+        ,c->deg
+#endif
+        ,0);
+}
+
+static void run_hfadj(void *p)
+{
+    sbr_ctx *c = (sbr_ctx*)p;
+
+    hf_adjustment(c->sbr, c->sbr->Xsbr[0]
+#ifdef SBR_LOW_POWER
+        ,c->deg
+#endif
+        ,0);
+}
+
+static void bench_sbr(bench_ctx *b, uint8_t level, uint8_t plain)
+{
+    static const struct
+    {
+        const char *name;
+        bench_fn fn;
+        uint8_t dispatched;
+        uint8_t downsampled;
+    } kernels[] = {
+        { "sbr_qmf_analysis_32", run_qmfa, 1, 0 },
+        { "sbr_qmf_synthesis_64", run_qmfs64, 1, 0 },
+        { "sbr_qmf_synthesis_32", run_qmfs32, 0, 1 },
+        { "hf_generation", run_hfgen, 0, 0 },
+        { "hf_adjustment", run_hfadj, 0, 0 },
+    };
+    uint8_t i, k;
+    char name[64];
+
+    for (i = 0; i < NUM_FRAME_LENGTHS; i++)
+    {
+        for (k = 0; k < sizeof(kernels)/sizeof(kernels[0]); k++)
+        {
+            sbr_ctx *c;
+            double samples;
+
+            if (!kernels[k].dispatched && !plain)
+                continue;
+
+            sprintf(name, "%s/%d", kernels[k].name, frame_lengths[i]);
+            if (!bench_match(b, name))
+                continue;
+
+            c = (sbr_ctx*)faad_malloc(sizeof(sbr_ctx));
+            memset(c, 0, sizeof(sbr_ctx));
+            c->sbr = bench_sbr_init(frame_lengths[i], level);
+            if (c->sbr == NULL)
+            {
+                fprintf(stderr, "%s: SBR setup failed\n", name);
+                faad_free(c);
+                continue;
+            }
+            if (kernels[k].downsampled)
+            {
+                qmfs_end(c->sbr->qmfs[0]);
+                c->sbr->qmfs[0] = qmfs_init(32);
+            }
+            fill_real(c->time, 2048, 1000.0);
+            fill_qmf(&c->X[0][0], MAX_NTSRHFG*64, 1000.0);
+
+            /* the first call builds the patches and limiter tables */
+            run_hfgen(c);
+            c->sbr->Reset = 0;
+
+            /* output samples of the SBR frame */
+            samples = (double)c->sbr->numTimeSlotsRate *
+                (kernels[k].downsampled ? 32 : 64);
+
+            bench_run(b, name, kernels[k].dispatched ? bench_level_name(level) : "-",
+                samples, kernels[k].fn, c);
+
+            sbrDecodeEnd(c->sbr);
+            faad_free(c);
+        }
+    }
+}
+#endif
+
+
+#ifdef PS_DEC
+
+/* ps_decode(), works in place on the QMF matrices so they are restored
+ * every call */
+
+typedef struct
+{
+    ps_info *ps;
+    uint8_t numTimeSlotsRate;
+    ALIGN qmf_t src[38][64];
+    ALIGN qmf_t left[38][64];
+    ALIGN qmf_t right[38][64];
+} ps_ctx;
+
+static void run_ps(void *p)
+{
+    ps_ctx *c = (ps_ctx*)p;
+
+    memcpy(c->left, c->src, sizeof(c->left));
+    ps_decode(c->ps, c->left, c->right);
+}
+
+static void bench_ps(bench_ctx *b, uint8_t level, uint8_t plain)
+{
+    uint8_t i, use34;
+    char name[64];
+
+    if (!plain)
+        return;
+
+    for (i = 0; i < NUM_FRAME_LENGTHS; i++)
+    {
+        for (use34 = 0; use34 <= 1; use34++)
+        {
+            ps_ctx *c;
+            uint8_t slots = (frame_lengths[i] == 1024) ? 32 : 30;
+
+            sprintf(name, "ps_decode/%s/%d", use34 ? "34" : "20", frame_lengths[i]);
+            if (!bench_match(b, name))
+                continue;
+
+            c = (ps_ctx*)faad_malloc(sizeof(ps_ctx));
+            memset(c, 0, sizeof(ps_ctx));
+            c->ps = ps_init(4, slots);
+            c->ps->use34hybrid_bands = use34;
+            c->numTimeSlotsRate = slots;
+            fill_qmf(&c->src[0][0], 38*64, 1000.0);
+
+            bench_run(b, name, "-", slots * 64.0, run_ps, c);
+
+            ps_free(c->ps);
+            faad_free(c);
+        }
+    }
+}
+#endif
+
+
+/* tns_decode_frame(), filters in place so the spectrum is restored every
+ * call */
+
+typedef struct
+{
+    ic_stream ics;
+    uint8_t sf_index;
+    uint8_t object_type;
+    uint16_t frame_len;
+    const dsp_funcs *dsp;
+    ALIGN real_t src[1024];
+    ALIGN real_t spec[1024];
+} tns_ctx;
+
+static void run_tns(void *p)
+{
+    tns_ctx *c = (tns_ctx*)p;
+
+    memcpy(c->spec, c->src, c->frame_len * sizeof(real_t));
+    tns_decode_frame(&c->ics, &c->ics.tns, c->sf_index, c->object_type,
+        c->spec, c->frame_len, c->dsp);
+}
+
+static void bench_tns(bench_ctx *b, uint8_t level, uint8_t plain)
+{
+    uint8_t i, s, w, k;
+    char name[64];
+    NeAACDecStruct *hDecoder;
+
+    (void)plain;
+    hDecoder = (NeAACDecStruct*)NeAACDecOpen();
+
+    for (i = 0; i < NUM_FRAME_LENGTHS; i++)
+    {
+        for (s = 0; s < 2; s++)
+        {
+            tns_ctx *c;
+            uint8_t is_short = (s == 1);
+
+            sprintf(name, "tns_decode_frame/%s/%d", is_short ? "short" : "long",
+                frame_lengths[i]);
+            if (!bench_match(b, name))
+                continue;
+
+            c = (tns_ctx*)faad_malloc(sizeof(tns_ctx));
+            memset(c, 0, sizeof(tns_ctx));
+            c->sf_index = 4;
+            c->object_type = LC;
+            c->frame_len = frame_lengths[i];
+            c->dsp = dsp_select(level);
+
+            hDecoder->sf_index = c->sf_index;
+            hDecoder->object_type = c->object_type;
+            hDecoder->frameLength = c->frame_len;
+            c->ics.window_sequence = is_short ? EIGHT_SHORT_SEQUENCE : ONLY_LONG_SEQUENCE;
+            if (window_grouping_info(hDecoder, &c->ics))
+            {
+                fprintf(stderr, "%s: window grouping failed\n", name);
+                faad_free(c);
+                continue;
+            }
+            c->ics.max_sfb = c->ics.num_swb;
+            c->ics.tns_data_present = 1;
+
+            /* one filter per window over the whole TNS range, at the
+               maximum order LC allows */
+            for (w = 0; w < c->ics.num_windows; w++)
+            {
+                c->ics.tns.n_filt[w] = 1;
+                c->ics.tns.coef_res[w] = 1;
+                c->ics.tns.length[w][0] = c->ics.num_swb;
+                c->ics.tns.order[w][0] = is_short ? 7 : 12;
+                c->ics.tns.direction[w][0] = 0;
+                c->ics.tns.coef_compress[w][0] = 0;
+                for (k = 0; k < c->ics.tns.order[w][0]; k++)
+                    c->ics.tns.coef[w][0][k] = (uint8_t)(bench_rand(&seed) & 15);
+            }
+            fill_real(c->src, c->frame_len, 1000.0);
+
+            bench_run(b, name, bench_level_name(level), c->frame_len, run_tns, c);
+
+            faad_free(c);
+        }
+    }
+
+    NeAACDecClose(hDecoder);
+}
+
+
+/* pns_decode() of a long frame with noise in every band, the reference
+ * generator once and the fast one at every CPU level */
+
+typedef struct
+{
+    ic_stream ics;
+    uint8_t mode;
+    const dsp_funcs *dsp;
+    uint32_t r1, r2;
+    ALIGN real_t spec[1024];
+} pns_ctx;
+
+static void run_pns(void *p)
+{
+    pns_ctx *c = (pns_ctx*)p;
+
+    pns_decode(&c->ics, NULL, c->spec, NULL, 1024, 0, LC, &c->r1, &c->r2,
+        c->mode, c->dsp);
+}
+
+static void bench_pns(bench_ctx *b, uint8_t level, uint8_t plain)
+{
+    NeAACDecStruct *hDecoder;
+    uint8_t m, sfb;
+    char name[64];
+
+    hDecoder = (NeAACDecStruct*)NeAACDecOpen();
+    hDecoder->sf_index = 4;
+    hDecoder->object_type = LC;
+    hDecoder->frameLength = 1024;
+
+    for (m = 0; m < 2; m++)
+    {
+        pns_ctx *c;
+
+        /* only the fast generator is dispatched */
+        if (m == FAAD_PNS_REFERENCE && !plain)
+            continue;
+
+        sprintf(name, "pns_decode/%s/1024", (m == FAAD_PNS_FAST) ? "fast" : "reference");
+        if (!bench_match(b, name))
+            continue;
+
+        c = (pns_ctx*)faad_malloc(sizeof(pns_ctx));
+        memset(c, 0, sizeof(pns_ctx));
+        c->mode = m;
+        c->dsp = dsp_select(level);
+        c->r1 = c->r2 = 1;
+        c->ics.window_sequence = ONLY_LONG_SEQUENCE;
+        if (window_grouping_info(hDecoder, &c->ics))
+        {
+            fprintf(stderr, "%s: window grouping failed\n", name);
+            faad_free(c);
+            continue;
+        }
+        c->ics.max_sfb = c->ics.num_swb;
+        for (sfb = 0; sfb < c->ics.max_sfb; sfb++)
+        {
+            c->ics.sfb_cb[0][sfb] = NOISE_HCB;
+            c->ics.scale_factors[0][sfb] = 100;
+        }
+
+        bench_run(b, name, (m == FAAD_PNS_FAST) ? bench_level_name(level) : "-",
+            1024, run_pns, c);
+
+        faad_free(c);
+    }
+
+    NeAACDecClose(hDecoder);
+}
+
+
+#ifdef MAIN_DEC
+/* ic_prediction() of a long Main profile frame with prediction used in
+ * every band, the predictor state carries over between calls */
+
+typedef struct
+{
+    ic_stream ics;
+    uint8_t sf_index;
+    const dsp_funcs *dsp;
+    pred_state state;
+    ALIGN real_t src[1024];
+    ALIGN real_t spec[1024];
+} pred_ctx;
+
+static void run_pred(void *p)
+{
+    pred_ctx *c = (pred_ctx*)p;
+
+    memcpy(c->spec, c->src, sizeof(c->spec));
+    ic_prediction(&c->ics, c->spec, &c->state, 1024, c->sf_index, c->dsp);
+}
+
+static void bench_pred(bench_ctx *b, uint8_t level, uint8_t plain)
+{
+    NeAACDecStruct *hDecoder;
+    pred_ctx *c;
+    uint8_t sfb;
+
+    (void)plain;
+    if (!bench_match(b, "ic_prediction/1024"))
+        return;
+
+    c = (pred_ctx*)faad_malloc(sizeof(pred_ctx));
+    memset(c, 0, sizeof(pred_ctx));
+    c->sf_index = 4;
+    c->dsp = dsp_select(level);
+
+    hDecoder = (NeAACDecStruct*)NeAACDecOpen();
+    hDecoder->sf_index = c->sf_index;
+    hDecoder->object_type = MAIN;
+    hDecoder->frameLength = 1024;
+    c->ics.window_sequence = ONLY_LONG_SEQUENCE;
+    if (window_grouping_info(hDecoder, &c->ics) == 0)
+    {
+        c->ics.max_sfb = c->ics.num_swb;
+        c->ics.predictor_data_present = 1;
+        for (sfb = 0; sfb < MAX_SFB; sfb++)
+            c->ics.pred.prediction_used[sfb] = 1;
+        reset_all_predictors(&c->state, 1024);
+        fill_real(c->src, 1024, 1000.0);
+
+        bench_run(b, "ic_prediction/1024", bench_level_name(level), 1024, run_pred, c);
+    } else {
+        fprintf(stderr, "ic_prediction/1024: window grouping failed\n");
+    }
+
+    NeAACDecClose(hDecoder);
+    faad_free(c);
+}
+#endif
+
+
+/* huffman_spectral_data(), decodes one frame worth of coefficients from a
+ * random bitstream per call; any bit pattern is a valid code word except
+ * for some escape sequences, the stream is restarted when one fails */
+
+#define HUFF_BUF_SIZE 65536
+
+typedef struct
+{
+    uint8_t cb;
+    uint32_t bits;
+    bitfile ld;
+    uint8_t buf[HUFF_BUF_SIZE];
+    int16_t sp[1024 + 4];
+} huff_ctx;
+
+static void run_huffman(void *p)
+{
+    huff_ctx *c = (huff_ctx*)p;
+    uint8_t inc = (c->cb >= FIRST_PAIR_HCB) ? 2 : 4;
+    uint16_t k;
+
+    if (faad_get_processed_bits(&c->ld) > c->bits - 1024*32)
+        faad_initbits(&c->ld, c->buf, HUFF_BUF_SIZE);
+
+    for (k = 0; k < 1024; k += inc)
+    {
+        if (huffman_spectral_data(c->cb, &c->ld, &c->sp[k]) > 0)
+            faad_initbits(&c->ld, c->buf, HUFF_BUF_SIZE);
+    }
+}
+
+static void bench_huffman(bench_ctx *b, uint8_t level, uint8_t plain)
+{
+    uint8_t cb;
+    uint32_t i;
+    char name[64];
+
+    if (!plain)
+        return;
+
+    for (cb = 1; cb <= ESC_HCB; cb++)
+    {
+        huff_ctx *c;
+
+        sprintf(name, "huffman_spectral_data/%d", cb);
+        if (!bench_match(b, name))
+            continue;
+
+        c = (huff_ctx*)faad_malloc(sizeof(huff_ctx));
+        memset(c, 0, sizeof(huff_ctx));
+        c->cb = cb;
+        c->bits = 8 * HUFF_BUF_SIZE;
+        for (i = 0; i < HUFF_BUF_SIZE; i++)
+            c->buf[i] = (uint8_t)bench_rand(&seed);
+        faad_initbits(&c->ld, c->buf, HUFF_BUF_SIZE);
+
+        bench_run(b, name, "-", 1024, run_huffman, c);
+
+        faad_free(c);
+    }
+}
+
+
+/* output_to_PCM(), interleaved stereo */
+
+typedef struct
+{
+    NeAACDecStruct *hDecoder;
+    uint8_t format;
+    uint16_t frame_len;
+    real_t *input[MAX_CHANNELS];
+    ALIGN real_t ch[2][1024];
+    ALIGN double out[2*1024];
+} pcm_ctx;
+
+static void run_pcm(void *p)
+{
+    pcm_ctx *c = (pcm_ctx*)p;
+
+    output_to_PCM(c->hDecoder, c->input, c->out, 2, c->frame_len, c->format);
+}
+
+static void bench_output(bench_ctx *b, uint8_t level, uint8_t plain)
+{
+    static const struct
+    {
+        const char *name;
+        uint8_t format;
+    } formats[] = {
+        { "16bit", FAAD_FMT_16BIT },
+        { "24bit", FAAD_FMT_24BIT },
+#ifndef FIXED_POINT
+        { "float", FAAD_FMT_FLOAT },
+#endif
+    };
+    uint8_t i, f;
+    char name[64];
+
+    for (i = 0; i < NUM_FRAME_LENGTHS; i++)
+    {
+        for (f = 0; f < sizeof(formats)/sizeof(formats[0]); f++)
+        {
+            pcm_ctx *c;
+
+            /* only 16 bit output is dispatched */
+            if (formats[f].format != FAAD_FMT_16BIT && !plain)
+                continue;
+
+            sprintf(name, "output_to_PCM/%s/%d", formats[f].name, frame_lengths[i]);
+            if (!bench_match(b, name))
+                continue;
+
+            c = (pcm_ctx*)faad_malloc(sizeof(pcm_ctx));
+            memset(c, 0, sizeof(pcm_ctx));
+            c->hDecoder = (NeAACDecStruct*)NeAACDecOpen();
+            c->hDecoder->dsp = dsp_select(level);
+            c->hDecoder->internal_channel[0] = 0;
+            c->hDecoder->internal_channel[1] = 1;
+            c->format = formats[f].format;
+            c->frame_len = frame_lengths[i];
+            c->input[0] = c->ch[0];
+            c->input[1] = c->ch[1];
+            /* mostly in range, some samples clip */
+            fill_real(c->ch[0], 1024, 36000.0);
+            fill_real(c->ch[1], 1024, 36000.0);
+
+            bench_run(b, name, (formats[f].format == FAAD_FMT_16BIT) ?
+                bench_level_name(level) : "-", 2.0 * c->frame_len, run_pcm, c);
+
+            NeAACDecClose(c->hDecoder);
+            faad_free(c);
+        }
+    }
+}
+
+
+
+/* dsp->adts_sync() over damaged data: frequent 0xFF bytes, no syncword */
+
+#define ADTS_SCAN_BYTES 65536
+
+typedef struct
+{
+    const dsp_funcs *dsp;
+    uint8_t data[ADTS_SCAN_BYTES];
+} adts_ctx;
+
+static void run_adts_sync(void *p)
+{
+    adts_ctx *c = (adts_ctx*)p;
+
+    if (c->dsp->adts_sync(c->data, ADTS_SCAN_BYTES) != ADTS_SCAN_BYTES)
+        abort();
+}
+
+static void bench_adts(bench_ctx *b, uint8_t level, uint8_t plain)
+{
+    adts_ctx *c;
+    uint32_t i;
+
+    (void)plain;
+    if (!bench_match(b, "adts_sync"))
+        return;
+
+    c = (adts_ctx*)faad_malloc(sizeof(adts_ctx));
+    c->dsp = dsp_select(level);
+    for (i = 0; i < ADTS_SCAN_BYTES; i++)
+    {
+        uint8_t v = (uint8_t)bench_rand(&seed);
+
+        if (v < 64)
+            v = 0xFF;
+        else if (i > 0 && c->data[i-1] == 0xFF)
+            v &= 0xEF; /* never a syncword */
+        c->data[i] = v;
+    }
+
+    bench_run(b, "adts_sync", bench_level_name(level), ADTS_SCAN_BYTES,
+        run_adts_sync, c);
+
+    faad_free(c);
+}
+
+
+int main(int argc, char *argv[])
+{
+    bench_opts opts;
+    bench_ctx b;
+    int level = FAAD_CPU_AUTO;
+    int first = 1, lo, hi, l;
+
+    bench_default_opts(&opts);
+
+    for (;;)
+    {
+        first = bench_parse_opts(&opts, argc, argv, first);
+        if (first < 0 || first >= argc)
+            break;
+
+        if (!strcmp(argv[first], "-c") && first + 1 < argc)
+        {
+            level = bench_parse_level(argv[first + 1]);
+            if (level == -2)
+            {
+                fprintf(stderr, "unknown CPU level %s\n", argv[first + 1]);
+                return 2;
+            }
+            first += 2;
+        } else {
+            first = -1;
+            break;
+        }
+    }
+    if (first < 0)
+    {
+        fprintf(stderr, "usage: %s [options]\n", argv[0]);
+        bench_usage("  -c <lvl>   CPU level: scalar, sse2, ssse3, avx2, avx512,\n"
+                    "             auto (default) or all\n");
+        return 2;
+    }
+
+    hi = dsp_detect_level();
+    if (level == -1)
+    {
+        lo = FAAD_CPU_SCALAR;
+    } else {
+        if (level == FAAD_CPU_AUTO)
+            level = dsp_default_level();
+        if (level > hi)
+        {
+            fprintf(stderr, "CPU level %s not supported, using %s\n",
+                bench_level_name(level), bench_level_name(hi));
+            level = hi;
+        }
+        lo = hi = level;
+    }
+
+    printf("faad kernel benchmarks, CPU level %s\n", bench_level_name(dsp_detect_level()));
+    if (bench_init(&b, &opts) < 0)
+        return 2;
+
+    /* kernels without CPU specific variants only run at the first level */
+    for (l = lo; l <= hi; l++)
+    {
+        uint8_t plain = (l == lo);
+
+        bench_transforms(&b, (uint8_t)l, plain);
+        bench_filterbank(&b, (uint8_t)l, plain);
+#ifdef SBR_DEC
+        bench_sbr(&b, (uint8_t)l, plain);
+#endif
+#ifdef PS_DEC
+        bench_ps(&b, (uint8_t)l, plain);
+#endif
+        bench_tns(&b, (uint8_t)l, plain);
+        bench_pns(&b, (uint8_t)l, plain);
+#ifdef MAIN_DEC
+        bench_pred(&b, (uint8_t)l, plain);
+#endif
+        bench_huffman(&b, (uint8_t)l, plain);
+        bench_output(&b, (uint8_t)l, plain);
+        bench_adts(&b, (uint8_t)l, plain);
+    }
+
+    return bench_finish(&b) ? 1 : 0;
+}
@@ -0,0 +1,1329 @@
+/*
+** FAAD2 - Freeware Advanced Audio (AAC) Decoder including SBR decoding
+** Copyright (C) 2003-2005 M. Bakker, Nero AG, http://www.nero.com
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+**
+** Any non-GPL usage of this software or parts of this software is strictly
+** forbidden.
+**
+** The "appropriate copyright message" mentioned in section 2c of the GPLv2
+** must read: "Code from FAAD2 is copyright (c) Nero AG, www.nero.com"
+**
+** Commercial non-GPL licensing of this software is possible.
+** For more info contact Nero AG through Mpeg4AAClicense@nero.com.
+**
+** $Id$
+**/
+
+#include "common.h"
+#include "structs.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bits.h"
+#include "huffman.h"
+#include "specrec.h"
+#include "syntax.h"
+#ifdef SBR_DEC
+#include "sbr_dec.h"
+#include "sbr_syntax.h"
+#include "sbr_fbt.h"
+#endif
+
+#include "bench.h"
+#include "streamgen.h"
+
+/* SBR header used for every stream */
+#define GEN_SBR_START_FREQ 5
+#define GEN_SBR_STOP_FREQ  9
+
+typedef struct
+{
+    unsigned char *buf;
+    unsigned long size;
+    unsigned long bits;
+} bitwriter;
+
+typedef struct
+{
+    const gen_config *cfg;
+    unsigned int seed;
+    NeAACDecStruct *hDecoder;   /* only used for the band tables */
+    uint8_t object_type;
+    uint8_t er;
+    uint8_t sbr;
+    uint8_t ps;
+    uint16_t frame_len;         /* core frame length */
+    int frame;
+    /* SBR band counts for the high and low frequency resolution and the
+       noise floor bands */
+    uint8_t sbr_n[2];
+    uint8_t sbr_nq;
+} gen_ctx;
+
+static const struct
+{
+    const char *name;
+    uint8_t object_type;
+    uint32_t samplerate;    /* of the core coder */
+    uint16_t frame_len;
+    float bandwidth;        /* fraction of the spectrum that is coded */
+} profiles[GEN_NUM_PROFILES] =
+{
+    { "lc", LC, 44100, 1024, 0.73f },
+    { "main", MAIN, 44100, 1024, 0.73f },
+    { "ltp", LTP, 44100, 1024, 0.73f },
+    { "he", LC, 22050, 1024, 0.85f },
+    { "hev2", LC, 22050, 1024, 0.85f },
+    { "er-lc", ER_LC, 44100, 1024, 0.73f },
+    { "ld", LD, 48000, 512, 0.6f },
+};
+
+/* largest spectral value the inverse quantiser accepts */
+#define MAX_QUANT 8191
+
+/* scalefactor code words for the differences -2 .. 2 */
+static const char *sf_code[5] = { "11010", "100", "0", "1010", "1100" };
+
+/* code words for the differences -1 .. 1 of the SBR and PS tables used */
+static const char *sbr_env_code[3] = { "10", "0", "110" };   /* t and f, 3 dB */
+static const char *sbr_noise_t_code[3] = { "110", "0", "10" };
+static const char *ps_iid_f_code[3] = { "101", "0", "100" };
+static const char *ps_icc_f_code[3] = { "110", "0", "10" };
+
+/* section codebooks from low to high frequencies, in pairs */
+static const uint8_t cb_by_pos[8][2] =
+{
+    { 11, 11 }, { 9, 10 }, { 7, 8 }, { 7, 8 }, { 5, 6 }, { 3, 4 }, { 3, 4 }, { 1, 2 }
+};
+
+/* short window groupings */
+static const uint8_t groupings[4] = { 0x00, 0x5B, 0x36, 0x7F };
+
+
+static void bw_grow(bitwriter *bw, unsigned long bytes)
+{
+    unsigned long size = bw->size ? bw->size : 1024;
+
+    while (size < bytes)
+        size *= 2;
+    if (size != bw->size)
+    {
+        bw->buf = (unsigned char*)realloc(bw->buf, size);
+        memset(bw->buf + bw->size, 0, size - bw->size);
+        bw->size = size;
+    }
+}
+
+static void bw_put(bitwriter *bw, uint32_t value, int n)
+{
+    bw_grow(bw, ((bw->bits + n) >> 3) + 1);
+
+    while (n-- > 0)
+    {
+        if ((value >> n) & 1)
+            bw->buf[bw->bits >> 3] |= 0x80 >> (bw->bits & 7);
+        bw->bits++;
+    }
+}
+
+static void bw_put_code(bitwriter *bw, const char *code)
+{
+    for (; *code; code++)
+        bw_put(bw, *code == '1', 1);
+}
+
+/* appends the first n bits of buf */
+static void bw_put_bits_from(bitwriter *bw, const unsigned char *buf, unsigned long n)
+{
+    unsigned long i;
+
+    for (i = 0; i < n; i++)
+        bw_put(bw, (buf[i >> 3] >> (7 - (i & 7))) & 1, 1);
+}
+
+static void bw_align(bitwriter *bw)
+{
+    bw->bits = (bw->bits + 7) & ~7UL;
+    bw_grow(bw, (bw->bits >> 3) + 1);
+}
+
+static void bw_free(bitwriter *bw)
+{
+    free(bw->buf);
+    memset(bw, 0, sizeof(bitwriter));
+}
+
+
+static unsigned int gen_rand(gen_ctx *g, unsigned int n)
+{
+    return bench_rand(&g->seed) % n;
+}
+
+/* a random step of -1, 0 or 1 that keeps value within [lo, hi] */
+static int gen_step(gen_ctx *g, int value, int lo, int hi)
+{
+    int d = (int)gen_rand(g, 3) - 1;
+
+    if (value + d < lo || value + d > hi)
+        d = -d;
+    return d;
+}
+
+
+/* spectral data: random bits are fed to the decoder's own Huffman decoder
+   until they form a valid code word with values the inverse quantiser
+   accepts, which is then copied to the stream */
+static void put_codeword(gen_ctx *g, bitwriter *bw, uint8_t cb)
+{
+    unsigned char scratch[16];
+    int16_t sp[4];
+    bitfile ld;
+    int i;
+
+    for (;;)
+    {
+        for (i = 0; i < 16; i++)
+            scratch[i] = (unsigned char)bench_rand(&g->seed);
+
+        faad_initbits(&ld, scratch, sizeof(scratch));
+        if (huffman_spectral_data(cb, &ld, sp) == 0 && !ld.error &&
+            abs(sp[0]) <= MAX_QUANT && abs(sp[1]) <= MAX_QUANT)
+        {
+            break;
+        }
+    }
+
+    bw_put_bits_from(bw, scratch, faad_get_processed_bits(&ld));
+}
+
+static uint8_t gen_window_sequence(gen_ctx *g, uint8_t lfe)
+{
+    if (lfe || g->object_type == LD)
+        return ONLY_LONG_SEQUENCE;
+
+    /* a short block every 16 frames */
+    switch (g->frame % 16)
+    {
+    case 7: return LONG_START_SEQUENCE;
+    case 8: return EIGHT_SHORT_SEQUENCE;
+    case 9: return LONG_STOP_SEQUENCE;
+    default: return ONLY_LONG_SEQUENCE;
+    }
+}
+
+static void setup_ics(gen_ctx *g, ic_stream *ics, uint8_t lfe)
+{
+    float bandwidth = lfe ? 0.02f : profiles[g->cfg->profile].bandwidth;
+    uint8_t sfb;
+
+    memset(ics, 0, sizeof(ic_stream));
+    ics->window_sequence = gen_window_sequence(g, lfe);
+    ics->window_shape = (g->object_type == LD) ? 0 : 1;
+    if (ics->window_sequence == EIGHT_SHORT_SEQUENCE)
+        ics->scale_factor_grouping = groupings[gen_rand(g, 4)];
+
+    window_grouping_info(g->hDecoder, ics);
+    for (sfb = 1; sfb < ics->num_swb; sfb++)
+    {
+        if (ics->swb_offset[sfb] >= bandwidth * ics->swb_offset_max)
+            break;
+    }
+    ics->max_sfb = sfb;
+    window_grouping_info(g->hDecoder, ics);
+}
+
+static void choose_codebooks(gen_ctx *g, ic_stream *ics, uint8_t lfe,
+                             uint8_t second)
+{
+    uint8_t grp, sfb;
+    uint8_t is_long = (ics->window_sequence != EIGHT_SHORT_SEQUENCE);
+
+    ics->noise_used = 0;
+    ics->is_used = 0;
+
+    for (grp = 0; grp < ics->num_window_groups; grp++)
+    {
+        for (sfb = 0; sfb < ics->max_sfb; sfb++)
+        {
+            uint8_t cb = cb_by_pos[sfb * 8 / ics->max_sfb][gen_rand(g, 2)];
+            uint8_t top = ics->max_sfb - sfb;
+
+            if (gen_rand(g, 16) == 0)
+                cb = ZERO_HCB;
+
+            /* noise substitution on even frames and intensity stereo on
+               odd ones, both in the highest bands */
+            if (!lfe && is_long && ics->max_sfb > 8)
+            {
+                if ((g->frame & 1) == 0 && top <= 2 && !g->cfg->no_pns)
+                {
+                    cb = NOISE_HCB;
+                    ics->noise_used = 1;
+                } else if (second && (g->frame & 1) && top <= 3) {
+                    cb = INTENSITY_HCB;
+                    ics->is_used = 1;
+                }
+            }
+
+            ics->sfb_cb[grp][sfb] = cb;
+        }
+    }
+}
+
+static void put_ltp_data(gen_ctx *g, bitwriter *bw, ic_stream *ics)
+{
+    uint16_t lag = g->frame_len / 2 + gen_rand(g, g->frame_len);
+    uint8_t sfb, last_band;
+
+    if (g->object_type == LD)
+    {
+        bw_put(bw, 1, 1); /* lag_update */
+        bw_put(bw, lag, 10);
+    } else {
+        bw_put(bw, lag, 11);
+    }
+    bw_put(bw, gen_rand(g, 8), 3);
+
+    /* only called for long blocks */
+    last_band = min(ics->max_sfb, MAX_LTP_SFB);
+    for (sfb = 0; sfb < last_band; sfb++)
+        bw_put(bw, 1, 1);
+}
+
+static void put_ics_info(gen_ctx *g, bitwriter *bw, ic_stream *ics,
+                         uint8_t common_window, uint8_t lfe)
+{
+    uint8_t sfb;
+
+    bw_put(bw, 0, 1);
+    bw_put(bw, ics->window_sequence, 2);
+    bw_put(bw, ics->window_shape, 1);
+
+    if (ics->window_sequence == EIGHT_SHORT_SEQUENCE)
+    {
+        bw_put(bw, ics->max_sfb, 4);
+        bw_put(bw, ics->scale_factor_grouping, 7);
+        return;
+    }
+    bw_put(bw, ics->max_sfb, 6);
+
+    ics->predictor_data_present = !lfe &&
+        (g->object_type == MAIN || g->object_type == LTP || g->object_type == LD);
+    bw_put(bw, ics->predictor_data_present, 1);
+    if (!ics->predictor_data_present)
+        return;
+
+    if (g->object_type == MAIN)
+    {
+        uint8_t limit = min(ics->max_sfb, max_pred_sfb(g->hDecoder->sf_index));
+
+        /* reset one predictor group every 8 frames */
+        if (g->frame % 8 == 0)
+        {
+            bw_put(bw, 1, 1);
+            bw_put(bw, (g->frame / 8) % 30 + 1, 5);
+        } else {
+            bw_put(bw, 0, 1);
+        }
+        for (sfb = 0; sfb < limit; sfb++)
+            bw_put(bw, 1, 1);
+    } else if (!g->er) {
+        bw_put(bw, 1, 1);
+        put_ltp_data(g, bw, ics);
+        if (common_window)
+        {
+            bw_put(bw, 1, 1);
+            put_ltp_data(g, bw, ics);
+        }
+    } else if (!common_window) {
+        bw_put(bw, 1, 1);
+        put_ltp_data(g, bw, ics);
+    }
+}
+
+static void put_section_data(bitwriter *bw, ic_stream *ics)
+{
+    uint8_t sect_bits = (ics->window_sequence == EIGHT_SHORT_SEQUENCE) ? 3 : 5;
+    uint8_t sect_esc_val = (1 << sect_bits) - 1;
+    uint8_t grp, sfb, len, incr;
+
+    for (grp = 0; grp < ics->num_window_groups; grp++)
+    {
+        for (sfb = 0; sfb < ics->max_sfb; sfb += len)
+        {
+            uint8_t cb = ics->sfb_cb[grp][sfb];
+
+            for (len = 1; sfb + len < ics->max_sfb; len++)
+            {
+                if (ics->sfb_cb[grp][sfb + len] != cb)
+                    break;
+            }
+
+            bw_put(bw, cb, 4);
+            for (incr = len; incr >= sect_esc_val; incr -= sect_esc_val)
+                bw_put(bw, sect_esc_val, sect_bits);
+            bw_put(bw, incr, sect_bits);
+        }
+    }
+}
+
+static void put_scale_factors(gen_ctx *g, bitwriter *bw, ic_stream *ics)
+{
+    int sf = ics->global_gain;
+    int is_position = 0;
+    uint8_t noise_first = 1;
+    uint8_t grp, sfb;
+    int d;
+
+    for (grp = 0; grp < ics->num_window_groups; grp++)
+    {
+        for (sfb = 0; sfb < ics->max_sfb; sfb++)
+        {
+            switch (ics->sfb_cb[grp][sfb])
+            {
+            case ZERO_HCB:
+                break;
+            case INTENSITY_HCB:
+            case INTENSITY_HCB2:
+                d = gen_step(g, is_position, -8, 8);
+                is_position += d;
+                bw_put_code(bw, sf_code[d + 2]);
+                break;
+            case NOISE_HCB:
+                /* noise energy relative to global_gain - 90 */
+                if (noise_first)
+                {
+                    bw_put(bw, 256 - 20, 9);
+                    noise_first = 0;
+                } else {
+                    bw_put_code(bw, sf_code[2]);
+                }
+                break;
+            default:
+                d = gen_step(g, sf, ics->global_gain - 12, ics->global_gain + 12);
+                sf += d;
+                bw_put_code(bw, sf_code[d + 2]);
+                break;
+            }
+        }
+    }
+}
+
+static void put_tns_data(gen_ctx *g, bitwriter *bw, ic_stream *ics)
+{
+    uint8_t w, i;
+
+    if (ics->window_sequence == EIGHT_SHORT_SEQUENCE)
+    {
+        for (w = 0; w < 8; w++)
+        {
+            bw_put(bw, 1, 1);   /* n_filt */
+            bw_put(bw, 1, 1);   /* coef_res */
+            bw_put(bw, min(ics->max_sfb, 15), 4);
+            bw_put(bw, 4, 3);
+            bw_put(bw, gen_rand(g, 2), 1);
+            bw_put(bw, 0, 1);
+            for (i = 0; i < 4; i++)
+                bw_put(bw, gen_rand(g, 16), 4);
+        }
+    } else {
+        bw_put(bw, 1, 2);
+        bw_put(bw, 1, 1);
+        bw_put(bw, min(ics->max_sfb, 63), 6);
+        bw_put(bw, 8, 5);
+        bw_put(bw, gen_rand(g, 2), 1);
+        bw_put(bw, 0, 1);
+        for (i = 0; i < 8; i++)
+            bw_put(bw, gen_rand(g, 16), 4);
+    }
+}
+
+static void put_spectral_data(gen_ctx *g, bitwriter *bw, ic_stream *ics)
+{
+    uint8_t grp, sfb;
+    uint16_t k;
+
+    for (grp = 0; grp < ics->num_window_groups; grp++)
+    {
+        for (sfb = 0; sfb < ics->max_sfb; sfb++)
+        {
+            uint8_t cb = ics->sfb_cb[grp][sfb];
+            uint8_t inc = (cb >= FIRST_PAIR_HCB) ? 2 : 4;
+
+            if (cb == ZERO_HCB || cb == NOISE_HCB ||
+                cb == INTENSITY_HCB || cb == INTENSITY_HCB2)
+            {
+                continue;
+            }
+
+            for (k = ics->sect_sfb_offset[grp][sfb];
+                 k < ics->sect_sfb_offset[grp][sfb + 1]; k += inc)
+            {
+                put_codeword(g, bw, cb);
+            }
+        }
+    }
+}
+
+/* individual_channel_stream() */
+static void put_ics(gen_ctx *g, bitwriter *bw, ic_stream *ics,
+                    uint8_t common_window, uint8_t lfe)
+{
+    uint8_t tns = !lfe && (ics->window_sequence == EIGHT_SHORT_SEQUENCE ||
+        g->frame % 4 == 1);
+
+    /* about -25 dB full scale, SBR adds the energy of the high band */
+    ics->global_gain = g->sbr ? 100 : 128;
+    bw_put(bw, ics->global_gain, 8);
+    if (!common_window)
+        put_ics_info(g, bw, ics, common_window, lfe);
+    put_section_data(bw, ics);
+    put_scale_factors(g, bw, ics);
+
+    bw_put(bw, 0, 1);   /* pulse_data_present */
+    bw_put(bw, tns, 1);
+    if (tns && !g->er)
+        put_tns_data(g, bw, ics);
+    bw_put(bw, 0, 1);   /* gain_control_data_present */
+    if (tns && g->er)
+        put_tns_data(g, bw, ics);
+
+    put_spectral_data(g, bw, ics);
+}
+
+
+#ifdef SBR_DEC
+static void put_sbr_header(bitwriter *bw)
+{
+    bw_put(bw, 1, 1);   /* bs_amp_res */
+    bw_put(bw, GEN_SBR_START_FREQ, 4);
+    bw_put(bw, GEN_SBR_STOP_FREQ, 4);
+    bw_put(bw, 0, 3);   /* bs_xover_band */
+    bw_put(bw, 0, 2);
+    bw_put(bw, 0, 1);   /* defaults for the rest */
+    bw_put(bw, 0, 1);
+}
+
+/* FIXFIX with two envelopes at high frequency resolution */
+static void put_sbr_grid(bitwriter *bw)
+{
+    bw_put(bw, FIXFIX, 2);
+    bw_put(bw, 1, 2);
+    bw_put(bw, 1, 1);
+}
+
+/* first envelope and noise floor coded in frequency direction, the
+   second one in time direction */
+static void put_sbr_dtdf(bitwriter *bw)
+{
+    bw_put(bw, 0, 1);
+    bw_put(bw, 1, 1);
+    bw_put(bw, 0, 1);
+    bw_put(bw, 1, 1);
+}
+
+static void put_sbr_invf(gen_ctx *g, bitwriter *bw)
+{
+    uint8_t n;
+
+    for (n = 0; n < g->sbr_nq; n++)
+        bw_put(bw, 2, 2);
+}
+
+static void put_sbr_envelope(gen_ctx *g, bitwriter *bw)
+{
+    uint8_t band, n = g->sbr_n[1];
+    int e[64];
+    int d;
+
+    e[0] = 20 + gen_rand(g, 8);
+    bw_put(bw, e[0], 6);
+    for (band = 1; band < n; band++)
+    {
+        d = gen_step(g, e[band - 1], 12, 40);
+        e[band] = e[band - 1] + d;
+        bw_put_code(bw, sbr_env_code[d + 1]);
+    }
+    for (band = 0; band < n; band++)
+    {
+        d = gen_step(g, e[band], 12, 40);
+        bw_put_code(bw, sbr_env_code[d + 1]);
+    }
+}
+
+static void put_sbr_noise(gen_ctx *g, bitwriter *bw)
+{
+    uint8_t band;
+    int q[64];
+    int d;
+
+    q[0] = 4 + gen_rand(g, 4);
+    bw_put(bw, q[0], 5);
+    for (band = 1; band < g->sbr_nq; band++)
+    {
+        d = gen_step(g, q[band - 1], 0, 12);
+        q[band] = q[band - 1] + d;
+        bw_put_code(bw, sbr_env_code[d + 1]);
+    }
+    for (band = 0; band < g->sbr_nq; band++)
+    {
+        d = gen_step(g, q[band], 0, 12);
+        bw_put_code(bw, sbr_noise_t_code[d + 1]);
+    }
+}
+
+/* ps_data() with a header, one envelope and 20 IID and ICC bands */
+static void put_ps_data(gen_ctx *g, bitwriter *bw)
+{
+    int iid = 0, icc = 0, d;
+    uint8_t n;
+
+    bw_put(bw, 1, 1);   /* enable_ps_header */
+    bw_put(bw, 1, 1);   /* enable_iid */
+    bw_put(bw, 1, 3);
+    bw_put(bw, 1, 1);   /* enable_icc */
+    bw_put(bw, 1, 3);
+    bw_put(bw, 0, 1);   /* enable_ext */
+
+    bw_put(bw, 0, 1);   /* frame_class */
+    bw_put(bw, 1, 2);   /* one envelope */
+
+    bw_put(bw, 0, 1);
+    for (n = 0; n < 20; n++)
+    {
+        d = gen_step(g, iid, -4, 4);
+        iid += d;
+        bw_put_code(bw, ps_iid_f_code[d + 1]);
+    }
+    bw_put(bw, 0, 1);
+    for (n = 0; n < 20; n++)
+    {
+        d = gen_step(g, icc, 0, 5);
+        icc += d;
+        bw_put_code(bw, ps_icc_f_code[d + 1]);
+    }
+}
+
+static void put_sbr_extended_data(gen_ctx *g, bitwriter *bw)
+{
+    bitwriter ps;
+    unsigned long cnt;
+
+    if (!g->ps)
+    {
+        bw_put(bw, 0, 1);
+        return;
+    }
+
+    memset(&ps, 0, sizeof(bitwriter));
+    bw_put(&ps, EXTENSION_ID_PS, 2);
+    put_ps_data(g, &ps);
+    cnt = (ps.bits + 7) / 8;
+
+    bw_put(bw, 1, 1);
+    if (cnt >= 15)
+    {
+        bw_put(bw, 15, 4);
+        bw_put(bw, cnt - 15, 8);
+    } else {
+        bw_put(bw, cnt, 4);
+    }
+    bw_put_bits_from(bw, ps.buf, 8 * cnt);
+    bw_free(&ps);
+}
+
+/* fill_element() with SBR data for the preceding SCE or CPE */
+static void put_sbr_fill(gen_ctx *g, bitwriter *bw, uint8_t id)
+{
+    bitwriter sbr;
+    unsigned long cnt;
+
+    memset(&sbr, 0, sizeof(bitwriter));
+    bw_put(&sbr, EXT_SBR_DATA, 4);
+    if (g->frame % 8 == 0)
+    {
+        bw_put(&sbr, 1, 1);
+        put_sbr_header(&sbr);
+    } else {
+        bw_put(&sbr, 0, 1);
+    }
+
+    bw_put(&sbr, 0, 1); /* bs_data_extra */
+    if (id == ID_SCE)
+    {
+        put_sbr_grid(&sbr);
+        put_sbr_dtdf(&sbr);
+        put_sbr_invf(g, &sbr);
+        put_sbr_envelope(g, &sbr);
+        put_sbr_noise(g, &sbr);
+        bw_put(&sbr, 0, 1); /* bs_add_harmonic_flag */
+        put_sbr_extended_data(g, &sbr);
+    } else {
+        bw_put(&sbr, 0, 1); /* bs_coupling */
+        put_sbr_grid(&sbr);
+        put_sbr_grid(&sbr);
+        put_sbr_dtdf(&sbr);
+        put_sbr_dtdf(&sbr);
+        put_sbr_invf(g, &sbr);
+        put_sbr_invf(g, &sbr);
+        put_sbr_envelope(g, &sbr);
+        put_sbr_envelope(g, &sbr);
+        put_sbr_noise(g, &sbr);
+        put_sbr_noise(g, &sbr);
+        bw_put(&sbr, 0, 1);
+        bw_put(&sbr, 0, 1);
+        bw_put(&sbr, 0, 1); /* bs_extended_data */
+    }
+
+    cnt = (sbr.bits + 7) / 8;
+    bw_put(bw, ID_FIL, LEN_SE_ID);
+    if (cnt >= 15)
+    {
+        bw_put(bw, 15, 4);
+        bw_put(bw, cnt - 14, 8);
+    } else {
+        bw_put(bw, cnt, 4);
+    }
+    bw_put_bits_from(bw, sbr.buf, 8 * cnt);
+    bw_free(&sbr);
+}
+
+static uint8_t sbr_band_counts(gen_ctx *g)
+{
+    sbr_info *sbr;
+    uint8_t k2, ret;
+
+    sbr = sbrDecodeInit(g->frame_len, ID_SCE, 2 * profiles[g->cfg->profile].samplerate, 0
+#ifdef DRM
+        , 0
+#endif
+        );
+    if (sbr == NULL)
+        return 1;
+
+    sbr->bs_freq_scale = 2;
+    sbr->bs_alter_scale = 1;
+    sbr->bs_noise_bands = 2;
+    sbr->k0 = qmf_start_channel(GEN_SBR_START_FREQ, sbr->bs_samplerate_mode,
+        sbr->sample_rate);
+    k2 = qmf_stop_channel(GEN_SBR_STOP_FREQ, sbr->sample_rate, sbr->k0);
+    ret = master_frequency_table(sbr, sbr->k0, k2, sbr->bs_freq_scale,
+        sbr->bs_alter_scale);
+    if (ret == 0)
+        ret = derived_frequency_table(sbr, 0, k2);
+
+    g->sbr_n[0] = sbr->n[0];
+    g->sbr_n[1] = sbr->n[1];
+    g->sbr_nq = sbr->N_Q;
+    sbrDecodeEnd(sbr);
+
+    return ret;
+}
+#endif
+
+
+static void put_sce(gen_ctx *g, bitwriter *bw, uint8_t id, uint8_t tag)
+{
+    ic_stream ics;
+    uint8_t lfe = (id == ID_LFE);
+
+    if (!g->er)
+        bw_put(bw, id, LEN_SE_ID);
+    bw_put(bw, tag, LEN_TAG);
+
+    setup_ics(g, &ics, lfe);
+    choose_codebooks(g, &ics, lfe, 0);
+    put_ics(g, bw, &ics, 0, lfe);
+
+#ifdef SBR_DEC
+    if (g->sbr && !lfe)
+        put_sbr_fill(g, bw, ID_SCE);
+#endif
+}
+
+static void put_cpe(gen_ctx *g, bitwriter *bw, uint8_t tag)
+{
+    ic_stream ics1, ics2;
+    uint8_t grp, sfb;
+
+    if (!g->er)
+        bw_put(bw, ID_CPE, LEN_SE_ID);
+    bw_put(bw, tag, LEN_TAG);
+
+    setup_ics(g, &ics1, 0);
+    bw_put(bw, 1, 1);   /* common_window */
+    put_ics_info(g, bw, &ics1, 1, 0);
+
+    bw_put(bw, 1, 2);   /* ms_mask_present */
+    for (grp = 0; grp < ics1.num_window_groups; grp++)
+    {
+        for (sfb = 0; sfb < ics1.max_sfb; sfb++)
+            bw_put(bw, gen_rand(g, 4) != 0, 1);
+    }
+
+    if (g->er && ics1.predictor_data_present)
+    {
+        bw_put(bw, 1, 1);
+        put_ltp_data(g, bw, &ics1);
+    }
+
+    memcpy(&ics2, &ics1, sizeof(ic_stream));
+    choose_codebooks(g, &ics1, 0, 0);
+    put_ics(g, bw, &ics1, 1, 0);
+
+    if (g->er && ics1.predictor_data_present)
+    {
+        bw_put(bw, 1, 1);
+        put_ltp_data(g, bw, &ics1);
+    }
+
+    choose_codebooks(g, &ics2, 0, 1);
+    put_ics(g, bw, &ics2, 1, 0);
+
+#ifdef SBR_DEC
+    if (g->sbr)
+        put_sbr_fill(g, bw, ID_CPE);
+#endif
+}
+
+/* raw_data_block() or er_raw_data_block() */
+static void put_raw_data_block(gen_ctx *g, bitwriter *bw)
+{
+    switch (g->cfg->channels)
+    {
+    case 1:
+        put_sce(g, bw, ID_SCE, 0);
+        break;
+    case 2:
+        put_cpe(g, bw, 0);
+        break;
+    case 6:
+        put_sce(g, bw, ID_SCE, 0);
+        put_cpe(g, bw, 0);
+        put_cpe(g, bw, 1);
+        put_sce(g, bw, ID_LFE, 0);
+        break;
+    }
+
+    if (!g->er)
+        bw_put(bw, ID_END, LEN_SE_ID);
+    bw_align(bw);
+}
+
+static void put_adts_header(gen_ctx *g, bitwriter *bw, unsigned long frame_bytes)
+{
+    bw_put(bw, 0xFFF, 12);
+    bw_put(bw, 0, 1);   /* MPEG-4 */
+    bw_put(bw, 0, 2);
+    bw_put(bw, 1, 1);   /* no CRC */
+    bw_put(bw, g->object_type - 1, 2);
+    bw_put(bw, g->hDecoder->sf_index, 4);
+    bw_put(bw, 0, 1);
+    bw_put(bw, g->cfg->channels, 3);
+    bw_put(bw, 0, 4);
+    bw_put(bw, frame_bytes, 13);
+    bw_put(bw, 0x7FF, 11);
+    bw_put(bw, 0, 2);
+}
+
+static void put_asc_bits(gen_ctx *g, bitwriter *bw)
+{
+    bw_put(bw, g->object_type, 5);
+    bw_put(bw, g->hDecoder->sf_index, 4);
+    bw_put(bw, g->cfg->channels, 4);
+    bw_put(bw, 0, 1);   /* frameLengthFlag */
+    bw_put(bw, 0, 1);   /* dependsOnCoreCoder */
+    bw_put(bw, g->er, 1);
+    if (g->er)
+    {
+        bw_put(bw, 0, 3);   /* no resilience tools */
+        bw_put(bw, 0, 1);   /* extensionFlag3 */
+        bw_put(bw, 0, 2);   /* epConfig */
+    }
+}
+
+static void put_asc(gen_ctx *g, gen_stream *s)
+{
+    bitwriter bw;
+
+    memset(&bw, 0, sizeof(bitwriter));
+    put_asc_bits(g, &bw);
+    bw_align(&bw);
+
+    s->asc_len = (int)(bw.bits / 8);
+    memcpy(s->asc, bw.buf, s->asc_len);
+    bw_free(&bw);
+}
+
+
+/* LOAS frame with one access unit. The StreamMuxConfig (version 0, one
+   program with one layer) is repeated every 8 frames, as a broadcast
+   repeats it for receivers that tune in. */
+static void put_loas_frame(gen_ctx *g, bitwriter *bw, const bitwriter *au)
+{
+    bitwriter mux;
+    unsigned long bytes = au->bits / 8, n;
+
+    memset(&mux, 0, sizeof(bitwriter));
+    if (g->frame % 8 == 0)
+    {
+        bw_put(&mux, 0, 1); /* useSameStreamMux */
+        bw_put(&mux, 0, 1); /* audioMuxVersion */
+        bw_put(&mux, 1, 1); /* allStreamsSameTimeFraming */
+        bw_put(&mux, 0, 6); /* numSubFrames */
+        bw_put(&mux, 0, 4); /* numProgram */
+        bw_put(&mux, 0, 3); /* numLayer */
+        put_asc_bits(g, &mux);
+        bw_put(&mux, 0, 3); /* frameLengthType */
+        bw_put(&mux, 0xFF, 8); /* latmBufferFullness */
+        bw_put(&mux, 0, 1); /* otherDataPresent */
+        bw_put(&mux, 0, 1); /* crcCheckPresent */
+    } else {
+        bw_put(&mux, 1, 1);
+    }
+
+    /* PayloadLengthInfo() and PayloadMux() */
+    for (n = bytes; n >= 255; n -= 255)
+        bw_put(&mux, 255, 8);
+    bw_put(&mux, n, 8);
+    bw_put_bits_from(&mux, au->buf, au->bits);
+    bw_align(&mux);
+
+    bw_put(bw, 0x2B7, 11);
+    bw_put(bw, mux.bits / 8, 13);
+    bw_put_bits_from(bw, mux.buf, mux.bits);
+    bw_free(&mux);
+}
+
+
+const char *gen_profile_name(int profile)
+{
+    if (profile < 0 || profile >= GEN_NUM_PROFILES)
+        return "?";
+    return profiles[profile].name;
+}
+
+int gen_profile_supports(int profile, int channels)
+{
+    if (profile < 0 || profile >= GEN_NUM_PROFILES)
+        return 0;
+    if (channels != 1 && channels != 2 && channels != 6)
+        return 0;
+
+    switch (profiles[profile].object_type)
+    {
+#ifndef MAIN_DEC
+    case MAIN:
+        return 0;
+#endif
+#ifndef LTP_DEC
+    case LTP:
+        return 0;
+#endif
+#ifndef ERROR_RESILIENCE
+    case ER_LC:
+        return 0;
+#endif
+#ifndef LD_DEC
+    case LD:
+        return 0;
+#endif
+    default:
+        break;
+    }
+#ifndef SBR_DEC
+    if (profile == GEN_HE || profile == GEN_HEV2)
+        return 0;
+#endif
+#ifndef PS_DEC
+    if (profile == GEN_HEV2)
+        return 0;
+#endif
+    /* parametric stereo needs a mono core */
+    if (profile == GEN_HEV2 && channels != 1)
+        return 0;
+
+    return 1;
+}
+
+gen_stream *gen_stream_create(const gen_config *cfg)
+{
+    gen_ctx g;
+    gen_stream *s;
+    bitwriter out, frame;
+    int i;
+
+    if (!gen_profile_supports(cfg->profile, cfg->channels) || cfg->frames <= 0)
+        return NULL;
+
+    memset(&g, 0, sizeof(gen_ctx));
+    g.cfg = cfg;
+    g.seed = cfg->seed ? cfg->seed : 1;
+    g.object_type = profiles[cfg->profile].object_type;
+    g.er = (g.object_type >= ER_OBJECT_START);
+    g.sbr = (cfg->profile == GEN_HE || cfg->profile == GEN_HEV2);
+    g.ps = (cfg->profile == GEN_HEV2);
+    g.frame_len = profiles[cfg->profile].frame_len;
+
+    g.hDecoder = (NeAACDecStruct*)NeAACDecOpen();
+    if (g.hDecoder == NULL)
+        return NULL;
+    g.hDecoder->sf_index = get_sr_index(profiles[cfg->profile].samplerate);
+    g.hDecoder->object_type = g.object_type;
+    g.hDecoder->frameLength = g.frame_len;
+
+#ifdef SBR_DEC
+    if (g.sbr && sbr_band_counts(&g))
+    {
+        NeAACDecClose(g.hDecoder);
+        return NULL;
+    }
+#endif
+
+    s = (gen_stream*)calloc(1, sizeof(gen_stream));
+    s->cfg = *cfg;
+    s->latm = cfg->latm;
+    s->adts = !g.er && !s->latm;
+    s->offset = (unsigned long*)malloc((cfg->frames + 1) * sizeof(unsigned long));
+    s->samplerate = profiles[cfg->profile].samplerate * (g.sbr ? 2 : 1);
+    s->channels = g.ps ? 2 : cfg->channels;
+    s->frame_len = g.frame_len * (g.sbr ? 2 : 1);
+    if (!s->adts)
+        put_asc(&g, s);
+
+    memset(&out, 0, sizeof(bitwriter));
+    memset(&frame, 0, sizeof(bitwriter));
+
+    for (i = 0; i < cfg->frames; i++)
+    {
+        unsigned long bytes;
+
+        g.frame = i;
+        frame.bits = 0;
+        if (frame.buf)
+            memset(frame.buf, 0, frame.size);
+        put_raw_data_block(&g, &frame);
+        bytes = frame.bits / 8;
+
+        s->offset[i] = out.bits / 8;
+        if (s->latm)
+        {
+            put_loas_frame(&g, &out, &frame);
+            continue;
+        }
+        if (s->adts)
+            put_adts_header(&g, &out, bytes + 7);
+        bw_put_bits_from(&out, frame.buf, frame.bits);
+    }
+    s->offset[cfg->frames] = out.bits / 8;
+    s->num_frames = cfg->frames;
+    s->data = out.buf;
+    s->size = out.bits / 8;
+
+    bw_free(&frame);
+    NeAACDecClose(g.hDecoder);
+
+    return s;
+}
+
+void gen_stream_free(gen_stream *s)
+{
+    if (s == NULL)
+        return;
+    free(s->data);
+    free(s->offset);
+    free(s);
+}
+
+
+/* minimal MP4 file with one audio track, enough for frontend/mp4read.c
+   and other players */
+
+typedef struct
+{
+    unsigned char *buf;
+    unsigned long len;
+    unsigned long size;
+} bytebuf;
+
+static void bb_put(bytebuf *b, const void *data, unsigned long n)
+{
+    if (b->len + n > b->size)
+    {
+        b->size = 2 * (b->len + n) + 256;
+        b->buf = (unsigned char*)realloc(b->buf, b->size);
+    }
+    memcpy(b->buf + b->len, data, n);
+    b->len += n;
+}
+
+static void bb_u8(bytebuf *b, uint32_t v)
+{
+    unsigned char c = (unsigned char)v;
+
+    bb_put(b, &c, 1);
+}
+
+static void bb_u16(bytebuf *b, uint32_t v)
+{
+    bb_u8(b, v >> 8);
+    bb_u8(b, v);
+}
+
+static void bb_u32(bytebuf *b, uint32_t v)
+{
+    bb_u16(b, v >> 16);
+    bb_u16(b, v);
+}
+
+static void bb_zero(bytebuf *b, unsigned long n)
+{
+    while (n--)
+        bb_u8(b, 0);
+}
+
+static void bb_set_u32(bytebuf *b, unsigned long pos, uint32_t v)
+{
+    b->buf[pos] = (unsigned char)(v >> 24);
+    b->buf[pos + 1] = (unsigned char)(v >> 16);
+    b->buf[pos + 2] = (unsigned char)(v >> 8);
+    b->buf[pos + 3] = (unsigned char)v;
+}
+
+static unsigned long box_begin(bytebuf *b, const char *type)
+{
+    unsigned long pos = b->len;
+
+    bb_u32(b, 0);
+    bb_put(b, type, 4);
+    return pos;
+}
+
+static void box_end(bytebuf *b, unsigned long pos)
+{
+    bb_set_u32(b, pos, b->len - pos);
+}
+
+static void put_matrix(bytebuf *b)
+{
+    bb_u32(b, 0x00010000); bb_u32(b, 0); bb_u32(b, 0);
+    bb_u32(b, 0); bb_u32(b, 0x00010000); bb_u32(b, 0);
+    bb_u32(b, 0); bb_u32(b, 0); bb_u32(b, 0x40000000);
+}
+
+static void put_esds(bytebuf *b, const gen_stream *s)
+{
+    unsigned long esds = box_begin(b, "esds");
+    uint32_t dc_len = 13 + 2 + s->asc_len;
+    uint32_t bitrate = (uint32_t)((double)s->size * 8 * s->samplerate /
+        ((double)s->num_frames * s->frame_len));
+
+    bb_u32(b, 0);
+    bb_u8(b, 3);        /* ES_Descriptor */
+    bb_u8(b, 3 + 2 + dc_len + 3);
+    bb_u16(b, 0);
+    bb_u8(b, 0);
+    bb_u8(b, 4);        /* DecoderConfigDescriptor */
+    bb_u8(b, dc_len);
+    bb_u8(b, 0x40);     /* MPEG-4 audio */
+    bb_u8(b, 0x15);     /* audio stream */
+    bb_u8(b, 0);
+    bb_u16(b, 6144 * s->cfg.channels / 8);
+    bb_u32(b, bitrate);
+    bb_u32(b, bitrate);
+    bb_u8(b, 5);        /* DecoderSpecificInfo */
+    bb_u8(b, s->asc_len);
+    bb_put(b, s->asc, s->asc_len);
+    bb_u8(b, 6);        /* SLConfigDescriptor */
+    bb_u8(b, 1);
+    bb_u8(b, 2);
+    box_end(b, esds);
+}
+
+static int write_mp4(const gen_stream *s, FILE *f)
+{
+    bytebuf b;
+    unsigned long moov, trak, mdia, minf, dinf, stbl, stsd, mp4a, box;
+    unsigned long stco_pos;
+    uint32_t duration = (uint32_t)s->num_frames * s->frame_len;
+    int i, ret;
+
+    memset(&b, 0, sizeof(bytebuf));
+
+    box = box_begin(&b, "ftyp");
+    bb_put(&b, "M4A ", 4);
+    bb_u32(&b, 0);
+    bb_put(&b, "M4A mp42isom", 12);
+    box_end(&b, box);
+
+    moov = box_begin(&b, "moov");
+
+    box = box_begin(&b, "mvhd");
+    bb_u32(&b, 0);
+    bb_u32(&b, 0);
+    bb_u32(&b, 0);
+    bb_u32(&b, s->samplerate);
+    bb_u32(&b, duration);
+    bb_u32(&b, 0x00010000);
+    bb_u16(&b, 0x0100);
+    bb_zero(&b, 10);
+    put_matrix(&b);
+    bb_zero(&b, 24);
+    bb_u32(&b, 2);
+    box_end(&b, box);
+
+    trak = box_begin(&b, "trak");
+
+    box = box_begin(&b, "tkhd");
+    bb_u32(&b, 7);
+    bb_u32(&b, 0);
+    bb_u32(&b, 0);
+    bb_u32(&b, 1);
+    bb_u32(&b, 0);
+    bb_u32(&b, duration);
+    bb_zero(&b, 8);
+    bb_u16(&b, 0);
+    bb_u16(&b, 0);
+    bb_u16(&b, 0x0100);
+    bb_u16(&b, 0);
+    put_matrix(&b);
+    bb_u32(&b, 0);
+    bb_u32(&b, 0);
+    box_end(&b, box);
+
+    mdia = box_begin(&b, "mdia");
+
+    box = box_begin(&b, "mdhd");
+    bb_u32(&b, 0);
+    bb_u32(&b, 0);
+    bb_u32(&b, 0);
+    bb_u32(&b, s->samplerate);
+    bb_u32(&b, duration);
+    bb_u16(&b, 0x55C4);     /* undetermined language */
+    bb_u16(&b, 0);
+    box_end(&b, box);
+
+    box = box_begin(&b, "hdlr");
+    bb_u32(&b, 0);
+    bb_u32(&b, 0);
+    bb_put(&b, "soun", 4);
+    bb_zero(&b, 12);
+    bb_u8(&b, 0);
+    box_end(&b, box);
+
+    minf = box_begin(&b, "minf");
+
+    box = box_begin(&b, "smhd");
+    bb_u32(&b, 0);
+    bb_u32(&b, 0);
+    box_end(&b, box);
+
+    dinf = box_begin(&b, "dinf");
+    box = box_begin(&b, "dref");
+    bb_u32(&b, 0);
+    bb_u32(&b, 1);
+    bb_u32(&b, 12);
+    bb_put(&b, "url ", 4);
+    bb_u32(&b, 1);
+    box_end(&b, box);
+    box_end(&b, dinf);
+
+    stbl = box_begin(&b, "stbl");
+
+    stsd = box_begin(&b, "stsd");
+    bb_u32(&b, 0);
+    bb_u32(&b, 1);
+    mp4a = box_begin(&b, "mp4a");
+    bb_zero(&b, 6);
+    bb_u16(&b, 1);
+    bb_zero(&b, 8);
+    bb_u16(&b, s->channels);
+    bb_u16(&b, 16);
+    bb_u32(&b, 0);
+    bb_u32(&b, s->samplerate << 16);
+    put_esds(&b, s);
+    box_end(&b, mp4a);
+    box_end(&b, stsd);
+
+    box = box_begin(&b, "stts");
+    bb_u32(&b, 0);
+    bb_u32(&b, 1);
+    bb_u32(&b, s->num_frames);
+    bb_u32(&b, s->frame_len);
+    box_end(&b, box);
+
+    box = box_begin(&b, "stsc");
+    bb_u32(&b, 0);
+    bb_u32(&b, 1);
+    bb_u32(&b, 1);
+    bb_u32(&b, s->num_frames);
+    bb_u32(&b, 1);
+    box_end(&b, box);
+
+    box = box_begin(&b, "stsz");
+    bb_u32(&b, 0);
+    bb_u32(&b, 0);
+    bb_u32(&b, s->num_frames);
+    for (i = 0; i < s->num_frames; i++)
+        bb_u32(&b, s->offset[i + 1] - s->offset[i]);
+    box_end(&b, box);
+
+    /* everything is in one chunk right after the moov box */
+    box = box_begin(&b, "stco");
+    bb_u32(&b, 0);
+    bb_u32(&b, 1);
+    stco_pos = b.len;
+    bb_u32(&b, 0);
+    box_end(&b, box);
+
+    box_end(&b, stbl);
+    box_end(&b, minf);
+    box_end(&b, mdia);
+    box_end(&b, trak);
+    box_end(&b, moov);
+
+    bb_set_u32(&b, stco_pos, b.len + 8);
+    bb_u32(&b, s->size + 8);
+    bb_put(&b, "mdat", 4);
+
+    ret = (fwrite(b.buf, 1, b.len, f) == b.len &&
+        fwrite(s->data, 1, s->size, f) == s->size) ? 0 : -1;
+    free(b.buf);
+
+    return ret;
+}
+
+int gen_stream_write(const gen_stream *s, const char *path)
+{
+    FILE *f = fopen(path, "wb");
+    int ret;
+
+    if (f == NULL)
+        return -1;
+
+    if (s->adts || s->latm)
+        ret = (fwrite(s->data, 1, s->size, f) == s->size) ? 0 : -1;
+    else
+        ret = write_mp4(s, f);
+
+    if (fclose(f) != 0)
+        ret = -1;
+
+    return ret;
+}
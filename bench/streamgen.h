@@ -0,0 +1,106 @@
+/*
+** FAAD2 - Freeware Advanced Audio (AAC) Decoder including SBR decoding
+** Copyright (C) 2003-2005 M. Bakker, Nero AG, http://www.nero.com
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+**
+** Any non-GPL usage of this software or parts of this software is strictly
+** forbidden.
+**
+** The "appropriate copyright message" mentioned in section 2c of the GPLv2
+** must read: "Code from FAAD2 is copyright (c) Nero AG, www.nero.com"
+**
+** Commercial non-GPL licensing of this software is possible.
+** For more info contact Nero AG through Mpeg4AAClicense@nero.com.
+**
+** $Id$
+**/
+
+#ifndef __STREAMGEN_H__
+#define __STREAMGEN_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Synthetic AAC stream generator for the benchmarks.
+ *
+ * The streams are syntactically valid and use the same tools a real
+ * encoder would (block switching, M/S, intensity, PNS, TNS, prediction,
+ * LTP, SBR and PS), but the spectral data is random: the Huffman code
+ * words are drawn with the probability of their code length, so the
+ * decoder sees a realistic mix of code words. The output is noise and is
+ * only meant for timing.
+ */
+
+enum
+{
+    GEN_LC = 0,
+    GEN_MAIN,
+    GEN_LTP,
+    GEN_HE,     /* LC + SBR, implicit signalling */
+    GEN_HEV2,   /* LC + SBR + PS, mono core only */
+    GEN_ER_LC,
+    GEN_LD,
+    GEN_NUM_PROFILES
+};
+
+typedef struct
+{
+    int profile;
+    int channels;       /* 1, 2 or 6 (5.1) */
+    int frames;
+    unsigned int seed;
+    int no_pns;         /* no noise substitution, for exact comparisons */
+    int latm;           /* LOAS/LATM frames instead of ADTS or raw ones */
+} gen_config;
+
+typedef struct
+{
+    gen_config cfg;
+
+    /* ADTS streams are decoded with NeAACDecInit(), the others are raw
+       access units with an AudioSpecificConfig as found in MP4 files,
+       unless they are LOAS frames (one access unit each, as broadcast in
+       DVB) */
+    int adts;
+    int latm;
+    unsigned char asc[8];
+    int asc_len;
+
+    unsigned char *data;
+    unsigned long size;
+    unsigned long *offset;  /* num_frames + 1 entries */
+    int num_frames;
+
+    /* decoded output */
+    unsigned long samplerate;
+    int channels;
+    int frame_len;          /* samples per channel per frame */
+} gen_stream;
+
+const char *gen_profile_name(int profile);
+int gen_profile_supports(int profile, int channels);
+
+gen_stream *gen_stream_create(const gen_config *cfg);
+void gen_stream_free(gen_stream *s);
+
+/* writes ADTS and LOAS streams as is and raw streams as an MP4 file */
+int gen_stream_write(const gen_stream *s, const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
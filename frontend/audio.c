@@ -28,11 +28,16 @@
 ** $Id: audio.c,v 1.30 2015/01/22 09:40:52 knik Exp $
 **/
 
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
 #ifdef _WIN32
 #include <io.h>
 #endif
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <fcntl.h>
 #include <math.h>
 #include <neaacdec.h>
@@ -40,7 +45,186 @@
 
 #include "unicode_support.h"
 #include "audio.h"
+#include "thread.h"
+
+static int write_samples(audio_file *aufile, void *sample_buffer,
+                         unsigned int samples);
+
+/* The output is gathered in page aligned chunks which the decoder can
+   write into directly, see get_audio_buffer(). */
+#define AUDIO_CHUNK_SIZE (1024*1024)
+#define AUDIO_PAGE_SIZE  4096
+
+/* chunks the decoder may run ahead of the writer thread */
+#define WRITER_QUEUE_SIZE 4
+
+struct audio_chunk
+{
+    char *memory;
+    char *data;     /* memory rounded up to a page boundary */
+    size_t size;
+    size_t used;
+};
+
+struct audio_writer
+{
+    worker_thread thread;
+    worker_monitor monitor;
+
+    /* chunks[head] is the oldest of count queued chunks, the chunk after
+       the last queued one is being filled by the decoder */
+    struct audio_chunk chunks[WRITER_QUEUE_SIZE];
+    unsigned int head;
+    unsigned int count;
+
+    int closing;
+    int failed;
+};
+
+/* size of a sample as delivered by the decoder */
+static unsigned int sample_size(audio_file *aufile)
+{
+    return (aufile->outputFormat == FAAD_FMT_16BIT) ? 2 : 4;
+}
+
+static int alloc_chunk(struct audio_chunk *chunk, size_t size)
+{
+    if (size < AUDIO_CHUNK_SIZE)
+        size = AUDIO_CHUNK_SIZE;
+
+    if (chunk->memory)
+        free(chunk->memory);
+    chunk->memory = malloc(size + AUDIO_PAGE_SIZE - 1);
+    chunk->data = NULL;
+    chunk->size = 0;
+    chunk->used = 0;
+    if (chunk->memory == NULL)
+        return 0;
+
+    chunk->data = (char*)(((size_t)chunk->memory + AUDIO_PAGE_SIZE - 1) &
+        ~(size_t)(AUDIO_PAGE_SIZE - 1));
+    chunk->size = size;
+
+    return 1;
+}
+
+static void audio_writer_main(void *arg)
+{
+    audio_file *aufile = (audio_file*)arg;
+    struct audio_writer *writer = aufile->writer;
+
+    for (;;)
+    {
+        struct audio_chunk *chunk;
+        int failed;
 
+        enter_worker_monitor(&writer->monitor);
+        while (writer->count == 0 && !writer->closing)
+            wait_worker_monitor(&writer->monitor);
+        if (writer->count == 0)
+        {
+            leave_worker_monitor(&writer->monitor);
+            break;
+        }
+        chunk = &writer->chunks[writer->head];
+        failed = writer->failed;
+        leave_worker_monitor(&writer->monitor);
+
+        /* the chunk stays queued, and so untouched by the decoder, until
+           it is written */
+        if (!failed &&
+            write_samples(aufile, chunk->data, chunk->used / sample_size(aufile)) == 0)
+        {
+            failed = 1;
+        }
+
+        enter_worker_monitor(&writer->monitor);
+        writer->failed = failed;
+        writer->head = (writer->head + 1) % WRITER_QUEUE_SIZE;
+        writer->count--;
+        notify_worker_monitor(&writer->monitor);
+        leave_worker_monitor(&writer->monitor);
+    }
+}
+
+static void start_audio_writer(audio_file *aufile)
+{
+    struct audio_writer *writer = calloc(1, sizeof(struct audio_writer));
+
+    aufile->writer = writer;
+    if (writer == NULL)
+        return;
+
+    init_worker_monitor(&writer->monitor);
+    if (!try_start_worker_thread(&writer->thread, audio_writer_main, aufile))
+    {
+        destroy_worker_monitor(&writer->monitor);
+        free(writer);
+        aufile->writer = NULL;
+        aufile->chunk = NULL;
+        return;
+    }
+    aufile->chunk = &writer->chunks[0];
+}
+
+/* writes all queued chunks and ends the thread */
+static void stop_audio_writer(audio_file *aufile)
+{
+    struct audio_writer *writer = aufile->writer;
+    unsigned int i;
+
+    enter_worker_monitor(&writer->monitor);
+    writer->closing = 1;
+    notify_worker_monitor(&writer->monitor);
+    leave_worker_monitor(&writer->monitor);
+
+    join_worker_thread(&writer->thread);
+    destroy_worker_monitor(&writer->monitor);
+
+    for (i = 0; i < WRITER_QUEUE_SIZE; i++)
+    {
+        if (writer->chunks[i].memory)
+            free(writer->chunks[i].memory);
+    }
+    free(writer);
+    aufile->writer = NULL;
+    aufile->chunk = NULL;
+}
+
+/* Hands the filled part of the current chunk to the writer thread, or
+   writes it right away. Returns 0 once writing has failed. */
+static int flush_chunk(audio_file *aufile)
+{
+    struct audio_writer *writer = aufile->writer;
+    struct audio_chunk *chunk = aufile->chunk;
+    int failed;
+
+    if (chunk->used == 0)
+        return 1;
+
+    if (writer == NULL)
+    {
+        failed = (write_samples(aufile, chunk->data, chunk->used / sample_size(aufile)) == 0);
+        chunk->used = 0;
+        return !failed;
+    }
+
+    /* the writer thread keeps taking chunks from the queue after a
+       failure, so there is always a chunk to wait for */
+    enter_worker_monitor(&writer->monitor);
+    writer->count++;
+    notify_worker_monitor(&writer->monitor);
+    while (writer->count == WRITER_QUEUE_SIZE)
+        wait_worker_monitor(&writer->monitor);
+    chunk = &writer->chunks[(writer->head + writer->count) % WRITER_QUEUE_SIZE];
+    failed = writer->failed;
+    leave_worker_monitor(&writer->monitor);
+
+    chunk->used = 0;
+    aufile->chunk = chunk;
+
+    return !failed;
+}
 
 audio_file *open_audio_file(char *infile, int samplerate, int channels,
                             int outputFormat, int fileType, long channelMask)
@@ -54,6 +238,7 @@ audio_file *open_audio_file(char *infile, int samplerate, int channels,
     aufile->total_samples = 0;
     aufile->fileType = fileType;
     aufile->channelMask = channelMask;
+    aufile->writer = NULL;
 
     switch (outputFormat)
     {
@@ -98,22 +283,36 @@ audio_file *open_audio_file(char *infile, int samplerate, int channels,
             write_wav_header(aufile);
     }
 
+    /* conversion and I/O overlap with decoding */
+    start_audio_writer(aufile);
+    if (aufile->writer == NULL)
+    {
+        aufile->chunk = calloc(1, sizeof(struct audio_chunk));
+        if (aufile->chunk == NULL)
+        {
+            if (aufile->toStdio == 0)
+                fclose(aufile->sndfile);
+            free(aufile);
+            return NULL;
+        }
+    }
+
     return aufile;
 }
 
-int write_audio_file(audio_file *aufile, void *sample_buffer, int samples, int offset)
+static int write_samples(audio_file *aufile, void *sample_buffer,
+                         unsigned int samples)
 {
-    char *buf = (char *)sample_buffer;
     switch (aufile->outputFormat)
     {
     case FAAD_FMT_16BIT:
-        return write_audio_16bit(aufile, buf + offset*2, samples);
+        return write_audio_16bit(aufile, sample_buffer, samples);
     case FAAD_FMT_24BIT:
-        return write_audio_24bit(aufile, buf + offset*4, samples);
+        return write_audio_24bit(aufile, sample_buffer, samples);
     case FAAD_FMT_32BIT:
-        return write_audio_32bit(aufile, buf + offset*4, samples);
+        return write_audio_32bit(aufile, sample_buffer, samples);
     case FAAD_FMT_FLOAT:
-        return write_audio_float(aufile, buf + offset*4, samples);
+        return write_audio_float(aufile, sample_buffer, samples);
     default:
         return 0;
     }
@@ -121,8 +320,60 @@ int write_audio_file(audio_file *aufile, void *sample_buffer, int samples, int o
     return 0;
 }
 
+void *get_audio_buffer(audio_file *aufile, unsigned long size)
+{
+    struct audio_chunk *chunk = aufile->chunk;
+
+    if (chunk->size - chunk->used < size)
+    {
+        if (!flush_chunk(aufile))
+            return NULL;
+
+        chunk = aufile->chunk;
+        if (chunk->size < size && !alloc_chunk(chunk, size))
+            return NULL;
+    }
+
+    return chunk->data + chunk->used;
+}
+
+int commit_audio_buffer(audio_file *aufile, int samples, int offset)
+{
+    struct audio_chunk *chunk = aufile->chunk;
+    unsigned int bytes = sample_size(aufile);
+    char *data = chunk->data + chunk->used;
+
+    if (offset > 0)
+        memmove(data, data + offset*bytes, samples*bytes);
+    chunk->used += samples*bytes;
+
+    return 1;
+}
+
+int write_audio_file(audio_file *aufile, void *sample_buffer, int samples, int offset)
+{
+    unsigned int bytes = sample_size(aufile);
+    void *data = get_audio_buffer(aufile, samples*bytes);
+
+    if (data == NULL)
+        return 0;
+    memcpy(data, (char *)sample_buffer + offset*bytes, samples*bytes);
+
+    return commit_audio_buffer(aufile, samples, 0);
+}
+
 void close_audio_file(audio_file *aufile)
 {
+    flush_chunk(aufile);
+    if (aufile->writer != NULL)
+    {
+        stop_audio_writer(aufile);
+    } else {
+        if (aufile->chunk->memory)
+            free(aufile->chunk->memory);
+        free(aufile->chunk);
+    }
+
     if ((aufile->fileType == OUTPUT_WAV) && (aufile->toStdio == 0))
     {
         fseek(aufile->sndfile, 0, SEEK_SET);
@@ -308,7 +559,7 @@ static int write_audio_16bit(audio_file *aufile, void *sample_buffer,
     int ret;
     unsigned int i;
     short *sample_buffer16 = (short*)sample_buffer;
-    char *data = malloc(samples*aufile->bits_per_sample*sizeof(char)/8);
+    char *data;
 
     aufile->total_samples += samples;
 
@@ -332,6 +583,12 @@ static int write_audio_16bit(audio_file *aufile, void *sample_buffer,
         }
     }
 
+#ifndef WORDS_BIGENDIAN
+    /* the samples are already stored as in the file */
+    return fwrite(sample_buffer, samples, aufile->bits_per_sample/8, aufile->sndfile);
+#endif
+
+    data = malloc(samples*aufile->bits_per_sample*sizeof(char)/8);
     for (i = 0; i < samples; i++)
     {
         data[i*2] = (char)(sample_buffer16[i] & 0xFF);
@@ -395,7 +652,7 @@ static int write_audio_32bit(audio_file *aufile, void *sample_buffer,
     int ret;
     unsigned int i;
     int32_t *sample_buffer32 = (int32_t*)sample_buffer;
-    char *data = malloc(samples*aufile->bits_per_sample*sizeof(char)/8);
+    char *data;
 
     aufile->total_samples += samples;
 
@@ -419,6 +676,12 @@ static int write_audio_32bit(audio_file *aufile, void *sample_buffer,
         }
     }
 
+#ifndef WORDS_BIGENDIAN
+    /* the samples are already stored as in the file */
+    return fwrite(sample_buffer, samples, aufile->bits_per_sample/8, aufile->sndfile);
+#endif
+
+    data = malloc(samples*aufile->bits_per_sample*sizeof(char)/8);
     for (i = 0; i < samples; i++)
     {
         data[i*4] = (char)(sample_buffer32[i] & 0xFF);
@@ -440,7 +703,7 @@ static int write_audio_float(audio_file *aufile, void *sample_buffer,
     int ret;
     unsigned int i;
     float *sample_buffer_f = (float*)sample_buffer;
-    unsigned char *data = malloc(samples*aufile->bits_per_sample*sizeof(char)/8);
+    unsigned char *data;
 
     aufile->total_samples += samples;
 
@@ -464,6 +727,12 @@ static int write_audio_float(audio_file *aufile, void *sample_buffer,
         }
     }
 
+#ifndef WORDS_BIGENDIAN
+    /* IEEE floats are already stored as in the file */
+    return fwrite(sample_buffer, samples, aufile->bits_per_sample/8, aufile->sndfile);
+#endif
+
+    data = malloc(samples*aufile->bits_per_sample*sizeof(char)/8);
     for (i = 0; i < samples; i++)
     {
         int exponent, mantissa, negative = 0 ;
@@ -51,11 +51,25 @@ typedef struct
     unsigned int channels;
     unsigned long total_samples;
     long channelMask;
+
+    /* converts and writes the samples on its own thread, NULL when the
+       samples are written right away */
+    struct audio_writer *writer;
+    /* the chunk the output is gathered in */
+    struct audio_chunk *chunk;
 } audio_file;
 
 audio_file *open_audio_file(char *infile, int samplerate, int channels,
                             int outputFormat, int fileType, long channelMask);
+/* write_audio_file() and commit_audio_buffer() return 0 when writing
+   failed and 1 otherwise, also for 0 samples */
 int write_audio_file(audio_file *aufile, void *sample_buffer, int samples, int offset);
+/* Returns room for at least size bytes of decoder output in the file's
+   current chunk, or NULL once writing has failed. The samples are only
+   written when they are committed, with the first offset samples left
+   out. */
+void *get_audio_buffer(audio_file *aufile, unsigned long size);
+int commit_audio_buffer(audio_file *aufile, int samples, int offset);
 void close_audio_file(audio_file *aufile);
 static int write_wav_header(audio_file *aufile);
 static int write_wav_extensible_header(audio_file *aufile, long channelMask);
@@ -43,6 +43,11 @@
 #include <time.h>
 #endif
 
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
 #include <fcntl.h>
 #include <stdio.h>
 #include <stdarg.h>
@@ -55,6 +60,7 @@
 #include "unicode_support.h"
 #include "audio.h"
 #include "mp4read.h"
+#include "thread.h"
 
 #include "marcus.h"
 
@@ -168,86 +174,260 @@ static void advance_buffer(aac_buffer *b, int bytes)
     }
 }
 
-static void lookforheader(aac_buffer *b)
+/* offset of the first "ADIF" in the buffer, -1 when there is none */
+static long find_adif(const unsigned char *buffer, long size)
 {
-    int i = 0;
-    while (!b->at_eof )
+    const unsigned char *p = buffer;
+
+    while ((p = memchr(p, 'A', size - (p - buffer))) != NULL)
     {
-        if (b->bytes_into_buffer > 4)
+        if (size - (p - buffer) >= 4 && memcmp(p, "ADIF", 4) == 0)
+            return (long)(p - buffer);
+        p++;
+    }
+
+    return -1;
+}
+
+/* drops everything in front of the first ADTS or ADIF header */
+static void lookforheader(aac_buffer *b, int old_format)
+{
+    while (!b->at_eof && b->bytes_into_buffer > 0)
+    {
+        long adts = NeAACDecFindADTSSync(b->buffer, b->bytes_into_buffer, old_format);
+        long adif = find_adif(b->buffer, b->bytes_into_buffer);
+        long skip;
+
+        if (adts >= 0 && (adif < 0 || adts < adif))
+            skip = adts;
+        else if (adif >= 0)
+            skip = adif;
+        else /* keep the tail, a frame there could not be checked yet */
+            skip = b->bytes_into_buffer - min(b->bytes_into_buffer, FAAD_MIN_STREAMSIZE);
+
+        if (skip == 0)
+            break;
+
+        advance_buffer(b, skip);
+        fill_buffer(b);
+    }
+}
+
+static int adts_sample_rates[] = {96000,88200,64000,48000,44100,32000,24000,22050,16000,12000,11025,8000,7350,0,0,0};
+
+/* Maps the whole input file, or reads it into memory where it can not be
+   mapped. Returns NULL on failure. */
+static unsigned char *map_input_file(FILE *file, long size, int *mapped)
+{
+    unsigned char *data;
+
+    *mapped = 0;
+    if (size <= 0)
+        return NULL;
+
+#if defined(_WIN32)
+    {
+        HANDLE mapping = CreateFileMapping((HANDLE)_get_osfhandle(_fileno(file)),
+            NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping != NULL)
         {
-            if( ((b->buffer[0+i] == 0xff) && ((b->buffer[1+i] & 0xf6) == 0xf0)) ||
-                (b->buffer[0+i] == 'A'    && b->buffer[1+i] == 'D' && b->buffer[2+i] == 'I' && b->buffer[3+i] == 'F'))
+            /* the view keeps the mapping alive */
+            data = (unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+            if (data != NULL)
             {
-                fill_buffer(b);
-                break;
-            } else {
-                i++;
-                b->file_offset       += 1;
-                b->bytes_consumed    += 1;
-                b->bytes_into_buffer -= 1;
+                *mapped = 1;
+                return data;
             }
         }
-        else
-        {
-            fill_buffer(b);
-            i = 0;
-        }
     }
+#elif defined(HAVE_MMAP) && defined(HAVE_SYS_MMAN_H)
+    data = (unsigned char*)mmap(NULL, size, PROT_READ, MAP_PRIVATE, fileno(file), 0);
+    if (data != MAP_FAILED)
+    {
+        *mapped = 1;
+        return data;
+    }
+#endif
+
+    data = (unsigned char*)malloc(size);
+    if (data == NULL)
+        return NULL;
+    if (fseek(file, 0, SEEK_SET) != 0 || fread(data, 1, size, file) != (size_t)size)
+    {
+        free(data);
+        return NULL;
+    }
+
+    return data;
 }
 
-static int adts_sample_rates[] = {96000,88200,64000,48000,44100,32000,24000,22050,16000,12000,11025,8000,7350,0,0,0};
+static void unmap_input_file(unsigned char *data, long size, int mapped)
+{
+    if (!mapped)
+    {
+        free(data);
+        return;
+    }
+#if defined(_WIN32)
+    UnmapViewOfFile(data);
+#elif defined(HAVE_MMAP) && defined(HAVE_SYS_MMAN_H)
+    munmap(data, size);
+#endif
+}
 
-static int adts_parse(aac_buffer *b, int *bitrate, float *length)
+/* Indexes all frames after the tag to get the exact time and bitrate */
+static int adts_parse(aac_buffer *b, long offset, long size, int old_format,
+                      int *bitrate, float *length)
 {
-    int frames, frame_length;
-    int t_framelength = 0;
-    int samplerate;
+    NeAACDecADTSIndex *index;
+    unsigned char *data;
+    int mapped;
     float frames_per_sec, bytes_per_frame;
 
-    /* Read all frames to ensure correct time and bitrate */
-    for (frames = 0; /* */; frames++)
+    *bitrate = 0;
+    *length = 1;
+
+    if (offset >= size)
+        return 0;
+    data = map_input_file(b->infile, size, &mapped);
+    if (data == NULL)
+        return 0;
+
+    index = NeAACDecIndexADTS(data + offset, size - offset, old_format);
+    if (index != NULL)
     {
-        fill_buffer(b);
+        frames_per_sec = (float)index->samplerate/1024.0f;
+        bytes_per_frame = (float)index->frame_bytes/(float)(index->blocks*1000);
+        *bitrate = (int)(8. * bytes_per_frame * frames_per_sec + 0.5);
+        if (frames_per_sec != 0)
+            *length = (float)index->blocks/frames_per_sec;
 
-        if (b->bytes_into_buffer > 7)
-        {
-            /* check syncword */
-            if (!((b->buffer[0] == 0xFF)&&((b->buffer[1] & 0xF6) == 0xF0)))
-                break;
+        NeAACDecFreeADTSIndex(index);
+    }
 
-            if (frames == 0)
-                samplerate = adts_sample_rates[(b->buffer[2]&0x3c)>>2];
+    unmap_input_file(data, size, mapped);
 
-            frame_length = ((((unsigned int)b->buffer[3] & 0x3)) << 11)
-                | (((unsigned int)b->buffer[4]) << 3) | (b->buffer[5] >> 5);
-            if (frame_length == 0)
-                break;
+    return (index != NULL);
+}
 
-            t_framelength += frame_length;
+static NeAACDecADTSIndex *load_index_file(const char *name, unsigned long size)
+{
+    NeAACDecADTSIndex *index = NULL;
+    unsigned char *data;
+    long n;
+    FILE *file = faad_fopen(name, "rb");
 
-            if (frame_length > b->bytes_into_buffer)
-                break;
+    if (file == NULL)
+        return NULL;
 
-            advance_buffer(b, frame_length);
-        } else {
-            break;
-        }
+    if (fseek(file, 0, SEEK_END) == 0 && (n = ftell(file)) > 0 &&
+        fseek(file, 0, SEEK_SET) == 0 && (data = (unsigned char*)malloc(n)) != NULL)
+    {
+        if (fread(data, 1, n, file) == (size_t)n)
+            index = NeAACDecLoadADTSIndex(data, n);
+        free(data);
     }
+    fclose(file);
 
-    frames_per_sec = (float)samplerate/1024.0f;
-    if (frames != 0)
-        bytes_per_frame = (float)t_framelength/(float)(frames*1000);
-    else
-        bytes_per_frame = 0;
-    *bitrate = (int)(8. * bytes_per_frame * frames_per_sec + 0.5);
-    if (frames_per_sec != 0)
-        *length = (float)frames/frames_per_sec;
-    else
-        *length = 1;
+    /* made for a different version of the file */
+    if (index != NULL && index->size != size)
+    {
+        NeAACDecFreeADTSIndex(index);
+        index = NULL;
+    }
 
-    return 1;
+    return index;
+}
+
+static void save_index_file(const char *name, const NeAACDecADTSIndex *index)
+{
+    unsigned long n = NeAACDecSaveADTSIndex(index, NULL, 0);
+    unsigned char *data = (unsigned char*)malloc(n);
+    FILE *file;
+
+    if (data == NULL)
+        return;
+
+    NeAACDecSaveADTSIndex(index, data, n);
+    file = faad_fopen(name, "wb");
+    if (file != NULL)
+    {
+        if (fwrite(data, 1, n, file) != n)
+            faad_fprintf(stderr, "Error writing index file %s\n", name);
+        fclose(file);
+    }
+    free(data);
 }
 
+/* Indexes the frames of the mapped file after the tag. The index is read
+   from or written to the sidecar file <aacfile>.idx when use_index is
+   set. */
+static NeAACDecADTSIndex *adts_index(const char *aacfile, unsigned char *data,
+                                     long tagsize, long size, int old_format,
+                                     int use_index)
+{
+    NeAACDecADTSIndex *index = NULL;
+    char *index_name = NULL;
+
+    if (use_index && (index_name = (char*)malloc(strlen(aacfile) + 5)) != NULL)
+    {
+        sprintf(index_name, "%s.idx", aacfile);
+        index = load_index_file(index_name, size - tagsize);
+    }
+    if (index == NULL)
+    {
+        index = NeAACDecIndexADTS(data + tagsize, size - tagsize, old_format);
+        if (index != NULL && index_name != NULL)
+            save_index_file(index_name, index);
+    }
+    if (index_name != NULL)
+        free(index_name);
+
+    return index;
+}
+
+/* Moves the input to the frame holding the given sample and decodes the
+   frames in front of it (see NeAACDecSeekADTS()). Returns 0 on failure. */
+static int adts_seek(aac_buffer *b, NeAACDecHandle hDecoder, const char *aacfile,
+                     long tagsize, long size, int old_format, int use_index,
+                     unsigned long sample, unsigned long *skip)
+{
+    NeAACDecADTSIndex *index;
+    unsigned char *data;
+    int mapped;
+    long frame = -1;
+
+    if (tagsize >= size)
+        return 0;
+    data = map_input_file(b->infile, size, &mapped);
+    if (data == NULL)
+        return 0;
+
+    index = adts_index(aacfile, data, tagsize, size, old_format, use_index);
+    if (index != NULL)
+    {
+        frame = NeAACDecSeekADTS(hDecoder, index, data + tagsize, size - tagsize,
+            sample, skip);
+    }
+    if (frame >= 0)
+    {
+        int bread;
+
+        b->file_offset = tagsize + index->offset[frame];
+        fseek(b->infile, b->file_offset, SEEK_SET);
+        bread = fread(b->buffer, 1, FAAD_MIN_STREAMSIZE*MAX_CHANNELS, b->infile);
+        b->at_eof = (bread != FAAD_MIN_STREAMSIZE*MAX_CHANNELS);
+        b->bytes_into_buffer = bread;
+        b->bytes_consumed = 0;
+    }
+
+    if (index != NULL)
+        NeAACDecFreeADTSIndex(index);
+    unmap_input_file(data, size, mapped);
+
+    return (frame >= 0);
+}
 
 
 uint32_t read_callback(void *user_data, void *buffer, uint32_t length)
@@ -447,7 +627,9 @@ static void usage(void)
     faad_fprintf(stdout, " -w    Write output to stdio instead of a file.\n");
     faad_fprintf(stdout, " -g    Disable gapless decoding.\n");
     faad_fprintf(stdout, " -q    Quiet - suppresses status messages.\n");
-    faad_fprintf(stdout, " -j X  Jump - start output X seconds into track (MP4 files only).\n");
+    faad_fprintf(stdout, " -j X  Jump - start output X seconds into track (MP4 and ADTS files).\n");
+    faad_fprintf(stdout, " -x    Keep the ADTS seek index in a file next to the input (infile.aac.idx).\n");
+    faad_fprintf(stdout, " -p X  Decode MP4 and ADTS files on X threads.\n");
     faad_fprintf(stdout, "Example:\n");
     faad_fprintf(stdout, "       %s infile.aac\n", progName);
     faad_fprintf(stdout, "       %s infile.mp4\n", progName);
@@ -457,15 +639,418 @@ static void usage(void)
     return;
 }
 
+/* Parallel decoding: the indexed frames are split into ranges that are
+   decoded on separate decoder handles, a batch of one range per thread at
+   a time, and written in order. */
+
+/* frames per range, a few seconds of audio */
+#define RANGE_FRAMES 256
+
+typedef struct
+{
+    NeAACDecHandle hDecoder;
+    const NeAACDecADTSIndex *index;
+    unsigned char *data;
+    unsigned long size;
+    unsigned long first;
+    unsigned long count;
+
+    unsigned char *output;
+    unsigned long output_size;
+    long samples;
+    NeAACDecFrameInfo frameInfo;
+} decode_range;
+
+static void run_decode_range(void *arg)
+{
+    decode_range *r = (decode_range*)arg;
+
+    r->samples = NeAACDecDecodeRange(r->hDecoder, &r->frameInfo, r->index,
+        r->data, r->size, r->first, r->count, r->output, r->output_size);
+}
+
+static unsigned long output_sample_size(int outputFormat)
+{
+    switch (outputFormat)
+    {
+    case FAAD_FMT_24BIT:
+    case FAAD_FMT_32BIT:
+    case FAAD_FMT_FLOAT:
+        return 4;
+    case FAAD_FMT_DOUBLE:
+        return 8;
+    default:
+        return 2;
+    }
+}
+
+/* samples per channel in the longest frame, 1024 doubled by SBR */
+#define MAX_FRAME_LENGTH 2048
+
+/* Decodes straight into the output chunk of aufile once it is open, the
+   samples then only have to be committed. *direct tells which happened. */
+static void *decode_frame(NeAACDecHandle hDecoder, NeAACDecFrameInfo *frameInfo,
+                          unsigned char *buffer, unsigned long buffer_size,
+                          audio_file *aufile, int *direct)
+{
+    void *sample_buffer = NULL;
+    unsigned long size = 0;
+
+    if (aufile != NULL)
+    {
+        size = MAX_FRAME_LENGTH * aufile->channels *
+            output_sample_size(aufile->outputFormat);
+        sample_buffer = get_audio_buffer(aufile, size);
+    }
+
+    /* without a chunk the next write reports the failure */
+    *direct = (sample_buffer != NULL);
+    if (!*direct)
+        return NeAACDecDecode(hDecoder, frameInfo, buffer, buffer_size);
+
+    return NeAACDecDecode2(hDecoder, frameInfo, buffer, buffer_size,
+        &sample_buffer, size);
+}
+
+/* Decodes all frames of the index with one decoder per thread and writes
+   the output to sndfile. The decoders must be initialised on the stream.
+   At most max_samples samples per channel are written when it is not 0.
+   Returns the error of the last failing frame, or -1 when the decoder
+   refuses to split the stream (see NeAACDecDecodeRange()) and it should
+   be decoded on one thread. */
+static int decode_parallel(NeAACDecHandle *decoders, int threads,
+                           const NeAACDecADTSIndex *index, unsigned char *data,
+                           unsigned long size, unsigned char channels,
+                           unsigned long max_samples, const char *name,
+                           char *sndfile, int to_stdout, int outputFormat,
+                           int fileType)
+{
+    decode_range *ranges;
+    worker_thread *thread;
+    audio_file *aufile = NULL;
+    char percents[MAX_PERCENTS];
+    unsigned long next = 0, written = 0;
+    int i, error = 0, done = 0, refused = 0;
+
+    ranges = (decode_range*)calloc(threads, sizeof(decode_range));
+    thread = (worker_thread*)calloc(threads, sizeof(worker_thread));
+    if (ranges == NULL || thread == NULL)
+    {
+        faad_fprintf(stderr, "Memory allocation error\n");
+        error = 1;
+        goto cleanup;
+    }
+
+    /* enough for a range of upsampled SBR frames, grown if the stream has
+       more channels than announced */
+    if (channels == 0)
+        channels = 2;
+    for (i = 0; i < threads; i++)
+    {
+        ranges[i].hDecoder = decoders[i];
+        ranges[i].index = index;
+        ranges[i].data = data;
+        ranges[i].size = size;
+        ranges[i].output_size = RANGE_FRAMES * 2048 * channels *
+            output_sample_size(outputFormat);
+        ranges[i].output = (unsigned char*)malloc(ranges[i].output_size);
+        if (ranges[i].output == NULL)
+        {
+            faad_fprintf(stderr, "Memory allocation error\n");
+            error = 1;
+            goto cleanup;
+        }
+    }
+
+    while (next < index->frames && !done)
+    {
+        int batch = 0;
+
+        for (i = 0; i < threads && next < index->frames; i++, batch++)
+        {
+            ranges[i].first = next;
+            ranges[i].count = min(RANGE_FRAMES, index->frames - next);
+            next += ranges[i].count;
+
+            start_worker_thread(&thread[i], run_decode_range, &ranges[i]);
+        }
+
+        for (i = 0; i < batch; i++)
+        {
+            decode_range *r = &ranges[i];
+            unsigned long samples;
+
+            join_worker_thread(&thread[i]);
+
+            /* output buffer too small, decode the range again with more room */
+            while (r->frameInfo.error == 27)
+            {
+                unsigned char *output = (unsigned char*)realloc(r->output,
+                    r->output_size * 2);
+                if (output == NULL)
+                    break;
+                r->output = output;
+                r->output_size *= 2;
+                run_decode_range(r);
+            }
+
+            /* nothing is written yet, the caller can start over */
+            if (r->samples < 0 && aufile == NULL && !done)
+            {
+                faad_fprintf(stderr, "Warning: %s can not be split into "
+                    "ranges, decoding it on one thread\n", name);
+                refused = 1;
+                done = 1;
+                continue;
+            }
+            if (r->samples < 0 || r->frameInfo.error == 27)
+            {
+                faad_fprintf(stderr, "Error: %s\n", NeAACDecGetErrorMessage(27));
+                error = 27;
+                done = 1;
+                continue;
+            }
+            if (r->frameInfo.error > 0)
+            {
+                faad_fprintf(stderr, "Warning: %s\n",
+                    NeAACDecGetErrorMessage(r->frameInfo.error));
+                error = r->frameInfo.error;
+            }
+            if (r->samples == 0 || done)
+                continue;
+
+            /* open the sound file now that the number of channels is known */
+            if (aufile == NULL)
+            {
+                print_channel_info(&r->frameInfo);
+
+                aufile = open_audio_file(to_stdout ? "-" : sndfile,
+                    r->frameInfo.samplerate, r->frameInfo.channels,
+                    outputFormat, fileType,
+                    aacChannelConfig2wavexChannelMask(&r->frameInfo));
+                if (aufile == NULL)
+                {
+                    done = 1;
+                    continue;
+                }
+            }
+
+            if (r->frameInfo.channels != aufile->channels)
+            {
+                faad_fprintf(stderr, "Error: %s\n", NeAACDecGetErrorMessage(12));
+                error = 12;
+                continue;
+            }
+
+            samples = r->samples / aufile->channels;
+            if (max_samples && written + samples > max_samples)
+            {
+                samples = max_samples - min(written, max_samples);
+                done = 1;
+            }
+            written += samples;
+
+            if (samples > 0 &&
+                write_audio_file(aufile, r->output, samples * aufile->channels, 0) == 0)
+                done = 1;
+        }
+
+        snprintf(percents, MAX_PERCENTS, "%d%% decoding %s.",
+            (int)((double)next*100/index->frames), name);
+        faad_fprintf(stderr, "%s\r", percents);
+#ifdef _WIN32
+        SetConsoleTitle(percents);
+#endif
+    }
+
+    if (aufile != NULL)
+        close_audio_file(aufile);
+
+cleanup:
+    if (ranges != NULL)
+    {
+        for (i = 0; i < threads; i++)
+        {
+            if (ranges[i].output)
+                free(ranges[i].output);
+        }
+        free(ranges);
+    }
+    if (thread != NULL)
+        free(thread);
+
+    return refused ? -1 : error;
+}
+
+/* Returns threads decoders configured like hDecoder and initialised with
+   init. hDecoder itself is left alone, a refused stream is then decoded
+   with it from the start. */
+static NeAACDecHandle *open_decoders(NeAACDecHandle hDecoder, int threads,
+                                     unsigned char *init, unsigned long init_size,
+                                     int raw)
+{
+    NeAACDecHandle *decoders;
+    unsigned long samplerate;
+    unsigned char channels;
+    int i;
+
+    decoders = (NeAACDecHandle*)calloc(threads, sizeof(NeAACDecHandle));
+    if (decoders == NULL)
+        return NULL;
+
+    for (i = 0; i < threads; i++)
+    {
+        long ret;
+
+        decoders[i] = NeAACDecOpen();
+        if (decoders[i] == NULL)
+            break;
+        NeAACDecSetConfiguration(decoders[i], NeAACDecGetCurrentConfiguration(hDecoder));
+
+        if (raw)
+            ret = NeAACDecInit2(decoders[i], init, init_size, &samplerate, &channels);
+        else
+            ret = NeAACDecInit(decoders[i], init, init_size, &samplerate, &channels);
+        if (ret < 0)
+        {
+            NeAACDecClose(decoders[i]);
+            break;
+        }
+    }
+
+    if (i < threads)
+    {
+        while (--i >= 0)
+            NeAACDecClose(decoders[i]);
+        free(decoders);
+        return NULL;
+    }
+
+    return decoders;
+}
+
+static void close_decoders(NeAACDecHandle *decoders, int threads)
+{
+    int i;
+
+    for (i = 0; i < threads; i++)
+        NeAACDecClose(decoders[i]);
+    free(decoders);
+}
+
+/* Parallel decoding of an ADTS file, returns -1 when it can not be set up
+   and the file should be decoded on one thread. */
+static int adts_decode_parallel(NeAACDecHandle hDecoder, FILE *infile,
+                                const char *aacfile, long tagsize, long size,
+                                int old_format, int use_index, int threads,
+                                unsigned char channels, char *sndfile,
+                                int to_stdout, int outputFormat, int fileType)
+{
+    NeAACDecADTSIndex *index;
+    NeAACDecHandle *decoders = NULL;
+    unsigned char *data;
+    int mapped, ret = -1;
+
+    if (tagsize >= size)
+        return -1;
+    data = map_input_file(infile, size, &mapped);
+    if (data == NULL)
+        return -1;
+
+    index = adts_index(aacfile, data, tagsize, size, old_format, use_index);
+    if (index != NULL)
+    {
+        decoders = open_decoders(hDecoder, threads, data + tagsize + index->offset[0],
+            index->length[0], 0);
+    }
+    if (decoders != NULL)
+    {
+        ret = decode_parallel(decoders, threads, index, data + tagsize,
+            size - tagsize, channels, 0, aacfile, sndfile, to_stdout,
+            outputFormat, fileType);
+        close_decoders(decoders, threads);
+    }
+
+    if (index != NULL)
+        NeAACDecFreeADTSIndex(index);
+    unmap_input_file(data, size, mapped);
+
+    return ret;
+}
+
+/* Parallel decoding of the opened MP4 track, the access units lie back to
+   back in the media data. Returns -1 when it can not be set up. */
+static int mp4_decode_parallel(NeAACDecHandle hDecoder, char *mp4file,
+                               int threads, unsigned char channels,
+                               unsigned long max_samples, char *sndfile,
+                               int to_stdout, int outputFormat, int fileType)
+{
+    NeAACDecADTSIndex index;
+    NeAACDecHandle *decoders = NULL;
+    unsigned char *data = NULL;
+    FILE *file;
+    long size = 0;
+    int mapped, ret = -1;
+    unsigned long i;
+
+    memset(&index, 0, sizeof(index));
+    index.frames = mp4config.frame.ents;
+    index.offset = (unsigned long*)malloc(index.frames * sizeof(unsigned long));
+    index.length = (unsigned short*)malloc(index.frames * sizeof(unsigned short));
+    if (index.frames == 0 || index.offset == NULL || index.length == NULL)
+        goto cleanup;
+
+    for (i = 0; i < index.frames; i++)
+    {
+        unsigned long length = mp4config.frame.data[i+1] - mp4config.frame.data[i];
+
+        if (length > 0xFFFF)
+            goto cleanup;
+        index.offset[i] = mp4config.frame.data[i];
+        index.length[i] = (unsigned short)length;
+    }
+
+    file = faad_fopen(mp4file, "rb");
+    if (file == NULL)
+        goto cleanup;
+    if (fseek(file, 0, SEEK_END) == 0)
+        size = ftell(file);
+    if (size > (long)mp4config.mdatofs)
+        data = map_input_file(file, size, &mapped);
+    fclose(file);
+    if (data == NULL)
+        goto cleanup;
+
+    decoders = open_decoders(hDecoder, threads, mp4config.asc.buf,
+        mp4config.asc.size, 1);
+    if (decoders != NULL)
+    {
+        ret = decode_parallel(decoders, threads, &index, data + mp4config.mdatofs,
+            size - mp4config.mdatofs, channels, max_samples, mp4file, sndfile,
+            to_stdout, outputFormat, fileType);
+        close_decoders(decoders, threads);
+    }
+    unmap_input_file(data, size, mapped);
+
+cleanup:
+    if (index.offset)
+        free(index.offset);
+    if (index.length)
+        free(index.length);
+
+    return ret;
+}
+
 static int decodeAACfile(char *aacfile, char *sndfile, char *adts_fn, int to_stdout,
                   int def_srate, int object_type, int outputFormat, int fileType,
                   int downMatrix, int infoOnly, int adts_out, int old_format,
-                  float *song_length)
+                  float *song_length, float seek_to, int use_index, int threads)
 {
     int tagsize;
     unsigned long samplerate;
     unsigned char channels;
     void *sample_buffer;
+    int direct = 0;
 
     audio_file *aufile = NULL;
 
@@ -487,6 +1072,7 @@ static int decodeAACfile(char *aacfile, char *sndfile, char *adts_fn, int to_std
     int first_time = 1;
     int retval;
     int streaminput = 0;
+    unsigned long skip = 0;
 
     aac_buffer b;
 
@@ -581,7 +1167,7 @@ static int decodeAACfile(char *aacfile, char *sndfile, char *adts_fn, int to_std
     /* get AAC infos for printing */
     header_type = 0;
     if (streaminput == 1)
-        lookforheader(&b);
+        lookforheader(&b, old_format);
 
     if ((b.buffer[0] == 0xFF) && ((b.buffer[1] & 0xF6) == 0xF0))
     {
@@ -600,7 +1186,7 @@ static int decodeAACfile(char *aacfile, char *sndfile, char *adts_fn, int to_std
             length = 1;
             faad_fprintf(stderr, "Streamed input format  samplerate %d channels %d.\n", samplerate, channels);
         } else {
-            adts_parse(&b, &bitrate, &length);
+            adts_parse(&b, tagsize, fileread, old_format, &bitrate, &length);
             fseek(b.infile, tagsize, SEEK_SET);
 
             bread = fread(b.buffer, 1, FAAD_MIN_STREAMSIZE*MAX_CHANNELS, b.infile);
@@ -633,6 +1219,11 @@ static int decodeAACfile(char *aacfile, char *sndfile, char *adts_fn, int to_std
 
         header_type = 2;
     }
+    else if ((b.buffer[0] == 0x56) && ((b.buffer[1] & 0xE0) == 0xE0))
+    {
+        /* LOAS syncword, the decoder demultiplexes the first program */
+        header_type = 3;
+    }
 
     *song_length = length;
 
@@ -667,6 +1258,9 @@ static int decodeAACfile(char *aacfile, char *sndfile, char *adts_fn, int to_std
         faad_fprintf(stderr, "ADIF, %.3f sec, %d kbps, %d Hz\n\n",
             length, bitrate, samplerate);
         break;
+    case 3:
+        faad_fprintf(stderr, "LATM/LOAS, %d Hz\n\n", samplerate);
+        break;
     }
 
     if (infoOnly)
@@ -679,6 +1273,32 @@ static int decodeAACfile(char *aacfile, char *sndfile, char *adts_fn, int to_std
         return 0;
     }
 
+    if (seek_to > 0.1)
+    {
+        if (header_type != 1 || streaminput ||
+            !adts_seek(&b, hDecoder, aacfile, tagsize, fileread, old_format,
+                use_index, (unsigned long)(seek_to * samplerate), &skip))
+        {
+            faad_fprintf(stderr, "Warning: can not seek in this file\n");
+        }
+    }
+
+    if (threads > 1 && header_type == 1 && !streaminput && !adts_out &&
+        seek_to <= 0.1)
+    {
+        retval = adts_decode_parallel(hDecoder, b.infile, aacfile, tagsize,
+            fileread, old_format, use_index, threads, channels, sndfile,
+            to_stdout, outputFormat, fileType);
+        if (retval >= 0)
+        {
+            NeAACDecClose(hDecoder);
+            fclose(b.infile);
+            if (b.buffer)
+                free(b.buffer);
+            return retval;
+        }
+    }
+
     int frameCount = 0;
     int output_count = 4;
 
@@ -686,8 +1306,8 @@ static int decodeAACfile(char *aacfile, char *sndfile, char *adts_fn, int to_std
     for (int mycount = 0; mycount < 16; mycount++)
     {
         //faad_fprintf(stderr, "frameCount: %d\r", ++frameCount);
-        sample_buffer = NeAACDecDecode(hDecoder, &frameInfo,
-            b.buffer, b.bytes_into_buffer);
+        sample_buffer = decode_frame(hDecoder, &frameInfo,
+            b.buffer, b.bytes_into_buffer, aufile, &direct);
 
         if (adts_out == 1)
         {
@@ -766,9 +1386,18 @@ static int decodeAACfile(char *aacfile, char *sndfile, char *adts_fn, int to_std
 
         if ((--output_count <= 0) && (frameInfo.error == 0) && (frameInfo.samples > 0) && (!adts_out))
         {
-            if (write_audio_file(aufile, sample_buffer, frameInfo.samples, 0) == 0)
+            /* the part of the first frame in front of the seek position */
+            unsigned long drop = min(skip * frameInfo.channels, frameInfo.samples);
+            unsigned long samples = frameInfo.samples - drop;
+
+            /* a frame can be dropped completely */
+            if (samples > 0 &&
+                (direct ? commit_audio_buffer(aufile, samples, drop) :
+                write_audio_file(aufile, sample_buffer, samples, drop)) == 0)
                 break;
         }
+        if (frameInfo.samples > 0)
+            skip = 0;
 
         if (output_count <= 0) output_count = 8;
 
@@ -807,12 +1436,14 @@ static const unsigned long srates[] =
 
 static int decodeMP4file(char *mp4file, char *sndfile, char *adts_fn, int to_stdout,
                   int outputFormat, int fileType, int downMatrix, int noGapless,
-                  int infoOnly, int adts_out, float *song_length, float seek_to)
+                  int infoOnly, int adts_out, float *song_length, float seek_to,
+                  int threads)
 {
     /*int track;*/
     unsigned long samplerate;
     unsigned char channels;
     void *sample_buffer;
+    int direct = 0;
 
     long sampleId, startSampleId;
 
@@ -918,6 +1549,24 @@ static int decodeMP4file(char *mp4file, char *sndfile, char *adts_fn, int to_std
         return 0;
     }
 
+    if (threads > 1 && !adts_out && seek_to <= 0.1)
+    {
+        /* gapless decoding stops at the length of the track */
+        unsigned long max_samples = 0;
+
+        if (!noGapless && !useAacLength && (mp4config.samplerate == samplerate))
+            max_samples = mp4config.samples;
+
+        int ret = mp4_decode_parallel(hDecoder, mp4file, threads, channels,
+            max_samples, sndfile, to_stdout, outputFormat, fileType);
+        if (ret >= 0)
+        {
+            NeAACDecClose(hDecoder);
+            mp4read_close();
+            return ret;
+        }
+    }
+
     startSampleId = 0;
     if (seek_to > 0.1)
         startSampleId = (int64_t)(seek_to * mp4config.samplerate / framesize);
@@ -933,7 +1582,8 @@ static int decodeMP4file(char *mp4file, char *sndfile, char *adts_fn, int to_std
         if (mp4read_frame())
             break;
 
-        sample_buffer = NeAACDecDecode(hDecoder, &frameInfo, mp4config.bitbuf.data, mp4config.bitbuf.size);
+        sample_buffer = decode_frame(hDecoder, &frameInfo, mp4config.bitbuf.data,
+            mp4config.bitbuf.size, aufile, &direct);
 
         if (!sample_buffer) {
             /* unable to decode file, abort */
@@ -1018,7 +1668,8 @@ static int decodeMP4file(char *mp4file, char *sndfile, char *adts_fn, int to_std
 
         if ((frameInfo.error == 0) && (sample_count > 0) && (!adts_out))
         {
-            if (write_audio_file(aufile, sample_buffer, sample_count, delay) == 0)
+            if ((direct ? commit_audio_buffer(aufile, sample_count, delay) :
+                write_audio_file(aufile, sample_buffer, sample_count, delay)) == 0)
                 break;
         }
 
@@ -1061,6 +1712,8 @@ static int faad_main(int argc, char *argv[])
     int showHelp = 0;
     int mp4file = 0;
     int noGapless = 0;
+    int useIndex = 0;
+    int threads = 1;
     char *fnp;
     char *aacFileName = NULL;
     char *audioFileName = NULL;
@@ -1102,11 +1755,13 @@ static int faad_main(int argc, char *argv[])
             { "stdio",      0, 0, 'w' },
             { "stdio",      0, 0, 'g' },
             { "seek",       1, 0, 'j' },
+            { "index",      0, 0, 'x' },
+            { "threads",    1, 0, 'p' },
             { "help",       0, 0, 'h' },
             { 0, 0, 0, 0 }
         };
 
-        c = getopt_long(argc, argv, "o:a:s:f:b:l:j:wgdhitq",
+        c = getopt_long(argc, argv, "o:a:s:f:b:l:j:p:wgdhitqx",
             long_options, &option_index);
 
         if (c == -1)
@@ -1203,6 +1858,17 @@ static int faad_main(int argc, char *argv[])
                 seekTo = atof(optarg);
             }
             break;
+        case 'x':
+            useIndex = 1;
+            break;
+        case 'p':
+            if (optarg)
+            {
+                threads = atoi(optarg);
+                if ((threads < 1) || (threads > 64))
+                    showHelp = 1;
+            }
+            break;
         case 't':
             old_format = 1;
             break;
@@ -1334,14 +2000,11 @@ static int faad_main(int argc, char *argv[])
     if (header[4] == 'f' && header[5] == 't' && header[6] == 'y' && header[7] == 'p')
         mp4file = 1;
 
-    if (!mp4file && seekTo != 0) {
-        faad_fprintf(stderr, "Warning: can only seek in MP4 files\n");
-    }
-
     if (mp4file)
     {
         result = decodeMP4file(aacFileName, audioFileName, adtsFileName, writeToStdio,
-            outputFormat, format, downMatrix, noGapless, infoOnly, adts_out, &length, seekTo);
+            outputFormat, format, downMatrix, noGapless, infoOnly, adts_out, &length, seekTo,
+            threads);
     } else {
 
     if (readFromStdin == 1) {
@@ -1357,7 +2020,7 @@ static int faad_main(int argc, char *argv[])
 
         result = decodeAACfile(aacFileName, audioFileName, adtsFileName, writeToStdio,
             def_srate, object_type, outputFormat, format, downMatrix, infoOnly, adts_out,
-            old_format, &length);
+            old_format, &length, seekTo, useIndex, threads);
     }
 
     if (audioFileName != NULL)
@@ -40,6 +40,8 @@ static void display_cmdline_options(Logger logger, cmdline_options *options)
     logger(LOGGER_INFO, "       channels: %d\n", options->channels);
     logger(LOGGER_INFO, "    sample rate: %d\n", options->samplerate);
     logger(LOGGER_INFO, "  output format: %d\n", options->aac_output_format);
+    logger(LOGGER_INFO, "         resync: %s\n", options->resync ? "yes" : "no");
+    logger(LOGGER_INFO, "        threads: %d\n", options->threads);
     logger(LOGGER_INFO, "------------------------------\n");
 }
 
@@ -130,6 +132,39 @@ static int process_cmdline_option_samplerate(Logger logger, cmdline_options *opt
 }
 
 
+static int process_cmdline_option_threads(Logger logger, cmdline_options *options)
+{
+    if (optarg == NULL)
+    {
+        logger(LOGGER_WARNING, "Missing threads parameter.\n");
+        return -1;
+    }
+
+    options->threads = atoi(optarg);
+    return 0;
+}
+
+
+static int process_cmdline_option_writer(Logger logger, cmdline_options *options)
+{
+    if (optarg == NULL)
+    {
+        logger(LOGGER_WARNING, "Missing writer parameter.\n");
+        return -1;
+    }
+
+    if (strcasecmp(optarg, "plain") == 0) options->create_audio_output_file = create_audio_wav_file;
+    else if (strcasecmp(optarg, "buffered") == 0) options->create_audio_output_file = create_audio_buffered_wav_file;
+    else
+    {
+        logger(LOGGER_WARNING, "Unknown writer: %s\n", optarg);
+        return -1;
+    }
+
+    return 0;
+}
+
+
 static int display_help_options(Logger logger)
 {
     logger(LOGGER_DISPLAY, "Current available options:\n\n");
@@ -138,6 +173,9 @@ static int display_help_options(Logger logger)
     logger(LOGGER_DISPLAY, "-l, --logger:     logging level (quiet, display, error, warning, info, debug)\n");
     logger(LOGGER_DISPLAY, "-s, --samplerate: sample rate\n");
     logger(LOGGER_DISPLAY, "-o, --outfile:    output filename\n");
+    logger(LOGGER_DISPLAY, "-r, --resync:     scan the whole input for recoverable frames\n");
+    logger(LOGGER_DISPLAY, "-t, --threads:    scanner threads (default: one per processor)\n");
+    logger(LOGGER_DISPLAY, "-w, --writer:     wav writer (plain, buffered)\n");
     return -1;
 }
 
@@ -151,7 +189,10 @@ static int process_cmdline_option(Logger logger, cmdline_options *options, int c
         case 'i': return process_cmdline_option_input_filename(logger, options);
         case 'l': return process_cmdline_option_logger_level(logger);
         case 'o': return process_cmdline_option_output_filename(logger, options);
+        case 'r': options->resync = 1; return 0;
         case 's': return process_cmdline_option_samplerate(logger, options);
+        case 't': return process_cmdline_option_threads(logger, options);
+        case 'w': return process_cmdline_option_writer(logger, options);
         default:
             logger(LOGGER_WARNING, "Unrecognized option: %c\n", c);
             return 0;
@@ -170,11 +211,14 @@ static int process_cmdline_options(Logger logger, cmdline_options *options, int
         { "infile",     required_argument, 0, 'i' },
         { "outfile",    required_argument, 0, 'o' },
         { "logger",     required_argument, 0, 'l' },
+        { "resync",     no_argument,       0, 'r' },
         { "samplerate", required_argument, 0, 's' },
+        { "threads",    required_argument, 0, 't' },
+        { "writer",     required_argument, 0, 'w' },
         { 0, 0, 0, 0 }
     };
 
-    while ((ch = getopt_long(argc, argv, "c:i:o:l:s:h", long_options, NULL)) != -1)
+    while ((ch = getopt_long(argc, argv, "c:i:o:l:s:t:w:rh", long_options, NULL)) != -1)
     {
         int result = process_cmdline_option(logger, options, ch);
         if (FAILED(result)) return result;
@@ -194,7 +238,9 @@ static void set_to_defaults(cmdline_options *options)
     options->bits_per_channel = 16;
     options->samplerate = 48000;
     options->aac_output_format = FAAD_FMT_16BIT;
-    options->create_audio_output_file = create_audio_wav_file;
+    options->resync = 0;
+    options->threads = 0;
+    options->create_audio_output_file = create_audio_buffered_wav_file;
 }
 
 void release_cmdline_options(cmdline_options *options)
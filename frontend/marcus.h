@@ -39,12 +39,17 @@ struct cmdline_options_tag
     long samplerate;
     char aac_output_format;
 
+    int resync;     /* scan the whole file for recoverable frames */
+    int threads;    /* scanner threads, 0 for one per processor */
+
     output_audio_file *(*create_audio_output_file)(Logger, cmdline_options *);
 };
 
 cmdline_options *initialize_cmdline_options(Logger logger, int argc, char *argv[]);
 void release_cmdline_options(cmdline_options *options);
 int rescue_media_file(Logger logger, cmdline_options *options);
+int rescue_scan_media_file(Logger logger, cmdline_options *options, NeAACDecHandle hDecoder,
+    const unsigned char *data, size_t size, size_t start, output_audio_file *poutfile);
 
 
 struct output_audio_file_tag
@@ -58,6 +63,7 @@ struct output_audio_file_tag
 
 void release_audio_wav_file(output_audio_file *wavfile);
 output_audio_file *create_audio_wav_file(Logger logger, cmdline_options *options);
+output_audio_file *create_audio_buffered_wav_file(Logger logger, cmdline_options *options);
 
 
 #endif
@@ -13,6 +13,12 @@
 #include <time.h>
 #endif
 
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+
 #include <fcntl.h>
 #include <stdio.h>
 #include <stdarg.h>
@@ -40,16 +46,30 @@ static const int FALSE = 0;
 static const int TRUE = !FALSE;
 
 
+/* The input is read in place. Regular files are mapped as a whole; anything
+ * that cannot be mapped (pipes, files too large for the address space) is
+ * read through a large block buffer. In both cases at least INFILE_WINDOW
+ * contiguous bytes (or everything up to the end of the file) are available
+ * at infile_data(), so a decode call never has to wait for a refill. */
+#define INFILE_BLOCK_SIZE (1024 * 1024)
+#define INFILE_WINDOW (FAAD_MIN_STREAMSIZE * MAX_CHANNELS)
+
 typedef struct
 {
     FILE *file;
     unsigned char *buffer;
-    int buffer_size;
+    size_t buffer_size;
+
+    /* non-zero when buffer points into a mapping of the whole file */
+    int mapped;
+#ifdef _WIN32
+    HANDLE mapping;
+#endif
 
     int at_eof;
-    int bytes_consumed;
-    int bytes_left_in_buffer;
-    int file_offset;
+    size_t read_position;
+    size_t bytes_left_in_buffer;
+    off_t file_offset;
 }
 buffer_infile;
 
@@ -58,61 +78,127 @@ static void initialize_buffer_infile(buffer_infile *pinfile)
     pinfile->file = NULL;
     pinfile->buffer = NULL;
     pinfile->buffer_size = 0;
+    pinfile->mapped = FALSE;
+#ifdef _WIN32
+    pinfile->mapping = NULL;
+#endif
     pinfile->at_eof = FALSE;
-    pinfile->bytes_consumed = 0;
+    pinfile->read_position = 0;
+    pinfile->bytes_left_in_buffer = 0;
     pinfile->file_offset = 0;
 }
 
-static int initial_fill_inbuffer(buffer_infile *pinfile)
+static unsigned char *infile_data(buffer_infile *pinfile)
+{
+    return pinfile->buffer + pinfile->read_position;
+}
+
+/* Size to hand to a single decoder call; the decoder takes 32 bit sizes. */
+static unsigned long infile_data_size(buffer_infile *pinfile)
 {
-    int bread = fread(pinfile->buffer, 1, pinfile->buffer_size, pinfile->file);
-    pinfile->bytes_left_in_buffer = bread;
-    return bread;
+    return (unsigned long)min(pinfile->bytes_left_in_buffer, (size_t)INFILE_BLOCK_SIZE);
 }
 
 static void fill_inbuffer(buffer_infile *pinfile)
 {
-    if (pinfile->bytes_consumed > 0)
+    size_t bread;
+
+    if (pinfile->at_eof || pinfile->bytes_left_in_buffer >= (size_t)INFILE_WINDOW)
+        return;
+
+    /* move the short tail to the front and read the next block behind it */
+    if (pinfile->bytes_left_in_buffer && pinfile->read_position)
     {
-        if (pinfile->bytes_left_in_buffer)
-        {
-            memmove(
-                pinfile->buffer,
-                pinfile->buffer + pinfile->bytes_consumed,
-                pinfile->bytes_left_in_buffer * sizeof(unsigned char));
-        }
+        memmove(pinfile->buffer, infile_data(pinfile), pinfile->bytes_left_in_buffer);
+    }
+    pinfile->read_position = 0;
 
-        if (!pinfile->at_eof)
-        {
-            int bread = fread(
-                pinfile->buffer + pinfile->bytes_left_in_buffer,
-                1,
-                pinfile->bytes_consumed,
-                pinfile->file);
+    bread = fread(
+        pinfile->buffer + pinfile->bytes_left_in_buffer,
+        1,
+        pinfile->buffer_size - pinfile->bytes_left_in_buffer,
+        pinfile->file);
 
-            pinfile->at_eof = (bread != pinfile->bytes_consumed);
+    pinfile->at_eof = (bread != pinfile->buffer_size - pinfile->bytes_left_in_buffer);
+    pinfile->bytes_left_in_buffer += bread;
+}
 
-            pinfile->bytes_left_in_buffer += bread;
-        }
+static void advance_inbuffer(buffer_infile *pinfile, size_t bytes)
+{
+    bytes = min(bytes, pinfile->bytes_left_in_buffer);
 
-        pinfile->bytes_consumed = 0;
-    }
+    pinfile->read_position += bytes;
+    pinfile->bytes_left_in_buffer -= bytes;
+    pinfile->file_offset += bytes;
+
+    fill_inbuffer(pinfile);
 }
 
-static void advance_inbuffer(buffer_infile *pinfile, int bytes)
+static int map_infile(buffer_infile *pinfile, off_t start)
 {
-    while ((pinfile->bytes_left_in_buffer > 0) && (bytes > 0))
+#if defined(_WIN32)
+    LARGE_INTEGER size;
+    HANDLE file = (HANDLE)_get_osfhandle(_fileno(pinfile->file));
+
+    if (file == INVALID_HANDLE_VALUE || GetFileType(file) != FILE_TYPE_DISK)
+        return FALSE;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart <= start ||
+        (unsigned long long)size.QuadPart > (size_t)-1)
+        return FALSE;
+
+    pinfile->mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (pinfile->mapping == NULL)
+        return FALSE;
+
+    pinfile->buffer = (unsigned char*)MapViewOfFile(pinfile->mapping, FILE_MAP_READ, 0, 0, 0);
+    if (pinfile->buffer == NULL)
     {
-        int chunk = min(bytes, pinfile->bytes_left_in_buffer);
+        CloseHandle(pinfile->mapping);
+        pinfile->mapping = NULL;
+        return FALSE;
+    }
+    pinfile->buffer_size = (size_t)size.QuadPart;
+#elif defined(HAVE_MMAP) && defined(HAVE_SYS_MMAN_H)
+    struct stat st;
+    void *map;
+    int fd = fileno(pinfile->file);
+
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= start ||
+        (unsigned long long)st.st_size > (size_t)-1)
+        return FALSE;
+
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED)
+        return FALSE;
+#ifdef MADV_SEQUENTIAL
+    madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+#endif
+    pinfile->buffer = (unsigned char*)map;
+    pinfile->buffer_size = (size_t)st.st_size;
+#else
+    (void)start;
+    return FALSE;
+#endif
 
-        bytes -= chunk;
-        pinfile->file_offset += chunk;
-        pinfile->bytes_consumed += chunk;
-        pinfile->bytes_left_in_buffer -= chunk;
+    pinfile->mapped = TRUE;
+    pinfile->at_eof = TRUE;
+    pinfile->read_position = (size_t)start;
+    pinfile->bytes_left_in_buffer = pinfile->buffer_size - (size_t)start;
+    pinfile->file_offset = start;
+    return TRUE;
+}
 
-        if (pinfile->bytes_left_in_buffer == 0)
-            fill_inbuffer(pinfile);
-    }
+static void unmap_infile(buffer_infile *pinfile)
+{
+#if defined(_WIN32)
+    UnmapViewOfFile(pinfile->buffer);
+    CloseHandle(pinfile->mapping);
+    pinfile->mapping = NULL;
+#elif defined(HAVE_MMAP) && defined(HAVE_SYS_MMAN_H)
+    munmap(pinfile->buffer, pinfile->buffer_size);
+#endif
+    pinfile->buffer = NULL;
+    pinfile->mapped = FALSE;
 }
 
 
@@ -139,11 +225,9 @@ static int rmf_decode_aac(
     int result = 0;
     int a = 0;
 
-    int bread = initial_fill_inbuffer(pinfile);
-
     do
     {
-        void *sample_buffer = NeAACDecDecode(hDecoder, &frameinfo, pinfile->buffer, pinfile->buffer_size);
+        void *sample_buffer = NeAACDecDecode(hDecoder, &frameinfo, infile_data(pinfile), infile_data_size(pinfile));
         logger(LOGGER_INFO, "Object count: %d; Frame info: channels = %d, bytes consumed = %d\n", ++a, frameinfo.channels, frameinfo.bytesconsumed);
         if (frameinfo.channels == 0) return -1;
 
@@ -151,7 +235,6 @@ static int rmf_decode_aac(
         if (FAILED(result)) return result;
 
         advance_inbuffer(pinfile, frameinfo.bytesconsumed);
-        fill_inbuffer(pinfile);
     }
     while (pinfile->bytes_left_in_buffer);
 
@@ -170,9 +253,10 @@ static int rmf_initialize_aac_decoder(
     unsigned long samplerate;
     unsigned char channels;
 
-    int bread = NeAACDecInit(hDecoder, pinfile->buffer, pinfile->buffer_size, &samplerate, &channels);
+    long bread = NeAACDecInit(hDecoder, infile_data(pinfile), infile_data_size(pinfile), &samplerate, &channels);
     if (bread >= 0)
     {
+        advance_inbuffer(pinfile, bread);
         logger(LOGGER_INFO, "NeAACDecInit: samplerate = %ld, channels = %d\n", samplerate, channels);
         result = rmf_decode_aac(logger, options, hDecoder, pinfile, poutfile);
     }
@@ -199,7 +283,15 @@ static int rmf_open_outfile(
     result = poutfile->open(poutfile, options->output_filename);
     if (SUCCESSFUL(result))
     {
-        result = rmf_initialize_aac_decoder(logger, options, hDecoder, pinfile, poutfile);
+        if (options->resync && pinfile->mapped)
+        {
+            result = rescue_scan_media_file(logger, options, hDecoder,
+                pinfile->buffer, pinfile->buffer_size, pinfile->read_position, poutfile);
+        }
+        else
+        {
+            result = rmf_initialize_aac_decoder(logger, options, hDecoder, pinfile, poutfile);
+        }
         poutfile->close(poutfile);
     }
 
@@ -216,11 +308,11 @@ static int rmf_malloc_infile_buffer(
 {
     int result = -1;
 
-    pinfile->buffer_size = 2 * 16 * 1024;//FAAD_MIN_STREAMSIZE * MAX_CHANNELS;
+    pinfile->buffer_size = INFILE_BLOCK_SIZE;
     pinfile->buffer = (unsigned char*)malloc(pinfile->buffer_size);
     if (pinfile->buffer != NULL)
     {
-        memset(pinfile->buffer, 0, pinfile->buffer_size);
+        fill_inbuffer(pinfile);
         result = rmf_open_outfile(logger, options, hDecoder, pinfile);
         free(pinfile->buffer);
     }
@@ -244,6 +336,7 @@ static int rmf_seek_infile(
     int seek = fseek(pinfile->file, options->infile_seek_position, SEEK_SET);
     if (seek == 0)
     {
+        pinfile->file_offset = options->infile_seek_position;
         result = rmf_malloc_infile_buffer(logger, options, hDecoder, pinfile);
     }
     else
@@ -255,6 +348,29 @@ static int rmf_seek_infile(
 }
 
 
+static int rmf_map_infile(
+    Logger logger,
+    cmdline_options *options,
+    NeAACDecHandle hDecoder,
+    buffer_infile *pinfile)
+{
+    int result = -1;
+
+    if (map_infile(pinfile, options->infile_seek_position))
+    {
+        logger(LOGGER_DEBUG, "rmf_map_infile: reading mapped infile in place\n");
+        result = rmf_open_outfile(logger, options, hDecoder, pinfile);
+        unmap_infile(pinfile);
+    }
+    else
+    {
+        result = rmf_seek_infile(logger, options, hDecoder, pinfile);
+    }
+
+    return result;
+}
+
+
 static int rmf_open_infile(
     Logger logger,
     cmdline_options *options,
@@ -268,7 +384,7 @@ static int rmf_open_infile(
     infileBuffer.file = fopen(options->input_filename, "rb");
     if (infileBuffer.file != NULL)
     {
-        result = rmf_seek_infile(logger, options, hDecoder, &infileBuffer);
+        result = rmf_map_infile(logger, options, hDecoder, &infileBuffer);
         fclose(infileBuffer.file);
     }
     else
@@ -0,0 +1,499 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <io.h>
+#ifndef __MINGW32__
+#define off_t __int64
+#endif
+#else
+#include <time.h>
+#endif
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <errno.h>
+
+#include <neaacdec.h>
+
+#include "unicode_support.h"
+#include "audio.h"
+#include "mp4read.h"
+#include "thread.h"
+
+#include "marcus.h"
+
+
+#ifndef min
+#define min(a,b) ( (a) < (b) ? (a) : (b) )
+#endif
+
+
+static const int MAX_CHANNELS = 16;
+
+/* A run is a chain of frames that decode without error one after the
+ * other. Shorter chains are taken for noise that happened to decode. */
+#define SCAN_MIN_FRAMES 4
+/* Bytes handed to a single trial decode, and the most an ADTS frame can
+ * span when its successor is checked. */
+#define SCAN_WINDOW (FAAD_MIN_STREAMSIZE * MAX_CHANNELS)
+#define SCAN_ADTS_REACH 8192
+/* Largest block handed to a single sync search. */
+#define SCAN_SYNC_BLOCK (16 * 1024 * 1024)
+/* Bytes searched for ADTS headers to tell ADTS from raw input. */
+#define SCAN_PROBE (1024 * 1024)
+
+
+typedef struct
+{
+    size_t offset;
+    size_t size;
+}
+scan_frame;
+
+typedef struct
+{
+    size_t first_frame;     /* index into the frame list of its scanner */
+    size_t frame_count;
+    size_t start;
+    size_t end;
+    int channels;
+    long score;
+}
+scan_run;
+
+typedef struct
+{
+    NeAACDecHandle hDecoder;
+    NeAACDecConfigurationPtr config;
+    const unsigned char *init;
+    unsigned long init_size;
+
+    const unsigned char *data;
+    size_t size;
+    int adts;
+
+    /* runs starting in [begin, end) are found by this scanner */
+    size_t begin;
+    size_t end;
+
+    scan_frame *frames;
+    size_t frame_count;
+    size_t frame_capacity;
+
+    scan_run *runs;
+    size_t run_count;
+    size_t run_capacity;
+
+    int failed;
+}
+scan_chunk;
+
+
+static int grow_array(void **array, size_t *capacity, size_t count, size_t element_size)
+{
+    void *grown;
+    size_t new_capacity;
+
+    if (count < *capacity) return 0;
+
+    new_capacity = (*capacity != 0) ? 2 * *capacity : 256;
+    grown = realloc(*array, new_capacity * element_size);
+    if (grown == NULL) return -1;
+
+    *array = grown;
+    *capacity = new_capacity;
+    return 0;
+}
+
+
+/* The decoder keeps the element layout of the first frame it decoded, a
+ * frame of noise can leave it unable to decode anything else. */
+static int scan_open_decoder(scan_chunk *chunk)
+{
+    unsigned long samplerate;
+    unsigned char channels;
+
+    if (chunk->hDecoder != NULL) NeAACDecClose(chunk->hDecoder);
+
+    chunk->hDecoder = NeAACDecOpen();
+    if (chunk->hDecoder == NULL) return -1;
+    NeAACDecSetConfiguration(chunk->hDecoder, chunk->config);
+
+    return (NeAACDecInit(chunk->hDecoder, (unsigned char *)chunk->init, chunk->init_size, &samplerate, &channels) < 0) ? -1 : 0;
+}
+
+
+/* Decodes frame after frame from offset and appends them to the frame
+ * list. The chain stops at the first frame that fails, or once it is long
+ * enough and has left the chunk; the next chunk continues from there. */
+static size_t scan_trial_run(scan_chunk *chunk, size_t offset, int *channels)
+{
+    NeAACDecFrameInfo frameinfo;
+    size_t position = offset;
+    size_t count = 0;
+    int retried = 0;
+
+    while (position < chunk->size)
+    {
+        if (position >= chunk->end && count >= SCAN_MIN_FRAMES) break;
+
+        NeAACDecDecode(chunk->hDecoder, &frameinfo, (unsigned char *)chunk->data + position,
+            (unsigned long)min(chunk->size - position, (size_t)SCAN_WINDOW));
+
+        /* element inconsistency, try again with a fresh layout */
+        if (frameinfo.error == 21 && count == 0 && !retried)
+        {
+            retried = 1;
+            if (FAILED(scan_open_decoder(chunk)))
+            {
+                chunk->failed = 1;
+                break;
+            }
+            continue;
+        }
+        if (frameinfo.error != 0 || frameinfo.channels == 0 || frameinfo.bytesconsumed == 0) break;
+        if (count == 0) *channels = frameinfo.channels;
+        else if (frameinfo.channels != *channels) break;
+
+        if (grow_array((void **)&chunk->frames, &chunk->frame_capacity, chunk->frame_count + count, sizeof(scan_frame)))
+        {
+            chunk->failed = 1;
+            break;
+        }
+        chunk->frames[chunk->frame_count + count].offset = position;
+        chunk->frames[chunk->frame_count + count].size = frameinfo.bytesconsumed;
+
+        position += frameinfo.bytesconsumed;
+        count++;
+    }
+
+    return count;
+}
+
+
+/* Returns the next offset worth a trial decode, chunk->end when there is
+ * none left in the chunk. */
+static size_t scan_next_candidate(scan_chunk *chunk, size_t position)
+{
+    if (!chunk->adts) return position;
+
+    while (position < chunk->end)
+    {
+        size_t block = min(chunk->end - position, (size_t)SCAN_SYNC_BLOCK);
+        size_t reach = min(chunk->size - position, block + SCAN_ADTS_REACH);
+        long sync = NeAACDecFindADTSSync(chunk->data + position, (unsigned long)reach, 0);
+
+        if (sync >= 0 && (size_t)sync < block) return position + sync;
+        position += block;
+    }
+
+    return chunk->end;
+}
+
+
+static void scan_chunk_main(void *arg)
+{
+    scan_chunk *chunk = (scan_chunk *)arg;
+    size_t position = chunk->begin;
+
+    while (!chunk->failed)
+    {
+        size_t count;
+        int channels = 0;
+
+        position = scan_next_candidate(chunk, position);
+        if (position >= chunk->end) break;
+
+        count = scan_trial_run(chunk, position, &channels);
+        if (count < SCAN_MIN_FRAMES)
+        {
+            position++;
+            continue;
+        }
+
+        if (grow_array((void **)&chunk->runs, &chunk->run_capacity, chunk->run_count, sizeof(scan_run)))
+        {
+            chunk->failed = 1;
+            break;
+        }
+
+        scan_run *run = &chunk->runs[chunk->run_count++];
+        scan_frame *last = &chunk->frames[chunk->frame_count + count - 1];
+        run->first_frame = chunk->frame_count;
+        run->frame_count = count;
+        run->start = position;
+        run->end = last->offset + last->size;
+        run->channels = channels;
+        run->score = (long)count;
+
+        chunk->frame_count += count;
+        position = run->end;
+    }
+}
+
+
+/* Merges the runs of all chunks into one ordered list. Where two runs
+ * claim the same bytes the one with the higher score keeps them and the
+ * other one loses the frames involved. Returns the number of runs. */
+static size_t scan_merge_runs(scan_chunk *chunks, int chunk_count, scan_run *merged, scan_chunk **owner)
+{
+    size_t count = 0;
+    int c;
+
+    for (c = 0; c < chunk_count; c++)
+    {
+        size_t r;
+        for (r = 0; r < chunks[c].run_count; r++)
+        {
+            scan_run run = chunks[c].runs[r];
+            scan_frame *frames = chunks[c].frames;
+
+            while (count > 0 && run.start < merged[count-1].end)
+            {
+                scan_run *previous = &merged[count-1];
+                scan_frame *previous_frames = owner[count-1]->frames;
+
+                if (run.score > previous->score)
+                {
+                    /* drop the tail of the previous run */
+                    while (previous->frame_count > 0 &&
+                        previous_frames[previous->first_frame + previous->frame_count - 1].offset +
+                        previous_frames[previous->first_frame + previous->frame_count - 1].size > run.start)
+                    {
+                        previous->frame_count--;
+                    }
+                    if (previous->frame_count < SCAN_MIN_FRAMES)
+                    {
+                        count--;
+                        continue;
+                    }
+                    previous->end = previous_frames[previous->first_frame + previous->frame_count - 1].offset +
+                        previous_frames[previous->first_frame + previous->frame_count - 1].size;
+                    previous->score = (long)previous->frame_count;
+                }
+                else
+                {
+                    /* drop the head of this run */
+                    while (run.frame_count > 0 && frames[run.first_frame].offset < previous->end)
+                    {
+                        run.first_frame++;
+                        run.frame_count--;
+                    }
+                    if (run.frame_count > 0) run.start = frames[run.first_frame].offset;
+                    run.score = (long)run.frame_count;
+                }
+                break;
+            }
+
+            if (run.frame_count < SCAN_MIN_FRAMES) continue;
+
+            merged[count] = run;
+            owner[count] = &chunks[c];
+            count++;
+        }
+    }
+
+    return count;
+}
+
+
+/* Fills a gap with silent frames, as many as the lost bytes would have
+ * held on average. */
+static int scan_write_gap(Logger logger, output_audio_file *poutfile, size_t start, size_t end,
+    double frame_bytes, unsigned char *silence, int sample_count, int channel_count)
+{
+    long frames = (long)((double)(end - start) / frame_bytes + 0.5);
+    long i;
+
+    logger(LOGGER_INFO, "Gap of %lu bytes at offset %lu, %ld frames of silence\n",
+        (unsigned long)(end - start), (unsigned long)start, frames);
+
+    for (i = 0; i < frames; i++)
+    {
+        int result = poutfile->write(poutfile, silence, sample_count, channel_count);
+        if (FAILED(result)) return result;
+    }
+
+    return 0;
+}
+
+
+static int scan_decode_runs(Logger logger, cmdline_options *options, NeAACDecHandle hDecoder,
+    const unsigned char *data, size_t start, scan_run *runs, scan_chunk **owner, size_t run_count,
+    output_audio_file *poutfile)
+{
+    NeAACDecFrameInfo frameinfo;
+    unsigned char *silence = NULL;
+    unsigned long samplerate;
+    unsigned char channels;
+    size_t frame_count = 0, frame_bytes = 0;
+    int sample_count = 0, channel_count = 0;
+    int result = 0;
+    size_t r, f;
+
+    for (r = 0; r < run_count; r++)
+    {
+        frame_count += runs[r].frame_count;
+        frame_bytes += runs[r].end - runs[r].start;
+    }
+
+    if (NeAACDecInit(hDecoder, (unsigned char *)data + runs[0].start,
+        (unsigned long)min(runs[0].end - runs[0].start, (size_t)SCAN_WINDOW), &samplerate, &channels) < 0)
+    {
+        logger(LOGGER_ERROR, "Could not initialize aac decoder.\n");
+        return -1;
+    }
+    logger(LOGGER_INFO, "NeAACDecInit: samplerate = %ld, channels = %d\n", samplerate, channels);
+
+    if (runs[0].start > start)
+        logger(LOGGER_INFO, "Skipped %lu bytes in front of the first frame\n", (unsigned long)(runs[0].start - start));
+
+    for (r = 0; r < run_count && SUCCESSFUL(result); r++)
+    {
+        scan_frame *frames = owner[r]->frames + runs[r].first_frame;
+
+        if (r > 0 && runs[r].start != runs[r-1].end && silence != NULL)
+        {
+            result = scan_write_gap(logger, poutfile, runs[r-1].end, runs[r].start,
+                (double)frame_bytes / frame_count, silence, sample_count, channel_count);
+            if (FAILED(result)) break;
+        }
+
+        for (f = 0; f < runs[r].frame_count; f++)
+        {
+            void *sample_buffer = NeAACDecDecode(hDecoder, &frameinfo, (unsigned char *)data + frames[f].offset,
+                (unsigned long)frames[f].size);
+            if (frameinfo.error != 0 || frameinfo.channels == 0) continue;
+
+            result = poutfile->write(poutfile, sample_buffer, frameinfo.samples, frameinfo.channels);
+            if (FAILED(result)) break;
+
+            /* silence for the gaps, shaped like the frames around them */
+            if (silence == NULL && frameinfo.samples > 0)
+            {
+                sample_count = frameinfo.samples;
+                channel_count = frameinfo.channels;
+                silence = (unsigned char *)calloc(sample_count, options->bits_per_channel / 8);
+            }
+        }
+    }
+
+    if (silence != NULL) free(silence);
+    return result;
+}
+
+
+int rescue_scan_media_file(Logger logger, cmdline_options *options, NeAACDecHandle hDecoder,
+    const unsigned char *data, size_t size, size_t start, output_audio_file *poutfile)
+{
+    NeAACDecConfigurationPtr config = NeAACDecGetCurrentConfiguration(hDecoder);
+    scan_chunk *chunks = NULL;
+    scan_chunk **owner = NULL;
+    scan_run *runs = NULL;
+    worker_thread *threads = NULL;
+    size_t run_count = 0, total_runs = 0, chunk_size;
+    int chunk_count = options->threads;
+    int adts, c;
+    int result = -1;
+
+    if (start >= size) return -1;
+
+    /* ADTS input is recognised by two chained headers near the start */
+    long sync = NeAACDecFindADTSSync(data + start, (unsigned long)min(size - start, (size_t)SCAN_PROBE), 0);
+    adts = (sync >= 0);
+    logger(LOGGER_INFO, "Scanning %lu bytes for %s frames\n", (unsigned long)(size - start), adts ? "ADTS" : "raw AAC");
+
+    if (chunk_count <= 0) chunk_count = processor_count();
+    chunk_size = (size - start + chunk_count - 1) / chunk_count;
+    if (chunk_size < SCAN_WINDOW)
+    {
+        chunk_size = SCAN_WINDOW;
+        chunk_count = (int)((size - start + chunk_size - 1) / chunk_size);
+    }
+
+    chunks = (scan_chunk *)calloc(chunk_count, sizeof(scan_chunk));
+    threads = (worker_thread *)calloc(chunk_count, sizeof(worker_thread));
+    if (chunks == NULL || threads == NULL)
+    {
+        logger(LOGGER_ERROR, "rescue_scan_media_file: could not instantiate scanners: %d, %s\n", errno, strerror(errno));
+        goto cleanup;
+    }
+
+    for (c = 0; c < chunk_count; c++)
+    {
+        scan_chunk *chunk = &chunks[c];
+
+        chunk->config = config;
+        chunk->init = data + start + (adts ? sync : 0);
+        chunk->init_size = (unsigned long)min(size - start - (adts ? sync : 0), (size_t)SCAN_WINDOW);
+        chunk->data = data;
+        chunk->size = size;
+        chunk->adts = adts;
+        chunk->begin = start + c * chunk_size;
+        chunk->end = min(chunk->begin + chunk_size, size);
+
+        if (FAILED(scan_open_decoder(chunk)))
+        {
+            logger(LOGGER_ERROR, "Could not initialize aac decoder.\n");
+            goto cleanup;
+        }
+    }
+
+    for (c = 0; c < chunk_count; c++)
+        start_worker_thread(&threads[c], scan_chunk_main, &chunks[c]);
+    for (c = 0; c < chunk_count; c++)
+    {
+        join_worker_thread(&threads[c]);
+        if (chunks[c].failed)
+        {
+            logger(LOGGER_ERROR, "rescue_scan_media_file: out of memory while scanning\n");
+            goto cleanup;
+        }
+        total_runs += chunks[c].run_count;
+    }
+
+    if (total_runs == 0)
+    {
+        logger(LOGGER_ERROR, "No decodable frames found\n");
+        goto cleanup;
+    }
+
+    runs = (scan_run *)malloc(total_runs * sizeof(scan_run));
+    owner = (scan_chunk **)malloc(total_runs * sizeof(scan_chunk *));
+    if (runs == NULL || owner == NULL)
+    {
+        logger(LOGGER_ERROR, "rescue_scan_media_file: could not instantiate run list: %d, %s\n", errno, strerror(errno));
+        goto cleanup;
+    }
+
+    run_count = scan_merge_runs(chunks, chunk_count, runs, owner);
+    logger(LOGGER_INFO, "Found %lu recoverable segments\n", (unsigned long)run_count);
+    if (run_count == 0) goto cleanup;
+
+    result = scan_decode_runs(logger, options, hDecoder, data, start, runs, owner, run_count, poutfile);
+
+cleanup:
+    if (chunks != NULL)
+    {
+        for (c = 0; c < chunk_count; c++)
+        {
+            if (chunks[c].hDecoder != NULL) NeAACDecClose(chunks[c].hDecoder);
+            if (chunks[c].frames != NULL) free(chunks[c].frames);
+            if (chunks[c].runs != NULL) free(chunks[c].runs);
+        }
+        free(chunks);
+    }
+    if (threads != NULL) free(threads);
+    if (runs != NULL) free(runs);
+    if (owner != NULL) free(owner);
+
+    return result;
+}
@@ -35,6 +35,8 @@
 #define SAMPLES_PER_FRAME 1024
 #define BITS_PER_SAMPLE 16
 #define SAMPLE_FORMAT short
+/* staging buffer of the buffered writer, flushed with a single fwrite */
+#define BUFFERED_WRITE_SIZE (4 * 1024 * 1024)
 
 
 const uint32_t HEADER_RIFF_SIZE = 12;
@@ -67,6 +69,8 @@ struct audio_wav_file_tag
 
     void *buffer;
     size_t sizeof_buffer;
+    int frames_per_buffer;  /* complete frames the buffer holds before it is written */
+    int buffered_frames;
 
     int (*writer)(audio_wav_file *, unsigned char *, int, int);
 };
@@ -182,10 +186,28 @@ static void wav_file_rewrite_header(audio_wav_file *wavfile)
 }
 
 
+static int wav_file_flush(audio_wav_file *wavfile)
+{
+    if (wavfile->buffered_frames == 0) return 0;
+
+    size_t count = (size_t)wavfile->buffered_frames * wavfile->channels * SAMPLES_PER_FRAME;
+    size_t written = fwrite(wavfile->buffer, sizeof(SAMPLE_FORMAT), count, wavfile->file);
+    wavfile->buffered_frames = 0;
+    if (count != written)
+    {
+        wavfile->logger(LOGGER_ERROR, "wav_file_flush: error writing wav file: %d, %s\n", errno, strerror(errno));
+        return -1;
+    }
+
+    return 0;
+}
+
+
 static int wav_file_write_multichannel(audio_wav_file *wavfile, unsigned char *inbuffer, int sample_count, int channel_count)
 {
     SAMPLE_FORMAT *sample_buffer = (SAMPLE_FORMAT *)inbuffer;
-    SAMPLE_FORMAT *output_buffer = (SAMPLE_FORMAT *)wavfile->buffer + 2 * wavfile->current_pair_count;
+    SAMPLE_FORMAT *output_buffer = (SAMPLE_FORMAT *)wavfile->buffer +
+        (size_t)wavfile->buffered_frames * wavfile->channels * SAMPLES_PER_FRAME + 2 * wavfile->current_pair_count;
 
     for (int sindex = sample_count / channel_count; sindex > 0; --sindex)
     {
@@ -198,15 +220,10 @@ static int wav_file_write_multichannel(audio_wav_file *wavfile, unsigned char *i
     if (wavfile->current_pair_count < wavfile->channels / 2) return 0;
 
     wavfile->current_pair_count = 0;
-    int count = wavfile->channels * SAMPLES_PER_FRAME;
-    int written = fwrite(wavfile->buffer, sizeof(SAMPLE_FORMAT), count, wavfile->file);
-    if (count != written)
-    {
-        wavfile->logger(LOGGER_ERROR, "wav_file_write_multichannel_16: error writing wav file: %d, %s\n", errno, strerror(errno));
-        return -1;
-    }
+    wavfile->buffered_frames++;
+    if (wavfile->buffered_frames < wavfile->frames_per_buffer) return 0;
 
-    return 0;
+    return wav_file_flush(wavfile);
 }
 
 
@@ -242,6 +259,7 @@ static void wav_file_close(output_audio_file *audiofile)
     audio_wav_file *wavfile = UNWRAP(audiofile);
     if (wavfile == NULL || wavfile->file == NULL) return;
 
+    wav_file_flush(wavfile);
     wav_file_rewrite_header(wavfile);
     fclose(wavfile->file);
     wavfile->file = NULL;
@@ -286,7 +304,7 @@ static void wav_file_release(output_audio_file *audiofile)
 }
 
 
-output_audio_file *create_audio_wav_file(Logger logger, cmdline_options *options)
+static output_audio_file *create_wav_file(Logger logger, cmdline_options *options, int frames_per_buffer)
 {
     /* Instantiate audio_wav_file */
     audio_wav_file *wavfile = (audio_wav_file *)malloc(sizeof(audio_wav_file));
@@ -308,9 +326,11 @@ output_audio_file *create_audio_wav_file(Logger logger, cmdline_options *options
     wavfile->max_samples = (0xFFFFFFFF - HEADER_TOTAL_SIZE) / bytes_per_sample;
     wavfile->header_written = 0;
     wavfile->writer = wav_file_write_multichannel;
+    wavfile->frames_per_buffer = frames_per_buffer;
+    wavfile->buffered_frames = 0;
 
     /* Instantiate samples buffer */
-    wavfile->sizeof_buffer = options->channels * SAMPLES_PER_FRAME * bytes_per_sample;
+    wavfile->sizeof_buffer = (size_t)frames_per_buffer * options->channels * SAMPLES_PER_FRAME * bytes_per_sample;
     void *buffer = malloc(wavfile->sizeof_buffer);
     if (buffer == NULL)
     {
@@ -344,3 +364,21 @@ error_buffer:
 error_wavfile:
     return NULL;
 }
+
+
+/* Writes every frame as soon as all channel pairs are in. */
+output_audio_file *create_audio_wav_file(Logger logger, cmdline_options *options)
+{
+    return create_wav_file(logger, options, 1);
+}
+
+
+/* Collects frames and writes them in blocks of a few megabytes, for low
+ * bitrate input where the output calls would dominate. */
+output_audio_file *create_audio_buffered_wav_file(Logger logger, cmdline_options *options)
+{
+    size_t frame_size = (size_t)options->channels * SAMPLES_PER_FRAME * sizeof(SAMPLE_FORMAT);
+    int frames = (frame_size != 0) ? (int)(BUFFERED_WRITE_SIZE / frame_size) : 1;
+
+    return create_wav_file(logger, options, (frames > 0) ? frames : 1);
+}
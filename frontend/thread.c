@@ -0,0 +1,175 @@
+/*
+** FAAD2 - Freeware Advanced Audio (AAC) Decoder including SBR decoding
+** Copyright (C) 2003-2005 M. Bakker, Nero AG, http://www.nero.com
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+**
+** Any non-GPL usage of this software or parts of this software is strictly
+** forbidden.
+**
+** The "appropriate copyright message" mentioned in section 2c of the GPLv2
+** must read: "Code from FAAD2 is copyright (c) Nero AG, www.nero.com"
+**
+** Commercial non-GPL licensing of this software is possible.
+** For more info contact Nero AG through Mpeg4AAClicense@nero.com.
+**
+** $Id$
+**/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#if !defined(_WIN32) && defined(HAVE_UNISTD_H)
+#include <unistd.h>
+#endif
+
+#include "thread.h"
+
+#if defined(_WIN32)
+static DWORD WINAPI worker_thread_main(LPVOID arg)
+{
+    worker_thread *thread = (worker_thread*)arg;
+    thread->func(thread->arg);
+    return 0;
+}
+#elif defined(HAVE_PTHREAD_H)
+static void *worker_thread_main(void *arg)
+{
+    worker_thread *thread = (worker_thread*)arg;
+    thread->func(thread->arg);
+    return NULL;
+}
+#endif
+
+/* returns 0 when no thread could be started, func is not called then */
+int try_start_worker_thread(worker_thread *thread, thread_func func, void *arg)
+{
+    thread->func = func;
+    thread->arg = arg;
+    thread->started = 0;
+
+#if defined(_WIN32)
+    thread->handle = CreateThread(NULL, 0, worker_thread_main, thread, 0, NULL);
+    thread->started = (thread->handle != NULL);
+#elif defined(HAVE_PTHREAD_H)
+    thread->started = (pthread_create(&thread->handle, NULL, worker_thread_main, thread) == 0);
+#endif
+
+    return thread->started;
+}
+
+void start_worker_thread(worker_thread *thread, thread_func func, void *arg)
+{
+    if (!try_start_worker_thread(thread, func, arg))
+        func(arg);
+}
+
+void join_worker_thread(worker_thread *thread)
+{
+    if (!thread->started)
+        return;
+
+#if defined(_WIN32)
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+#elif defined(HAVE_PTHREAD_H)
+    pthread_join(thread->handle, NULL);
+#endif
+    thread->started = 0;
+}
+
+int processor_count(void)
+{
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#elif defined(HAVE_PTHREAD_H) && defined(_SC_NPROCESSORS_ONLN)
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return (n > 0) ? (int)n : 1;
+#else
+    return 1;
+#endif
+}
+
+void init_worker_monitor(worker_monitor *monitor)
+{
+#if defined(_WIN32)
+    InitializeCriticalSection(&monitor->lock);
+    InitializeConditionVariable(&monitor->changed);
+#elif defined(HAVE_PTHREAD_H)
+    pthread_mutex_init(&monitor->lock, NULL);
+    pthread_cond_init(&monitor->changed, NULL);
+#else
+    (void)monitor;
+#endif
+}
+
+void destroy_worker_monitor(worker_monitor *monitor)
+{
+#if defined(_WIN32)
+    DeleteCriticalSection(&monitor->lock);
+#elif defined(HAVE_PTHREAD_H)
+    pthread_cond_destroy(&monitor->changed);
+    pthread_mutex_destroy(&monitor->lock);
+#else
+    (void)monitor;
+#endif
+}
+
+void enter_worker_monitor(worker_monitor *monitor)
+{
+#if defined(_WIN32)
+    EnterCriticalSection(&monitor->lock);
+#elif defined(HAVE_PTHREAD_H)
+    pthread_mutex_lock(&monitor->lock);
+#else
+    (void)monitor;
+#endif
+}
+
+void leave_worker_monitor(worker_monitor *monitor)
+{
+#if defined(_WIN32)
+    LeaveCriticalSection(&monitor->lock);
+#elif defined(HAVE_PTHREAD_H)
+    pthread_mutex_unlock(&monitor->lock);
+#else
+    (void)monitor;
+#endif
+}
+
+void wait_worker_monitor(worker_monitor *monitor)
+{
+#if defined(_WIN32)
+    SleepConditionVariableCS(&monitor->changed, &monitor->lock, INFINITE);
+#elif defined(HAVE_PTHREAD_H)
+    pthread_cond_wait(&monitor->changed, &monitor->lock);
+#else
+    (void)monitor;
+#endif
+}
+
+void notify_worker_monitor(worker_monitor *monitor)
+{
+#if defined(_WIN32)
+    WakeAllConditionVariable(&monitor->changed);
+#elif defined(HAVE_PTHREAD_H)
+    pthread_cond_broadcast(&monitor->changed);
+#else
+    (void)monitor;
+#endif
+}
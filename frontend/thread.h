@@ -0,0 +1,92 @@
+/*
+** FAAD2 - Freeware Advanced Audio (AAC) Decoder including SBR decoding
+** Copyright (C) 2003-2005 M. Bakker, Nero AG, http://www.nero.com
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+**
+** Any non-GPL usage of this software or parts of this software is strictly
+** forbidden.
+**
+** The "appropriate copyright message" mentioned in section 2c of the GPLv2
+** must read: "Code from FAAD2 is copyright (c) Nero AG, www.nero.com"
+**
+** Commercial non-GPL licensing of this software is possible.
+** For more info contact Nero AG through Mpeg4AAClicense@nero.com.
+**
+** $Id$
+**/
+
+#ifndef THREAD_H_INCLUDED
+#define THREAD_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(HAVE_PTHREAD_H)
+#include <pthread.h>
+#endif
+
+/* Worker threads of the frontend. Without thread support the work is done
+   on the calling thread when it is started. */
+
+typedef void (*thread_func)(void *arg);
+
+typedef struct
+{
+#if defined(_WIN32)
+    HANDLE handle;
+#elif defined(HAVE_PTHREAD_H)
+    pthread_t handle;
+#endif
+    int started;
+    thread_func func;
+    void *arg;
+} worker_thread;
+
+/* a lock with one condition to wait for, without thread support all
+   calls do nothing */
+typedef struct
+{
+#if defined(_WIN32)
+    CRITICAL_SECTION lock;
+    CONDITION_VARIABLE changed;
+#elif defined(HAVE_PTHREAD_H)
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+#else
+    int unused;
+#endif
+} worker_monitor;
+
+void start_worker_thread(worker_thread *thread, thread_func func, void *arg);
+int try_start_worker_thread(worker_thread *thread, thread_func func, void *arg);
+void join_worker_thread(worker_thread *thread);
+int processor_count(void);
+
+void init_worker_monitor(worker_monitor *monitor);
+void destroy_worker_monitor(worker_monitor *monitor);
+void enter_worker_monitor(worker_monitor *monitor);
+void leave_worker_monitor(worker_monitor *monitor);
+/* releases the lock while waiting for a notification */
+void wait_worker_monitor(worker_monitor *monitor);
+void notify_worker_monitor(worker_monitor *monitor);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
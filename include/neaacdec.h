@@ -108,6 +108,31 @@ extern "C" {
 #define ERROR_RESILIENCE_CAP (1<<4) /* Can decode ER */
 #define FIXED_POINT_CAP      (1<<5) /* Fixed point */
 
+/* CPU levels for the runtime selected DSP kernels */
+#define FAAD_CPU_SCALAR 0
+#define FAAD_CPU_SSE2   1
+#define FAAD_CPU_SSSE3  2
+#define FAAD_CPU_AVX2   3
+#define FAAD_CPU_AVX512 4
+#define FAAD_CPU_AUTO   255 /* best level this CPU supports */
+
+/* PNS noise generators */
+#define FAAD_PNS_REFERENCE 0 /* serial generator of the reference decoder */
+#define FAAD_PNS_FAST      1 /* counter based, made several values at a time */
+
+/* Decoder stages reported by NeAACDecGetStats() */
+#define FAAD_STAGE_PARSE      0 /* bitstream parsing, excluding huffman */
+#define FAAD_STAGE_HUFFMAN    1 /* scalefactor and spectral data decoding */
+#define FAAD_STAGE_REQUANT    2 /* inverse quantisation and scaling, for long
+                                   window pairs also PNS, M/S and IS */
+#define FAAD_STAGE_TOOLS      3 /* PNS, M/S, IS, prediction, LTP, DRC */
+#define FAAD_STAGE_TNS        4
+#define FAAD_STAGE_FILTERBANK 5 /* inverse MDCT, windowing and overlap */
+#define FAAD_STAGE_SBR        6 /* SBR, excluding PS */
+#define FAAD_STAGE_PS         7
+#define FAAD_STAGE_OUTPUT     8 /* PCM conversion */
+#define FAAD_STAGE_COUNT      9
+
 /* Channel definitions */
 #define FRONT_CHANNEL_CENTER (1)
 #define FRONT_CHANNEL_LEFT   (2)
@@ -134,6 +159,7 @@ extern "C" {
 
 
 typedef void *NeAACDecHandle;
+typedef void *NeAACDecLATMHandle;
 
 typedef struct mp4AudioSpecificConfig
 {
@@ -196,6 +222,38 @@ typedef struct NeAACDecFrameInfo
     unsigned char ps;
 } NeAACDecFrameInfo;
 
+typedef struct NeAACDecStats
+{
+    /* time spent in NeAACDecDecode(), NeAACDecDecode2() */
+    unsigned long long total_ns;
+
+    /* time spent in and number of calls to each FAAD_STAGE_* stage,
+       the stages do not overlap */
+    unsigned long long stage_ns[FAAD_STAGE_COUNT];
+    unsigned long long stage_calls[FAAD_STAGE_COUNT];
+
+    unsigned long long bytes;  /* input bytes consumed */
+    unsigned long long frames; /* frames decoded without error */
+    unsigned long long errors; /* frames that returned an error */
+} NeAACDecStats;
+
+typedef struct NeAACDecADTSIndex
+{
+    unsigned long frames;        /* number of frames found */
+    unsigned long *offset;       /* byte offset of every frame */
+    unsigned short *length;      /* length of every frame in bytes */
+
+    unsigned long blocks;        /* raw data blocks in all frames */
+    unsigned long frame_bytes;   /* sum of all frame lengths */
+    unsigned long skipped;       /* bytes outside of frames */
+    unsigned long size;          /* size of the indexed stream */
+
+    /* from the header of the first frame */
+    unsigned long samplerate;
+    unsigned char object_type;
+    unsigned char channels;
+} NeAACDecADTSIndex;
+
 NEAACDECAPI char* NeAACDecGetErrorMessage(unsigned char errcode);
 
 NEAACDECAPI unsigned long NeAACDecGetCapabilities(void);
@@ -207,6 +265,37 @@ NEAACDECAPI NeAACDecConfigurationPtr NeAACDecGetCurrentConfiguration(NeAACDecHan
 NEAACDECAPI unsigned char NeAACDecSetConfiguration(NeAACDecHandle hDecoder,
                                                    NeAACDecConfigurationPtr config);
 
+/* Force the DSP kernels to a specific CPU level, mainly for testing.
+   The level is clipped to what the CPU supports, the level actually
+   used is returned. The FAAD_CPU_LEVEL environment variable (scalar, sse2,
+   ssse3, avx2, avx512) sets the default for new decoder handles. */
+NEAACDECAPI unsigned char NeAACDecSetCpuLevel(NeAACDecHandle hDecoder,
+                                              unsigned char level);
+
+NEAACDECAPI unsigned char NeAACDecGetCpuLevel(NeAACDecHandle hDecoder);
+
+/* Select the noise generator for perceptual noise substitution. The
+   default FAAD_PNS_REFERENCE gives bit exact output; FAAD_PNS_FAST is
+   quicker but produces different (equally valid) noise. The FAAD_PNS
+   environment variable set to "fast" changes the default for new decoder
+   handles. Fixed point builds only have the reference generator, the
+   mode actually used is returned. */
+NEAACDECAPI unsigned char NeAACDecSetPnsMode(NeAACDecHandle hDecoder,
+                                             unsigned char mode);
+
+/* Turn the per stage statistics on or off, they are off by default unless
+   the FAAD_STATS environment variable is set to a non-zero value. Enabling
+   does not clear the counters collected so far. */
+NEAACDECAPI void NeAACDecEnableStats(NeAACDecHandle hDecoder,
+                                     unsigned char enable);
+
+/* Copy the statistics collected so far, returns 1 when collection is
+   enabled, 0 otherwise */
+NEAACDECAPI unsigned char NeAACDecGetStats(NeAACDecHandle hDecoder,
+                                           NeAACDecStats *stats);
+
+NEAACDECAPI void NeAACDecResetStats(NeAACDecHandle hDecoder);
+
 /* Init the library based on info from the AAC file (ADTS/ADIF) */
 NEAACDECAPI long NeAACDecInit(NeAACDecHandle hDecoder,
                               unsigned char *buffer,
@@ -241,6 +330,165 @@ NEAACDECAPI void* NeAACDecDecode2(NeAACDecHandle hDecoder,
                                   void **sample_buffer,
                                   unsigned long sample_buffer_size);
 
+/* Streaming interface: feed the input in chunks of any size and pull the
+   decoded frames one by one. The library buffers the input internally, so
+   the caller does not need to keep track of bytesconsumed.
+
+   NeAACDecFeed() copies as much of the buffer as fits into the internal
+   buffer (64 kB) and returns the number of bytes taken. Pass a NULL buffer
+   once all input has been fed so the last frame is flushed out.
+
+   NeAACDecPull() decodes the next complete frame. ADTS streams are found and
+   followed by their syncword, damaged data between frames is skipped. ADTS
+   and ADIF streams do not need NeAACDecInit(), raw streams need
+   NeAACDecInit2() before the first pull. NULL is returned with
+   hInfo->bytesconsumed == 0 when more input is needed, otherwise the return
+   value and hInfo are the same as for NeAACDecDecode(). NeAACDecPull2() is
+   the counterpart of NeAACDecDecode2().
+
+   NeAACDecPostSeekReset() drops the buffered input. */
+NEAACDECAPI unsigned long NeAACDecFeed(NeAACDecHandle hDecoder,
+                                       unsigned char *buffer,
+                                       unsigned long buffer_size);
+
+NEAACDECAPI void* NeAACDecPull(NeAACDecHandle hDecoder,
+                               NeAACDecFrameInfo *hInfo);
+
+NEAACDECAPI void* NeAACDecPull2(NeAACDecHandle hDecoder,
+                                NeAACDecFrameInfo *hInfo,
+                                void **sample_buffer,
+                                unsigned long sample_buffer_size);
+
+/* ADTS frame scanning, no decoder handle is needed.
+
+   NeAACDecFindADTSSync() returns the offset of the first ADTS header in the
+   buffer that is followed by another valid header right after its frame,
+   or -1 when there is none.
+
+   NeAACDecIndexADTS() walks a complete ADTS stream held in memory (usually
+   a mapped file) in one pass and lists the offset and length of every
+   frame. Data between frames is skipped the same way, a truncated frame at
+   the end is left out. Returns NULL when no frame is found or on allocation
+   failure, the index is released with NeAACDecFreeADTSIndex(). */
+NEAACDECAPI long NeAACDecFindADTSSync(const unsigned char *buffer,
+                                      unsigned long buffer_size,
+                                      unsigned char old_format);
+
+NEAACDECAPI NeAACDecADTSIndex* NeAACDecIndexADTS(const unsigned char *buffer,
+                                                unsigned long buffer_size,
+                                                unsigned char old_format);
+
+NEAACDECAPI void NeAACDecFreeADTSIndex(NeAACDecADTSIndex *index);
+
+/* Store an index in a compact, portable form (for a sidecar file) and read
+   it back. NeAACDecSaveADTSIndex() returns the number of bytes needed, the
+   data is only written when buffer_size is large enough.
+   NeAACDecLoadADTSIndex() returns NULL when the data is damaged. */
+NEAACDECAPI unsigned long NeAACDecSaveADTSIndex(const NeAACDecADTSIndex *index,
+                                                unsigned char *buffer,
+                                                unsigned long buffer_size);
+
+NEAACDECAPI NeAACDecADTSIndex* NeAACDecLoadADTSIndex(const unsigned char *buffer,
+                                                    unsigned long buffer_size);
+
+/* Random access into an indexed ADTS stream. The decoder must have been
+   initialised on the stream, buffer and buffer_size are the indexed data.
+   The frames in front of the target are decoded and thrown away to fill
+   the filter bank overlap, for SBR/PS back to an SBR header early enough
+   for its state to settle, and the SBR phases are set for the target. This
+   makes the output exact for LC and SBR/PS streams (PNS noise aside, SBR
+   streams must start with an SBR header). The state of Main prediction
+   and LTP/LD is not restored, the output of those streams only
+   approximates a decode from the start after a seek. Returns the
+   index of the frame to decode next, the first *skip samples per channel
+   of its output precede the requested position and should be dropped.
+   sample counts output samples per channel from the start of the stream,
+   as delivered by decoding it from the beginning. Returns -1 when sample
+   is past the end. */
+NEAACDECAPI long NeAACDecSeekADTS(NeAACDecHandle hDecoder,
+                                  const NeAACDecADTSIndex *index,
+                                  unsigned char *buffer,
+                                  unsigned long buffer_size,
+                                  unsigned long sample,
+                                  unsigned long *skip);
+
+/* Decode the frames first to first+count-1 of an indexed stream into
+   sample_buffer, the frames in front of them are decoded first as for
+   NeAACDecSeekADTS(). For LC and SBR/PS streams the output continues
+   sample for sample where the output of frame first-1 ends (PNS noise
+   aside), so the ranges of a split stream can be decoded on separate
+   handles (one per thread) and joined. Streams with Main, LTP and LD
+   carry more state from frame to frame and are refused. The index may
+   also be filled by the application, for example with the access units
+   of an MP4 track. Damaged frames give no output. Returns the number of
+   samples written (all channels, counted as in hInfo->samples), hInfo
+   describes the last frame and reports an error when sample_buffer is
+   full. Returns -1 when the range is not in the index or the stream is
+   refused. */
+NEAACDECAPI long NeAACDecDecodeRange(NeAACDecHandle hDecoder,
+                                     NeAACDecFrameInfo *hInfo,
+                                     const NeAACDecADTSIndex *index,
+                                     unsigned char *buffer,
+                                     unsigned long buffer_size,
+                                     unsigned long first,
+                                     unsigned long count,
+                                     void *sample_buffer,
+                                     unsigned long sample_buffer_size);
+
+/* LATM/LOAS streams, as broadcast in DVB.
+
+   NeAACDecInit() recognises a LOAS stream by its syncword and sets the
+   decoder up for its first stream (program 0, layer 0). NeAACDecDecode()
+   then takes one LOAS frame at a time. A frame can carry several access
+   units, they are decoded one per call and bytesconsumed is 0 until the
+   last one. When the AudioSpecificConfig of the stream changes, error 37
+   is returned and the decoder must be initialised again.
+
+   NeAACDecFindLOASSync() works like NeAACDecFindADTSSync().
+
+   The demultiplexer gives access to all programs and layers of a
+   multiplex, each of these streams is decoded by a decoder of its own.
+   The decoders get config (may be NULL for the defaults) and are set up
+   again when the config of their stream changes. NeAACDecLATMDemux()
+   reads the LOAS frame at the start of buffer and returns the number of
+   bytes to skip: the size of the frame, also when it is damaged, or when
+   buffer does not start with a frame the distance to the next possible
+   syncword. 0 is returned when more input is needed. *error is set to
+   the error of the frame. The streams of the frame are numbered program
+   by program and layer by layer, NeAACDecLATMStreams() returns their
+   number. NeAACDecLATMDecode() decodes the next access unit of a stream
+   from the last frame, NULL with hInfo->bytesconsumed == 0 and no error
+   is returned when there is none left. */
+NEAACDECAPI long NeAACDecFindLOASSync(const unsigned char *buffer,
+                                      unsigned long buffer_size);
+
+NEAACDECAPI NeAACDecLATMHandle NeAACDecLATMOpen(NeAACDecConfigurationPtr config);
+
+NEAACDECAPI void NeAACDecLATMClose(NeAACDecLATMHandle hLatm);
+
+NEAACDECAPI long NeAACDecLATMDemux(NeAACDecLATMHandle hLatm,
+                                   unsigned char *buffer,
+                                   unsigned long buffer_size,
+                                   unsigned char *error);
+
+NEAACDECAPI unsigned char NeAACDecLATMStreams(NeAACDecLATMHandle hLatm);
+
+NEAACDECAPI char NeAACDecLATMStreamInfo(NeAACDecLATMHandle hLatm,
+                                        unsigned char stream,
+                                        unsigned char *program,
+                                        unsigned char *layer,
+                                        mp4AudioSpecificConfig *mp4ASC);
+
+NEAACDECAPI void* NeAACDecLATMDecode(NeAACDecLATMHandle hLatm,
+                                     unsigned char stream,
+                                     NeAACDecFrameInfo *hInfo);
+
+NEAACDECAPI void* NeAACDecLATMDecode2(NeAACDecLATMHandle hLatm,
+                                      unsigned char stream,
+                                      NeAACDecFrameInfo *hInfo,
+                                      void **sample_buffer,
+                                      unsigned long sample_buffer_size);
+
 NEAACDECAPI char NeAACDecAudioSpecificConfig(unsigned char *pBuffer,
                                              unsigned long buffer_size,
                                              mp4AudioSpecificConfig *mp4ASC);
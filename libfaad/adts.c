@@ -0,0 +1,684 @@
+/*
+** FAAD2 - Freeware Advanced Audio (AAC) Decoder including SBR decoding
+** Copyright (C) 2003-2005 M. Bakker, Nero AG, http://www.nero.com
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+**
+** Any non-GPL usage of this software or parts of this software is strictly
+** forbidden.
+**
+** The "appropriate copyright message" mentioned in section 2c of the GPLv2
+** must read: "Code from FAAD2 is copyright (c) Nero AG, www.nero.com"
+**
+** Commercial non-GPL licensing of this software is possible.
+** For more info contact Nero AG through Mpeg4AAClicense@nero.com.
+**
+** $Id$
+**/
+
+/* ADTS syncword scanning and frame indexing, see adts.h */
+
+#include "common.h"
+#include "structs.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "adts.h"
+#include "lt_predict.h"
+
+/* largest block handed to a single dsp->adts_sync() call */
+#define ADTS_SCAN_BLOCK 0x40000000UL
+#define ADTS_INDEX_MIN  256
+
+/* frames decoded after an SBR header before the output of a seek or range
+   is exact: the chirp factors of the HF generator keep at most a quarter
+   of their previous value per frame, after 12 frames the difference is
+   below float precision */
+#define ADTS_SBR_SETTLE 12
+
+/* sidecar format: magic, version, header fields, then per frame the gap to
+   the previous frame as a varint and the length as 16 bit value, followed
+   by a checksum over everything before it */
+static const uint8_t adts_index_magic[8] = { 'F','A','A','D','I','D','X', 1 };
+#define ADTS_INDEX_HEAD (8 + 5*8 + 4 + 2)
+
+
+/* returns the position of the first possible syncword (0xFFF, layer 0) that
+   lies completely within the n bytes at p, or n when there is none */
+uint32_t adts_sync_c(const uint8_t *p, uint32_t n)
+{
+    const uint8_t *q = p;
+    const uint8_t *end = p + n;
+
+    while (end - q >= 2)
+    {
+        q = (const uint8_t*)memchr(q, 0xFF, end - q - 1);
+        if (q == NULL)
+            break;
+        if ((q[1] & 0xF6) == 0xF0)
+            return (uint32_t)(q - p);
+        q++;
+    }
+
+    return n;
+}
+
+/* returns the frame length from the ADTS header at p, or 0 when p does not
+   start a plausible header. ADTS_PROBE_SIZE bytes are read. */
+uint32_t adts_frame_length(const uint8_t *p, uint8_t old_format)
+{
+    uint32_t len, min_len = ADTS_HEADER_SIZE;
+
+    /* syncword, layer 0 */
+    if ((p[0] != 0xFF) || ((p[1] & 0xF6) != 0xF0))
+        return 0;
+    /* sampling frequency index */
+    if (((p[2] >> 2) & 0x0F) > 11)
+        return 0;
+
+    /* old MPEG-4 headers carry 2 bits of emphasis before the length */
+    if (old_format && !(p[1] & 0x08))
+    {
+        len = ((uint32_t)p[4] << 5) | (p[5] >> 3);
+        min_len += 2;
+    } else {
+        len = ((uint32_t)(p[3] & 0x03) << 11) | ((uint32_t)p[4] << 3) | (p[5] >> 5);
+    }
+    /* CRC */
+    if (!(p[1] & 0x01))
+        min_len += 2;
+
+    return (len >= min_len) ? len : 0;
+}
+
+static uint8_t adts_raw_blocks(const uint8_t *p, uint8_t old_format)
+{
+    if (old_format && !(p[1] & 0x08))
+        return (p[7] >> 6) + 1;
+
+    return (p[6] & 0x03) + 1;
+}
+
+/* position of the next possible syncword at or after pos, size when there
+   is none */
+static unsigned long adts_scan(const dsp_funcs *dsp, const uint8_t *buffer,
+                               unsigned long size, unsigned long pos)
+{
+    while (size - pos >= 2)
+    {
+        uint32_t n = (uint32_t)min(size - pos, ADTS_SCAN_BLOCK);
+        uint32_t i = dsp->adts_sync(buffer + pos, n);
+
+        if (i < n)
+            return pos + i;
+
+        /* the last byte may pair with the first one of the next block */
+        pos += n - 1;
+    }
+
+    return size;
+}
+
+/* length of the frame at pos when the next header follows it, 0 otherwise */
+static uint32_t adts_chained_length(const uint8_t *buffer, unsigned long size,
+                                    unsigned long pos, uint8_t old_format)
+{
+    uint32_t len;
+
+    if (size - pos < ADTS_PROBE_SIZE)
+        return 0;
+
+    len = adts_frame_length(buffer + pos, old_format);
+    if (len == 0 || size - pos < len + ADTS_PROBE_SIZE)
+        return 0;
+
+    if (adts_frame_length(buffer + pos + len, old_format) == 0)
+        return 0;
+
+    return len;
+}
+
+long adts_find_sync(const dsp_funcs *dsp, const uint8_t *buffer,
+                    unsigned long size, uint8_t old_format)
+{
+    unsigned long pos = 0;
+
+    while ((pos = adts_scan(dsp, buffer, size, pos)) < size)
+    {
+        if (adts_chained_length(buffer, size, pos, old_format) != 0)
+            return (long)pos;
+        pos++;
+    }
+
+    return -1;
+}
+
+static uint8_t adts_index_grow(NeAACDecADTSIndex *index, unsigned long *capacity)
+{
+    unsigned long n = *capacity ? 2 * *capacity : ADTS_INDEX_MIN;
+    unsigned long *offset = (unsigned long*)faad_malloc(n * sizeof(unsigned long));
+    unsigned short *length = (unsigned short*)faad_malloc(n * sizeof(unsigned short));
+
+    if (offset == NULL || length == NULL)
+    {
+        if (offset) faad_free(offset);
+        if (length) faad_free(length);
+        return 0;
+    }
+
+    if (index->frames)
+    {
+        memcpy(offset, index->offset, index->frames * sizeof(unsigned long));
+        memcpy(length, index->length, index->frames * sizeof(unsigned short));
+    }
+    if (index->offset) faad_free(index->offset);
+    if (index->length) faad_free(index->length);
+
+    index->offset = offset;
+    index->length = length;
+    *capacity = n;
+
+    return 1;
+}
+
+/* Single pass over the stream. Until a header has been seen to chain to
+   the next one the data is scanned for syncwords, after that the frames
+   are followed by their length fields alone. */
+NeAACDecADTSIndex *adts_build_index(const dsp_funcs *dsp, const uint8_t *buffer,
+                                    unsigned long size, uint8_t old_format)
+{
+    NeAACDecADTSIndex *index;
+    unsigned long capacity = 0;
+    unsigned long pos = 0, next;
+    uint8_t locked = 0;
+
+    index = (NeAACDecADTSIndex*)faad_malloc(sizeof(NeAACDecADTSIndex));
+    if (index == NULL)
+        return NULL;
+    memset(index, 0, sizeof(NeAACDecADTSIndex));
+
+    while (size - pos >= ADTS_PROBE_SIZE)
+    {
+        const uint8_t *p = buffer + pos;
+        uint32_t len = adts_frame_length(p, old_format);
+
+        /* a frame is taken when it continues a locked run, ends the
+           buffer, or is followed by another header */
+        if (len != 0 && len <= size - pos &&
+            (locked || len == size - pos ||
+             adts_chained_length(buffer, size, pos, old_format) != 0))
+        {
+            if (index->frames == capacity && !adts_index_grow(index, &capacity))
+            {
+                adts_free_index(index);
+                return NULL;
+            }
+
+            if (index->frames == 0)
+            {
+                index->object_type = (p[2] >> 6) + 1;
+                index->samplerate = get_sample_rate((p[2] >> 2) & 0x0F);
+                index->channels = ((p[2] & 0x01) << 2) | (p[3] >> 6);
+            }
+
+            index->offset[index->frames] = pos;
+            index->length[index->frames] = (unsigned short)len;
+            index->frames++;
+            index->blocks += adts_raw_blocks(p, old_format);
+            index->frame_bytes += len;
+
+            pos += len;
+            locked = 1;
+            continue;
+        }
+
+        locked = 0;
+        next = adts_scan(dsp, buffer, size, pos + 1);
+        index->skipped += next - pos;
+        pos = next;
+    }
+    index->skipped += size - pos;
+    index->size = size;
+
+    if (index->frames == 0)
+    {
+        adts_free_index(index);
+        return NULL;
+    }
+
+    return index;
+}
+
+void adts_free_index(NeAACDecADTSIndex *index)
+{
+    if (index)
+    {
+        if (index->offset) faad_free(index->offset);
+        if (index->length) faad_free(index->length);
+        faad_free(index);
+    }
+}
+
+
+static uint8_t *put_le(uint8_t *p, uint64_t v, uint8_t bytes)
+{
+    while (bytes--)
+    {
+        *p++ = (uint8_t)v;
+        v >>= 8;
+    }
+    return p;
+}
+
+static uint64_t get_le(const uint8_t *p, uint8_t bytes)
+{
+    uint64_t v = 0;
+
+    while (bytes--)
+        v = (v << 8) | p[bytes];
+    return v;
+}
+
+static uint32_t adts_index_checksum(const uint8_t *p, unsigned long n)
+{
+    /* FNV-1a */
+    uint32_t h = 2166136261u;
+
+    while (n--)
+        h = (h ^ *p++) * 16777619u;
+    return h;
+}
+
+static unsigned long adts_frame_gap(const NeAACDecADTSIndex *index, unsigned long i)
+{
+    if (i == 0)
+        return index->offset[0];
+    return index->offset[i] - index->offset[i-1] - index->length[i-1];
+}
+
+unsigned long adts_save_index(const NeAACDecADTSIndex *index, uint8_t *buffer,
+                              unsigned long size)
+{
+    unsigned long need = ADTS_INDEX_HEAD + 4;
+    unsigned long i;
+    uint8_t *p;
+
+    for (i = 0; i < index->frames; i++)
+    {
+        unsigned long gap = adts_frame_gap(index, i);
+
+        need += 2;
+        do {
+            need++;
+            gap >>= 7;
+        } while (gap);
+    }
+
+    if (buffer == NULL || size < need)
+        return need;
+
+    p = buffer;
+    memcpy(p, adts_index_magic, 8);
+    p = put_le(p + 8, index->size, 8);
+    p = put_le(p, index->frames, 8);
+    p = put_le(p, index->blocks, 8);
+    p = put_le(p, index->frame_bytes, 8);
+    p = put_le(p, index->skipped, 8);
+    p = put_le(p, index->samplerate, 4);
+    *p++ = index->object_type;
+    *p++ = index->channels;
+
+    for (i = 0; i < index->frames; i++)
+    {
+        unsigned long gap = adts_frame_gap(index, i);
+
+        while (gap >= 0x80)
+        {
+            *p++ = (uint8_t)(gap | 0x80);
+            gap >>= 7;
+        }
+        *p++ = (uint8_t)gap;
+        p = put_le(p, index->length[i], 2);
+    }
+    put_le(p, adts_index_checksum(buffer, (unsigned long)(p - buffer)), 4);
+
+    return need;
+}
+
+NeAACDecADTSIndex *adts_load_index(const uint8_t *buffer, unsigned long size)
+{
+    NeAACDecADTSIndex *index;
+    const uint8_t *p, *end;
+    unsigned long capacity, i;
+    uint64_t frames, pos = 0;
+
+    if (size < ADTS_INDEX_HEAD + 4 || memcmp(buffer, adts_index_magic, 8) != 0)
+        return NULL;
+    end = buffer + size - 4;
+    if (adts_index_checksum(buffer, size - 4) != (uint32_t)get_le(end, 4))
+        return NULL;
+
+    /* every frame takes at least 3 bytes */
+    frames = get_le(buffer + 16, 8);
+    if (frames == 0 || frames > (uint64_t)(size - ADTS_INDEX_HEAD) / 3)
+        return NULL;
+
+    index = (NeAACDecADTSIndex*)faad_malloc(sizeof(NeAACDecADTSIndex));
+    if (index == NULL)
+        return NULL;
+    memset(index, 0, sizeof(NeAACDecADTSIndex));
+
+    /* grown once to at least frames entries */
+    capacity = (unsigned long)(frames + 1) / 2;
+    if (!adts_index_grow(index, &capacity))
+    {
+        adts_free_index(index);
+        return NULL;
+    }
+
+    index->size = (unsigned long)get_le(buffer + 8, 8);
+    index->blocks = (unsigned long)get_le(buffer + 24, 8);
+    index->frame_bytes = (unsigned long)get_le(buffer + 32, 8);
+    index->skipped = (unsigned long)get_le(buffer + 40, 8);
+    index->samplerate = (unsigned long)get_le(buffer + 48, 4);
+    index->object_type = buffer[52];
+    index->channels = buffer[53];
+
+    p = buffer + ADTS_INDEX_HEAD;
+    for (i = 0; i < (unsigned long)frames; i++)
+    {
+        uint64_t gap = 0;
+        uint8_t shift = 0;
+
+        do {
+            if (p >= end || shift > 56)
+                goto damaged;
+            gap |= (uint64_t)(*p & 0x7F) << shift;
+            shift += 7;
+        } while (*p++ & 0x80);
+        if (end - p < 2)
+            goto damaged;
+
+        pos += gap;
+        index->offset[i] = (unsigned long)pos;
+        index->length[i] = (unsigned short)get_le(p, 2);
+        pos += index->length[i];
+        p += 2;
+        if (pos > index->size)
+            goto damaged;
+    }
+    index->frames = (unsigned long)frames;
+
+    if (p == end)
+        return index;
+
+damaged:
+    adts_free_index(index);
+    return NULL;
+}
+
+/* frames decoded in front of a seek target. The filter bank overlap
+   comes from the frame before it, that makes the output of an LC stream
+   match a decode from the start (except for PNS noise). The prediction
+   state of Main and the LTP buffer of LTP and LD are only approached, the
+   extra frames for them bring the output closer. */
+static unsigned long adts_preroll(const NeAACDecStruct *hDecoder)
+{
+    unsigned long frames = 1;
+
+#ifdef SBR_DEC
+    /* room for an SBR header and the frames after it, see adts_prime(),
+       upsampling alone only needs the QMF banks filled */
+    if (hDecoder->sbr_present_flag)
+        frames = 2 * ADTS_SBR_SETTLE;
+    else if (hDecoder->forceUpSampling || hDecoder->downSampledSBR)
+        frames = 2;
+#endif
+#ifdef LTP_DEC
+    /* long term prediction looks up to 2048 samples back, four frames
+       of a low delay stream */
+    if ((hDecoder->object_type == LTP) || (hDecoder->object_type == LD))
+        frames = 1 + (2048 + hDecoder->frameLength - 1) / hDecoder->frameLength;
+#endif
+#ifdef MAIN_DEC
+    /* the backward adaptive predictors only approach their state */
+    if (hDecoder->object_type == MAIN)
+        frames = 3;
+#endif
+
+    return frames;
+}
+
+/* brings the stream state back to where NeAACDecInit() left it, the
+   buffers are cleared when the next frame allocates them again */
+static void adts_rewind(NeAACDecStruct *hDecoder)
+{
+    uint8_t i;
+
+    for (i = 0; i < MAX_SYNTAX_ELEMENTS; i++)
+    {
+        hDecoder->element_alloced[i] = 0;
+        hDecoder->element_output_channels[i] = 0;
+#ifdef SBR_DEC
+        if (hDecoder->sbr[i])
+        {
+            sbrDecodeEnd(hDecoder->sbr[i]);
+            hDecoder->sbr[i] = NULL;
+        }
+#endif
+#if (defined(PS_DEC) || defined(DRM_PS))
+        hDecoder->ps_used[i] = 0;
+#endif
+    }
+#if (defined(PS_DEC) || defined(DRM_PS))
+    hDecoder->ps_used_global = 0;
+#endif
+    for (i = 0; i < MAX_CHANNELS; i++)
+    {
+        /* a channel pair only allocates what is missing, so drop the
+           buffers to have it start from silence like a new decoder */
+        if (hDecoder->time_out[i]) faad_free(hDecoder->time_out[i]);
+        hDecoder->time_out[i] = NULL;
+        if (hDecoder->fb_intermed[i]) faad_free(hDecoder->fb_intermed[i]);
+        hDecoder->fb_intermed[i] = NULL;
+#ifdef MAIN_DEC
+        if (hDecoder->pred_stat[i]) faad_free(hDecoder->pred_stat[i]);
+        hDecoder->pred_stat[i] = NULL;
+#endif
+#ifdef LTP_DEC
+        if (hDecoder->lt_pred_stat[i]) faad_free(hDecoder->lt_pred_stat[i]);
+        hDecoder->lt_pred_stat[i] = NULL;
+        hDecoder->ltp_lag[i] = 0;
+#endif
+        hDecoder->window_shape_prev[i] = 0;
+    }
+
+    hDecoder->__r1 = 1;
+    hDecoder->__r2 = 1;
+    hDecoder->postSeekResetFlag = 0;
+    hDecoder->frame = 0;
+}
+
+#ifdef SBR_DEC
+/* every SBR element of the frame just decoded came with a header */
+static uint8_t adts_sbr_header(const NeAACDecStruct *hDecoder)
+{
+    uint8_t i, found = 0;
+
+    for (i = 0; i < MAX_SYNTAX_ELEMENTS; i++)
+    {
+        if (hDecoder->sbr[i] == NULL)
+            continue;
+        if (!hDecoder->sbr[i]->bs_header_flag)
+            return 0;
+        found = 1;
+    }
+
+    return found;
+}
+#endif
+
+/* Decodes the frames in front of frame target, its output then continues
+   the one of a decode from the start. Seeking to the first frame starts
+   the stream over. SBR needs a header and ADTS_SBR_SETTLE frames after
+   it in front of target, the preroll is doubled until one is found. The
+   SBR noise and sinusoid phases are set from the frame number (see
+   hf_assembly()), which assumes the stream starts with an SBR header. */
+static void adts_prime(NeAACDecStruct *hDecoder, const NeAACDecADTSIndex *index,
+                       uint8_t *buffer, unsigned long target)
+{
+    NeAACDecFrameInfo info;
+    unsigned long frames = adts_preroll(hDecoder);
+
+    for (;;)
+    {
+        unsigned long first = target - min(target, frames), i;
+#ifdef SBR_DEC
+        uint8_t header = 0;
+#endif
+
+        if (first == 0)
+            adts_rewind(hDecoder);
+        else
+            NeAACDecPostSeekReset(hDecoder, (long)first);
+
+        for (i = first; i < target; i++)
+        {
+            NeAACDecDecode(hDecoder, &info, buffer + index->offset[i], index->length[i]);
+#ifdef SBR_DEC
+            if ((i > first) && (i + ADTS_SBR_SETTLE <= target) &&
+                adts_sbr_header(hDecoder))
+                header = 1;
+#endif
+        }
+
+#ifdef SBR_DEC
+        /* no header early enough, start further back */
+        if ((first > 0) && hDecoder->sbr_present_flag && !header)
+        {
+            frames = max(2 * frames, 2 * ADTS_SBR_SETTLE);
+            continue;
+        }
+#endif
+        break;
+    }
+}
+
+long adts_seek(NeAACDecStruct *hDecoder, const NeAACDecADTSIndex *index,
+               uint8_t *buffer, unsigned long size, unsigned long sample,
+               unsigned long *skip)
+{
+    unsigned long frame_len = hDecoder->frameLength;
+    unsigned long target;
+
+#ifdef SBR_DEC
+    if (((hDecoder->sbr_present_flag == 1) && (!hDecoder->downSampledSBR)) ||
+        (hDecoder->forceUpSampling == 1))
+        frame_len *= 2;
+#endif
+
+    /* the output of frame n follows the one of frame n-1, the first frame
+       only fills the overlap */
+    target = sample / frame_len + 1;
+    if (target >= index->frames)
+        return -1;
+    if (index->offset[index->frames-1] + index->length[index->frames-1] > size)
+        return -1;
+
+    adts_prime(hDecoder, index, buffer, target);
+
+    *skip = sample % frame_len;
+    return (long)target;
+}
+
+/* a range continues sample for sample only when adts_prime() restores
+   all the state carried from frame to frame */
+static uint8_t adts_range_exact(const NeAACDecStruct *hDecoder)
+{
+    (void)hDecoder;
+#ifdef MAIN_DEC
+    if (hDecoder->object_type == MAIN)
+        return 0;
+#endif
+#ifdef LTP_DEC
+    if (is_ltp_ot(hDecoder->object_type))
+        return 0;
+#endif
+
+    return 1;
+}
+
+long adts_decode_range(NeAACDecStruct *hDecoder, NeAACDecFrameInfo *hInfo,
+                       const NeAACDecADTSIndex *index, uint8_t *buffer,
+                       unsigned long size, unsigned long first,
+                       unsigned long count, uint8_t *sample_buffer,
+                       unsigned long sample_buffer_size)
+{
+    unsigned long written = 0, i;
+    uint8_t stride;
+
+    if ((first > index->frames) || (count > index->frames - first))
+        return -1;
+    if ((count > 0) &&
+        (index->offset[first+count-1] + index->length[first+count-1] > size))
+        return -1;
+
+    switch (hDecoder->config.outputFormat)
+    {
+    case FAAD_FMT_24BIT:
+    case FAAD_FMT_32BIT:
+    case FAAD_FMT_FLOAT:
+        stride = sizeof(int32_t);
+        break;
+    case FAAD_FMT_DOUBLE:
+        stride = sizeof(double);
+        break;
+    default:
+        stride = sizeof(int16_t);
+        break;
+    }
+
+    memset(hInfo, 0, sizeof(NeAACDecFrameInfo));
+    if (!adts_range_exact(hDecoder))
+        return -1;
+
+    /* the range continues exactly where the output of the frames before
+       it ends */
+    adts_prime(hDecoder, index, buffer, first);
+
+    for (i = first; i < first + count; i++)
+    {
+        void *out = NeAACDecDecode(hDecoder, hInfo, buffer + index->offset[i],
+            index->length[i]);
+        unsigned long bytes = hInfo->samples * stride;
+
+        /* a damaged frame leaves no output, as when it is skipped while
+           decoding the whole stream */
+        if ((out == NULL) || (hInfo->error != 0) || (bytes == 0))
+            continue;
+
+        if (bytes > sample_buffer_size - written)
+        {
+            hInfo->error = 27;
+            break;
+        }
+
+        memcpy(sample_buffer + written, out, bytes);
+        written += bytes;
+    }
+
+    return (long)(written / stride);
+}
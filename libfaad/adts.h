@@ -0,0 +1,69 @@
+/*
+** FAAD2 - Freeware Advanced Audio (AAC) Decoder including SBR decoding
+** Copyright (C) 2003-2005 M. Bakker, Nero AG, http://www.nero.com
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+**
+** Any non-GPL usage of this software or parts of this software is strictly
+** forbidden.
+**
+** The "appropriate copyright message" mentioned in section 2c of the GPLv2
+** must read: "Code from FAAD2 is copyright (c) Nero AG, www.nero.com"
+**
+** Commercial non-GPL licensing of this software is possible.
+** For more info contact Nero AG through Mpeg4AAClicense@nero.com.
+**
+** $Id$
+**/
+
+#ifndef __ADTS_H__
+#define __ADTS_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ADTS frame scanning shared by the streaming interface and the frame
+   indexer */
+
+/* fixed header plus the variable header, without CRC */
+#define ADTS_HEADER_SIZE 7
+/* bytes needed by adts_frame_length(), the old format header is 2 bits
+   longer */
+#define ADTS_PROBE_SIZE  (ADTS_HEADER_SIZE + 1)
+
+uint32_t adts_sync_c(const uint8_t *p, uint32_t n);
+uint32_t adts_frame_length(const uint8_t *p, uint8_t old_format);
+long adts_find_sync(const dsp_funcs *dsp, const uint8_t *buffer,
+                    unsigned long size, uint8_t old_format);
+NeAACDecADTSIndex *adts_build_index(const dsp_funcs *dsp, const uint8_t *buffer,
+                                    unsigned long size, uint8_t old_format);
+void adts_free_index(NeAACDecADTSIndex *index);
+unsigned long adts_save_index(const NeAACDecADTSIndex *index, uint8_t *buffer,
+                              unsigned long size);
+NeAACDecADTSIndex *adts_load_index(const uint8_t *buffer, unsigned long size);
+long adts_seek(NeAACDecStruct *hDecoder, const NeAACDecADTSIndex *index,
+               uint8_t *buffer, unsigned long size, unsigned long sample,
+               unsigned long *skip);
+long adts_decode_range(NeAACDecStruct *hDecoder, NeAACDecFrameInfo *hInfo,
+                       const NeAACDecADTSIndex *index, uint8_t *buffer,
+                       unsigned long size, unsigned long first,
+                       unsigned long count, uint8_t *sample_buffer,
+                       unsigned long sample_buffer_size);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -43,7 +43,7 @@
 #include <stdlib.h>
 
 #include "cfft.h"
-#include "cfft_tab.h"
+#include "tables.h"
 
 
 /* static function declarations */
@@ -60,7 +60,7 @@ static void passf4neg(const uint16_t ido, const uint16_t l1, const complex_t *cc
 static void passf5(const uint16_t ido, const uint16_t l1, const complex_t *cc, complex_t *ch,
                    const complex_t *wa1, const complex_t *wa2, const complex_t *wa3,
                    const complex_t *wa4, const int8_t isign);
-static void cffti1(uint16_t n, complex_t *wa, uint16_t *ifac);
+static void cffti1(uint16_t n, uint16_t *ifac);
 
 
 /*----------------------------------------------------------------------
@@ -858,15 +858,9 @@ void cfftb(cfft_info *cfft, complex_t *c)
     cfftf1pos(cfft->n, c, cfft->work, (const uint16_t*)cfft->ifac, (const complex_t*)cfft->tab, +1);
 }
 
-static void cffti1(uint16_t n, complex_t *wa, uint16_t *ifac)
+static void cffti1(uint16_t n, uint16_t *ifac)
 {
     static uint16_t ntryh[4] = {3, 4, 2, 5};
-#ifndef FIXED_POINT
-    real_t arg, argh, argld, fi;
-    uint16_t ido, ipm;
-    uint16_t i1, k1, l1, l2;
-    uint16_t ld, ii, ip;
-#endif
     uint16_t ntry = 0, i, j;
     uint16_t ib;
     uint16_t nf, nl, nq, nr;
@@ -908,51 +902,6 @@ startloop:
 
     ifac[0] = n;
     ifac[1] = nf;
-
-#ifndef FIXED_POINT
-    argh = (real_t)2.0*(real_t)M_PI / (real_t)n;
-    i = 0;
-    l1 = 1;
-
-    for (k1 = 1; k1 <= nf; k1++)
-    {
-        ip = ifac[k1+1];
-        ld = 0;
-        l2 = l1*ip;
-        ido = n / l2;
-        ipm = ip - 1;
-
-        for (j = 0; j < ipm; j++)
-        {
-            i1 = i;
-            RE(wa[i]) = 1.0;
-            IM(wa[i]) = 0.0;
-            ld += l1;
-            fi = 0;
-            argld = ld*argh;
-
-            for (ii = 0; ii < ido; ii++)
-            {
-                i++;
-                fi++;
-                arg = fi * argld;
-                RE(wa[i]) = (real_t)cos(arg);
-#if 1
-                IM(wa[i]) = (real_t)sin(arg);
-#else
-                IM(wa[i]) = (real_t)-sin(arg);
-#endif
-            }
-
-            if (ip > 5)
-            {
-                RE(wa[i1]) = RE(wa[i]);
-                IM(wa[i1]) = IM(wa[i]);
-            }
-        }
-        l1 = l2;
-    }
-#endif
 }
 
 cfft_info *cffti(uint16_t n)
@@ -962,31 +911,9 @@ cfft_info *cffti(uint16_t n)
     cfft->n = n;
     cfft->work = (complex_t*)faad_malloc(n*sizeof(complex_t));
 
-#ifndef FIXED_POINT
-    cfft->tab = (complex_t*)faad_malloc(n*sizeof(complex_t));
-
-    cffti1(n, cfft->tab, cfft->ifac);
-#else
-    cffti1(n, NULL, cfft->ifac);
-
-    switch (n)
-    {
-    case 64: cfft->tab = (complex_t*)cfft_tab_64; break;
-    case 512: cfft->tab = (complex_t*)cfft_tab_512; break;
-#ifdef LD_DEC
-    case 256: cfft->tab = (complex_t*)cfft_tab_256; break;
-#endif
-
-#ifdef ALLOW_SMALL_FRAMELENGTH
-    case 60: cfft->tab = (complex_t*)cfft_tab_60; break;
-    case 480: cfft->tab = (complex_t*)cfft_tab_480; break;
-#ifdef LD_DEC
-    case 240: cfft->tab = (complex_t*)cfft_tab_240; break;
-#endif
-#endif
-    case 128: cfft->tab = (complex_t*)cfft_tab_128; break;
-    }
-#endif
+    cffti1(n, cfft->ifac);
+    /* twiddle factors are shared by all instances */
+    cfft->tab = table_cfft(n, cfft->ifac);
 
     return cfft;
 }
@@ -994,10 +921,6 @@ cfft_info *cffti(uint16_t n)
 void cfftu(cfft_info *cfft)
 {
     if (cfft->work) faad_free(cfft->work);
-#ifndef FIXED_POINT
-    if (cfft->tab) faad_free(cfft->tab);
-#endif
 
     if (cfft) faad_free(cfft);
 }
-
@@ -40,7 +40,7 @@ typedef struct
     uint16_t n;
     uint16_t ifac[15];
     complex_t *work;
-    complex_t *tab;
+    const complex_t *tab;
 } cfft_info;
 
 
@@ -191,6 +191,86 @@ void faad_free(void *b)
 }
 #endif
 
+#define ONCE_NEW     0
+#define ONCE_RUNNING 1
+#define ONCE_DONE    2
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#pragma intrinsic(_InterlockedCompareExchange, _InterlockedExchange)
+
+/* the interlocked functions are full barriers on all targets */
+static long once_load(faad_once_t *once)
+{
+    return _InterlockedCompareExchange((volatile long*)once, ONCE_NEW, ONCE_NEW);
+}
+
+static uint8_t once_claim(faad_once_t *once)
+{
+    return _InterlockedCompareExchange((volatile long*)once,
+        ONCE_RUNNING, ONCE_NEW) == ONCE_NEW;
+}
+
+static void once_store(faad_once_t *once, long v)
+{
+    _InterlockedExchange((volatile long*)once, v);
+}
+#elif defined(__GNUC__)
+static long once_load(faad_once_t *once)
+{
+    return __atomic_load_n(once, __ATOMIC_ACQUIRE);
+}
+
+static uint8_t once_claim(faad_once_t *once)
+{
+    long expected = ONCE_NEW;
+
+    return __atomic_compare_exchange_n(once, &expected, ONCE_RUNNING, 0,
+        __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE);
+}
+
+static void once_store(faad_once_t *once, long v)
+{
+    __atomic_store_n(once, v, __ATOMIC_RELEASE);
+}
+#else
+static long once_load(faad_once_t *once)
+{
+    return *once;
+}
+
+static uint8_t once_claim(faad_once_t *once)
+{
+    *once = ONCE_RUNNING;
+    return 1;
+}
+
+static void once_store(faad_once_t *once, long v)
+{
+    *once = v;
+}
+#endif
+
+uint8_t faad_once_begin(faad_once_t *once)
+{
+    if (once_load(once) == ONCE_DONE)
+        return 0;
+
+    if (once_claim(once))
+        return 1;
+
+    /* another thread is filling the data, this takes microseconds */
+    while (once_load(once) != ONCE_DONE)
+        ;
+
+    return 0;
+}
+
+void faad_once_end(faad_once_t *once)
+{
+    once_store(once, ONCE_DONE);
+}
+
 static const  uint8_t    Parity [256] = {  // parity
     0,1,1,0,1,0,0,1,1,0,0,1,0,1,1,0,1,0,0,1,0,1,1,0,0,1,1,0,1,0,0,1,
     1,0,0,1,0,1,1,0,0,1,1,0,1,0,0,1,0,1,1,0,1,0,0,1,1,0,0,1,0,1,1,0,
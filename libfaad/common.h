@@ -67,6 +67,9 @@ extern "C" {
 /* use fixed point reals */
 //#define FIXED_POINT
 //#define BIG_IQ_TABLE
+/* compute the window, MDCT and inverse quantisation tables on first use
+   instead of storing them in the library, see tables.h */
+//#define RUNTIME_TABLES
 
 /* Use if target platform has address generators with autoincrement */
 //#define PREFER_POINTERS
@@ -130,11 +133,14 @@ extern "C" {
 #undef PS_DEC
 #endif
 
-/* FIXED POINT: No MAIN decoding */
+/* FIXED POINT: No MAIN decoding, tables are stored */
 #ifdef FIXED_POINT
 # ifdef MAIN_DEC
 #  undef MAIN_DEC
 # endif
+# ifdef RUNTIME_TABLES
+#  undef RUNTIME_TABLES
+# endif
 #endif // FIXED_POINT
 
 #ifdef DRM
@@ -410,7 +416,6 @@ typedef real_t complex_t[2];
 
 
 /* common functions */
-uint8_t cpu_has_sse(void);
 uint32_t ne_rng(uint32_t *__r1, uint32_t *__r2);
 uint32_t wl_min_lzc(uint32_t x);
 #ifdef FIXED_POINT
@@ -430,16 +435,25 @@ int8_t can_decode_ot(const uint8_t object_type);
 void *faad_malloc(size_t size);
 void faad_free(void *b);
 
-//#define PROFILE
-#ifdef PROFILE
-static int64_t faad_get_ts()
-{
-    __asm
-    {
-        rdtsc
-    }
-}
-#endif
+/* One time initialisation of data shared by all decoder instances, safe
+ * when decoders are opened on several threads:
+ *
+ *     static faad_once_t once = FAAD_ONCE_INIT;
+ *
+ *     if (faad_once_begin(&once))
+ *     {
+ *         ... fill the shared data ...
+ *         faad_once_end(&once);
+ *     }
+ *
+ * faad_once_begin() returns 1 to exactly one caller, other callers wait
+ * until that one has called faad_once_end(). Without compiler support for
+ * atomics (GCC, clang, MSVC) the first call must not race.
+ */
+typedef long faad_once_t;
+#define FAAD_ONCE_INIT 0
+uint8_t faad_once_begin(faad_once_t *once);
+void faad_once_end(faad_once_t *once);
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -41,10 +41,14 @@
 #include "output.h"
 #include "filtbank.h"
 #include "drc.h"
+#include "pns.h"
 #ifdef SBR_DEC
 #include "sbr_dec.h"
 #include "sbr_syntax.h"
 #endif
+#include "stream.h"
+#include "adts.h"
+#include "latm.h"
 #ifdef SSR_DEC
 #include "ssr.h"
 #endif
@@ -150,6 +154,7 @@ NeAACDecHandle NeAACDecOpen(void)
 
     hDecoder->__r1 = 1;
     hDecoder->__r2 = 1;
+    hDecoder->pns_mode = pns_default_mode();
 
     for (i = 0; i < MAX_CHANNELS; i++)
     {
@@ -179,6 +184,10 @@ NeAACDecHandle NeAACDecOpen(void)
 
     hDecoder->drc = drc_init(REAL_CONST(1.0), REAL_CONST(1.0));
 
+    hDecoder->dsp = dsp_select(FAAD_CPU_AUTO);
+
+    stats_init(&hDecoder->stats);
+
     return hDecoder;
 }
 
@@ -232,31 +241,137 @@ unsigned char NeAACDecSetConfiguration(NeAACDecHandle hpDecoder,
     return 0;
 }
 
+unsigned char NeAACDecSetCpuLevel(NeAACDecHandle hpDecoder, unsigned char level)
+{
+    NeAACDecStruct* hDecoder = (NeAACDecStruct*)hpDecoder;
+#ifdef SBR_DEC
+    uint8_t i;
+#endif
+
+    if (hDecoder == NULL)
+        return FAAD_CPU_SCALAR;
+
+    if (level > FAAD_CPU_AVX512 && level != FAAD_CPU_AUTO)
+        level = FAAD_CPU_AVX512;
+
+    hDecoder->dsp = dsp_select(level);
+
+    /* already initialised parts pick up the new kernels as well */
+    filter_bank_set_dsp(hDecoder->fb, hDecoder->dsp);
+#ifdef SBR_DEC
+    for (i = 0; i < MAX_SYNTAX_ELEMENTS; i++)
+    {
+        if (hDecoder->sbr[i] != NULL)
+            hDecoder->sbr[i]->dsp = hDecoder->dsp;
+    }
+#endif
+
+    return hDecoder->dsp->level;
+}
+
+unsigned char NeAACDecGetCpuLevel(NeAACDecHandle hpDecoder)
+{
+    NeAACDecStruct* hDecoder = (NeAACDecStruct*)hpDecoder;
+
+    if (hDecoder == NULL)
+        return dsp_default_level();
+
+    return hDecoder->dsp->level;
+}
+
+unsigned char NeAACDecSetPnsMode(NeAACDecHandle hpDecoder, unsigned char mode)
+{
+    NeAACDecStruct* hDecoder = (NeAACDecStruct*)hpDecoder;
+
+    if (hDecoder == NULL)
+        return FAAD_PNS_REFERENCE;
+
+#ifdef FIXED_POINT
+    mode = FAAD_PNS_REFERENCE;
+#else
+    if (mode != FAAD_PNS_FAST)
+        mode = FAAD_PNS_REFERENCE;
+#endif
+    hDecoder->pns_mode = mode;
+
+    return mode;
+}
+
+void NeAACDecEnableStats(NeAACDecHandle hpDecoder, unsigned char enable)
+{
+    NeAACDecStruct* hDecoder = (NeAACDecStruct*)hpDecoder;
+
+    if (hDecoder)
+        hDecoder->stats.enabled = (enable != 0);
+}
 
-static int latmCheck(latm_header *latm, bitfile *ld)
+unsigned char NeAACDecGetStats(NeAACDecHandle hpDecoder, NeAACDecStats *stats)
 {
-    uint32_t good=0, bad=0, bits, m;
+    NeAACDecStruct* hDecoder = (NeAACDecStruct*)hpDecoder;
+
+    if ((hDecoder == NULL) || (stats == NULL))
+        return 0;
+
+    *stats = hDecoder->stats.s;
 
-    while (ld->bytes_left)
+    return hDecoder->stats.enabled;
+}
+
+void NeAACDecResetStats(NeAACDecHandle hpDecoder)
+{
+    NeAACDecStruct* hDecoder = (NeAACDecStruct*)hpDecoder;
+
+    if (hDecoder)
+        memset(&hDecoder->stats.s, 0, sizeof(NeAACDecStats));
+}
+
+
+/* sets the decoder up for the first stream of a LOAS stream, returns the
+   bytes in front of the first frame with a StreamMuxConfig or -1 */
+static long latm_init_decoder(NeAACDecStruct *hDecoder, unsigned char *buffer,
+                              unsigned long buffer_size,
+                              unsigned long *samplerate, unsigned char *channels)
+{
+    latm_mux *mux;
+    latm_stream *s;
+    unsigned long pos = 0;
+    uint32_t frame_size;
+
+    latm_end(hDecoder->latm);
+    if ((hDecoder->latm = mux = latm_init()) == NULL)
+        return -1;
+
+    while (latm_frame(mux, buffer + pos, (uint32_t)(buffer_size - pos), &frame_size) > 0)
     {
-        bits = faad_latm_frame(latm, ld);
-        if(bits==0xFFFFFFFF)
-            bad++;
-        else
-        {
-            good++;
-            while(bits>0)
-            {
-                m = min(bits, 8);
-                faad_getbits(ld, m);
-                bits -= m;
-            }
-        }
+        pos += frame_size;
+        if (frame_size == 0 || pos >= buffer_size)
+            break;
+    }
+
+    s = &mux->stream[0];
+    hDecoder->latm_header_present = 1;
+    if (!mux->inited || pos >= buffer_size ||
+        NeAACDecInit2(hDecoder, s->asc, bit2byte(s->asc_bits), samplerate, channels) < 0)
+    {
+        latm_end(mux);
+        hDecoder->latm = NULL;
+        hDecoder->latm_header_present = 0;
+        return -1;
     }
+    hDecoder->latm_asc_version = s->asc_version;
 
-    return (good>0);
+    /* decoding starts with this frame again, the config is kept */
+    latm_reset(mux);
+
+    return (long)pos;
 }
 
+/* picks the specialised reconstruction for the configuration just set up */
+static void select_decode_path(NeAACDecStruct *hDecoder)
+{
+    hDecoder->lc_fast = (hDecoder->object_type == LC) &&
+        (hDecoder->frameLength == 1024);
+}
 
 long NeAACDecInit(NeAACDecHandle hpDecoder,
                               unsigned char *buffer,
@@ -281,29 +396,12 @@ long NeAACDecInit(NeAACDecHandle hpDecoder,
 
     if (buffer != NULL)
     {
-#if 0
-        int is_latm;
-        latm_header *l = &hDecoder->latm_config;
-#endif
+        /* Check if a LOAS syncword is present */
+        if ((buffer_size >= LOAS_HEADER_SIZE) && loas_frame_length(buffer))
+            return latm_init_decoder(hDecoder, buffer, buffer_size, samplerate, channels);
 
         faad_initbits(&ld, buffer, buffer_size);
 
-#if 0
-        memset(l, 0, sizeof(latm_header));
-        is_latm = latmCheck(l, &ld);
-        l->inited = 0;
-        l->frameLength = 0;
-        faad_rewindbits(&ld);
-        if(is_latm && l->ASCbits>0)
-        {
-            int32_t x;
-            hDecoder->latm_header_present = 1;
-            x = NeAACDecInit2(hDecoder, l->ASC, (l->ASCbits+7)/8, samplerate, channels);
-            if(x!=0)
-                hDecoder->latm_header_present = 0;
-            return x;
-        } else
-#endif
         /* Check if an ADIF header is present */
         if ((buffer[0] == 'A') && (buffer[1] == 'D') &&
             (buffer[2] == 'I') && (buffer[3] == 'F'))
@@ -379,6 +477,7 @@ long NeAACDecInit(NeAACDecHandle hpDecoder,
     else
 #endif
         hDecoder->fb = filter_bank_init(hDecoder->frameLength);
+    filter_bank_set_dsp(hDecoder->fb, hDecoder->dsp);
 
 #ifdef LD_DEC
     if (hDecoder->object_type == LD)
@@ -388,6 +487,8 @@ long NeAACDecInit(NeAACDecHandle hpDecoder,
     if (can_decode_ot(hDecoder->object_type) < 0)
         return -1;
 
+    select_decode_path(hDecoder);
+
     return bits;
 }
 
@@ -476,12 +577,15 @@ char NeAACDecInit2(NeAACDecHandle hpDecoder,
     else
 #endif
         hDecoder->fb = filter_bank_init(hDecoder->frameLength);
+    filter_bank_set_dsp(hDecoder->fb, hDecoder->dsp);
 
 #ifdef LD_DEC
     if (hDecoder->object_type == LD)
         hDecoder->frameLength >>= 1;
 #endif
 
+    select_decode_path(hDecoder);
+
     return 0;
 }
 
@@ -524,6 +628,7 @@ char NeAACDecInitDRM(NeAACDecHandle *hpDecoder,
 #endif
 
     (*hDecoder)->fb = filter_bank_init((*hDecoder)->frameLength);
+    filter_bank_set_dsp((*hDecoder)->fb, (*hDecoder)->dsp);
 
     return 0;
 }
@@ -537,14 +642,6 @@ void NeAACDecClose(NeAACDecHandle hpDecoder)
     if (hDecoder == NULL)
         return;
 
-#ifdef PROFILE
-    printf("AAC decoder total:  %I64d cycles\n", hDecoder->cycles);
-    printf("requant:            %I64d cycles\n", hDecoder->requant_cycles);
-    printf("spectral_data:      %I64d cycles\n", hDecoder->spectral_cycles);
-    printf("scalefactors:       %I64d cycles\n", hDecoder->scalefac_cycles);
-    printf("output:             %I64d cycles\n", hDecoder->output_cycles);
-#endif
-
     for (i = 0; i < MAX_CHANNELS; i++)
     {
         if (hDecoder->time_out[i]) faad_free(hDecoder->time_out[i]);
@@ -580,6 +677,9 @@ void NeAACDecClose(NeAACDecHandle hpDecoder)
     }
 #endif
 
+    stream_end(hDecoder->stream);
+    latm_end(hDecoder->latm);
+
     if (hDecoder) faad_free(hDecoder);
 }
 
@@ -592,6 +692,11 @@ void NeAACDecPostSeekReset(NeAACDecHandle hpDecoder, long frame)
 
         if (frame != -1)
             hDecoder->frame = frame;
+
+        if (hDecoder->stream)
+            stream_reset(hDecoder->stream);
+        if (hDecoder->latm)
+            latm_reset(hDecoder->latm);
     }
 }
 
@@ -819,7 +924,19 @@ void* NeAACDecDecode(NeAACDecHandle hpDecoder,
                                  unsigned long buffer_size)
 {
     NeAACDecStruct* hDecoder = (NeAACDecStruct*)hpDecoder;
-    return aac_frame_decode(hDecoder, hInfo, buffer, buffer_size, NULL, 0);
+    void *sample_buffer;
+    int64_t t0;
+
+    if ((hDecoder == NULL) || (hInfo == NULL))
+        return NULL;
+
+    t0 = stats_frame_begin(&hDecoder->stats);
+
+    sample_buffer = aac_frame_decode(hDecoder, hInfo, buffer, buffer_size, NULL, 0);
+
+    stats_frame_end(&hDecoder->stats, t0, hInfo->bytesconsumed, hInfo->error);
+
+    return sample_buffer;
 }
 
 void* NeAACDecDecode2(NeAACDecHandle hpDecoder,
@@ -830,14 +947,252 @@ void* NeAACDecDecode2(NeAACDecHandle hpDecoder,
                                   unsigned long sample_buffer_size)
 {
     NeAACDecStruct* hDecoder = (NeAACDecStruct*)hpDecoder;
+    void *out;
+    int64_t t0;
+
     if ((sample_buffer == NULL) || (sample_buffer_size == 0))
     {
         hInfo->error = 27;
         return NULL;
     }
 
-    return aac_frame_decode(hDecoder, hInfo, buffer, buffer_size,
+    if ((hDecoder == NULL) || (hInfo == NULL))
+        return NULL;
+
+    t0 = stats_frame_begin(&hDecoder->stats);
+
+    out = aac_frame_decode(hDecoder, hInfo, buffer, buffer_size,
         sample_buffer, sample_buffer_size);
+
+    stats_frame_end(&hDecoder->stats, t0, hInfo->bytesconsumed, hInfo->error);
+
+    return out;
+}
+
+unsigned long NeAACDecFeed(NeAACDecHandle hpDecoder,
+                           unsigned char *buffer,
+                           unsigned long buffer_size)
+{
+    NeAACDecStruct* hDecoder = (NeAACDecStruct*)hpDecoder;
+
+    if (hDecoder == NULL)
+        return 0;
+
+    if (hDecoder->stream == NULL)
+    {
+        if ((hDecoder->stream = stream_init()) == NULL)
+            return 0;
+    }
+
+    if (buffer == NULL)
+    {
+        hDecoder->stream->eof = 1;
+        return 0;
+    }
+    hDecoder->stream->eof = 0;
+
+    return stream_feed(hDecoder->stream, buffer,
+        (uint32_t)min(buffer_size, STREAM_BUFFER_SIZE));
+}
+
+void* NeAACDecPull(NeAACDecHandle hpDecoder,
+                   NeAACDecFrameInfo *hInfo)
+{
+    NeAACDecStruct* hDecoder = (NeAACDecStruct*)hpDecoder;
+
+    if ((hDecoder == NULL) || (hInfo == NULL))
+        return NULL;
+
+    return stream_pull(hDecoder, hInfo, NULL, 0);
+}
+
+void* NeAACDecPull2(NeAACDecHandle hpDecoder,
+                    NeAACDecFrameInfo *hInfo,
+                    void **sample_buffer,
+                    unsigned long sample_buffer_size)
+{
+    NeAACDecStruct* hDecoder = (NeAACDecStruct*)hpDecoder;
+
+    if ((hDecoder == NULL) || (hInfo == NULL))
+        return NULL;
+
+    if ((sample_buffer == NULL) || (sample_buffer_size == 0))
+    {
+        hInfo->error = 27;
+        return NULL;
+    }
+
+    return stream_pull(hDecoder, hInfo, sample_buffer, sample_buffer_size);
+}
+
+long NeAACDecFindADTSSync(const unsigned char *buffer,
+                          unsigned long buffer_size,
+                          unsigned char old_format)
+{
+    if (buffer == NULL)
+        return -1;
+
+    return adts_find_sync(dsp_select(FAAD_CPU_AUTO), buffer, buffer_size,
+        old_format);
+}
+
+NeAACDecADTSIndex* NeAACDecIndexADTS(const unsigned char *buffer,
+                                    unsigned long buffer_size,
+                                    unsigned char old_format)
+{
+    if (buffer == NULL)
+        return NULL;
+
+    return adts_build_index(dsp_select(FAAD_CPU_AUTO), buffer, buffer_size,
+        old_format);
+}
+
+void NeAACDecFreeADTSIndex(NeAACDecADTSIndex *index)
+{
+    adts_free_index(index);
+}
+
+unsigned long NeAACDecSaveADTSIndex(const NeAACDecADTSIndex *index,
+                                    unsigned char *buffer,
+                                    unsigned long buffer_size)
+{
+    if (index == NULL)
+        return 0;
+
+    return adts_save_index(index, buffer, buffer_size);
+}
+
+NeAACDecADTSIndex* NeAACDecLoadADTSIndex(const unsigned char *buffer,
+                                        unsigned long buffer_size)
+{
+    if (buffer == NULL)
+        return NULL;
+
+    return adts_load_index(buffer, buffer_size);
+}
+
+long NeAACDecSeekADTS(NeAACDecHandle hpDecoder,
+                      const NeAACDecADTSIndex *index,
+                      unsigned char *buffer,
+                      unsigned long buffer_size,
+                      unsigned long sample,
+                      unsigned long *skip)
+{
+    NeAACDecStruct* hDecoder = (NeAACDecStruct*)hpDecoder;
+
+    if ((hDecoder == NULL) || (index == NULL) || (buffer == NULL) ||
+        (skip == NULL) || (hDecoder->fb == NULL))
+        return -1;
+
+    return adts_seek(hDecoder, index, buffer, buffer_size, sample, skip);
+}
+
+long NeAACDecDecodeRange(NeAACDecHandle hpDecoder,
+                         NeAACDecFrameInfo *hInfo,
+                         const NeAACDecADTSIndex *index,
+                         unsigned char *buffer,
+                         unsigned long buffer_size,
+                         unsigned long first,
+                         unsigned long count,
+                         void *sample_buffer,
+                         unsigned long sample_buffer_size)
+{
+    NeAACDecStruct* hDecoder = (NeAACDecStruct*)hpDecoder;
+
+    if ((hDecoder == NULL) || (hInfo == NULL) || (index == NULL) ||
+        (buffer == NULL) || (sample_buffer == NULL) || (hDecoder->fb == NULL))
+        return -1;
+
+    return adts_decode_range(hDecoder, hInfo, index, buffer, buffer_size,
+        first, count, (uint8_t*)sample_buffer, sample_buffer_size);
+}
+
+long NeAACDecFindLOASSync(const unsigned char *buffer,
+                          unsigned long buffer_size)
+{
+    if (buffer == NULL)
+        return -1;
+
+    return loas_find_sync(buffer, buffer_size);
+}
+
+NeAACDecLATMHandle NeAACDecLATMOpen(NeAACDecConfigurationPtr config)
+{
+    return (NeAACDecLATMHandle)latm_demux_init(config);
+}
+
+void NeAACDecLATMClose(NeAACDecLATMHandle hLatm)
+{
+    latm_demux_end((latm_demux*)hLatm);
+}
+
+long NeAACDecLATMDemux(NeAACDecLATMHandle hLatm,
+                       unsigned char *buffer,
+                       unsigned long buffer_size,
+                       unsigned char *error)
+{
+    uint8_t err;
+    long ret;
+
+    if ((hLatm == NULL) || (buffer == NULL))
+        return 0;
+
+    ret = latm_demux_frame((latm_demux*)hLatm, buffer, buffer_size, &err);
+    if (error)
+        *error = err;
+
+    return ret;
+}
+
+unsigned char NeAACDecLATMStreams(NeAACDecLATMHandle hLatm)
+{
+    if (hLatm == NULL)
+        return 0;
+
+    return latm_demux_streams((latm_demux*)hLatm);
+}
+
+char NeAACDecLATMStreamInfo(NeAACDecLATMHandle hLatm,
+                            unsigned char stream,
+                            unsigned char *program,
+                            unsigned char *layer,
+                            mp4AudioSpecificConfig *mp4ASC)
+{
+    if (hLatm == NULL)
+        return -1;
+
+    return latm_demux_stream_info((latm_demux*)hLatm, stream, program, layer,
+        mp4ASC);
+}
+
+void* NeAACDecLATMDecode(NeAACDecLATMHandle hLatm,
+                         unsigned char stream,
+                         NeAACDecFrameInfo *hInfo)
+{
+    if ((hLatm == NULL) || (hInfo == NULL))
+        return NULL;
+
+    return latm_demux_decode((latm_demux*)hLatm, stream, hInfo, NULL, 0);
+}
+
+void* NeAACDecLATMDecode2(NeAACDecLATMHandle hLatm,
+                          unsigned char stream,
+                          NeAACDecFrameInfo *hInfo,
+                          void **sample_buffer,
+                          unsigned long sample_buffer_size)
+{
+    if ((hLatm == NULL) || (hInfo == NULL))
+        return NULL;
+
+    if ((sample_buffer == NULL) || (sample_buffer_size == 0))
+    {
+        memset(hInfo, 0, sizeof(NeAACDecFrameInfo));
+        hInfo->error = 27;
+        return NULL;
+    }
+
+    return latm_demux_decode((latm_demux*)hLatm, stream, hInfo, sample_buffer,
+        sample_buffer_size);
 }
 
 #ifdef DRM
@@ -865,11 +1220,7 @@ static void* aac_frame_decode(NeAACDecStruct *hDecoder,
     uint32_t bitsconsumed;
     uint16_t frame_len;
     void *sample_buffer;
-    uint32_t startbit=0, endbit=0, payload_bits=0;
-
-#ifdef PROFILE
-    int64_t count = faad_get_ts();
-#endif
+    stats_mark mark;
 
     /* safety checks */
     if ((hDecoder == NULL) || (hInfo == NULL) || (buffer == NULL))
@@ -914,8 +1265,42 @@ static void* aac_frame_decode(NeAACDecStruct *hDecoder,
     }
 
 
-    /* initialize the bitstream */
-    faad_initbits(&ld, buffer, buffer_size);
+    if (hDecoder->latm != NULL)
+    {
+        latm_mux *mux = hDecoder->latm;
+        const uint8_t *au;
+        uint32_t au_size;
+
+        /* a LOAS frame can carry several access units of the stream, it is
+           only consumed with the last one */
+        if (!latm_au_pending(mux, 0))
+        {
+            hInfo->error = latm_frame(mux, buffer, buffer_size, &hDecoder->latm_frame_size);
+            if (hInfo->error == 0 && mux->stream[0].asc_version != hDecoder->latm_asc_version)
+            {
+                latm_reset(mux);
+                hInfo->error = 37;
+            }
+            if (hInfo->error > 0)
+            {
+                hInfo->bytesconsumed = hDecoder->latm_frame_size;
+                goto error;
+            }
+        }
+        if (!latm_next_au(mux, 0, &au, &au_size))
+        {
+            /* no complete access unit in this frame */
+            hInfo->bytesconsumed = hDecoder->latm_frame_size;
+            return NULL;
+        }
+        if (!latm_au_pending(mux, 0))
+            hInfo->bytesconsumed = hDecoder->latm_frame_size;
+
+        faad_initbits(&ld, au, au_size);
+    } else {
+        /* initialize the bitstream */
+        faad_initbits(&ld, buffer, buffer_size);
+    }
 
 #if 0
     {
@@ -935,19 +1320,6 @@ static void* aac_frame_decode(NeAACDecStruct *hDecoder,
     }
 #endif
 
-#if 0
-    if(hDecoder->latm_header_present)
-    {
-        payload_bits = faad_latm_frame(&hDecoder->latm_config, &ld);
-        startbit = faad_get_processed_bits(&ld);
-        if(payload_bits == -1U)
-        {
-            hInfo->error = 1;
-            goto error;
-        }
-    }
-#endif
-
 #ifdef DRM
     if (hDecoder->object_type == DRM_ER_LC)
     {
@@ -963,13 +1335,18 @@ static void* aac_frame_decode(NeAACDecStruct *hDecoder,
     }
 #endif
 
+    stats_begin(&hDecoder->stats, &mark);
+
     if (hDecoder->adts_header_present)
     {
         adts_header adts;
 
         adts.old_format = hDecoder->config.useOldADTSFormat;
         if ((hInfo->error = adts_frame(&adts, &ld)) > 0)
+        {
+            stats_end(&hDecoder->stats, &mark, FAAD_STAGE_PARSE);
             goto error;
+        }
 
         /* MPEG2 does byte_alignment() here,
          * but ADTS header is always multiple of 8 bits in MPEG2
@@ -993,18 +1370,7 @@ static void* aac_frame_decode(NeAACDecStruct *hDecoder,
     }
 #endif
 
-#if 0
-    if(hDecoder->latm_header_present)
-    {
-        endbit = faad_get_processed_bits(&ld);
-        if(endbit-startbit > payload_bits)
-            fprintf(stderr, "\r\nERROR, too many payload bits read: %u > %d. Please. report with a link to a sample\n",
-                endbit-startbit, payload_bits);
-        if(hDecoder->latm_config.otherDataLenBits > 0)
-            faad_getbits(&ld, hDecoder->latm_config.otherDataLenBits);
-        faad_byte_align(&ld);
-    }
-#endif
+    stats_end(&hDecoder->stats, &mark, FAAD_STAGE_PARSE);
 
     channels = hDecoder->fr_channels;
 
@@ -1021,7 +1387,8 @@ static void* aac_frame_decode(NeAACDecStruct *hDecoder,
 
     /* no more bit reading after this */
     bitsconsumed = faad_get_processed_bits(&ld);
-    hInfo->bytesconsumed = bit2byte(bitsconsumed);
+    if (hDecoder->latm == NULL)
+        hInfo->bytesconsumed = bit2byte(bitsconsumed);
     if (ld.error)
     {
         hInfo->error = 14;
@@ -1083,10 +1450,8 @@ static void* aac_frame_decode(NeAACDecStruct *hDecoder,
         hInfo->header_type = ADIF;
     if (hDecoder->adts_header_present)
         hInfo->header_type = ADTS;
-#if 0
     if (hDecoder->latm_header_present)
         hInfo->header_type = LATM;
-#endif
 #if (defined(PS_DEC) || defined(DRM_PS))
     hInfo->ps = hDecoder->ps_used_global;
 #endif
@@ -1205,11 +1570,6 @@ static void* aac_frame_decode(NeAACDecStruct *hDecoder,
     fflush(stdout);
 #endif
 
-#ifdef PROFILE
-    count = faad_get_ts() - count;
-    hDecoder->cycles += count;
-#endif
-
     return sample_buffer;
 
 error:
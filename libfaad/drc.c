@@ -110,13 +110,46 @@ static real_t drc_pow2_table[] =
 };
 #endif
 
+#ifndef FIXED_POINT
+/* DRC gain factor for one band. The factor only depends on the sign and
+   control value of the band and on prog_ref_level (ctrl1 and ctrl2 are
+   fixed at init), so it is computed once and looked up afterwards.
+ */
+static real_t drc_gain(drc_info *drc, uint8_t sgn, uint8_t ctl)
+{
+    real_t exp;
+
+    sgn = (sgn != 0);
+    ctl &= 0x7F;
+
+    if (drc->gain_ref_level != drc->prog_ref_level)
+    {
+        memset(drc->gain_ready, 0, sizeof(drc->gain_ready));
+        drc->gain_ref_level = drc->prog_ref_level;
+    }
+
+    if (drc->gain_ready[sgn][ctl >> 5] & (1u << (ctl & 31)))
+        return drc->gain[sgn][ctl];
+
+    if (sgn)  /* compress */
+        exp = ((-drc->ctrl1 * ctl) - (DRC_REF_LEVEL - drc->prog_ref_level))/REAL_CONST(24.0);
+    else /* boost */
+        exp = ((drc->ctrl2 * ctl) - (DRC_REF_LEVEL - drc->prog_ref_level))/REAL_CONST(24.0);
+
+    drc->gain[sgn][ctl] = (real_t)pow(2.0, exp);
+    drc->gain_ready[sgn][ctl >> 5] |= (1u << (ctl & 31));
+
+    return drc->gain[sgn][ctl];
+}
+#endif
+
 void drc_decode(drc_info *drc, real_t *spec)
 {
     uint16_t i, bd, top;
 #ifdef FIXED_POINT
     int32_t exp, frac;
 #else
-    real_t factor, exp;
+    real_t factor;
 #endif
     uint16_t bottom = 0;
 
@@ -128,16 +161,15 @@ void drc_decode(drc_info *drc, real_t *spec)
         top = 4 * (drc->band_top[bd] + 1);
 
 #ifndef FIXED_POINT
-        /* Decode DRC gain factor */
-        if (drc->dyn_rng_sgn[bd])  /* compress */
-            exp = ((-drc->ctrl1 * drc->dyn_rng_ctl[bd]) - (DRC_REF_LEVEL - drc->prog_ref_level))/REAL_CONST(24.0);
-        else /* boost */
-            exp = ((drc->ctrl2 * drc->dyn_rng_ctl[bd]) - (DRC_REF_LEVEL - drc->prog_ref_level))/REAL_CONST(24.0);
-        factor = (real_t)pow(2.0, exp);
+        /* Look up DRC gain factor */
+        factor = drc_gain(drc, drc->dyn_rng_sgn[bd], drc->dyn_rng_ctl[bd]);
 
-        /* Apply gain factor */
-        for (i = bottom; i < top; i++)
-            spec[i] *= factor;
+        /* Apply gain factor, unity gain leaves the band untouched */
+        if (factor != REAL_CONST(1.0))
+        {
+            for (i = bottom; i < top; i++)
+                spec[i] *= factor;
+        }
 #else
         /* Decode DRC gain factor */
         if (drc->dyn_rng_sgn[bd])  /* compress */
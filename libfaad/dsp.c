@@ -0,0 +1,162 @@
+/*
+** FAAD2 - Freeware Advanced Audio (AAC) Decoder including SBR decoding
+** Copyright (C) 2003-2005 M. Bakker, Nero AG, http://www.nero.com
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+**
+** Any non-GPL usage of this software or parts of this software is strictly
+** forbidden.
+**
+** The "appropriate copyright message" mentioned in section 2c of the GPLv2
+** must read: "Code from FAAD2 is copyright (c) Nero AG, www.nero.com"
+**
+** Commercial non-GPL licensing of this software is possible.
+** For more info contact Nero AG through Mpeg4AAClicense@nero.com.
+**
+** $Id$
+**/
+
+/* runtime selection of the DSP kernels, see dsp.h */
+
+#include "common.h"
+#include "structs.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "dsp.h"
+#include "adts.h"
+#include "mdct.h"
+#include "output.h"
+#include "specrec.h"
+#include "tns.h"
+#include "pns.h"
+#ifdef MAIN_DEC
+#include "ic_predict.h"
+#endif
+#ifdef SBR_DEC
+#include "sbr_qmf.h"
+#endif
+
+
+static dsp_funcs dsp_tables[FAAD_CPU_AVX512 + 1];
+static faad_once_t dsp_once = FAAD_ONCE_INIT;
+static uint8_t dsp_hw_level;
+static uint8_t dsp_auto_level;
+
+static void dsp_init_c(dsp_funcs *dsp)
+{
+    memset(dsp, 0, sizeof(dsp_funcs));
+
+    dsp->imdct_pre = imdct_pre_c;
+    dsp->imdct_post = imdct_post_c;
+#ifdef SBR_DEC
+    dsp->qmfa_window = qmfa_window_c;
+    dsp->qmfs_window = qmfs_window_c;
+#endif
+    dsp->adts_sync = adts_sync_c;
+#ifndef FIXED_POINT
+    dsp->requant = requant_c;
+    dsp->tns_ar_lanes = tns_ar_lanes_c;
+    dsp->pns_noise = pns_noise_c;
+#ifdef MAIN_DEC
+    dsp->ic_predict = ic_predict_c;
+#endif
+    dsp->pcm16_mono = pcm16_mono_c;
+    dsp->pcm16_stereo = pcm16_stereo_c;
+#endif
+}
+
+/* parses FAAD_CPU_LEVEL, returns FAAD_CPU_AUTO when it is not set */
+static uint8_t dsp_env_level(void)
+{
+#ifndef _WIN32_WCE
+    static const char *names[FAAD_CPU_AVX512 + 1] =
+    {
+        "scalar", "sse2", "ssse3", "avx2", "avx512"
+    };
+    const char *env = getenv("FAAD_CPU_LEVEL");
+    uint8_t i;
+
+    if (env == NULL || *env == '\0')
+        return FAAD_CPU_AUTO;
+
+    if (env[0] >= '0' && env[0] <= '0' + FAAD_CPU_AVX512 && env[1] == '\0')
+        return (uint8_t)(env[0] - '0');
+
+    for (i = 0; i <= FAAD_CPU_AVX512; i++)
+    {
+        if (strcmp(env, names[i]) == 0)
+            return i;
+    }
+#endif
+
+    return FAAD_CPU_AUTO;
+}
+
+/* detects the CPU and fills the kernel tables, once for all decoders */
+static void dsp_init(void)
+{
+    if (faad_once_begin(&dsp_once))
+    {
+        uint8_t i;
+        uint8_t forced;
+
+        for (i = 0; i <= FAAD_CPU_AVX512; i++)
+        {
+            dsp_init_c(&dsp_tables[i]);
+            dsp_init_x86(&dsp_tables[i], i);
+            dsp_tables[i].level = i;
+        }
+
+        dsp_hw_level = dsp_detect_x86();
+
+        /* FAAD_CPU_LEVEL may lower the level of new decoder instances */
+        forced = dsp_env_level();
+        dsp_auto_level = (forced < dsp_hw_level) ? forced : dsp_hw_level;
+
+        faad_once_end(&dsp_once);
+    }
+}
+
+/* highest level supported by this CPU */
+uint8_t dsp_detect_level(void)
+{
+    dsp_init();
+
+    return dsp_hw_level;
+}
+
+/* level used by new decoder instances, FAAD_CPU_LEVEL may lower it */
+uint8_t dsp_default_level(void)
+{
+    dsp_init();
+
+    return dsp_auto_level;
+}
+
+/* Returns the kernel table for the requested level. The level is clipped
+ * to what this CPU supports, FAAD_CPU_AUTO selects the default level. */
+const dsp_funcs *dsp_select(uint8_t level)
+{
+    dsp_init();
+
+    if (level == FAAD_CPU_AUTO)
+        level = dsp_auto_level;
+    else if (level > dsp_hw_level)
+        level = dsp_hw_level;
+
+    return &dsp_tables[level];
+}
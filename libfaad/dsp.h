@@ -0,0 +1,109 @@
+/*
+** FAAD2 - Freeware Advanced Audio (AAC) Decoder including SBR decoding
+** Copyright (C) 2003-2005 M. Bakker, Nero AG, http://www.nero.com
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+**
+** Any non-GPL usage of this software or parts of this software is strictly
+** forbidden.
+**
+** The "appropriate copyright message" mentioned in section 2c of the GPLv2
+** must read: "Code from FAAD2 is copyright (c) Nero AG, www.nero.com"
+**
+** Commercial non-GPL licensing of this software is possible.
+** For more info contact Nero AG through Mpeg4AAClicense@nero.com.
+**
+** $Id$
+**/
+
+#ifndef __DSP_H__
+#define __DSP_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Runtime selected DSP kernels.
+ *
+ * Every decoder instance holds a pointer to one of these tables. The table
+ * is chosen in NeAACDecOpen() from the CPU features reported by CPUID, can
+ * be forced with the FAAD_CPU_LEVEL environment variable (scalar, sse2,
+ * ssse3, avx2, avx512) or through NeAACDecSetCpuLevel().
+ *
+ * All variants produce bit identical output: they perform the same floating
+ * point operations in the same order as the scalar reference code, only
+ * several samples at a time.
+ */
+
+struct pred_state;
+
+typedef struct
+{
+    uint8_t level;
+
+    /* faad_imdct(): pre- and post-IFFT complex multiplication */
+    void (*imdct_pre)(const real_t *X_in, const complex_t *sincos,
+                      complex_t *Z1, uint16_t N2, uint16_t N4);
+    void (*imdct_post)(complex_t *Z1, const complex_t *sincos, uint16_t N4);
+
+    /* SBR QMF windowing, 64 output samples per call */
+    void (*qmfa_window)(const real_t *x, const real_t *c, real_t *u);
+    void (*qmfs_window)(const real_t *v, const real_t *c, real_t *out);
+
+    /* position of the first possible ADTS syncword in n bytes, n if none */
+    uint32_t (*adts_sync)(const uint8_t *p, uint32_t n);
+
+#ifndef FIXED_POINT
+    /* inverse quantisation and scaling of one scalefactor window band,
+       returns error 17 on out of range values */
+    uint8_t (*requant)(const int16_t *q, real_t *spec, uint16_t width,
+                       real_t scf, const real_t *tab);
+
+    /* TNS all-pole filters of the same order in TNS_LANES lanes, lanes
+       with size 0 are unused, see tns_ar_lanes_c() */
+    void (*tns_ar_lanes)(real_t **spec, const uint16_t *size, const int8_t *inc,
+                         const real_t *lpc, uint8_t order);
+
+    /* FAAD_PNS_FAST noise of one band, returns its energy, see
+       pns_noise_c() */
+    real_t (*pns_noise)(real_t *spec, uint16_t size, uint32_t seed,
+                        uint32_t counter);
+
+#ifdef MAIN_DEC
+    /* Main profile backward adaptive predictors of the bins low..high-1,
+       pred set when the prediction is added to spec */
+    void (*ic_predict)(struct pred_state *state, real_t *spec,
+                       uint16_t low, uint16_t high, uint8_t pred);
+#endif
+
+    /* 16 bit PCM output */
+    void (*pcm16_mono)(const real_t *in, int16_t *out, uint16_t n);
+    void (*pcm16_stereo)(const real_t *in0, const real_t *in1,
+                         int16_t *out, uint16_t n);
+#endif
+} dsp_funcs;
+
+uint8_t dsp_detect_level(void);
+uint8_t dsp_default_level(void);
+const dsp_funcs *dsp_select(uint8_t level);
+
+/* dsp_x86.c */
+uint8_t dsp_detect_x86(void);
+void dsp_init_x86(dsp_funcs *dsp, uint8_t level);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,1385 @@
+/*
+** FAAD2 - Freeware Advanced Audio (AAC) Decoder including SBR decoding
+** Copyright (C) 2003-2005 M. Bakker, Nero AG, http://www.nero.com
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+**
+** Any non-GPL usage of this software or parts of this software is strictly
+** forbidden.
+**
+** The "appropriate copyright message" mentioned in section 2c of the GPLv2
+** must read: "Code from FAAD2 is copyright (c) Nero AG, www.nero.com"
+**
+** Commercial non-GPL licensing of this software is possible.
+** For more info contact Nero AG through Mpeg4AAClicense@nero.com.
+**
+** $Id$
+**/
+
+/* x86 SIMD versions of the kernels in dsp.h
+ *
+ * Each function is compiled for its instruction set with a target
+ * attribute, so a plain build still runs on any x86 CPU; dsp_select()
+ * only hands out variants that dsp_detect_x86() found to be supported.
+ * No fused multiply-add is used, the results are identical to the C
+ * reference kernels.
+ */
+
+#include "common.h"
+#include "structs.h"
+
+#include "dsp.h"
+#include "adts.h"
+#include "mdct.h"
+#include "output.h"
+#include "specrec.h"
+#include "tns.h"
+#include "pns.h"
+#ifdef MAIN_DEC
+#include "ic_predict.h"
+#endif
+#ifdef SBR_DEC
+#include "sbr_qmf.h"
+#endif
+
+#if !defined(FIXED_POINT) && \
+    (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)) && \
+    (defined(__GNUC__) || defined(_MSC_VER))
+#define DSP_X86
+#endif
+
+#ifdef DSP_X86
+
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+#if defined(__GNUC__)
+#define DSP_TARGET(isa) __attribute__((target(isa)))
+#else
+#define DSP_TARGET(isa)
+#endif
+
+/* IQ_TABLE_SIZE of iq_table.h */
+#define DSP_IQ_TABLE_SIZE 8192
+
+/* keep mul+add pairs separate, AVX-512 implies FMA */
+#if defined(__clang__)
+#pragma clang fp contract(off)
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+static void dsp_cpuid(uint32_t leaf, uint32_t sub, uint32_t r[4])
+{
+#ifdef _MSC_VER
+    int regs[4];
+    __cpuidex(regs, (int)leaf, (int)sub);
+    r[0] = regs[0]; r[1] = regs[1]; r[2] = regs[2]; r[3] = regs[3];
+#else
+    __cpuid_count(leaf, sub, r[0], r[1], r[2], r[3]);
+#endif
+}
+
+static uint64_t dsp_xgetbv(void)
+{
+#ifdef _MSC_VER
+    return _xgetbv(0);
+#else
+    uint32_t lo, hi;
+    __asm__ __volatile__ (".byte 0x0f, 0x01, 0xd0" : "=a" (lo), "=d" (hi) : "c" (0));
+    return ((uint64_t)hi << 32) | lo;
+#endif
+}
+
+/* index of the lowest set bit, x must not be 0 */
+static INLINE uint32_t dsp_ctz(uint32_t x)
+{
+#ifdef _MSC_VER
+    unsigned long i;
+    _BitScanForward(&i, x);
+    return (uint32_t)i;
+#else
+    return (uint32_t)__builtin_ctz(x);
+#endif
+}
+
+uint8_t dsp_detect_x86(void)
+{
+    uint32_t r[4], max_leaf;
+    uint64_t xcr0 = 0;
+    uint8_t level = FAAD_CPU_SCALAR;
+
+    dsp_cpuid(0, 0, r);
+    max_leaf = r[0];
+    if (max_leaf < 1)
+        return level;
+
+    dsp_cpuid(1, 0, r);
+    if (!(r[3] & (1u << 26))) /* SSE2 */
+        return level;
+    level = FAAD_CPU_SSE2;
+
+    if (!(r[2] & (1u << 9))) /* SSSE3 */
+        return level;
+    level = FAAD_CPU_SSSE3;
+
+    /* AVX state must be enabled by the OS */
+    if (!(r[2] & (1u << 27)) || !(r[2] & (1u << 28)) || max_leaf < 7)
+        return level;
+    xcr0 = dsp_xgetbv();
+    if ((xcr0 & 0x06) != 0x06)
+        return level;
+
+    dsp_cpuid(7, 0, r);
+    if (!(r[1] & (1u << 5))) /* AVX2 */
+        return level;
+    level = FAAD_CPU_AVX2;
+
+    if (!(r[1] & (1u << 16)) || (xcr0 & 0xE6) != 0xE6) /* AVX512F */
+        return level;
+    level = FAAD_CPU_AVX512;
+
+    return level;
+}
+
+
+/* SSE2 */
+
+DSP_TARGET("sse2")
+static void imdct_pre_sse2(const real_t *X_in, const complex_t *sincos,
+                           complex_t *Z1, uint16_t N2, uint16_t N4)
+{
+    const float *sc = (const float*)sincos;
+    float *z = (float*)Z1;
+    uint16_t k;
+
+    for (k = 0; k + 4 <= N4; k += 4)
+    {
+        const float *p = X_in + N2 - 8 - 2*k;
+        __m128 a  = _mm_loadu_ps(X_in + 2*k);
+        __m128 b  = _mm_loadu_ps(X_in + 2*k + 4);
+        __m128 c  = _mm_loadu_ps(p);
+        __m128 d  = _mm_loadu_ps(p + 4);
+        __m128 s0 = _mm_loadu_ps(sc + 2*k);
+        __m128 s1 = _mm_loadu_ps(sc + 2*k + 4);
+        __m128 x1 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2,0,2,0));
+        __m128 x2 = _mm_shuffle_ps(d, c, _MM_SHUFFLE(1,3,1,3));
+        __m128 c1 = _mm_shuffle_ps(s0, s1, _MM_SHUFFLE(2,0,2,0));
+        __m128 c2 = _mm_shuffle_ps(s0, s1, _MM_SHUFFLE(3,1,3,1));
+        __m128 im = _mm_add_ps(_mm_mul_ps(x1, c1), _mm_mul_ps(x2, c2));
+        __m128 re = _mm_sub_ps(_mm_mul_ps(x2, c1), _mm_mul_ps(x1, c2));
+
+        _mm_storeu_ps(z + 2*k,     _mm_unpacklo_ps(re, im));
+        _mm_storeu_ps(z + 2*k + 4, _mm_unpackhi_ps(re, im));
+    }
+
+    for (; k < N4; k++)
+    {
+        ComplexMult(&IM(Z1[k]), &RE(Z1[k]),
+            X_in[2*k], X_in[N2 - 1 - 2*k], RE(sincos[k]), IM(sincos[k]));
+    }
+}
+
+DSP_TARGET("sse2")
+static void imdct_post_sse2(complex_t *Z1, const complex_t *sincos, uint16_t N4)
+{
+    const float *sc = (const float*)sincos;
+    float *z = (float*)Z1;
+    const __m128 neg_re = _mm_castsi128_ps(_mm_setr_epi32((int)0x80000000, 0, (int)0x80000000, 0));
+    uint16_t k;
+
+    for (k = 0; k + 2 <= N4; k += 2)
+    {
+        __m128 v  = _mm_loadu_ps(z + 2*k);
+        __m128 s  = _mm_loadu_ps(sc + 2*k);
+        __m128 c1 = _mm_shuffle_ps(s, s, _MM_SHUFFLE(2,2,0,0));
+        __m128 c2 = _mm_shuffle_ps(s, s, _MM_SHUFFLE(3,3,1,1));
+        __m128 vs = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2,3,0,1));
+        __m128 a  = _mm_mul_ps(v, c1);
+        __m128 b  = _mm_mul_ps(vs, c2);
+
+        /* re*c1 - im*c2, im*c1 + re*c2 */
+        _mm_storeu_ps(z + 2*k, _mm_add_ps(a, _mm_xor_ps(b, neg_re)));
+    }
+
+    if (k < N4)
+        imdct_post_c(Z1 + k, sincos + k, N4 - k);
+}
+
+#ifdef SBR_DEC
+DSP_TARGET("sse2")
+static void qmfa_window_sse2(const real_t *x, const real_t *c, real_t *u)
+{
+    uint8_t n, j;
+
+    for (n = 0; n < 64; n += 4)
+    {
+        __m128 sum = _mm_setzero_ps();
+
+        for (j = 0; j < 5; j++)
+        {
+            const float *cj = c + 2*n + 128*j;
+            __m128 cv = _mm_shuffle_ps(_mm_loadu_ps(cj), _mm_loadu_ps(cj + 4),
+                _MM_SHUFFLE(2,0,2,0));
+            __m128 t = _mm_mul_ps(_mm_loadu_ps(x + n + 64*j), cv);
+
+            sum = (j == 0) ? t : _mm_add_ps(sum, t);
+        }
+        _mm_storeu_ps(u + n, sum);
+    }
+}
+
+static const uint16_t qmfs_offset[10] =
+{
+    0, 192, 256, 448, 512, 704, 768, 960, 1024, 1216
+};
+
+DSP_TARGET("sse2")
+static void qmfs_window_sse2(const real_t *v, const real_t *c, real_t *out)
+{
+    uint8_t k, j;
+
+    for (k = 0; k < 64; k += 4)
+    {
+        __m128 sum = _mm_mul_ps(_mm_loadu_ps(v + k), _mm_loadu_ps(c + k));
+
+        for (j = 1; j < 10; j++)
+        {
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(v + k + qmfs_offset[j]),
+                _mm_loadu_ps(c + k + 64*j)));
+        }
+        _mm_storeu_ps(out + k, sum);
+    }
+}
+#endif
+
+DSP_TARGET("sse2")
+static uint8_t requant_sse2(const int16_t *q, real_t *spec, uint16_t width,
+                            real_t scf, const real_t *tab)
+{
+    const __m128i limit = _mm_set1_epi32(DSP_IQ_TABLE_SIZE - 1);
+    const __m128 vscf = _mm_set1_ps(scf);
+    ALIGN int32_t idx[4];
+    __m128i bad = _mm_setzero_si128();
+    uint16_t bin;
+
+    for (bin = 0; bin < width; bin += 4)
+    {
+        __m128i v   = _mm_loadl_epi64((const __m128i*)(q + bin));
+        __m128i v32 = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        __m128i sgn = _mm_srai_epi32(v32, 31);
+        __m128i a   = _mm_sub_epi32(_mm_xor_si128(v32, sgn), sgn);
+        __m128i oob = _mm_cmpgt_epi32(a, limit);
+        __m128 iq;
+
+        _mm_storeu_si128((__m128i*)idx, _mm_andnot_si128(oob, a));
+        iq = _mm_setr_ps(tab[idx[0]], tab[idx[1]], tab[idx[2]], tab[idx[3]]);
+        iq = _mm_xor_ps(iq, _mm_castsi128_ps(_mm_slli_epi32(sgn, 31)));
+        iq = _mm_andnot_ps(_mm_castsi128_ps(oob), iq);
+        _mm_storeu_ps(spec + bin, _mm_mul_ps(iq, vscf));
+
+        bad = _mm_or_si128(bad, oob);
+    }
+
+    return _mm_movemask_epi8(bad) ? 17 : 0;
+}
+
+/* TNS_LANES filters in the four lanes, the lane states form a shift
+   register so the products are subtracted in the order of tns_ar_filter() */
+DSP_TARGET("sse2")
+static void tns_ar_lanes_sse2(real_t **spec, const uint16_t *size, const int8_t *inc,
+                              const real_t *lpc, uint8_t order)
+{
+    __m128 a[TNS_MAX_ORDER], state[TNS_MAX_ORDER];
+    ALIGN real_t x[TNS_LANES];
+    real_t *p[TNS_LANES];
+    uint16_t i, n = 0;
+    uint8_t j, k;
+
+    for (j = 0; j < order; j++)
+    {
+        a[j] = _mm_loadu_ps(lpc + j*TNS_LANES);
+        state[j] = _mm_setzero_ps();
+    }
+    for (k = 0; k < TNS_LANES; k++)
+    {
+        p[k] = spec[k];
+        n = max(n, size[k]);
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        __m128 y;
+
+        for (k = 0; k < TNS_LANES; k++)
+            x[k] = (i < size[k]) ? *p[k] : 0;
+
+        y = _mm_loadu_ps(x);
+        for (j = 0; j < order; j++)
+            y = _mm_sub_ps(y, _mm_mul_ps(state[j], a[j]));
+
+        for (j = order - 1; j > 0; j--)
+            state[j] = state[j-1];
+        state[0] = y;
+
+        _mm_storeu_ps(x, y);
+        for (k = 0; k < TNS_LANES; k++)
+        {
+            if (i < size[k])
+            {
+                *p[k] = x[k];
+                p[k] += inc[k];
+            }
+        }
+    }
+}
+
+/* pns_hash() of four counters, SSE2 has no 32 bit mullo so the even and
+   odd lanes are multiplied separately */
+DSP_TARGET("sse2")
+static INLINE __m128i pns_mullo_sse2(__m128i a, __m128i b)
+{
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0,0,2,0)),
+        _mm_shuffle_epi32(odd, _MM_SHUFFLE(0,0,2,0)));
+}
+
+DSP_TARGET("sse2")
+static INLINE __m128i pns_hash_sse2(__m128i x)
+{
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+    x = pns_mullo_sse2(x, _mm_set1_epi32((int)0x85EBCA6Bu));
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 13));
+    x = pns_mullo_sse2(x, _mm_set1_epi32((int)0xC2B2AE35u));
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+
+    return x;
+}
+
+DSP_TARGET("sse2")
+static real_t pns_noise_sse2(real_t *spec, uint16_t size, uint32_t seed,
+                             uint32_t counter)
+{
+    const __m128i step = _mm_set1_epi32(8);
+    uint32_t base = seed * PNS_GOLDEN + counter;
+    __m128i c0 = _mm_add_epi32(_mm_set1_epi32((int)base), _mm_setr_epi32(0, 1, 2, 3));
+    __m128i c1 = _mm_add_epi32(c0, _mm_set1_epi32(4));
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    ALIGN real_t acc[8];
+    uint16_t i;
+
+    for (i = 0; i + 8 <= size; i += 8)
+    {
+        __m128 v0 = _mm_cvtepi32_ps(pns_hash_sse2(c0));
+        __m128 v1 = _mm_cvtepi32_ps(pns_hash_sse2(c1));
+
+        _mm_storeu_ps(spec + i, v0);
+        _mm_storeu_ps(spec + i + 4, v1);
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(v0, v0));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(v1, v1));
+        c0 = _mm_add_epi32(c0, step);
+        c1 = _mm_add_epi32(c1, step);
+    }
+    _mm_storeu_ps(acc, acc0);
+    _mm_storeu_ps(acc + 4, acc1);
+
+    for (; i < size; i++)
+    {
+        real_t tmp = (real_t)(int32_t)pns_hash(base + i);
+        spec[i] = tmp;
+        acc[i & 7] += tmp*tmp;
+    }
+
+    return pns_sum8(acc);
+}
+
+#ifdef MAIN_DEC
+/* inv_quant_pred() and quant_pred() of ic_predict.c, the upper halves
+   always fit in 16 bits so packs does not saturate */
+DSP_TARGET("sse2")
+static INLINE __m128 pred_load_sse2(const int16_t *q)
+{
+    return _mm_castsi128_ps(_mm_unpacklo_epi16(_mm_setzero_si128(),
+        _mm_loadl_epi64((const __m128i*)q)));
+}
+
+DSP_TARGET("sse2")
+static INLINE void pred_store_sse2(int16_t *q, __m128 v)
+{
+    __m128i h = _mm_srai_epi32(_mm_castps_si128(v), 16);
+    _mm_storel_epi64((__m128i*)q, _mm_packs_epi32(h, h));
+}
+
+/* COR * exp_table[] * mnt_table[] indexed by the bits of VAR, 0 for
+   small VAR */
+DSP_TARGET("sse2")
+static INLINE __m128 pred_k_sse2(const int16_t *var, __m128 cor)
+{
+    __m128i v = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*)var),
+        _mm_setzero_si128());
+    __m128i j = _mm_srli_epi32(v, 7);
+    __m128i use = _mm_cmpgt_epi32(j, _mm_set1_epi32(127));
+    ALIGN int32_t e[4], m[4];
+    __m128 k;
+
+    _mm_storeu_si128((__m128i*)e, _mm_and_si128(j, _mm_set1_epi32(127)));
+    _mm_storeu_si128((__m128i*)m, _mm_and_si128(v, _mm_set1_epi32(127)));
+    k = _mm_mul_ps(cor, _mm_setr_ps(exp_table[e[0]], exp_table[e[1]],
+        exp_table[e[2]], exp_table[e[3]]));
+    k = _mm_mul_ps(k, _mm_setr_ps(mnt_table[m[0]], mnt_table[m[1]],
+        mnt_table[m[2]], mnt_table[m[3]]));
+
+    return _mm_and_ps(_mm_castsi128_ps(use), k);
+}
+
+/* flt_round() */
+DSP_TARGET("sse2")
+static INLINE __m128 pred_round_sse2(__m128 x)
+{
+    __m128i b = _mm_castps_si128(x);
+    __m128i flg = _mm_cmpeq_epi32(_mm_and_si128(b, _mm_set1_epi32(0x00008000)),
+        _mm_set1_epi32(0x00008000));
+    __m128 t1 = _mm_castsi128_ps(_mm_and_si128(b, _mm_set1_epi32((int)0xffff0000)));
+    __m128i t = _mm_and_si128(b, _mm_set1_epi32((int)0xff800000));
+    __m128 t2 = _mm_castsi128_ps(_mm_or_si128(t, _mm_set1_epi32(0x00010000)));
+    __m128 r = _mm_sub_ps(_mm_add_ps(t1, t2), _mm_castsi128_ps(t));
+
+    return _mm_or_ps(_mm_and_ps(_mm_castsi128_ps(flg), r),
+        _mm_andnot_ps(_mm_castsi128_ps(flg), t1));
+}
+
+DSP_TARGET("sse2")
+static void ic_predict_sse2(struct pred_state *state, real_t *spec,
+                            uint16_t low, uint16_t high, uint8_t pred)
+{
+    const __m128 alpha = _mm_set1_ps(ALPHA);
+    const __m128 a = _mm_set1_ps(A);
+    const __m128 half = _mm_set1_ps(0.5f);
+    uint16_t bin;
+
+    for (bin = low; bin + 4 <= high; bin += 4)
+    {
+        __m128 r0 = pred_load_sse2(&state->r[0][bin]);
+        __m128 r1 = pred_load_sse2(&state->r[1][bin]);
+        __m128 cor0 = pred_load_sse2(&state->COR[0][bin]);
+        __m128 cor1 = pred_load_sse2(&state->COR[1][bin]);
+        __m128 var0 = pred_load_sse2(&state->VAR[0][bin]);
+        __m128 var1 = pred_load_sse2(&state->VAR[1][bin]);
+        __m128 k1 = pred_k_sse2(&state->VAR[0][bin], cor0);
+        __m128 e0 = _mm_loadu_ps(spec + bin);
+        __m128 e1, dr1;
+
+        if (pred)
+        {
+            __m128 k2 = pred_k_sse2(&state->VAR[1][bin], cor1);
+            __m128 p = _mm_add_ps(_mm_mul_ps(k1, r0), _mm_mul_ps(k2, r1));
+            e0 = _mm_add_ps(e0, pred_round_sse2(p));
+            _mm_storeu_ps(spec + bin, e0);
+        }
+
+        e1 = _mm_sub_ps(e0, _mm_mul_ps(k1, r0));
+        dr1 = _mm_mul_ps(k1, e0);
+
+        var0 = _mm_add_ps(_mm_mul_ps(alpha, var0), _mm_mul_ps(half,
+            _mm_add_ps(_mm_mul_ps(r0, r0), _mm_mul_ps(e0, e0))));
+        cor0 = _mm_add_ps(_mm_mul_ps(alpha, cor0), _mm_mul_ps(r0, e0));
+        var1 = _mm_add_ps(_mm_mul_ps(alpha, var1), _mm_mul_ps(half,
+            _mm_add_ps(_mm_mul_ps(r1, r1), _mm_mul_ps(e1, e1))));
+        cor1 = _mm_add_ps(_mm_mul_ps(alpha, cor1), _mm_mul_ps(r1, e1));
+
+        r1 = _mm_mul_ps(a, _mm_sub_ps(r0, dr1));
+        r0 = _mm_mul_ps(a, e0);
+
+        pred_store_sse2(&state->r[0][bin], r0);
+        pred_store_sse2(&state->r[1][bin], r1);
+        pred_store_sse2(&state->COR[0][bin], cor0);
+        pred_store_sse2(&state->COR[1][bin], cor1);
+        pred_store_sse2(&state->VAR[0][bin], var0);
+        pred_store_sse2(&state->VAR[1][bin], var1);
+    }
+
+    if (bin < high)
+        ic_predict_c(state, spec, bin, high, pred);
+}
+#endif
+
+/* float -> int32 with the rounding and clipping of the CLIP macro in output.c */
+DSP_TARGET("sse2")
+static INLINE __m128i pcm16_cvt_sse2(__m128 v)
+{
+#ifdef HAS_LRINTF
+    v = _mm_min_ps(_mm_max_ps(v, _mm_set1_ps(-32768.0f)), _mm_set1_ps(32767.0f));
+    return _mm_cvtps_epi32(v);
+#else
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    v = _mm_add_ps(v, _mm_or_ps(_mm_and_ps(v, sign), _mm_set1_ps(0.5f)));
+    v = _mm_min_ps(_mm_max_ps(v, _mm_set1_ps(-32768.0f)), _mm_set1_ps(32767.0f));
+    return _mm_cvttps_epi32(v);
+#endif
+}
+
+DSP_TARGET("sse2")
+static void pcm16_mono_sse2(const real_t *in, int16_t *out, uint16_t n)
+{
+    uint16_t i;
+
+    for (i = 0; i + 8 <= n; i += 8)
+    {
+        __m128i lo = pcm16_cvt_sse2(_mm_loadu_ps(in + i));
+        __m128i hi = pcm16_cvt_sse2(_mm_loadu_ps(in + i + 4));
+        _mm_storeu_si128((__m128i*)(out + i), _mm_packs_epi32(lo, hi));
+    }
+
+    if (i < n)
+        pcm16_mono_c(in + i, out + i, n - i);
+}
+
+DSP_TARGET("sse2")
+static void pcm16_stereo_sse2(const real_t *in0, const real_t *in1,
+                              int16_t *out, uint16_t n)
+{
+    uint16_t i;
+
+    for (i = 0; i + 4 <= n; i += 4)
+    {
+        __m128i l = pcm16_cvt_sse2(_mm_loadu_ps(in0 + i));
+        __m128i r = pcm16_cvt_sse2(_mm_loadu_ps(in1 + i));
+        _mm_storeu_si128((__m128i*)(out + 2*i),
+            _mm_packs_epi32(_mm_unpacklo_epi32(l, r), _mm_unpackhi_epi32(l, r)));
+    }
+
+    if (i < n)
+        pcm16_stereo_c(in0 + i, in1 + i, out + 2*i, n - i);
+}
+
+/* compares 16 positions at once: 0xFF followed by a byte matching 0xF0 under
+   the layer mask 0xF6 */
+DSP_TARGET("sse2")
+static uint32_t adts_sync_sse2(const uint8_t *p, uint32_t n)
+{
+    const __m128i ff = _mm_set1_epi8((char)0xFF);
+    const __m128i mask = _mm_set1_epi8((char)0xF6);
+    const __m128i sync = _mm_set1_epi8((char)0xF0);
+    uint32_t i;
+
+    for (i = 0; i + 17 <= n; i += 16)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i*)(p + i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(p + i + 1));
+        __m128i m = _mm_and_si128(_mm_cmpeq_epi8(a, ff),
+            _mm_cmpeq_epi8(_mm_and_si128(b, mask), sync));
+        uint32_t bits = (uint32_t)_mm_movemask_epi8(m);
+
+        if (bits)
+            return i + dsp_ctz(bits);
+    }
+
+    return i + adts_sync_c(p + i, n - i);
+}
+
+
+/* SSSE3 (and SSE3) */
+
+DSP_TARGET("ssse3")
+static void imdct_post_ssse3(complex_t *Z1, const complex_t *sincos, uint16_t N4)
+{
+    const float *sc = (const float*)sincos;
+    float *z = (float*)Z1;
+    uint16_t k;
+
+    for (k = 0; k + 2 <= N4; k += 2)
+    {
+        __m128 v  = _mm_loadu_ps(z + 2*k);
+        __m128 s  = _mm_loadu_ps(sc + 2*k);
+        __m128 vs = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2,3,0,1));
+        __m128 a  = _mm_mul_ps(v, _mm_moveldup_ps(s));
+        __m128 b  = _mm_mul_ps(vs, _mm_movehdup_ps(s));
+
+        _mm_storeu_ps(z + 2*k, _mm_addsub_ps(a, b));
+    }
+
+    if (k < N4)
+        imdct_post_c(Z1 + k, sincos + k, N4 - k);
+}
+
+DSP_TARGET("ssse3")
+static uint8_t requant_ssse3(const int16_t *q, real_t *spec, uint16_t width,
+                             real_t scf, const real_t *tab)
+{
+    const __m128i limit = _mm_set1_epi32(DSP_IQ_TABLE_SIZE - 1);
+    const __m128 vscf = _mm_set1_ps(scf);
+    ALIGN int32_t idx[4];
+    __m128i bad = _mm_setzero_si128();
+    uint16_t bin;
+
+    for (bin = 0; bin < width; bin += 4)
+    {
+        __m128i v   = _mm_loadl_epi64((const __m128i*)(q + bin));
+        __m128i v32 = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        __m128i a   = _mm_abs_epi32(v32);
+        __m128i oob = _mm_cmpgt_epi32(a, limit);
+        __m128 iq;
+
+        _mm_storeu_si128((__m128i*)idx, _mm_andnot_si128(oob, a));
+        iq = _mm_setr_ps(tab[idx[0]], tab[idx[1]], tab[idx[2]], tab[idx[3]]);
+        iq = _mm_xor_ps(iq, _mm_castsi128_ps(_mm_slli_epi32(_mm_srai_epi32(v32, 31), 31)));
+        iq = _mm_andnot_ps(_mm_castsi128_ps(oob), iq);
+        _mm_storeu_ps(spec + bin, _mm_mul_ps(iq, vscf));
+
+        bad = _mm_or_si128(bad, oob);
+    }
+
+    return _mm_movemask_epi8(bad) ? 17 : 0;
+}
+
+
+/* AVX2 */
+
+/* even and odd elements of a[0..7], b[0..7] in order */
+#define AVX2_EVEN(a, b) _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd( \
+    _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2,0,2,0))), _MM_SHUFFLE(3,1,2,0)))
+#define AVX2_ODD(a, b) _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd( \
+    _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3,1,3,1))), _MM_SHUFFLE(3,1,2,0)))
+
+DSP_TARGET("avx2")
+static void imdct_pre_avx2(const real_t *X_in, const complex_t *sincos,
+                           complex_t *Z1, uint16_t N2, uint16_t N4)
+{
+    const __m256i rev = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+    const float *sc = (const float*)sincos;
+    float *z = (float*)Z1;
+    uint16_t k;
+
+    for (k = 0; k + 8 <= N4; k += 8)
+    {
+        const float *p = X_in + N2 - 16 - 2*k;
+        __m256 a  = _mm256_loadu_ps(X_in + 2*k);
+        __m256 b  = _mm256_loadu_ps(X_in + 2*k + 8);
+        __m256 c  = _mm256_loadu_ps(p);
+        __m256 d  = _mm256_loadu_ps(p + 8);
+        __m256 s0 = _mm256_loadu_ps(sc + 2*k);
+        __m256 s1 = _mm256_loadu_ps(sc + 2*k + 8);
+        __m256 x1 = AVX2_EVEN(a, b);
+        __m256 x2 = _mm256_permutevar8x32_ps(AVX2_ODD(c, d), rev);
+        __m256 c1 = AVX2_EVEN(s0, s1);
+        __m256 c2 = AVX2_ODD(s0, s1);
+        __m256 im = _mm256_add_ps(_mm256_mul_ps(x1, c1), _mm256_mul_ps(x2, c2));
+        __m256 re = _mm256_sub_ps(_mm256_mul_ps(x2, c1), _mm256_mul_ps(x1, c2));
+        __m256 lo = _mm256_unpacklo_ps(re, im);
+        __m256 hi = _mm256_unpackhi_ps(re, im);
+
+        _mm256_storeu_ps(z + 2*k,     _mm256_permute2f128_ps(lo, hi, 0x20));
+        _mm256_storeu_ps(z + 2*k + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+    }
+
+    for (; k < N4; k++)
+    {
+        ComplexMult(&IM(Z1[k]), &RE(Z1[k]),
+            X_in[2*k], X_in[N2 - 1 - 2*k], RE(sincos[k]), IM(sincos[k]));
+    }
+}
+
+DSP_TARGET("avx2")
+static void imdct_post_avx2(complex_t *Z1, const complex_t *sincos, uint16_t N4)
+{
+    const float *sc = (const float*)sincos;
+    float *z = (float*)Z1;
+    uint16_t k;
+
+    for (k = 0; k + 4 <= N4; k += 4)
+    {
+        __m256 v  = _mm256_loadu_ps(z + 2*k);
+        __m256 s  = _mm256_loadu_ps(sc + 2*k);
+        __m256 vs = _mm256_permute_ps(v, _MM_SHUFFLE(2,3,0,1));
+        __m256 a  = _mm256_mul_ps(v, _mm256_moveldup_ps(s));
+        __m256 b  = _mm256_mul_ps(vs, _mm256_movehdup_ps(s));
+
+        _mm256_storeu_ps(z + 2*k, _mm256_addsub_ps(a, b));
+    }
+
+    if (k < N4)
+        imdct_post_ssse3(Z1 + k, sincos + k, N4 - k);
+}
+
+#ifdef SBR_DEC
+DSP_TARGET("avx2")
+static void qmfa_window_avx2(const real_t *x, const real_t *c, real_t *u)
+{
+    uint8_t n, j;
+
+    for (n = 0; n < 64; n += 8)
+    {
+        __m256 sum = _mm256_setzero_ps();
+
+        for (j = 0; j < 5; j++)
+        {
+            const float *cj = c + 2*n + 128*j;
+            __m256 cv = AVX2_EVEN(_mm256_loadu_ps(cj), _mm256_loadu_ps(cj + 8));
+            __m256 t = _mm256_mul_ps(_mm256_loadu_ps(x + n + 64*j), cv);
+
+            sum = (j == 0) ? t : _mm256_add_ps(sum, t);
+        }
+        _mm256_storeu_ps(u + n, sum);
+    }
+}
+
+DSP_TARGET("avx2")
+static void qmfs_window_avx2(const real_t *v, const real_t *c, real_t *out)
+{
+    uint8_t k, j;
+
+    for (k = 0; k < 64; k += 8)
+    {
+        __m256 sum = _mm256_mul_ps(_mm256_loadu_ps(v + k), _mm256_loadu_ps(c + k));
+
+        for (j = 1; j < 10; j++)
+        {
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_loadu_ps(v + k + qmfs_offset[j]),
+                _mm256_loadu_ps(c + k + 64*j)));
+        }
+        _mm256_storeu_ps(out + k, sum);
+    }
+}
+#endif
+
+DSP_TARGET("avx2")
+static uint8_t requant_avx2(const int16_t *q, real_t *spec, uint16_t width,
+                            real_t scf, const real_t *tab)
+{
+    const __m256i limit = _mm256_set1_epi32(DSP_IQ_TABLE_SIZE - 1);
+    const __m256 vscf = _mm256_set1_ps(scf);
+    __m256i bad = _mm256_setzero_si256();
+    uint16_t bin;
+
+    for (bin = 0; bin + 8 <= width; bin += 8)
+    {
+        __m256i v32 = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(q + bin)));
+        __m256i a   = _mm256_abs_epi32(v32);
+        __m256i oob = _mm256_cmpgt_epi32(a, limit);
+        __m256 iq   = _mm256_i32gather_ps(tab, _mm256_andnot_si256(oob, a), 4);
+
+        iq = _mm256_xor_ps(iq, _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_srai_epi32(v32, 31), 31)));
+        iq = _mm256_andnot_ps(_mm256_castsi256_ps(oob), iq);
+        _mm256_storeu_ps(spec + bin, _mm256_mul_ps(iq, vscf));
+
+        bad = _mm256_or_si256(bad, oob);
+    }
+
+    if (_mm256_movemask_epi8(bad))
+    {
+        if (bin < width)
+            requant_ssse3(q + bin, spec + bin, width - bin, scf, tab);
+        return 17;
+    }
+    if (bin < width)
+        return requant_ssse3(q + bin, spec + bin, width - bin, scf, tab);
+
+    return 0;
+}
+
+DSP_TARGET("avx2")
+static INLINE __m256i pns_hash_avx2(__m256i x)
+{
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+    x = _mm256_mullo_epi32(x, _mm256_set1_epi32((int)0x85EBCA6Bu));
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 13));
+    x = _mm256_mullo_epi32(x, _mm256_set1_epi32((int)0xC2B2AE35u));
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+
+    return x;
+}
+
+DSP_TARGET("avx2")
+static real_t pns_noise_avx2(real_t *spec, uint16_t size, uint32_t seed,
+                             uint32_t counter)
+{
+    const __m256i step = _mm256_set1_epi32(8);
+    uint32_t base = seed * PNS_GOLDEN + counter;
+    __m256i c = _mm256_add_epi32(_mm256_set1_epi32((int)base),
+        _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    __m256 sum = _mm256_setzero_ps();
+    ALIGN real_t acc[8];
+    uint16_t i;
+
+    for (i = 0; i + 8 <= size; i += 8)
+    {
+        __m256 v = _mm256_cvtepi32_ps(pns_hash_avx2(c));
+
+        _mm256_storeu_ps(spec + i, v);
+        sum = _mm256_add_ps(sum, _mm256_mul_ps(v, v));
+        c = _mm256_add_epi32(c, step);
+    }
+    _mm256_storeu_ps(acc, sum);
+
+    for (; i < size; i++)
+    {
+        real_t tmp = (real_t)(int32_t)pns_hash(base + i);
+        spec[i] = tmp;
+        acc[i & 7] += tmp*tmp;
+    }
+
+    return pns_sum8(acc);
+}
+
+#ifdef MAIN_DEC
+DSP_TARGET("avx2")
+static INLINE __m256 pred_load_avx2(const int16_t *q)
+{
+    return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_cvtepu16_epi32(
+        _mm_loadu_si128((const __m128i*)q)), 16));
+}
+
+DSP_TARGET("avx2")
+static INLINE void pred_store_avx2(int16_t *q, __m256 v)
+{
+    __m256i h = _mm256_srai_epi32(_mm256_castps_si256(v), 16);
+    _mm_storeu_si128((__m128i*)q, _mm_packs_epi32(_mm256_castsi256_si128(h),
+        _mm256_extracti128_si256(h, 1)));
+}
+
+DSP_TARGET("avx2")
+static INLINE __m256 pred_k_avx2(const int16_t *var, __m256 cor)
+{
+    __m256i v = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)var));
+    __m256i j = _mm256_srli_epi32(v, 7);
+    __m256i use = _mm256_cmpgt_epi32(j, _mm256_set1_epi32(127));
+    __m256 k;
+
+    k = _mm256_mul_ps(cor, _mm256_i32gather_ps(exp_table,
+        _mm256_and_si256(j, _mm256_set1_epi32(127)), 4));
+    k = _mm256_mul_ps(k, _mm256_i32gather_ps(mnt_table,
+        _mm256_and_si256(v, _mm256_set1_epi32(127)), 4));
+
+    return _mm256_and_ps(_mm256_castsi256_ps(use), k);
+}
+
+DSP_TARGET("avx2")
+static INLINE __m256 pred_round_avx2(__m256 x)
+{
+    __m256i b = _mm256_castps_si256(x);
+    __m256i flg = _mm256_cmpeq_epi32(_mm256_and_si256(b, _mm256_set1_epi32(0x00008000)),
+        _mm256_set1_epi32(0x00008000));
+    __m256 t1 = _mm256_castsi256_ps(_mm256_and_si256(b, _mm256_set1_epi32((int)0xffff0000)));
+    __m256i t = _mm256_and_si256(b, _mm256_set1_epi32((int)0xff800000));
+    __m256 t2 = _mm256_castsi256_ps(_mm256_or_si256(t, _mm256_set1_epi32(0x00010000)));
+    __m256 r = _mm256_sub_ps(_mm256_add_ps(t1, t2), _mm256_castsi256_ps(t));
+
+    return _mm256_blendv_ps(t1, r, _mm256_castsi256_ps(flg));
+}
+
+DSP_TARGET("avx2")
+static void ic_predict_avx2(struct pred_state *state, real_t *spec,
+                            uint16_t low, uint16_t high, uint8_t pred)
+{
+    const __m256 alpha = _mm256_set1_ps(ALPHA);
+    const __m256 a = _mm256_set1_ps(A);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    uint16_t bin;
+
+    for (bin = low; bin + 8 <= high; bin += 8)
+    {
+        __m256 r0 = pred_load_avx2(&state->r[0][bin]);
+        __m256 r1 = pred_load_avx2(&state->r[1][bin]);
+        __m256 cor0 = pred_load_avx2(&state->COR[0][bin]);
+        __m256 cor1 = pred_load_avx2(&state->COR[1][bin]);
+        __m256 var0 = pred_load_avx2(&state->VAR[0][bin]);
+        __m256 var1 = pred_load_avx2(&state->VAR[1][bin]);
+        __m256 k1 = pred_k_avx2(&state->VAR[0][bin], cor0);
+        __m256 e0 = _mm256_loadu_ps(spec + bin);
+        __m256 e1, dr1;
+
+        if (pred)
+        {
+            __m256 k2 = pred_k_avx2(&state->VAR[1][bin], cor1);
+            __m256 p = _mm256_add_ps(_mm256_mul_ps(k1, r0), _mm256_mul_ps(k2, r1));
+            e0 = _mm256_add_ps(e0, pred_round_avx2(p));
+            _mm256_storeu_ps(spec + bin, e0);
+        }
+
+        e1 = _mm256_sub_ps(e0, _mm256_mul_ps(k1, r0));
+        dr1 = _mm256_mul_ps(k1, e0);
+
+        var0 = _mm256_add_ps(_mm256_mul_ps(alpha, var0), _mm256_mul_ps(half,
+            _mm256_add_ps(_mm256_mul_ps(r0, r0), _mm256_mul_ps(e0, e0))));
+        cor0 = _mm256_add_ps(_mm256_mul_ps(alpha, cor0), _mm256_mul_ps(r0, e0));
+        var1 = _mm256_add_ps(_mm256_mul_ps(alpha, var1), _mm256_mul_ps(half,
+            _mm256_add_ps(_mm256_mul_ps(r1, r1), _mm256_mul_ps(e1, e1))));
+        cor1 = _mm256_add_ps(_mm256_mul_ps(alpha, cor1), _mm256_mul_ps(r1, e1));
+
+        r1 = _mm256_mul_ps(a, _mm256_sub_ps(r0, dr1));
+        r0 = _mm256_mul_ps(a, e0);
+
+        pred_store_avx2(&state->r[0][bin], r0);
+        pred_store_avx2(&state->r[1][bin], r1);
+        pred_store_avx2(&state->COR[0][bin], cor0);
+        pred_store_avx2(&state->COR[1][bin], cor1);
+        pred_store_avx2(&state->VAR[0][bin], var0);
+        pred_store_avx2(&state->VAR[1][bin], var1);
+    }
+
+    if (bin < high)
+        ic_predict_sse2(state, spec, bin, high, pred);
+}
+#endif
+
+DSP_TARGET("avx2")
+static INLINE __m256i pcm16_cvt_avx2(__m256 v)
+{
+#ifdef HAS_LRINTF
+    v = _mm256_min_ps(_mm256_max_ps(v, _mm256_set1_ps(-32768.0f)), _mm256_set1_ps(32767.0f));
+    return _mm256_cvtps_epi32(v);
+#else
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    v = _mm256_add_ps(v, _mm256_or_ps(_mm256_and_ps(v, sign), _mm256_set1_ps(0.5f)));
+    v = _mm256_min_ps(_mm256_max_ps(v, _mm256_set1_ps(-32768.0f)), _mm256_set1_ps(32767.0f));
+    return _mm256_cvttps_epi32(v);
+#endif
+}
+
+DSP_TARGET("avx2")
+static void pcm16_mono_avx2(const real_t *in, int16_t *out, uint16_t n)
+{
+    uint16_t i;
+
+    for (i = 0; i + 16 <= n; i += 16)
+    {
+        __m256i lo = pcm16_cvt_avx2(_mm256_loadu_ps(in + i));
+        __m256i hi = pcm16_cvt_avx2(_mm256_loadu_ps(in + i + 8));
+        _mm256_storeu_si256((__m256i*)(out + i),
+            _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), _MM_SHUFFLE(3,1,2,0)));
+    }
+
+    if (i < n)
+        pcm16_mono_sse2(in + i, out + i, n - i);
+}
+
+DSP_TARGET("avx2")
+static void pcm16_stereo_avx2(const real_t *in0, const real_t *in1,
+                              int16_t *out, uint16_t n)
+{
+    uint16_t i;
+
+    for (i = 0; i + 8 <= n; i += 8)
+    {
+        __m256i l = pcm16_cvt_avx2(_mm256_loadu_ps(in0 + i));
+        __m256i r = pcm16_cvt_avx2(_mm256_loadu_ps(in1 + i));
+        _mm256_storeu_si256((__m256i*)(out + 2*i),
+            _mm256_packs_epi32(_mm256_unpacklo_epi32(l, r), _mm256_unpackhi_epi32(l, r)));
+    }
+
+    if (i < n)
+        pcm16_stereo_sse2(in0 + i, in1 + i, out + 2*i, n - i);
+}
+
+
+/* AVX-512 */
+
+DSP_TARGET("avx512f")
+static void imdct_pre_avx512(const real_t *X_in, const complex_t *sincos,
+                             complex_t *Z1, uint16_t N2, uint16_t N4)
+{
+    const __m512i even = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14,
+                                           16, 18, 20, 22, 24, 26, 28, 30);
+    const __m512i odd  = _mm512_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15,
+                                           17, 19, 21, 23, 25, 27, 29, 31);
+    const __m512i rodd = _mm512_setr_epi32(31, 29, 27, 25, 23, 21, 19, 17,
+                                           15, 13, 11, 9, 7, 5, 3, 1);
+    const __m512i ilo  = _mm512_setr_epi32(0, 16, 1, 17, 2, 18, 3, 19,
+                                           4, 20, 5, 21, 6, 22, 7, 23);
+    const __m512i ihi  = _mm512_setr_epi32(8, 24, 9, 25, 10, 26, 11, 27,
+                                           12, 28, 13, 29, 14, 30, 15, 31);
+    const float *sc = (const float*)sincos;
+    float *z = (float*)Z1;
+    uint16_t k;
+
+    for (k = 0; k + 16 <= N4; k += 16)
+    {
+        const float *p = X_in + N2 - 32 - 2*k;
+        __m512 a  = _mm512_loadu_ps(X_in + 2*k);
+        __m512 b  = _mm512_loadu_ps(X_in + 2*k + 16);
+        __m512 s0 = _mm512_loadu_ps(sc + 2*k);
+        __m512 s1 = _mm512_loadu_ps(sc + 2*k + 16);
+        __m512 x1 = _mm512_permutex2var_ps(a, even, b);
+        __m512 x2 = _mm512_permutex2var_ps(_mm512_loadu_ps(p), rodd, _mm512_loadu_ps(p + 16));
+        __m512 c1 = _mm512_permutex2var_ps(s0, even, s1);
+        __m512 c2 = _mm512_permutex2var_ps(s0, odd, s1);
+        __m512 im = _mm512_add_ps(_mm512_mul_ps(x1, c1), _mm512_mul_ps(x2, c2));
+        __m512 re = _mm512_sub_ps(_mm512_mul_ps(x2, c1), _mm512_mul_ps(x1, c2));
+
+        _mm512_storeu_ps(z + 2*k,      _mm512_permutex2var_ps(re, ilo, im));
+        _mm512_storeu_ps(z + 2*k + 16, _mm512_permutex2var_ps(re, ihi, im));
+    }
+
+    for (; k < N4; k++)
+    {
+        ComplexMult(&IM(Z1[k]), &RE(Z1[k]),
+            X_in[2*k], X_in[N2 - 1 - 2*k], RE(sincos[k]), IM(sincos[k]));
+    }
+}
+
+DSP_TARGET("avx512f")
+static void imdct_post_avx512(complex_t *Z1, const complex_t *sincos, uint16_t N4)
+{
+    const float *sc = (const float*)sincos;
+    float *z = (float*)Z1;
+    uint16_t k;
+
+    for (k = 0; k + 8 <= N4; k += 8)
+    {
+        __m512 v  = _mm512_loadu_ps(z + 2*k);
+        __m512 s  = _mm512_loadu_ps(sc + 2*k);
+        __m512 vs = _mm512_permute_ps(v, _MM_SHUFFLE(2,3,0,1));
+        __m512 a  = _mm512_mul_ps(v, _mm512_moveldup_ps(s));
+        __m512 b  = _mm512_mul_ps(vs, _mm512_movehdup_ps(s));
+
+        /* subtract in the real, add in the imaginary lanes */
+        _mm512_storeu_ps(z + 2*k, _mm512_mask_sub_ps(_mm512_add_ps(a, b), 0x5555, a, b));
+    }
+
+    if (k < N4)
+        imdct_post_avx2(Z1 + k, sincos + k, N4 - k);
+}
+
+#ifdef SBR_DEC
+DSP_TARGET("avx512f")
+static void qmfa_window_avx512(const real_t *x, const real_t *c, real_t *u)
+{
+    const __m512i even = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14,
+                                           16, 18, 20, 22, 24, 26, 28, 30);
+    uint8_t n, j;
+
+    for (n = 0; n < 64; n += 16)
+    {
+        __m512 sum = _mm512_setzero_ps();
+
+        for (j = 0; j < 5; j++)
+        {
+            const float *cj = c + 2*n + 128*j;
+            __m512 cv = _mm512_permutex2var_ps(_mm512_loadu_ps(cj), even, _mm512_loadu_ps(cj + 16));
+            __m512 t = _mm512_mul_ps(_mm512_loadu_ps(x + n + 64*j), cv);
+
+            sum = (j == 0) ? t : _mm512_add_ps(sum, t);
+        }
+        _mm512_storeu_ps(u + n, sum);
+    }
+}
+
+DSP_TARGET("avx512f")
+static void qmfs_window_avx512(const real_t *v, const real_t *c, real_t *out)
+{
+    uint8_t k, j;
+
+    for (k = 0; k < 64; k += 16)
+    {
+        __m512 sum = _mm512_mul_ps(_mm512_loadu_ps(v + k), _mm512_loadu_ps(c + k));
+
+        for (j = 1; j < 10; j++)
+        {
+            sum = _mm512_add_ps(sum, _mm512_mul_ps(_mm512_loadu_ps(v + k + qmfs_offset[j]),
+                _mm512_loadu_ps(c + k + 64*j)));
+        }
+        _mm512_storeu_ps(out + k, sum);
+    }
+}
+#endif
+
+DSP_TARGET("avx512f")
+static uint8_t requant_avx512(const int16_t *q, real_t *spec, uint16_t width,
+                              real_t scf, const real_t *tab)
+{
+    const __m512i limit = _mm512_set1_epi32(DSP_IQ_TABLE_SIZE - 1);
+    const __m512 vscf = _mm512_set1_ps(scf);
+    __mmask16 bad = 0;
+    uint8_t error = 0;
+    uint16_t bin;
+
+    for (bin = 0; bin + 16 <= width; bin += 16)
+    {
+        __m512i v32 = _mm512_cvtepi16_epi32(_mm256_loadu_si256((const __m256i*)(q + bin)));
+        __m512i a   = _mm512_abs_epi32(v32);
+        __mmask16 ok = _mm512_cmple_epi32_mask(a, limit);
+        __m512 iq   = _mm512_mask_i32gather_ps(_mm512_setzero_ps(), ok, a, tab, 4);
+        __m512i sgn = _mm512_and_si512(v32, _mm512_set1_epi32((int)0x80000000));
+
+        iq = _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(iq), sgn));
+        iq = _mm512_maskz_mov_ps(ok, iq);
+        _mm512_storeu_ps(spec + bin, _mm512_mul_ps(iq, vscf));
+
+        bad |= (__mmask16)~ok;
+    }
+
+    if (bin < width)
+        error = requant_avx2(q + bin, spec + bin, width - bin, scf, tab);
+
+    return bad ? 17 : error;
+}
+
+#ifdef MAIN_DEC
+DSP_TARGET("avx512f")
+static INLINE __m512 pred_load_avx512(const int16_t *q)
+{
+    return _mm512_castsi512_ps(_mm512_slli_epi32(_mm512_cvtepu16_epi32(
+        _mm256_loadu_si256((const __m256i*)q)), 16));
+}
+
+DSP_TARGET("avx512f")
+static INLINE void pred_store_avx512(int16_t *q, __m512 v)
+{
+    _mm256_storeu_si256((__m256i*)q, _mm512_cvtepi32_epi16(
+        _mm512_srai_epi32(_mm512_castps_si512(v), 16)));
+}
+
+DSP_TARGET("avx512f")
+static INLINE __m512 pred_k_avx512(const int16_t *var, __m512 cor)
+{
+    __m512i v = _mm512_cvtepu16_epi32(_mm256_loadu_si256((const __m256i*)var));
+    __m512i j = _mm512_srli_epi32(v, 7);
+    __mmask16 use = _mm512_cmpgt_epi32_mask(j, _mm512_set1_epi32(127));
+    __m512 k;
+
+    k = _mm512_mul_ps(cor, _mm512_i32gather_ps(
+        _mm512_and_si512(j, _mm512_set1_epi32(127)), exp_table, 4));
+    k = _mm512_maskz_mul_ps(use, k, _mm512_i32gather_ps(
+        _mm512_and_si512(v, _mm512_set1_epi32(127)), mnt_table, 4));
+
+    return k;
+}
+
+DSP_TARGET("avx512f")
+static INLINE __m512 pred_round_avx512(__m512 x)
+{
+    __m512i b = _mm512_castps_si512(x);
+    __mmask16 flg = _mm512_test_epi32_mask(b, _mm512_set1_epi32(0x00008000));
+    __m512 t1 = _mm512_castsi512_ps(_mm512_and_si512(b, _mm512_set1_epi32((int)0xffff0000)));
+    __m512i t = _mm512_and_si512(b, _mm512_set1_epi32((int)0xff800000));
+    __m512 t2 = _mm512_castsi512_ps(_mm512_or_si512(t, _mm512_set1_epi32(0x00010000)));
+    __m512 r = _mm512_sub_ps(_mm512_add_ps(t1, t2), _mm512_castsi512_ps(t));
+
+    return _mm512_mask_blend_ps(flg, t1, r);
+}
+
+DSP_TARGET("avx512f")
+static void ic_predict_avx512(struct pred_state *state, real_t *spec,
+                              uint16_t low, uint16_t high, uint8_t pred)
+{
+    const __m512 alpha = _mm512_set1_ps(ALPHA);
+    const __m512 a = _mm512_set1_ps(A);
+    const __m512 half = _mm512_set1_ps(0.5f);
+    uint16_t bin;
+
+    for (bin = low; bin + 16 <= high; bin += 16)
+    {
+        __m512 r0 = pred_load_avx512(&state->r[0][bin]);
+        __m512 r1 = pred_load_avx512(&state->r[1][bin]);
+        __m512 cor0 = pred_load_avx512(&state->COR[0][bin]);
+        __m512 cor1 = pred_load_avx512(&state->COR[1][bin]);
+        __m512 var0 = pred_load_avx512(&state->VAR[0][bin]);
+        __m512 var1 = pred_load_avx512(&state->VAR[1][bin]);
+        __m512 k1 = pred_k_avx512(&state->VAR[0][bin], cor0);
+        __m512 e0 = _mm512_loadu_ps(spec + bin);
+        __m512 e1, dr1;
+
+        if (pred)
+        {
+            __m512 k2 = pred_k_avx512(&state->VAR[1][bin], cor1);
+            __m512 p = _mm512_add_ps(_mm512_mul_ps(k1, r0), _mm512_mul_ps(k2, r1));
+            e0 = _mm512_add_ps(e0, pred_round_avx512(p));
+            _mm512_storeu_ps(spec + bin, e0);
+        }
+
+        e1 = _mm512_sub_ps(e0, _mm512_mul_ps(k1, r0));
+        dr1 = _mm512_mul_ps(k1, e0);
+
+        var0 = _mm512_add_ps(_mm512_mul_ps(alpha, var0), _mm512_mul_ps(half,
+            _mm512_add_ps(_mm512_mul_ps(r0, r0), _mm512_mul_ps(e0, e0))));
+        cor0 = _mm512_add_ps(_mm512_mul_ps(alpha, cor0), _mm512_mul_ps(r0, e0));
+        var1 = _mm512_add_ps(_mm512_mul_ps(alpha, var1), _mm512_mul_ps(half,
+            _mm512_add_ps(_mm512_mul_ps(r1, r1), _mm512_mul_ps(e1, e1))));
+        cor1 = _mm512_add_ps(_mm512_mul_ps(alpha, cor1), _mm512_mul_ps(r1, e1));
+
+        r1 = _mm512_mul_ps(a, _mm512_sub_ps(r0, dr1));
+        r0 = _mm512_mul_ps(a, e0);
+
+        pred_store_avx512(&state->r[0][bin], r0);
+        pred_store_avx512(&state->r[1][bin], r1);
+        pred_store_avx512(&state->COR[0][bin], cor0);
+        pred_store_avx512(&state->COR[1][bin], cor1);
+        pred_store_avx512(&state->VAR[0][bin], var0);
+        pred_store_avx512(&state->VAR[1][bin], var1);
+    }
+
+    if (bin < high)
+        ic_predict_avx2(state, spec, bin, high, pred);
+}
+#endif
+
+DSP_TARGET("avx512f")
+static INLINE __m512i pcm16_cvt_avx512(__m512 v)
+{
+#ifdef HAS_LRINTF
+    v = _mm512_min_ps(_mm512_max_ps(v, _mm512_set1_ps(-32768.0f)), _mm512_set1_ps(32767.0f));
+    return _mm512_cvtps_epi32(v);
+#else
+    const __m512i sign = _mm512_set1_epi32((int)0x80000000);
+    __m512i half = _mm512_or_si512(_mm512_and_si512(_mm512_castps_si512(v), sign),
+        _mm512_castps_si512(_mm512_set1_ps(0.5f)));
+    v = _mm512_add_ps(v, _mm512_castsi512_ps(half));
+    v = _mm512_min_ps(_mm512_max_ps(v, _mm512_set1_ps(-32768.0f)), _mm512_set1_ps(32767.0f));
+    return _mm512_cvttps_epi32(v);
+#endif
+}
+
+DSP_TARGET("avx512f")
+static void pcm16_mono_avx512(const real_t *in, int16_t *out, uint16_t n)
+{
+    uint16_t i;
+
+    for (i = 0; i + 16 <= n; i += 16)
+    {
+        __m512i v = pcm16_cvt_avx512(_mm512_loadu_ps(in + i));
+        _mm256_storeu_si256((__m256i*)(out + i), _mm512_cvtsepi32_epi16(v));
+    }
+
+    if (i < n)
+        pcm16_mono_avx2(in + i, out + i, n - i);
+}
+
+DSP_TARGET("avx512f")
+static void pcm16_stereo_avx512(const real_t *in0, const real_t *in1,
+                                int16_t *out, uint16_t n)
+{
+    const __m512i ilo = _mm512_setr_epi32(0, 16, 1, 17, 2, 18, 3, 19,
+                                          4, 20, 5, 21, 6, 22, 7, 23);
+    const __m512i ihi = _mm512_setr_epi32(8, 24, 9, 25, 10, 26, 11, 27,
+                                          12, 28, 13, 29, 14, 30, 15, 31);
+    uint16_t i;
+
+    for (i = 0; i + 16 <= n; i += 16)
+    {
+        __m512i l = pcm16_cvt_avx512(_mm512_loadu_ps(in0 + i));
+        __m512i r = pcm16_cvt_avx512(_mm512_loadu_ps(in1 + i));
+        _mm256_storeu_si256((__m256i*)(out + 2*i),
+            _mm512_cvtsepi32_epi16(_mm512_permutex2var_epi32(l, ilo, r)));
+        _mm256_storeu_si256((__m256i*)(out + 2*i + 16),
+            _mm512_cvtsepi32_epi16(_mm512_permutex2var_epi32(l, ihi, r)));
+    }
+
+    if (i < n)
+        pcm16_stereo_avx2(in0 + i, in1 + i, out + 2*i, n - i);
+}
+
+DSP_TARGET("avx2")
+static uint32_t adts_sync_avx2(const uint8_t *p, uint32_t n)
+{
+    const __m256i ff = _mm256_set1_epi8((char)0xFF);
+    const __m256i mask = _mm256_set1_epi8((char)0xF6);
+    const __m256i sync = _mm256_set1_epi8((char)0xF0);
+    uint32_t i;
+
+    for (i = 0; i + 33 <= n; i += 32)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(p + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(p + i + 1));
+        __m256i m = _mm256_and_si256(_mm256_cmpeq_epi8(a, ff),
+            _mm256_cmpeq_epi8(_mm256_and_si256(b, mask), sync));
+        uint32_t bits = (uint32_t)_mm256_movemask_epi8(m);
+
+        if (bits)
+            return i + dsp_ctz(bits);
+    }
+
+    return i + adts_sync_sse2(p + i, n - i);
+}
+
+void dsp_init_x86(dsp_funcs *dsp, uint8_t level)
+{
+    if (level >= FAAD_CPU_SSE2)
+    {
+        dsp->imdct_pre = imdct_pre_sse2;
+        dsp->imdct_post = imdct_post_sse2;
+#ifdef SBR_DEC
+        dsp->qmfa_window = qmfa_window_sse2;
+        dsp->qmfs_window = qmfs_window_sse2;
+#endif
+        dsp->requant = requant_sse2;
+        dsp->tns_ar_lanes = tns_ar_lanes_sse2;
+        dsp->pns_noise = pns_noise_sse2;
+#ifdef MAIN_DEC
+        dsp->ic_predict = ic_predict_sse2;
+#endif
+        dsp->pcm16_mono = pcm16_mono_sse2;
+        dsp->pcm16_stereo = pcm16_stereo_sse2;
+        dsp->adts_sync = adts_sync_sse2;
+    }
+    if (level >= FAAD_CPU_SSSE3)
+    {
+        dsp->imdct_post = imdct_post_ssse3;
+        dsp->requant = requant_ssse3;
+    }
+    if (level >= FAAD_CPU_AVX2)
+    {
+        dsp->imdct_pre = imdct_pre_avx2;
+        dsp->imdct_post = imdct_post_avx2;
+#ifdef SBR_DEC
+        dsp->qmfa_window = qmfa_window_avx2;
+        dsp->qmfs_window = qmfs_window_avx2;
+#endif
+        dsp->requant = requant_avx2;
+        dsp->pns_noise = pns_noise_avx2;
+#ifdef MAIN_DEC
+        dsp->ic_predict = ic_predict_avx2;
+#endif
+        dsp->pcm16_mono = pcm16_mono_avx2;
+        dsp->pcm16_stereo = pcm16_stereo_avx2;
+        dsp->adts_sync = adts_sync_avx2;
+    }
+    if (level >= FAAD_CPU_AVX512)
+    {
+        dsp->imdct_pre = imdct_pre_avx512;
+        dsp->imdct_post = imdct_post_avx512;
+#ifdef SBR_DEC
+        dsp->qmfa_window = qmfa_window_avx512;
+        dsp->qmfs_window = qmfs_window_avx512;
+#endif
+        dsp->requant = requant_avx512;
+#ifdef MAIN_DEC
+        dsp->ic_predict = ic_predict_avx512;
+#endif
+        dsp->pcm16_mono = pcm16_mono_avx512;
+        dsp->pcm16_stereo = pcm16_stereo_avx512;
+    }
+}
+
+#else
+
+uint8_t dsp_detect_x86(void)
+{
+    return FAAD_CPU_SCALAR;
+}
+
+void dsp_init_x86(dsp_funcs *dsp, uint8_t level)
+{
+    (void)dsp;
+    (void)level;
+}
+
+#endif
@@ -65,6 +65,10 @@ char *err_msg[] = {
     "No standard extension payload allowed in DRM",
     "PCE shall be the first element in a frame",
     "Bitstream value not allowed by specification",
-	"MAIN prediction not initialised"
+	"MAIN prediction not initialised",
+    "Unable to find LOAS syncword",
+    "Unsupported LATM stream configuration",
+    "LATM frame without a preceding StreamMuxConfig",
+    "LATM audio configuration changed, decoder needs to be initialised again"
 };
 
@@ -41,8 +41,7 @@
 
 #include "filtbank.h"
 #include "syntax.h"
-#include "kbd_win.h"
-#include "sine_win.h"
+#include "tables.h"
 #include "mdct.h"
 
 
@@ -64,42 +63,38 @@ fb_info *filter_bank_init(uint16_t frame_len)
     fb->mdct1024 = faad_mdct_init(2*frame_len_ld);
 #endif
 
-#ifdef ALLOW_SMALL_FRAMELENGTH
-    if (frame_len == 1024)
-    {
-#endif
-        fb->long_window[0]  = sine_long_1024;
-        fb->short_window[0] = sine_short_128;
-        fb->long_window[1]  = kbd_long_1024;
-        fb->short_window[1] = kbd_short_128;
+    fb->long_window[0]  = table_sine_window(frame_len);
+    fb->short_window[0] = table_sine_window(nshort);
+    fb->long_window[1]  = table_kbd_window(frame_len);
+    fb->short_window[1] = table_kbd_window(nshort);
 #ifdef LD_DEC
-        fb->ld_window[0] = sine_mid_512;
-        fb->ld_window[1] = ld_mid_512;
-#endif
-#ifdef ALLOW_SMALL_FRAMELENGTH
-    } else /* (frame_len == 960) */ {
-        fb->long_window[0]  = sine_long_960;
-        fb->short_window[0] = sine_short_120;
-        fb->long_window[1]  = kbd_long_960;
-        fb->short_window[1] = kbd_short_120;
-#ifdef LD_DEC
-        fb->ld_window[0] = sine_mid_480;
-        fb->ld_window[1] = ld_mid_480;
-#endif
-    }
+    fb->ld_window[0] = table_ld_sine_window(frame_len_ld);
+    fb->ld_window[1] = table_ld_window(frame_len_ld);
 #endif
 
     return fb;
 }
 
+/* selects the kernels used by the (I)MDCTs of this filterbank */
+void filter_bank_set_dsp(fb_info *fb, const dsp_funcs *dsp)
+{
+    if (fb == NULL)
+        return;
+
+    if (fb->mdct256 != NULL)
+        fb->mdct256->dsp = dsp;
+    if (fb->mdct2048 != NULL)
+        fb->mdct2048->dsp = dsp;
+#ifdef LD_DEC
+    if (fb->mdct1024 != NULL)
+        fb->mdct1024->dsp = dsp;
+#endif
+}
+
 void filter_bank_end(fb_info *fb)
 {
     if (fb != NULL)
     {
-#ifdef PROFILE
-        printf("FB:                 %I64d cycles\n", fb->cycles);
-#endif
-
         faad_mdct_end(fb->mdct256);
         faad_mdct_end(fb->mdct2048);
 #ifdef LD_DEC
@@ -161,13 +156,15 @@ static INLINE void mdct(fb_info *fb, real_t *in_data, real_t *out_data, uint16_t
 }
 #endif
 
-void ifilter_bank(fb_info *fb, uint8_t window_sequence, uint8_t window_shape,
-                  uint8_t window_shape_prev, real_t *freq_in,
-                  real_t *time_out, real_t *overlap,
-                  uint8_t object_type, uint16_t frame_len)
+/* shared by ifilter_bank() and ifilter_bank_lc(), object_type and frame_len
+   are constants in the latter so the window and length selection folds away */
+static INLINE void ifilter_bank_frame(fb_info *fb, uint8_t window_sequence,
+                                      uint8_t window_shape, uint8_t window_shape_prev,
+                                      real_t *freq_in, real_t *time_out, real_t *overlap,
+                                      real_t *transf_buf, uint8_t object_type,
+                                      uint16_t frame_len)
 {
     int16_t i;
-    ALIGN real_t transf_buf[2*1024] = {0};
 
     const real_t *window_long = NULL;
     const real_t *window_long_prev = NULL;
@@ -180,10 +177,6 @@ void ifilter_bank(fb_info *fb, uint8_t window_sequence, uint8_t window_shape,
 
     uint16_t nflat_ls = (nlong-nshort)/2;
 
-#ifdef PROFILE
-    int64_t count = faad_get_ts();
-#endif
-
     /* select windows of current frame and previous frame (Sine or KBD) */
 #ifdef LD_DEC
     if (object_type == LD)
@@ -323,23 +316,45 @@ void ifilter_bank(fb_info *fb, uint8_t window_sequence, uint8_t window_shape,
         //printf("0x%.8X\n", time_out[i]);
     }
 #endif
+}
 
+void ifilter_bank(fb_info *fb, uint8_t window_sequence, uint8_t window_shape,
+                  uint8_t window_shape_prev, real_t *freq_in,
+                  real_t *time_out, real_t *overlap,
+                  uint8_t object_type, uint16_t frame_len)
+{
+    ALIGN real_t transf_buf[2*1024] = {0};
 
-#ifdef PROFILE
-    count = faad_get_ts() - count;
-    fb->cycles += count;
-#endif
+    ifilter_bank_frame(fb, window_sequence, window_shape, window_shape_prev,
+        freq_in, time_out, overlap, transf_buf, object_type, frame_len);
+}
+
+/* AAC LC with 1024 sample frames, every window sequence fills the whole
+   transform buffer so it is not cleared first */
+void ifilter_bank_lc(fb_info *fb, uint8_t window_sequence, uint8_t window_shape,
+                     uint8_t window_shape_prev, real_t *freq_in,
+                     real_t *time_out, real_t *overlap)
+{
+    ALIGN real_t transf_buf[2*1024];
+
+    ifilter_bank_frame(fb, window_sequence, window_shape, window_shape_prev,
+        freq_in, time_out, overlap, transf_buf, LC, 1024);
 }
 
 
 #ifdef LTP_DEC
 /* only works for LTP -> no overlapping, no short blocks */
+/* the time signal is the 16 bit LTP history in_data scaled by gain, it is
+   built while windowing instead of in a separate pass */
+#define LTP_EST(i) ((real_t)in_data[(i)] * gain)
+
 void filter_bank_ltp(fb_info *fb, uint8_t window_sequence, uint8_t window_shape,
-                     uint8_t window_shape_prev, real_t *in_data, real_t *out_mdct,
-                     uint8_t object_type, uint16_t frame_len)
+                     uint8_t window_shape_prev, const int16_t *in_data, real_t gain,
+                     real_t *out_mdct, uint8_t object_type, uint16_t frame_len)
 {
     int16_t i;
-    ALIGN real_t windowed_buf[2*1024] = {0};
+    /* every sample is written below */
+    ALIGN real_t windowed_buf[2*1024];
 
     const real_t *window_long = NULL;
     const real_t *window_long_prev = NULL;
@@ -372,19 +387,19 @@ void filter_bank_ltp(fb_info *fb, uint8_t window_sequence, uint8_t window_shape,
     case ONLY_LONG_SEQUENCE:
         for (i = nlong-1; i >= 0; i--)
         {
-            windowed_buf[i] = MUL_F(in_data[i], window_long_prev[i]);
-            windowed_buf[i+nlong] = MUL_F(in_data[i+nlong], window_long[nlong-1-i]);
+            windowed_buf[i] = MUL_F(LTP_EST(i), window_long_prev[i]);
+            windowed_buf[i+nlong] = MUL_F(LTP_EST(i+nlong), window_long[nlong-1-i]);
         }
         mdct(fb, windowed_buf, out_mdct, 2*nlong);
         break;
 
     case LONG_START_SEQUENCE:
         for (i = 0; i < nlong; i++)
-            windowed_buf[i] = MUL_F(in_data[i], window_long_prev[i]);
+            windowed_buf[i] = MUL_F(LTP_EST(i), window_long_prev[i]);
         for (i = 0; i < nflat_ls; i++)
-            windowed_buf[i+nlong] = in_data[i+nlong];
+            windowed_buf[i+nlong] = LTP_EST(i+nlong);
         for (i = 0; i < nshort; i++)
-            windowed_buf[i+nlong+nflat_ls] = MUL_F(in_data[i+nlong+nflat_ls], window_short[nshort-1-i]);
+            windowed_buf[i+nlong+nflat_ls] = MUL_F(LTP_EST(i+nlong+nflat_ls), window_short[nshort-1-i]);
         for (i = 0; i < nflat_ls; i++)
             windowed_buf[i+nlong+nflat_ls+nshort] = 0;
         mdct(fb, windowed_buf, out_mdct, 2*nlong);
@@ -394,11 +409,11 @@ void filter_bank_ltp(fb_info *fb, uint8_t window_sequence, uint8_t window_shape,
         for (i = 0; i < nflat_ls; i++)
             windowed_buf[i] = 0;
         for (i = 0; i < nshort; i++)
-            windowed_buf[i+nflat_ls] = MUL_F(in_data[i+nflat_ls], window_short_prev[i]);
+            windowed_buf[i+nflat_ls] = MUL_F(LTP_EST(i+nflat_ls), window_short_prev[i]);
         for (i = 0; i < nflat_ls; i++)
-            windowed_buf[i+nflat_ls+nshort] = in_data[i+nflat_ls+nshort];
+            windowed_buf[i+nflat_ls+nshort] = LTP_EST(i+nflat_ls+nshort);
         for (i = 0; i < nlong; i++)
-            windowed_buf[i+nlong] = MUL_F(in_data[i+nlong], window_long[nlong-1-i]);
+            windowed_buf[i+nlong] = MUL_F(LTP_EST(i+nlong), window_long[nlong-1-i]);
         mdct(fb, windowed_buf, out_mdct, 2*nlong);
         break;
     }
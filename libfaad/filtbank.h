@@ -38,13 +38,15 @@ extern "C" {
 
 fb_info *filter_bank_init(uint16_t frame_len);
 void filter_bank_end(fb_info *fb);
+void filter_bank_set_dsp(fb_info *fb, const dsp_funcs *dsp);
 
 #ifdef LTP_DEC
 void filter_bank_ltp(fb_info *fb,
                      uint8_t window_sequence,
                      uint8_t window_shape,
                      uint8_t window_shape_prev,
-                     real_t *in_data,
+                     const int16_t *in_data,
+                     real_t gain,
                      real_t *out_mdct,
                      uint8_t object_type,
                      uint16_t frame_len);
@@ -54,6 +56,9 @@ void ifilter_bank(fb_info *fb, uint8_t window_sequence, uint8_t window_shape,
                   uint8_t window_shape_prev, real_t *freq_in,
                   real_t *time_out, real_t *overlap,
                   uint8_t object_type, uint16_t frame_len);
+void ifilter_bank_lc(fb_info *fb, uint8_t window_sequence, uint8_t window_shape,
+                     uint8_t window_shape_prev, real_t *freq_in,
+                     real_t *time_out, real_t *overlap);
 
 #ifdef __cplusplus
 }
@@ -73,9 +73,42 @@ static const uint8_t maxCwLen[MAX_CB] = {0, 11, 9, 20, 16, 13, 11, 14, 12, 17, 1
 
 #define segmentWidth(cb)    min(maxCwLen[cb], ics->length_of_longest_codeword)
 
-/* bit-twiddling helpers */
-static const uint8_t  S[] = {1, 2, 4, 8, 16};
-static const uint32_t B[] = {0x55555555, 0x33333333, 0x0F0F0F0F, 0x00FF00FF, 0x0000FFFF};
+/* bit reversal of a byte, words are reversed a byte at a time */
+static const uint8_t rev8[256] =
+{
+    0x00, 0x80, 0x40, 0xC0, 0x20, 0xA0, 0x60, 0xE0,
+    0x10, 0x90, 0x50, 0xD0, 0x30, 0xB0, 0x70, 0xF0,
+    0x08, 0x88, 0x48, 0xC8, 0x28, 0xA8, 0x68, 0xE8,
+    0x18, 0x98, 0x58, 0xD8, 0x38, 0xB8, 0x78, 0xF8,
+    0x04, 0x84, 0x44, 0xC4, 0x24, 0xA4, 0x64, 0xE4,
+    0x14, 0x94, 0x54, 0xD4, 0x34, 0xB4, 0x74, 0xF4,
+    0x0C, 0x8C, 0x4C, 0xCC, 0x2C, 0xAC, 0x6C, 0xEC,
+    0x1C, 0x9C, 0x5C, 0xDC, 0x3C, 0xBC, 0x7C, 0xFC,
+    0x02, 0x82, 0x42, 0xC2, 0x22, 0xA2, 0x62, 0xE2,
+    0x12, 0x92, 0x52, 0xD2, 0x32, 0xB2, 0x72, 0xF2,
+    0x0A, 0x8A, 0x4A, 0xCA, 0x2A, 0xAA, 0x6A, 0xEA,
+    0x1A, 0x9A, 0x5A, 0xDA, 0x3A, 0xBA, 0x7A, 0xFA,
+    0x06, 0x86, 0x46, 0xC6, 0x26, 0xA6, 0x66, 0xE6,
+    0x16, 0x96, 0x56, 0xD6, 0x36, 0xB6, 0x76, 0xF6,
+    0x0E, 0x8E, 0x4E, 0xCE, 0x2E, 0xAE, 0x6E, 0xEE,
+    0x1E, 0x9E, 0x5E, 0xDE, 0x3E, 0xBE, 0x7E, 0xFE,
+    0x01, 0x81, 0x41, 0xC1, 0x21, 0xA1, 0x61, 0xE1,
+    0x11, 0x91, 0x51, 0xD1, 0x31, 0xB1, 0x71, 0xF1,
+    0x09, 0x89, 0x49, 0xC9, 0x29, 0xA9, 0x69, 0xE9,
+    0x19, 0x99, 0x59, 0xD9, 0x39, 0xB9, 0x79, 0xF9,
+    0x05, 0x85, 0x45, 0xC5, 0x25, 0xA5, 0x65, 0xE5,
+    0x15, 0x95, 0x55, 0xD5, 0x35, 0xB5, 0x75, 0xF5,
+    0x0D, 0x8D, 0x4D, 0xCD, 0x2D, 0xAD, 0x6D, 0xED,
+    0x1D, 0x9D, 0x5D, 0xDD, 0x3D, 0xBD, 0x7D, 0xFD,
+    0x03, 0x83, 0x43, 0xC3, 0x23, 0xA3, 0x63, 0xE3,
+    0x13, 0x93, 0x53, 0xD3, 0x33, 0xB3, 0x73, 0xF3,
+    0x0B, 0x8B, 0x4B, 0xCB, 0x2B, 0xAB, 0x6B, 0xEB,
+    0x1B, 0x9B, 0x5B, 0xDB, 0x3B, 0xBB, 0x7B, 0xFB,
+    0x07, 0x87, 0x47, 0xC7, 0x27, 0xA7, 0x67, 0xE7,
+    0x17, 0x97, 0x57, 0xD7, 0x37, 0xB7, 0x77, 0xF7,
+    0x0F, 0x8F, 0x4F, 0xCF, 0x2F, 0xAF, 0x6F, 0xEF,
+    0x1F, 0x9F, 0x5F, 0xDF, 0x3F, 0xBF, 0x7F, 0xFF
+};
 
 typedef struct
 {
@@ -85,21 +118,18 @@ typedef struct
     bits_t      bits;
 } codeword_t;
 
+static INLINE uint32_t reverse_word(uint32_t v)
+{
+    return ((uint32_t)rev8[v & 0xFF] << 24) | ((uint32_t)rev8[(v >> 8) & 0xFF] << 16) |
+        ((uint32_t)rev8[(v >> 16) & 0xFF] << 8) | (uint32_t)rev8[v >> 24];
+}
+
 /* rewind and reverse */
 /* 32 bit version */
 static uint32_t rewrev_word(uint32_t v, const uint8_t len)
 {
-    /* 32 bit reverse */
-    v = ((v >> S[0]) & B[0]) | ((v << S[0]) & ~B[0]);
-    v = ((v >> S[1]) & B[1]) | ((v << S[1]) & ~B[1]);
-    v = ((v >> S[2]) & B[2]) | ((v << S[2]) & ~B[2]);
-    v = ((v >> S[3]) & B[3]) | ((v << S[3]) & ~B[3]);
-    v = ((v >> S[4]) & B[4]) | ((v << S[4]) & ~B[4]);
-
     /* shift off low bits */
-    v >>= (32 - len);
-
-    return v;
+    return reverse_word(v) >> (32 - len);
 }
 
 /* 64 bit version */
@@ -110,21 +140,8 @@ static void rewrev_lword(uint32_t *hi, uint32_t *lo, const uint8_t len)
         *lo = rewrev_word(*lo, len);
     } else
     {
-        uint32_t t = *hi, v = *lo;
-
-        /* double 32 bit reverse */
-        v = ((v >> S[0]) & B[0]) | ((v << S[0]) & ~B[0]);
-        t = ((t >> S[0]) & B[0]) | ((t << S[0]) & ~B[0]);
-        v = ((v >> S[1]) & B[1]) | ((v << S[1]) & ~B[1]);
-        t = ((t >> S[1]) & B[1]) | ((t << S[1]) & ~B[1]);
-        v = ((v >> S[2]) & B[2]) | ((v << S[2]) & ~B[2]);
-        t = ((t >> S[2]) & B[2]) | ((t << S[2]) & ~B[2]);
-        v = ((v >> S[3]) & B[3]) | ((v << S[3]) & ~B[3]);
-        t = ((t >> S[3]) & B[3]) | ((t << S[3]) & ~B[3]);
-        v = ((v >> S[4]) & B[4]) | ((v << S[4]) & ~B[4]);
-        t = ((t >> S[4]) & B[4]) | ((t << S[4]) & ~B[4]);
-
-        /* last 32<>32 bit swap is implicit below */
+        /* double 32 bit reverse, the 32<>32 bit swap is implicit below */
+        uint32_t t = reverse_word(*hi), v = reverse_word(*lo);
 
         /* shift off low bits (this is really only one 64 bit shift) */
         *lo = (t >> (64 - len)) | (v << (len - 32));
@@ -232,6 +249,7 @@ uint8_t reordered_spectral_data(NeAACDecStruct *hDecoder, ic_stream *ics,
     const uint16_t sp_data_len = ics->length_of_reordered_spectral_data;
 
     const uint8_t *PreSortCb;
+    uint32_t cb_used = 0;
 
     /* no data (e.g. silence) */
     if (sp_data_len == 0)
@@ -266,98 +284,105 @@ uint8_t reordered_spectral_data(NeAACDecStruct *hDecoder, ic_stream *ics,
         last_CB = NUM_CB;
     }
 
+    /* codebooks used in this frame, the sections cover 0..max_sfb of every
+       group so sfb_cb gives the codebook of a band without a section search */
+    for (g = 0; g < ics->num_window_groups; g++)
+    {
+        for (sfb = 0; sfb < ics->max_sfb; sfb++)
+            cb_used |= (uint32_t)1 << ics->sfb_cb[g][sfb];
+    }
+
     /* step 1: decode PCW's (set 0), and stuff data in easier-to-use format */
     for (sortloop = 0; sortloop < last_CB; sortloop++)
     {
         /* select codebook to process this pass */
         this_CB = PreSortCb[sortloop];
 
+        /* skip passes without any codeword */
+        if (!(cb_used & ((this_CB < ESC_HCB) ? (3u << this_CB) : (1u << this_CB))))
+            continue;
+
         /* loop over sfbs */
         for (sfb = 0; sfb < ics->max_sfb; sfb++)
         {
+            const uint16_t sfb_width = min(ics->swb_offset[sfb+1], ics->swb_offset_max) - ics->swb_offset[sfb];
+
             /* loop over all in this sfb, 4 lines per loop */
-            for (w_idx = 0; 4*w_idx < (min(ics->swb_offset[sfb+1], ics->swb_offset_max) - ics->swb_offset[sfb]); w_idx++)
+            for (w_idx = 0; 4*w_idx < sfb_width; w_idx++)
             {
                 for(g = 0; g < ics->num_window_groups; g++)
                 {
-                    for (i = 0; i < ics->num_sec[g]; i++)
+                    /* check whether codebook used here is the one we want to process */
+                    this_sec_CB = ics->sfb_cb[g][sfb];
+
+                    if (is_good_cb(this_CB, this_sec_CB))
                     {
-                        /* check whether sfb used here is the one we want to process */
-                        if ((ics->sect_start[g][i] <= sfb) && (ics->sect_end[g][i] > sfb))
+                        /* precalculate some stuff */
+                        uint16_t sect_sfb_size = ics->sect_sfb_offset[g][sfb+1] - ics->sect_sfb_offset[g][sfb];
+                        uint8_t inc = (this_sec_CB < FIRST_PAIR_HCB) ? QUAD_LEN : PAIR_LEN;
+                        uint16_t group_cws_count = (4*ics->window_group_length[g])/inc;
+                        uint8_t segwidth = segmentWidth(this_sec_CB);
+                        uint16_t cws;
+
+                        /* read codewords until end of sfb or end of window group (shouldn't only 1 trigger?) */
+                        for (cws = 0; (cws < group_cws_count) && ((cws + w_idx*group_cws_count) < sect_sfb_size); cws++)
                         {
-                            /* check whether codebook used here is the one we want to process */
-                            this_sec_CB = ics->sect_cb[g][i];
+                            uint16_t sp = sp_offset[g] + ics->sect_sfb_offset[g][sfb] + inc * (cws + w_idx*group_cws_count);
 
-                            if (is_good_cb(this_CB, this_sec_CB))
+                            /* read and decode PCW */
+                            if (!PCWs_done)
                             {
-                                /* precalculate some stuff */
-                                uint16_t sect_sfb_size = ics->sect_sfb_offset[g][sfb+1] - ics->sect_sfb_offset[g][sfb];
-                                uint8_t inc = (this_sec_CB < FIRST_PAIR_HCB) ? QUAD_LEN : PAIR_LEN;
-                                uint16_t group_cws_count = (4*ics->window_group_length[g])/inc;
-                                uint8_t segwidth = segmentWidth(this_sec_CB);
-                                uint16_t cws;
-
-                                /* read codewords until end of sfb or end of window group (shouldn't only 1 trigger?) */
-                                for (cws = 0; (cws < group_cws_count) && ((cws + w_idx*group_cws_count) < sect_sfb_size); cws++)
+                                /* read in normal segments */
+                                if (bitsread + segwidth <= sp_data_len)
                                 {
-                                    uint16_t sp = sp_offset[g] + ics->sect_sfb_offset[g][sfb] + inc * (cws + w_idx*group_cws_count);
+                                    read_segment(&segment[numberOfSegments], segwidth, ld);
+                                    bitsread += segwidth;
 
-                                    /* read and decode PCW */
-                                    if (!PCWs_done)
-                                    {
-                                        /* read in normal segments */
-                                        if (bitsread + segwidth <= sp_data_len)
-                                        {
-                                            read_segment(&segment[numberOfSegments], segwidth, ld);
-                                            bitsread += segwidth;
+                                    huffman_spectral_data_2(this_sec_CB, &segment[numberOfSegments], &spectral_data[sp]);
 
-                                            huffman_spectral_data_2(this_sec_CB, &segment[numberOfSegments], &spectral_data[sp]);
+                                    /* keep leftover bits */
+                                    rewrev_bits(&segment[numberOfSegments]);
 
-                                            /* keep leftover bits */
-                                            rewrev_bits(&segment[numberOfSegments]);
+                                    numberOfSegments++;
+                                } else {
+                                    /* remaining stuff after last segment, we unfortunately couldn't read
+                                       this in earlier because it might not fit in 64 bits. since we already
+                                       decoded (and removed) the PCW it is now guaranteed to fit */
+                                    if (bitsread < sp_data_len)
+                                    {
+                                        const uint8_t additional_bits = sp_data_len - bitsread;
+
+                                        read_segment(&segment[numberOfSegments], additional_bits, ld);
+                                        segment[numberOfSegments].len += segment[numberOfSegments-1].len;
+                                        rewrev_bits(&segment[numberOfSegments]);
 
-                                            numberOfSegments++;
+                                        if (segment[numberOfSegments-1].len > 32)
+                                        {
+                                            segment[numberOfSegments-1].bufb = segment[numberOfSegments].bufb +
+                                                showbits_hcr(&segment[numberOfSegments-1], segment[numberOfSegments-1].len - 32);
+                                            segment[numberOfSegments-1].bufa = segment[numberOfSegments].bufa +
+                                                showbits_hcr(&segment[numberOfSegments-1], 32);
                                         } else {
-                                            /* remaining stuff after last segment, we unfortunately couldn't read
-                                               this in earlier because it might not fit in 64 bits. since we already
-                                               decoded (and removed) the PCW it is now guaranteed to fit */
-                                            if (bitsread < sp_data_len)
-                                            {
-                                                const uint8_t additional_bits = sp_data_len - bitsread;
-
-                                                read_segment(&segment[numberOfSegments], additional_bits, ld);
-                                                segment[numberOfSegments].len += segment[numberOfSegments-1].len;
-                                                rewrev_bits(&segment[numberOfSegments]);
-
-                                                if (segment[numberOfSegments-1].len > 32)
-                                                {
-                                                    segment[numberOfSegments-1].bufb = segment[numberOfSegments].bufb +
-                                                        showbits_hcr(&segment[numberOfSegments-1], segment[numberOfSegments-1].len - 32);
-                                                    segment[numberOfSegments-1].bufa = segment[numberOfSegments].bufa +
-                                                        showbits_hcr(&segment[numberOfSegments-1], 32);
-                                                } else {
-                                                    segment[numberOfSegments-1].bufa = segment[numberOfSegments].bufa +
-                                                        showbits_hcr(&segment[numberOfSegments-1], segment[numberOfSegments-1].len);
-                                                    segment[numberOfSegments-1].bufb = segment[numberOfSegments].bufb;
-                                                }
-                                                segment[numberOfSegments-1].len += additional_bits;
-                                            }
-                                            bitsread = sp_data_len;
-                                            PCWs_done = 1;
-
-                                            fill_in_codeword(codeword, 0, sp, this_sec_CB);
+                                            segment[numberOfSegments-1].bufa = segment[numberOfSegments].bufa +
+                                                showbits_hcr(&segment[numberOfSegments-1], segment[numberOfSegments-1].len);
+                                            segment[numberOfSegments-1].bufb = segment[numberOfSegments].bufb;
                                         }
-                                    } else {
-                                        fill_in_codeword(codeword, numberOfCodewords - numberOfSegments, sp, this_sec_CB);
+                                        segment[numberOfSegments-1].len += additional_bits;
                                     }
-                                    numberOfCodewords++;
+                                    bitsread = sp_data_len;
+                                    PCWs_done = 1;
+
+                                    fill_in_codeword(codeword, 0, sp, this_sec_CB);
                                 }
+                            } else {
+                                fill_in_codeword(codeword, numberOfCodewords - numberOfSegments, sp, this_sec_CB);
                             }
+                            numberOfCodewords++;
                         }
                     }
-                 }
-             }
-         }
+                }
+            }
+        }
     }
 
     if (numberOfSegments == 0)
@@ -376,9 +401,12 @@ uint8_t reordered_spectral_data(NeAACDecStruct *hDecoder, ic_stream *ics,
 
             for (codewordBase = 0; codewordBase < numberOfSegments; codewordBase++)
             {
-                const uint16_t segment_idx = (trial + codewordBase) % numberOfSegments;
+                uint16_t segment_idx = trial + codewordBase;
                 const uint16_t codeword_idx = codewordBase + set*numberOfSegments - numberOfSegments;
 
+                if (segment_idx >= numberOfSegments)
+                    segment_idx -= numberOfSegments;
+
                 /* data up */
                 if (codeword_idx >= numberOfCodewords - numberOfSegments) break;
 
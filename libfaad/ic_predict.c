@@ -80,7 +80,8 @@ static float32_t inv_quant_pred(int16_t q)
     return x;
 }
 
-static void ic_predict(pred_state *state, real_t input, real_t *output, uint8_t pred)
+static void ic_predict(pred_state *state, uint16_t bin, real_t input, real_t *output,
+                       uint8_t pred)
 {
     uint16_t tmp;
     int16_t i, j;
@@ -93,16 +94,16 @@ static void ic_predict(pred_state *state, real_t input, real_t *output, uint8_t
     real_t COR[2];
     real_t VAR[2];
 
-    r[0] = inv_quant_pred(state->r[0]);
-    r[1] = inv_quant_pred(state->r[1]);
-    COR[0] = inv_quant_pred(state->COR[0]);
-    COR[1] = inv_quant_pred(state->COR[1]);
-    VAR[0] = inv_quant_pred(state->VAR[0]);
-    VAR[1] = inv_quant_pred(state->VAR[1]);
+    r[0] = inv_quant_pred(state->r[0][bin]);
+    r[1] = inv_quant_pred(state->r[1][bin]);
+    COR[0] = inv_quant_pred(state->COR[0][bin]);
+    COR[1] = inv_quant_pred(state->COR[1][bin]);
+    VAR[0] = inv_quant_pred(state->VAR[0][bin]);
+    VAR[1] = inv_quant_pred(state->VAR[1][bin]);
 
 
 #if 1
-    tmp = state->VAR[0];
+    tmp = state->VAR[0][bin];
     j = (tmp >> 7);
     i = tmp & 0x7f;
     if (j >= 128)
@@ -133,7 +134,7 @@ static void ic_predict(pred_state *state, real_t input, real_t *output, uint8_t
     if (pred)
     {
 #if 1
-        tmp = state->VAR[1];
+        tmp = state->VAR[1][bin];
         j = (tmp >> 7);
         i = tmp & 0x7f;
         if (j >= 128)
@@ -177,22 +178,33 @@ static void ic_predict(pred_state *state, real_t input, real_t *output, uint8_t
     r[1] = A * (r[0]-dr1);
     r[0] = A * e0;
 
-    state->r[0] = quant_pred(r[0]);
-    state->r[1] = quant_pred(r[1]);
-    state->COR[0] = quant_pred(COR[0]);
-    state->COR[1] = quant_pred(COR[1]);
-    state->VAR[0] = quant_pred(VAR[0]);
-    state->VAR[1] = quant_pred(VAR[1]);
+    state->r[0][bin] = quant_pred(r[0]);
+    state->r[1][bin] = quant_pred(r[1]);
+    state->COR[0][bin] = quant_pred(COR[0]);
+    state->COR[1][bin] = quant_pred(COR[1]);
+    state->VAR[0][bin] = quant_pred(VAR[0]);
+    state->VAR[1][bin] = quant_pred(VAR[1]);
 }
 
-static void reset_pred_state(pred_state *state)
+/* reference version of dsp->ic_predict(), runs the predictors of the
+   bins low..high-1 */
+void ic_predict_c(pred_state *state, real_t *spec, uint16_t low, uint16_t high,
+                  uint8_t pred)
 {
-    state->r[0]   = 0;
-    state->r[1]   = 0;
-    state->COR[0] = 0;
-    state->COR[1] = 0;
-    state->VAR[0] = 0x3F80;
-    state->VAR[1] = 0x3F80;
+    uint16_t bin;
+
+    for (bin = low; bin < high; bin++)
+        ic_predict(state, bin, spec[bin], &spec[bin], pred);
+}
+
+static void reset_pred_state(pred_state *state, uint16_t bin)
+{
+    state->r[0][bin]   = 0;
+    state->r[1][bin]   = 0;
+    state->COR[0][bin] = 0;
+    state->COR[1][bin] = 0;
+    state->VAR[0][bin] = 0x3F80;
+    state->VAR[1][bin] = 0x3F80;
 }
 
 void pns_reset_pred_state(ic_stream *ics, pred_state *state)
@@ -216,7 +228,7 @@ void pns_reset_pred_state(ic_stream *ics, pred_state *state)
                     offs2 = min(ics->swb_offset[sfb+1], ics->swb_offset_max);
 
                     for (i = offs; i < offs2; i++)
-                        reset_pred_state(&state[i]);
+                        reset_pred_state(state, i);
                 }
             }
         }
@@ -228,30 +240,40 @@ void reset_all_predictors(pred_state *state, uint16_t frame_len)
     uint16_t i;
 
     for (i = 0; i < frame_len; i++)
-        reset_pred_state(&state[i]);
+        reset_pred_state(state, i);
 }
 
 /* intra channel prediction */
 void ic_prediction(ic_stream *ics, real_t *spec, pred_state *state,
-                   uint16_t frame_len, uint8_t sf_index)
+                   uint16_t frame_len, uint8_t sf_index, const dsp_funcs *dsp)
 {
-    uint8_t sfb;
+    uint8_t sfb, end, pred, num_sfb;
     uint16_t bin;
 
     if (ics->window_sequence == EIGHT_SHORT_SEQUENCE)
     {
         reset_all_predictors(state, frame_len);
     } else {
-        for (sfb = 0; sfb < max_pred_sfb(sf_index); sfb++)
+        num_sfb = max_pred_sfb(sf_index);
+
+        /* neighbouring bands with the same prediction_used flag are run
+           in one go, the bins are independent of each other */
+        for (sfb = 0; sfb < num_sfb; sfb = end)
         {
-            uint16_t low  = ics->swb_offset[sfb];
-            uint16_t high = min(ics->swb_offset[sfb+1], ics->swb_offset_max);
+            uint16_t low, high;
 
-            for (bin = low; bin < high; bin++)
+            pred = (ics->predictor_data_present && ics->pred.prediction_used[sfb]);
+            for (end = sfb + 1; end < num_sfb; end++)
             {
-                ic_predict(&state[bin], spec[bin], &spec[bin],
-                    (ics->predictor_data_present && ics->pred.prediction_used[sfb]));
+                if ((ics->predictor_data_present && ics->pred.prediction_used[end]) != pred)
+                    break;
             }
+
+            low  = ics->swb_offset[sfb];
+            high = min(ics->swb_offset[end], ics->swb_offset_max);
+
+            if (low < high)
+                dsp->ic_predict(state, spec, low, high, pred);
         }
 
         if (ics->predictor_data_present)
@@ -261,7 +283,7 @@ void ic_prediction(ic_stream *ics, real_t *spec, pred_state *state,
                 for (bin = ics->pred.predictor_reset_group_number - 1;
                      bin < frame_len; bin += 30)
                 {
-                    reset_pred_state(&state[bin]);
+                    reset_pred_state(state, bin);
                 }
             }
         }
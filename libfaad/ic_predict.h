@@ -44,7 +44,9 @@ extern "C" {
 void pns_reset_pred_state(ic_stream *ics, pred_state *state);
 void reset_all_predictors(pred_state *state, uint16_t frame_len);
 void ic_prediction(ic_stream *ics, real_t *spec, pred_state *state,
-                   uint16_t frame_len, uint8_t sf_index);
+                   uint16_t frame_len, uint8_t sf_index, const dsp_funcs *dsp);
+void ic_predict_c(pred_state *state, real_t *spec, uint16_t low, uint16_t high,
+                  uint8_t pred);
 
 ALIGN static const real_t mnt_table[128] = {
     COEF_CONST(0.9531250000), COEF_CONST(0.9453125000),
@@ -36,13 +36,11 @@ extern "C" {
 #endif
 
 
-/* !!!DON'T CHANGE IQ_TABLE_SIZE!!! */
+/* IQ_TABLE_SIZE is defined in tables.h */
 
 
 #ifndef FIXED_POINT
 
-#define IQ_TABLE_SIZE 8192
-
 #ifdef _MSC_VER
 #pragma warning(disable:4305)
 #pragma warning(disable:4244)
@@ -8246,12 +8244,6 @@ ALIGN static const real_t iq_table[IQ_TABLE_SIZE] =
 
 #else
 
-#ifdef BIG_IQ_TABLE
-#define IQ_TABLE_SIZE  8192
-#else
-#define IQ_TABLE_SIZE  1026
-#endif
-
 ALIGN static const real_t iq_table[IQ_TABLE_SIZE] =
 {
     REAL_CONST(0.0),
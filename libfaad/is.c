@@ -46,10 +46,11 @@ static real_t pow05_table[] = {
 };
 #endif
 
-void is_decode(ic_stream *ics, ic_stream *icsr, real_t *l_spec, real_t *r_spec,
-               uint16_t frame_len)
+/* intensity stereo decoding of scalefactor band sfb in window group g,
+   base is the offset of the window in the spectrum */
+void is_decode_band(ic_stream *ics, ic_stream *icsr, real_t *l_spec, real_t *r_spec,
+                    uint8_t g, uint8_t sfb, uint16_t base)
 {
-    uint8_t g, sfb, b;
     uint16_t i;
 #ifndef FIXED_POINT
     real_t scale;
@@ -57,51 +58,59 @@ void is_decode(ic_stream *ics, ic_stream *icsr, real_t *l_spec, real_t *r_spec,
     int32_t exp, frac;
 #endif
 
-    uint16_t nshort = frame_len/8;
-    uint8_t group = 0;
+    if (!is_intensity(icsr, g, sfb))
+        return;
 
-    for (g = 0; g < icsr->num_window_groups; g++)
-    {
-        /* Do intensity stereo decoding */
-        for (b = 0; b < icsr->window_group_length[g]; b++)
-        {
-            for (sfb = 0; sfb < icsr->max_sfb; sfb++)
-            {
-                if (is_intensity(icsr, g, sfb))
-                {
 #ifdef MAIN_DEC
-                    /* For scalefactor bands coded in intensity stereo the
-                       corresponding predictors in the right channel are
-                       switched to "off".
-                     */
-                    ics->pred.prediction_used[sfb] = 0;
-                    icsr->pred.prediction_used[sfb] = 0;
+    /* For scalefactor bands coded in intensity stereo the
+       corresponding predictors in the right channel are
+       switched to "off".
+     */
+    ics->pred.prediction_used[sfb] = 0;
+    icsr->pred.prediction_used[sfb] = 0;
 #endif
 
 #ifndef FIXED_POINT
-                    scale = (real_t)pow(0.5, (0.25*icsr->scale_factors[g][sfb]));
+    scale = (real_t)pow(0.5, (0.25*icsr->scale_factors[g][sfb]));
 #else
-                    exp = icsr->scale_factors[g][sfb] >> 2;
-                    frac = icsr->scale_factors[g][sfb] & 3;
+    exp = icsr->scale_factors[g][sfb] >> 2;
+    frac = icsr->scale_factors[g][sfb] & 3;
 #endif
 
-                    /* Scale from left to right channel,
-                       do not touch left channel */
-                    for (i = icsr->swb_offset[sfb]; i < min(icsr->swb_offset[sfb+1], ics->swb_offset_max); i++)
-                    {
+    /* Scale from left to right channel,
+       do not touch left channel */
+    for (i = icsr->swb_offset[sfb]; i < min(icsr->swb_offset[sfb+1], ics->swb_offset_max); i++)
+    {
 #ifndef FIXED_POINT
-                        r_spec[(group*nshort)+i] = MUL_R(l_spec[(group*nshort)+i], scale);
+        r_spec[base+i] = MUL_R(l_spec[base+i], scale);
 #else
-                        if (exp < 0)
-                            r_spec[(group*nshort)+i] = l_spec[(group*nshort)+i] << -exp;
-                        else
-                            r_spec[(group*nshort)+i] = l_spec[(group*nshort)+i] >> exp;
-                        r_spec[(group*nshort)+i] = MUL_C(r_spec[(group*nshort)+i], pow05_table[frac + 3]);
+        if (exp < 0)
+            r_spec[base+i] = l_spec[base+i] << -exp;
+        else
+            r_spec[base+i] = l_spec[base+i] >> exp;
+        r_spec[base+i] = MUL_C(r_spec[base+i], pow05_table[frac + 3]);
 #endif
-                        if (is_intensity(icsr, g, sfb) != invert_intensity(ics, g, sfb))
-                            r_spec[(group*nshort)+i] = -r_spec[(group*nshort)+i];
-                    }
-                }
+        if (is_intensity(icsr, g, sfb) != invert_intensity(ics, g, sfb))
+            r_spec[base+i] = -r_spec[base+i];
+    }
+}
+
+void is_decode(ic_stream *ics, ic_stream *icsr, real_t *l_spec, real_t *r_spec,
+               uint16_t frame_len)
+{
+    uint8_t g, sfb, b;
+
+    uint16_t nshort = frame_len/8;
+    uint8_t group = 0;
+
+    for (g = 0; g < icsr->num_window_groups; g++)
+    {
+        /* Do intensity stereo decoding */
+        for (b = 0; b < icsr->window_group_length[g]; b++)
+        {
+            for (sfb = 0; sfb < icsr->max_sfb; sfb++)
+            {
+                is_decode_band(ics, icsr, l_spec, r_spec, g, sfb, group*nshort);
             }
             group++;
         }
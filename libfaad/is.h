@@ -37,6 +37,8 @@ extern "C" {
 
 #include "syntax.h"
 
+void is_decode_band(ic_stream *ics, ic_stream *icsr, real_t *l_spec, real_t *r_spec,
+                    uint8_t g, uint8_t sfb, uint16_t base);
 void is_decode(ic_stream *ics, ic_stream *icsr, real_t *l_spec, real_t *r_spec,
                uint16_t frame_len);
 
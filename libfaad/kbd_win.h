@@ -1068,7 +1068,8 @@ ALIGN static const real_t kbd_long_1024[] =
     FRAC_CONST(0.99999995720387)
 };
 
-#ifdef ALLOW_SMALL_FRAMELENGTH
+/* RUNTIME_TABLES computes the 960 and 120 windows, see tables.h */
+#if defined(ALLOW_SMALL_FRAMELENGTH) && !defined(RUNTIME_TABLES)
 ALIGN static const real_t kbd_long_960[] = {
     FRAC_CONST(0.0003021562530949),
     FRAC_CONST(0.0004452267024786),
@@ -2165,7 +2166,7 @@ ALIGN static const real_t kbd_short_128[] =
     FRAC_CONST(0.99999999904096815)
 };
 
-#ifdef ALLOW_SMALL_FRAMELENGTH
+#if defined(ALLOW_SMALL_FRAMELENGTH) && !defined(RUNTIME_TABLES)
 ALIGN static const real_t kbd_short_120[] =
 {
     FRAC_CONST(0.0000452320086910),
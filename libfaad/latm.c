@@ -0,0 +1,726 @@
+/*
+** FAAD2 - Freeware Advanced Audio (AAC) Decoder including SBR decoding
+** Copyright (C) 2003-2005 M. Bakker, Nero AG, http://www.nero.com
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+**
+** Any non-GPL usage of this software or parts of this software is strictly
+** forbidden.
+**
+** The "appropriate copyright message" mentioned in section 2c of the GPLv2
+** must read: "Code from FAAD2 is copyright (c) Nero AG, www.nero.com"
+**
+** Commercial non-GPL licensing of this software is possible.
+** For more info contact Nero AG through Mpeg4AAClicense@nero.com.
+**
+** $Id$
+**/
+
+/* LATM/LOAS demultiplexing, see latm.h */
+
+#include "common.h"
+#include "structs.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bits.h"
+#include "mp4.h"
+#include "latm.h"
+
+/* largest block handed to a single loas_sync_c() call */
+#define LOAS_SCAN_BLOCK 0x40000000UL
+
+
+/* returns the position of the first possible syncword (0x2B7) that lies
+   completely within the n bytes at p, or n when there is none */
+uint32_t loas_sync_c(const uint8_t *p, uint32_t n)
+{
+    const uint8_t *q = p;
+    const uint8_t *end = p + n;
+
+    while (end - q >= 2)
+    {
+        q = (const uint8_t*)memchr(q, 0x56, end - q - 1);
+        if (q == NULL)
+            break;
+        if ((q[1] & 0xE0) == 0xE0)
+            return (uint32_t)(q - p);
+        q++;
+    }
+
+    return n;
+}
+
+/* returns the size of the LOAS frame at p including its header, or 0 when
+   p does not start one. LOAS_HEADER_SIZE bytes are read. */
+uint32_t loas_frame_length(const uint8_t *p)
+{
+    uint32_t len;
+
+    if ((p[0] != 0x56) || ((p[1] & 0xE0) != 0xE0))
+        return 0;
+
+    len = ((uint32_t)(p[1] & 0x1F) << 8) | p[2];
+    if (len == 0)
+        return 0;
+
+    return LOAS_HEADER_SIZE + len;
+}
+
+/* the offset of the first LOAS frame that is followed by another one, see
+   adts_find_sync() */
+long loas_find_sync(const uint8_t *buffer, unsigned long size)
+{
+    unsigned long pos = 0;
+
+    while (size - pos >= LOAS_HEADER_SIZE)
+    {
+        uint32_t n = (uint32_t)min(size - pos, LOAS_SCAN_BLOCK);
+        uint32_t i = loas_sync_c(buffer + pos, n);
+        uint32_t len;
+
+        if (i == n)
+        {
+            /* the last byte may pair with the first one of the next block */
+            pos += n - 1;
+            continue;
+        }
+        pos += i;
+
+        if (size - pos < LOAS_HEADER_SIZE)
+            break;
+        len = loas_frame_length(buffer + pos);
+        if (len != 0 && size - pos >= len + LOAS_HEADER_SIZE &&
+            loas_frame_length(buffer + pos + len) != 0)
+        {
+            return (long)pos;
+        }
+        pos++;
+    }
+
+    return -1;
+}
+
+latm_mux *latm_init(void)
+{
+    latm_mux *mux = (latm_mux*)faad_malloc(sizeof(latm_mux));
+
+    if (mux != NULL)
+        memset(mux, 0, sizeof(latm_mux));
+
+    return mux;
+}
+
+void latm_end(latm_mux *mux)
+{
+    if (mux)
+        faad_free(mux);
+}
+
+/* drops the access units not handed out yet, the StreamMuxConfig is kept */
+void latm_reset(latm_mux *mux)
+{
+    uint8_t i;
+
+    for (i = 0; i < LATM_MAX_STREAMS; i++)
+    {
+        mux->stream[i].payload_used = 0;
+        mux->stream[i].aus = 0;
+        mux->stream[i].au_next = 0;
+        mux->stream[i].au_open = 0;
+    }
+}
+
+/* copies bits from bit position pos of src to dst, the last byte is
+   padded with zero bits */
+static void latm_copy_bits(uint8_t *dst, const uint8_t *src, uint32_t pos,
+                           uint32_t bits)
+{
+    uint32_t i, bytes = bits >> 3;
+    uint8_t rest = bits & 7;
+    uint8_t shift = pos & 7;
+
+    src += pos >> 3;
+    if (shift == 0)
+    {
+        memcpy(dst, src, bytes);
+        if (rest)
+            dst[bytes] = src[bytes] & (uint8_t)(0xFF00 >> rest);
+        return;
+    }
+
+    for (i = 0; i < bytes; i++)
+        dst[i] = (uint8_t)((src[i] << shift) | (src[i+1] >> (8 - shift)));
+    if (rest)
+    {
+        uint32_t v = (uint32_t)src[bytes] << shift;
+        if (shift + rest > 8)
+            v |= src[bytes+1] >> (8 - shift);
+        dst[bytes] = (uint8_t)v & (uint8_t)(0xFF00 >> rest);
+    }
+}
+
+static void latm_skip_bits(bitfile *ld, uint32_t bits)
+{
+    faad_resetbits(ld, faad_get_processed_bits(ld) + bits);
+}
+
+static uint32_t latm_get_value(bitfile *ld)
+{
+    uint8_t i, bytes_for_value = (uint8_t)faad_getbits(ld, 2);
+    uint32_t value = 0;
+
+    for (i = 0; i <= bytes_for_value; i++)
+        value = (value << 8) | faad_getbits(ld, 8);
+
+    return value;
+}
+
+static uint8_t latm_stream_config(latm_mux *mux, bitfile *ld, const uint8_t *frame,
+                                  uint8_t prog, uint8_t lay)
+{
+    latm_stream *s = &mux->stream[mux->streams];
+    uint8_t asc[LATM_MAX_ASC_BYTES];
+    uint32_t asc_bits;
+    uint8_t object_type;
+    uint8_t use_same_config = 0;
+
+    if (prog != 0 || lay != 0)
+        use_same_config = (uint8_t)faad_get1bit(ld);
+
+    if (use_same_config)
+    {
+        memcpy(asc, s[-1].asc, sizeof(asc));
+        asc_bits = s[-1].asc_bits;
+        object_type = s[-1].object_type;
+    } else {
+        mp4AudioSpecificConfig mp4ASC;
+        program_config pce;
+        uint32_t asc_len = 0, start;
+
+        if (mux->version)
+            asc_len = latm_get_value(ld);
+
+        start = faad_get_processed_bits(ld);
+        if (AudioSpecificConfigFromBitfile(ld, &mp4ASC, &pce, 0, 1) < 0)
+            return 35;
+        asc_bits = faad_get_processed_bits(ld) - start;
+        if (asc_bits > LATM_MAX_ASC_BYTES*8)
+            return 35;
+
+        memset(asc, 0, sizeof(asc));
+        latm_copy_bits(asc, frame, start, asc_bits);
+        object_type = mp4ASC.objectTypeIndex;
+
+        /* fill bits */
+        if (asc_len > asc_bits)
+            latm_skip_bits(ld, asc_len - asc_bits);
+    }
+
+    /* a stream that is new or has a different config needs its decoder
+       set up again */
+    if (s->asc_version == 0 || s->asc_bits != asc_bits ||
+        memcmp(s->asc, asc, sizeof(asc)) != 0)
+    {
+        memcpy(s->asc, asc, sizeof(asc));
+        s->asc_bits = asc_bits;
+        s->asc_version = ++mux->asc_versions;
+        s->au_open = 0;
+    }
+    s->object_type = object_type;
+    s->program = prog;
+    s->layer = lay;
+
+    s->frame_length_type = (uint8_t)faad_getbits(ld, 3);
+    switch (s->frame_length_type)
+    {
+    case 0:
+        faad_getbits(ld, 8); /* latmBufferFullness */
+        if (!mux->same_time_framing && lay > 0 &&
+            (object_type == 6 || object_type == 20) &&
+            (s[-1].object_type == 8 || s[-1].object_type == 24))
+        {
+            faad_getbits(ld, 6); /* coreFrameOffset */
+        }
+        break;
+    case 1:
+        s->frame_length = (faad_getbits(ld, 9) + 20) * 8;
+        break;
+    default:
+        /* CELP and HVXC payloads have their lengths in tables */
+        return 35;
+    }
+
+    mux->stream_id[prog][lay] = mux->streams++;
+
+    return 0;
+}
+
+static uint8_t latm_stream_mux_config(latm_mux *mux, bitfile *ld,
+                                      const uint8_t *frame)
+{
+    uint8_t prog, lay, err;
+
+    mux->version = (uint8_t)faad_get1bit(ld);
+    /* the syntax of audioMuxVersionA 1 is not defined yet */
+    if (mux->version && faad_get1bit(ld))
+        return 35;
+    if (mux->version)
+        latm_get_value(ld); /* taraBufferFullness */
+
+    mux->same_time_framing = (uint8_t)faad_get1bit(ld);
+    mux->subframes = (uint8_t)faad_getbits(ld, 6) + 1;
+    mux->programs = (uint8_t)faad_getbits(ld, 4) + 1;
+    mux->streams = 0;
+
+    for (prog = 0; prog < mux->programs; prog++)
+    {
+        uint8_t layers = (uint8_t)faad_getbits(ld, 3) + 1;
+
+        for (lay = 0; lay < layers; lay++)
+        {
+            if (mux->streams == LATM_MAX_STREAMS)
+                return 35;
+            if ((err = latm_stream_config(mux, ld, frame, prog, lay)) > 0)
+                return err;
+        }
+    }
+
+    mux->other_data_bits = 0;
+    mux->other_data = (uint8_t)faad_get1bit(ld);
+    if (mux->other_data)
+    {
+        if (mux->version)
+        {
+            mux->other_data_bits = latm_get_value(ld);
+        } else {
+            uint8_t esc;
+            do {
+                esc = (uint8_t)faad_get1bit(ld);
+                mux->other_data_bits = (mux->other_data_bits << 8) + faad_getbits(ld, 8);
+            } while (esc);
+        }
+    }
+
+    if (faad_get1bit(ld))
+        faad_getbits(ld, 8); /* crcCheckSum */
+
+    return 0;
+}
+
+/* reads the StreamMuxConfig at the read position, unless it is the same
+   as the last one */
+static uint8_t latm_read_config(latm_mux *mux, bitfile *ld, const uint8_t *frame,
+                                uint32_t frame_bits)
+{
+    uint32_t start = faad_get_processed_bits(ld);
+    uint32_t bits;
+    uint8_t err;
+
+    if (mux->config_bits > 0 && frame_bits - start >= mux->config_bits)
+    {
+        uint8_t config[LATM_MAX_CONFIG_BYTES];
+
+        memset(config, 0, sizeof(config));
+        latm_copy_bits(config, frame, start, mux->config_bits);
+        if (memcmp(config, mux->config, bit2byte(mux->config_bits)) == 0)
+        {
+            latm_skip_bits(ld, mux->config_bits);
+            return 0;
+        }
+    }
+
+    mux->inited = 0;
+    mux->config_bits = 0;
+    if ((err = latm_stream_mux_config(mux, ld, frame)) > 0)
+        return err;
+    bits = faad_get_processed_bits(ld) - start;
+    if (bits > frame_bits - start)
+        return 14;
+
+    mux->inited = 1;
+    if (bits <= LATM_MAX_CONFIG_BYTES*8)
+    {
+        memset(mux->config, 0, sizeof(mux->config));
+        latm_copy_bits(mux->config, frame, start, bits);
+        mux->config_bits = bits;
+    }
+
+    return 0;
+}
+
+static uint32_t latm_slot_length(bitfile *ld)
+{
+    uint32_t len = 0;
+    uint8_t tmp;
+
+    do {
+        tmp = (uint8_t)faad_getbits(ld, 8);
+        len += tmp;
+    } while (tmp == 255);
+
+    return len * 8;
+}
+
+/* appends bits of payload to the unfinished access unit of stream s */
+static uint8_t latm_payload(latm_stream *s, bitfile *ld, const uint8_t *frame,
+                            uint32_t frame_bits, uint32_t bits, uint8_t au_end)
+{
+    uint32_t pos = faad_get_processed_bits(ld);
+    uint32_t bytes = bits >> 3;
+
+    if (pos > frame_bits || bits > frame_bits - pos ||
+        s->payload_used + bytes > LOAS_MAX_FRAME)
+        return 14;
+
+    latm_copy_bits(s->payload + s->payload_used, frame, pos, bits & ~7u);
+    latm_skip_bits(ld, bits);
+    s->payload_used += bytes;
+    s->au_open += bytes;
+
+    if (au_end)
+    {
+        if (s->aus == LATM_MAX_SUBFRAMES)
+            return 35;
+        s->au_offset[s->aus] = s->payload_used - s->au_open;
+        s->au_length[s->aus] = s->au_open;
+        s->aus++;
+        s->au_open = 0;
+    }
+
+    return 0;
+}
+
+static uint8_t latm_subframe(latm_mux *mux, bitfile *ld, const uint8_t *frame,
+                             uint32_t frame_bits)
+{
+    uint32_t length[LATM_MAX_STREAMS];
+    uint8_t i, err;
+
+    if (mux->same_time_framing)
+    {
+        /* PayloadLengthInfo(), then PayloadMux() */
+        for (i = 0; i < mux->streams; i++)
+        {
+            length[i] = (mux->stream[i].frame_length_type == 0) ?
+                latm_slot_length(ld) : mux->stream[i].frame_length;
+        }
+        for (i = 0; i < mux->streams; i++)
+        {
+            if ((err = latm_payload(&mux->stream[i], ld, frame, frame_bits,
+                length[i], 1)) > 0)
+            {
+                return err;
+            }
+        }
+    } else {
+        /* the chunks may belong to any stream and an access unit may be
+           spread over several of them */
+        uint8_t chunk_stream[16], au_end[16];
+        uint8_t chunks = (uint8_t)faad_getbits(ld, 4) + 1;
+
+        for (i = 0; i < chunks; i++)
+        {
+            uint8_t s = (uint8_t)faad_getbits(ld, 4);
+
+            if (s >= mux->streams)
+                return 35;
+            chunk_stream[i] = s;
+            if (mux->stream[s].frame_length_type == 0)
+            {
+                length[i] = latm_slot_length(ld);
+                au_end[i] = (uint8_t)faad_get1bit(ld);
+            } else {
+                length[i] = mux->stream[s].frame_length;
+                au_end[i] = 1;
+            }
+        }
+        for (i = 0; i < chunks; i++)
+        {
+            if ((err = latm_payload(&mux->stream[chunk_stream[i]], ld, frame,
+                frame_bits, length[i], au_end[i])) > 0)
+            {
+                return err;
+            }
+        }
+    }
+
+    return 0;
+}
+
+static uint8_t latm_audio_mux_element(latm_mux *mux, bitfile *ld,
+                                      const uint8_t *frame, uint32_t frame_bits)
+{
+    uint8_t i, err;
+
+    if (!faad_get1bit(ld)) /* useSameStreamMux */
+    {
+        if ((err = latm_read_config(mux, ld, frame, frame_bits)) > 0)
+            return err;
+    } else if (!mux->inited) {
+        return 36;
+    }
+
+    /* keep the unfinished access units */
+    for (i = 0; i < mux->streams; i++)
+    {
+        latm_stream *s = &mux->stream[i];
+
+        memmove(s->payload, s->payload + s->payload_used - s->au_open, s->au_open);
+        s->payload_used = s->au_open;
+        s->aus = 0;
+        s->au_next = 0;
+    }
+
+    for (i = 0; i < mux->subframes; i++)
+    {
+        if ((err = latm_subframe(mux, ld, frame, frame_bits)) > 0)
+            return err;
+    }
+
+    /* otherData and the byte alignment are covered by the frame length */
+    return 0;
+}
+
+/* Demultiplexes the LOAS frame at buffer. *frame_size is set to the size
+   of the frame, or to 0 when the buffer holds no complete frame. */
+uint8_t latm_frame(latm_mux *mux, const uint8_t *buffer, uint32_t size,
+                   uint32_t *frame_size)
+{
+    bitfile ld;
+    uint32_t len;
+    uint8_t err;
+
+    *frame_size = 0;
+    if (size < LOAS_HEADER_SIZE)
+        return 14;
+
+    len = loas_frame_length(buffer);
+    if (len == 0)
+        return 34;
+    if (size < len)
+        return 14;
+    *frame_size = len;
+
+    faad_initbits(&ld, buffer + LOAS_HEADER_SIZE, len - LOAS_HEADER_SIZE);
+    err = latm_audio_mux_element(mux, &ld, buffer + LOAS_HEADER_SIZE,
+        (len - LOAS_HEADER_SIZE) * 8);
+    faad_endbits(&ld);
+
+    if (err > 0)
+        latm_reset(mux);
+
+    return err;
+}
+
+/* hands out the next access unit of a stream from the last frame, returns
+   0 when there is none left */
+uint8_t latm_next_au(latm_mux *mux, uint8_t stream, const uint8_t **au,
+                     uint32_t *au_size)
+{
+    latm_stream *s;
+
+    if (!mux->inited || stream >= mux->streams)
+        return 0;
+
+    s = &mux->stream[stream];
+    while (s->au_next < s->aus)
+    {
+        uint8_t i = s->au_next++;
+
+        /* an empty access unit carries no frame */
+        if (s->au_length[i] > 0)
+        {
+            *au = s->payload + s->au_offset[i];
+            *au_size = s->au_length[i];
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/* true when stream has access units left in the last frame */
+uint8_t latm_au_pending(const latm_mux *mux, uint8_t stream)
+{
+    const latm_stream *s = &mux->stream[stream];
+    uint8_t i;
+
+    for (i = s->au_next; i < s->aus; i++)
+    {
+        if (s->au_length[i] > 0)
+            return 1;
+    }
+
+    return 0;
+}
+
+latm_demux *latm_demux_init(const NeAACDecConfiguration *config)
+{
+    latm_demux *demux = (latm_demux*)faad_malloc(sizeof(latm_demux));
+
+    if (demux == NULL)
+        return NULL;
+
+    memset(demux, 0, sizeof(latm_demux));
+    if ((demux->mux = latm_init()) == NULL)
+    {
+        faad_free(demux);
+        return NULL;
+    }
+    if (config != NULL)
+    {
+        demux->config = *config;
+        demux->has_config = 1;
+    }
+
+    return demux;
+}
+
+void latm_demux_end(latm_demux *demux)
+{
+    uint8_t i;
+
+    if (demux == NULL)
+        return;
+
+    for (i = 0; i < LATM_MAX_STREAMS; i++)
+        NeAACDecClose(demux->decoder[i]);
+    latm_end(demux->mux);
+    faad_free(demux);
+}
+
+/* Returns the number of bytes to go on with: the size of the frame, also
+   when it is damaged, or the distance to the next possible syncword. 0
+   means more input is needed. */
+long latm_demux_frame(latm_demux *demux, const uint8_t *buffer,
+                      unsigned long size, uint8_t *error)
+{
+    uint32_t frame_size;
+    uint32_t n = (uint32_t)min(size, LOAS_MAX_FRAME);
+
+    *error = latm_frame(demux->mux, buffer, n, &frame_size);
+    if (*error == 34)
+    {
+        /* buffer[0] is not a syncword, or one with a zero length */
+        uint32_t skip = loas_sync_c(buffer + 1, n - 1) + 1;
+
+        /* without one the last byte may still start a syncword */
+        return (long)((skip < n) ? skip : n - 1);
+    }
+    if (frame_size == 0)
+        *error = 0;
+
+    return (long)frame_size;
+}
+
+uint8_t latm_demux_streams(const latm_demux *demux)
+{
+    return demux->mux->inited ? demux->mux->streams : 0;
+}
+
+int8_t latm_demux_stream_info(const latm_demux *demux, uint8_t stream,
+                              uint8_t *program, uint8_t *layer,
+                              mp4AudioSpecificConfig *mp4ASC)
+{
+    const latm_stream *s = &demux->mux->stream[stream];
+    program_config pce;
+
+    if (stream >= latm_demux_streams(demux))
+        return -1;
+
+    if (program)
+        *program = s->program;
+    if (layer)
+        *layer = s->layer;
+    if (mp4ASC &&
+        AudioSpecificConfig2((uint8_t*)s->asc, bit2byte(s->asc_bits), mp4ASC, &pce, 1) < 0)
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+/* (re)creates the decoder of a stream when its config is new */
+static NeAACDecHandle latm_demux_decoder(latm_demux *demux, uint8_t stream)
+{
+    latm_stream *s = &demux->mux->stream[stream];
+    NeAACDecStruct *hDecoder;
+    unsigned long samplerate;
+    unsigned char channels;
+
+    if (demux->decoder[stream] != NULL &&
+        demux->asc_version[stream] == s->asc_version)
+    {
+        return demux->decoder[stream];
+    }
+
+    NeAACDecClose(demux->decoder[stream]);
+    demux->decoder[stream] = NULL;
+
+    if ((hDecoder = (NeAACDecStruct*)NeAACDecOpen()) == NULL)
+        return NULL;
+    if (demux->has_config)
+        NeAACDecSetConfiguration(hDecoder, &demux->config);
+
+    /* the config is in the short LATM form */
+    hDecoder->latm_header_present = 1;
+    if (NeAACDecInit2(hDecoder, s->asc, bit2byte(s->asc_bits),
+        &samplerate, &channels) < 0)
+    {
+        NeAACDecClose(hDecoder);
+        return NULL;
+    }
+
+    demux->decoder[stream] = hDecoder;
+    demux->asc_version[stream] = s->asc_version;
+
+    return hDecoder;
+}
+
+void *latm_demux_decode(latm_demux *demux, uint8_t stream,
+                        NeAACDecFrameInfo *hInfo, void **sample_buffer,
+                        unsigned long sample_buffer_size)
+{
+    NeAACDecHandle hDecoder;
+    const uint8_t *au;
+    uint32_t au_size;
+    void *out;
+
+    memset(hInfo, 0, sizeof(NeAACDecFrameInfo));
+
+    if (!latm_next_au(demux->mux, stream, &au, &au_size))
+        return NULL;
+
+    if ((hDecoder = latm_demux_decoder(demux, stream)) == NULL)
+    {
+        hInfo->error = 35;
+        hInfo->bytesconsumed = au_size;
+        return NULL;
+    }
+
+    if (sample_buffer)
+    {
+        out = NeAACDecDecode2(hDecoder, hInfo, (uint8_t*)au, au_size,
+            sample_buffer, sample_buffer_size);
+    } else {
+        out = NeAACDecDecode(hDecoder, hInfo, (uint8_t*)au, au_size);
+    }
+    hInfo->bytesconsumed = au_size;
+
+    return out;
+}
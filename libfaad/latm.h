@@ -0,0 +1,146 @@
+/*
+** FAAD2 - Freeware Advanced Audio (AAC) Decoder including SBR decoding
+** Copyright (C) 2003-2005 M. Bakker, Nero AG, http://www.nero.com
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+**
+** Any non-GPL usage of this software or parts of this software is strictly
+** forbidden.
+**
+** The "appropriate copyright message" mentioned in section 2c of the GPLv2
+** must read: "Code from FAAD2 is copyright (c) Nero AG, www.nero.com"
+**
+** Commercial non-GPL licensing of this software is possible.
+** For more info contact Nero AG through Mpeg4AAClicense@nero.com.
+**
+** $Id$
+**/
+
+#ifndef __LATM_H__
+#define __LATM_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* LATM/LOAS demultiplexing (ISO/IEC 14496-3, 1.7).
+ *
+ * A LOAS frame (AudioSyncStream) is a 3 byte header with the 0x2B7
+ * syncword and the frame length, followed by an AudioMuxElement. The
+ * StreamMuxConfig in it describes up to 16 programs of up to 8 layers,
+ * every program/layer pair is a stream with its own AudioSpecificConfig.
+ * The access units of all streams are extracted into byte aligned copies,
+ * so they can be decoded as raw data blocks.
+ *
+ * Broadcasts repeat the StreamMuxConfig in every frame or every few
+ * frames. The bits of the last one are kept, a repeated config is
+ * recognised by comparing them and is not parsed again.
+ */
+
+#define LOAS_HEADER_SIZE      3
+#define LOAS_MAX_FRAME        (LOAS_HEADER_SIZE + 0x1FFF)
+
+#define LATM_MAX_STREAMS      16
+#define LATM_MAX_SUBFRAMES    64
+#define LATM_MAX_ASC_BYTES    64
+#define LATM_MAX_CONFIG_BYTES 512
+
+typedef struct
+{
+    uint8_t program;
+    uint8_t layer;
+    uint8_t object_type;
+
+    /* 0: lengths in the frame, 1: fixed length, others are not supported */
+    uint8_t frame_length_type;
+    uint32_t frame_length;      /* in bits, for frame_length_type 1 */
+
+    uint8_t asc[LATM_MAX_ASC_BYTES];
+    uint32_t asc_bits;
+    uint32_t asc_version;       /* changes with every different config */
+
+    /* access units of the last frame, one per subframe, back to back */
+    uint8_t payload[LOAS_MAX_FRAME];
+    uint32_t payload_used;
+    uint32_t au_offset[LATM_MAX_SUBFRAMES];
+    uint32_t au_length[LATM_MAX_SUBFRAMES];
+    uint8_t aus;
+    uint8_t au_next;            /* next access unit to hand out */
+
+    /* without allStreamsSameTimeFraming an access unit can be spread over
+       frames, this much of the unfinished one is in payload */
+    uint32_t au_open;
+} latm_stream;
+
+typedef struct latm_mux
+{
+    uint8_t inited;             /* a StreamMuxConfig has been read */
+    uint8_t version;
+    uint8_t same_time_framing;
+    uint8_t subframes;
+    uint8_t programs;
+    uint8_t streams;
+    uint8_t stream_id[16][8];   /* program, layer to stream */
+    uint8_t other_data;
+    uint32_t other_data_bits;
+
+    latm_stream stream[LATM_MAX_STREAMS];
+    uint32_t asc_versions;
+
+    /* the last StreamMuxConfig as read from the stream */
+    uint8_t config[LATM_MAX_CONFIG_BYTES];
+    uint32_t config_bits;
+} latm_mux;
+
+/* the demultiplexer behind NeAACDecLATMOpen(), with a decoder per stream */
+typedef struct latm_demux
+{
+    latm_mux *mux;
+    NeAACDecConfiguration config;
+    uint8_t has_config;
+
+    NeAACDecHandle decoder[LATM_MAX_STREAMS];
+    uint32_t asc_version[LATM_MAX_STREAMS]; /* the decoder was set up for */
+} latm_demux;
+
+uint32_t loas_sync_c(const uint8_t *p, uint32_t n);
+uint32_t loas_frame_length(const uint8_t *p);
+long loas_find_sync(const uint8_t *buffer, unsigned long size);
+
+latm_mux *latm_init(void);
+void latm_end(latm_mux *mux);
+void latm_reset(latm_mux *mux);
+uint8_t latm_frame(latm_mux *mux, const uint8_t *buffer, uint32_t size,
+                   uint32_t *frame_size);
+uint8_t latm_next_au(latm_mux *mux, uint8_t stream, const uint8_t **au,
+                     uint32_t *au_size);
+uint8_t latm_au_pending(const latm_mux *mux, uint8_t stream);
+
+latm_demux *latm_demux_init(const NeAACDecConfiguration *config);
+void latm_demux_end(latm_demux *demux);
+long latm_demux_frame(latm_demux *demux, const uint8_t *buffer,
+                      unsigned long size, uint8_t *error);
+uint8_t latm_demux_streams(const latm_demux *demux);
+int8_t latm_demux_stream_info(const latm_demux *demux, uint8_t stream,
+                              uint8_t *program, uint8_t *layer,
+                              mp4AudioSpecificConfig *mp4ASC);
+void *latm_demux_decode(latm_demux *demux, uint8_t stream,
+                        NeAACDecFrameInfo *hInfo, void **sample_buffer,
+                        unsigned long sample_buffer_size);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
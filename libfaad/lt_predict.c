@@ -82,35 +82,29 @@ void lt_prediction(ic_stream *ics, ltp_info *ltp, real_t *spec,
                    uint8_t win_shape_prev, uint8_t sr_index,
                    uint8_t object_type, uint16_t frame_len)
 {
-    uint8_t sfb;
-    uint16_t bin, i, num_samples;
-    ALIGN real_t x_est[2048];
+    uint8_t sfb, used;
+    uint16_t bin, num_samples;
     ALIGN real_t X_est[2048];
 
     if (ics->window_sequence != EIGHT_SHORT_SEQUENCE)
     {
         if (ltp->data_present)
         {
-            num_samples = frame_len << 1;
-
-            for(i = 0; i < num_samples; i++)
-            {
-                /* The extra lookback M (N/2 for LD, 0 for LTP) is handled
-                   in the buffer updating */
+            /* nothing to add when no band uses the prediction */
+            used = 0;
+            for (sfb = 0; sfb < ltp->last_band; sfb++)
+                used |= ltp->long_used[sfb];
+            if (!used)
+                return;
 
-#if 0
-                x_est[i] = MUL_R_C(lt_pred_stat[num_samples + i - ltp->lag],
-                    codebook[ltp->coef]);
-#else
-                /* lt_pred_stat is a 16 bit int, multiplied with the fixed point real
-                   this gives a real for x_est
-                */
-                x_est[i] = (real_t)lt_pred_stat[num_samples + i - ltp->lag] * codebook[ltp->coef];
-#endif
-            }
+            num_samples = frame_len << 1;
 
+            /* The extra lookback M (N/2 for LD, 0 for LTP) is handled
+               in the buffer updating. lt_pred_stat is a 16 bit int,
+               multiplied with the real codebook entry while windowing */
             filter_bank_ltp(fb, ics->window_sequence, win_shape, win_shape_prev,
-                x_est, X_est, object_type, frame_len);
+                lt_pred_stat + num_samples - ltp->lag, codebook[ltp->coef],
+                X_est, object_type, frame_len);
 
             tns_encode_frame(ics, &(ics->tns), sr_index, object_type, X_est,
                 frame_len);
@@ -56,7 +56,7 @@
 
 #include "cfft.h"
 #include "mdct.h"
-#include "mdct_tab.h"
+#include "tables.h"
 
 
 mdct_info *faad_mdct_init(uint16_t N)
@@ -73,33 +73,12 @@ mdct_info *faad_mdct_init(uint16_t N)
     /* RE(mdct->sincos[k]) = scale*(real_t)(cos(2.0*M_PI*(k+1./8.) / (real_t)N));
      * IM(mdct->sincos[k]) = scale*(real_t)(sin(2.0*M_PI*(k+1./8.) / (real_t)N)); */
     /* scale is 1 for fixed point, sqrt(N) for floating point */
-    switch (N)
-    {
-    case 2048: mdct->sincos = (complex_t*)mdct_tab_2048; break;
-    case 256:  mdct->sincos = (complex_t*)mdct_tab_256;  break;
-#ifdef LD_DEC
-    case 1024: mdct->sincos = (complex_t*)mdct_tab_1024; break;
-#endif
-#ifdef ALLOW_SMALL_FRAMELENGTH
-    case 1920: mdct->sincos = (complex_t*)mdct_tab_1920; break;
-    case 240:  mdct->sincos = (complex_t*)mdct_tab_240;  break;
-#ifdef LD_DEC
-    case 960:  mdct->sincos = (complex_t*)mdct_tab_960;  break;
-#endif
-#endif
-#ifdef SSR_DEC
-    case 512:  mdct->sincos = (complex_t*)mdct_tab_512;  break;
-    case 64:   mdct->sincos = (complex_t*)mdct_tab_64;   break;
-#endif
-    }
+    mdct->sincos = table_mdct(N);
 
     /* initialise fft */
     mdct->cfft = cffti(N/4);
 
-#ifdef PROFILE
-    mdct->cycles = 0;
-    mdct->fft_cycles = 0;
-#endif
+    mdct->dsp = dsp_select(FAAD_CPU_AUTO);
 
     return mdct;
 }
@@ -108,39 +87,57 @@ void faad_mdct_end(mdct_info *mdct)
 {
     if (mdct != NULL)
     {
-#ifdef PROFILE
-        printf("MDCT[%.4d]:         %I64d cycles\n", mdct->N, mdct->cycles);
-        printf("CFFT[%.4d]:         %I64d cycles\n", mdct->N/4, mdct->fft_cycles);
-#endif
-
         cfftu(mdct->cfft);
 
         faad_free(mdct);
     }
 }
 
-void faad_imdct(mdct_info *mdct, real_t *X_in, real_t *X_out)
+/* pre-IFFT complex multiplication, reference version of dsp->imdct_pre */
+void imdct_pre_c(const real_t *X_in, const complex_t *sincos,
+                 complex_t *Z1, uint16_t N2, uint16_t N4)
 {
     uint16_t k;
 
+    for (k = 0; k < N4; k++)
+    {
+        ComplexMult(&IM(Z1[k]), &RE(Z1[k]),
+            X_in[2*k], X_in[N2 - 1 - 2*k], RE(sincos[k]), IM(sincos[k]));
+    }
+}
+
+/* post-IFFT complex multiplication, reference version of dsp->imdct_post */
+void imdct_post_c(complex_t *Z1, const complex_t *sincos, uint16_t N4)
+{
+    uint16_t k;
     complex_t x;
+
+    for (k = 0; k < N4; k++)
+    {
+        RE(x) = RE(Z1[k]);
+        IM(x) = IM(Z1[k]);
+        ComplexMult(&IM(Z1[k]), &RE(Z1[k]),
+            IM(x), RE(x), RE(sincos[k]), IM(sincos[k]));
+    }
+}
+
+void faad_imdct(mdct_info *mdct, real_t *X_in, real_t *X_out)
+{
+    uint16_t k;
+
 #ifdef ALLOW_SMALL_FRAMELENGTH
 #ifdef FIXED_POINT
     real_t scale, b_scale = 0;
 #endif
 #endif
     ALIGN complex_t Z1[512];
-    complex_t *sincos = mdct->sincos;
+    const complex_t *sincos = mdct->sincos;
 
     uint16_t N  = mdct->N;
     uint16_t N2 = N >> 1;
     uint16_t N4 = N >> 2;
     uint16_t N8 = N >> 3;
 
-#ifdef PROFILE
-    int64_t count1, count2 = faad_get_ts();
-#endif
-
 #ifdef ALLOW_SMALL_FRAMELENGTH
 #ifdef FIXED_POINT
     /* detect non-power of 2 */
@@ -155,42 +152,27 @@ void faad_imdct(mdct_info *mdct, real_t *X_in, real_t *X_out)
 #endif
 
     /* pre-IFFT complex multiplication */
-    for (k = 0; k < N4; k++)
-    {
-        ComplexMult(&IM(Z1[k]), &RE(Z1[k]),
-            X_in[2*k], X_in[N2 - 1 - 2*k], RE(sincos[k]), IM(sincos[k]));
-    }
-
-#ifdef PROFILE
-    count1 = faad_get_ts();
-#endif
+    mdct->dsp->imdct_pre(X_in, sincos, Z1, N2, N4);
 
     /* complex IFFT, any non-scaling FFT can be used here */
     cfftb(mdct->cfft, Z1);
 
-#ifdef PROFILE
-    count1 = faad_get_ts() - count1;
-#endif
-
     /* post-IFFT complex multiplication */
-    for (k = 0; k < N4; k++)
-    {
-        RE(x) = RE(Z1[k]);
-        IM(x) = IM(Z1[k]);
-        ComplexMult(&IM(Z1[k]), &RE(Z1[k]),
-            IM(x), RE(x), RE(sincos[k]), IM(sincos[k]));
+    mdct->dsp->imdct_post(Z1, sincos, N4);
 
 #ifdef ALLOW_SMALL_FRAMELENGTH
 #ifdef FIXED_POINT
-        /* non-power of 2 MDCT scaling */
-        if (b_scale)
+    /* non-power of 2 MDCT scaling */
+    if (b_scale)
+    {
+        for (k = 0; k < N4; k++)
         {
             RE(Z1[k]) = MUL_C(RE(Z1[k]), scale);
             IM(Z1[k]) = MUL_C(IM(Z1[k]), scale);
         }
+    }
 #endif
 #endif
-    }
 
     /* reordering */
     for (k = 0; k < N8; k+=2)
@@ -219,12 +201,6 @@ void faad_imdct(mdct_info *mdct, real_t *X_in, real_t *X_out)
         X_out[N2 + N4 + 1 + 2*k] =  RE(Z1[N4 - 1 - k]);
         X_out[N2 + N4 + 3 + 2*k] =  RE(Z1[N4 - 2 - k]);
     }
-
-#ifdef PROFILE
-    count2 = faad_get_ts() - count2;
-    mdct->fft_cycles += count1;
-    mdct->cycles += (count2 - count1);
-#endif
 }
 
 #ifdef LTP_DEC
@@ -234,7 +210,7 @@ void faad_mdct(mdct_info *mdct, real_t *X_in, real_t *X_out)
 
     complex_t x;
     ALIGN complex_t Z1[512];
-    complex_t *sincos = mdct->sincos;
+    const complex_t *sincos = mdct->sincos;
 
     uint16_t N  = mdct->N;
     uint16_t N2 = N >> 1;
@@ -41,6 +41,10 @@ void faad_mdct_end(mdct_info *mdct);
 void faad_imdct(mdct_info *mdct, real_t *X_in, real_t *X_out);
 void faad_mdct(mdct_info *mdct, real_t *X_in, real_t *X_out);
 
+void imdct_pre_c(const real_t *X_in, const complex_t *sincos,
+                 complex_t *Z1, uint16_t N2, uint16_t N4);
+void imdct_post_c(complex_t *Z1, const complex_t *sincos, uint16_t N4);
+
 
 #ifdef __cplusplus
 }
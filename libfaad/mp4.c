@@ -168,8 +168,10 @@ int8_t AudioSpecificConfigFromBitfile(bitfile *ld,
     }
 
 #if (defined(PS_DEC) || defined(DRM_PS))
-    /* check if we have a mono file */
-    if (mp4ASC->channelsConfiguration == 1)
+    /* check if we have a mono file, ER streams can not carry PS and use
+       the channel configuration to know which elements to expect */
+    if (mp4ASC->channelsConfiguration == 1 &&
+        mp4ASC->objectTypeIndex < ER_OBJECT_START)
     {
         /* upMatrix to 2 channels for implicit signalling of PS */
         mp4ASC->channelsConfiguration = 2;
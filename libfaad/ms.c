@@ -36,6 +36,31 @@
 #include "is.h"
 #include "pns.h"
 
+/* M/S decoding of scalefactor band sfb in window group g, base is the
+   offset of the window in the spectrum */
+void ms_decode_band(ic_stream *ics, ic_stream *icsr, real_t *l_spec, real_t *r_spec,
+                    uint8_t g, uint8_t sfb, uint16_t base)
+{
+    uint16_t i, k;
+    real_t tmp;
+
+    /* If intensity stereo coding or noise substitution is on
+       for a particular scalefactor band, no M/S stereo decoding
+       is carried out.
+     */
+    if ((ics->ms_mask_present == 2 || ics->ms_used[g][sfb]) &&
+        !is_intensity(icsr, g, sfb) && !is_noise(ics, g, sfb))
+    {
+        for (i = ics->swb_offset[sfb]; i < min(ics->swb_offset[sfb+1], ics->swb_offset_max); i++)
+        {
+            k = base + i;
+            tmp = l_spec[k] - r_spec[k];
+            l_spec[k] = l_spec[k] + r_spec[k];
+            r_spec[k] = tmp;
+        }
+    }
+}
+
 void ms_decode(ic_stream *ics, ic_stream *icsr, real_t *l_spec, real_t *r_spec,
                uint16_t frame_len)
 {
@@ -43,9 +68,6 @@ void ms_decode(ic_stream *ics, ic_stream *icsr, real_t *l_spec, real_t *r_spec,
     uint8_t group = 0;
     uint16_t nshort = frame_len/8;
 
-    uint16_t i, k;
-    real_t tmp;
-
     if (ics->ms_mask_present >= 1)
     {
         for (g = 0; g < ics->num_window_groups; g++)
@@ -54,21 +76,7 @@ void ms_decode(ic_stream *ics, ic_stream *icsr, real_t *l_spec, real_t *r_spec,
             {
                 for (sfb = 0; sfb < ics->max_sfb; sfb++)
                 {
-                    /* If intensity stereo coding or noise substitution is on
-                       for a particular scalefactor band, no M/S stereo decoding
-                       is carried out.
-                     */
-                    if ((ics->ms_used[g][sfb] || ics->ms_mask_present == 2) &&
-                        !is_intensity(icsr, g, sfb) && !is_noise(ics, g, sfb))
-                    {
-                        for (i = ics->swb_offset[sfb]; i < min(ics->swb_offset[sfb+1], ics->swb_offset_max); i++)
-                        {
-                            k = (group*nshort) + i;
-                            tmp = l_spec[k] - r_spec[k];
-                            l_spec[k] = l_spec[k] + r_spec[k];
-                            r_spec[k] = tmp;
-                        }
-                    }
+                    ms_decode_band(ics, icsr, l_spec, r_spec, g, sfb, group*nshort);
                 }
                 group++;
             }
@@ -35,6 +35,8 @@
 extern "C" {
 #endif
 
+void ms_decode_band(ic_stream *ics, ic_stream *icsr, real_t *l_spec, real_t *r_spec,
+                    uint8_t g, uint8_t sfb, uint16_t base);
 void ms_decode(ic_stream *ics, ic_stream *icsr, real_t *l_spec, real_t *r_spec,
                uint16_t frame_len);
 
@@ -86,6 +86,40 @@ if (sample >= 0.0f)            \
 
 #define CONV(a,b) ((a<<1)|(b&0x1))
 
+/* mono 16 bit output, reference version of dsp->pcm16_mono */
+void pcm16_mono_c(const real_t *in, int16_t *out, uint16_t n)
+{
+    uint16_t i;
+
+    for(i = 0; i < n; i++)
+    {
+        real_t inp = in[i];
+
+        CLIP(inp, 32767.0f, -32768.0f);
+
+        out[i] = (int16_t)lrintf(inp);
+    }
+}
+
+/* interleaved stereo 16 bit output, reference version of dsp->pcm16_stereo */
+void pcm16_stereo_c(const real_t *in0, const real_t *in1,
+                    int16_t *out, uint16_t n)
+{
+    uint16_t i;
+
+    for(i = 0; i < n; i++)
+    {
+        real_t inp0 = in0[i];
+        real_t inp1 = in1[i];
+
+        CLIP(inp0, 32767.0f, -32768.0f);
+        CLIP(inp1, 32767.0f, -32768.0f);
+
+        out[(i*2)+0] = (int16_t)lrintf(inp0);
+        out[(i*2)+1] = (int16_t)lrintf(inp1);
+    }
+}
+
 static void to_PCM_16bit(NeAACDecStruct *hDecoder, real_t **input,
                          uint8_t channels, uint16_t frame_len,
                          int16_t **sample_buffer)
@@ -97,43 +131,14 @@ static void to_PCM_16bit(NeAACDecStruct *hDecoder, real_t **input,
     {
     case CONV(1,0):
     case CONV(1,1):
-        for(i = 0; i < frame_len; i++)
-        {
-            real_t inp = input[hDecoder->internal_channel[0]][i];
-
-            CLIP(inp, 32767.0f, -32768.0f);
-
-            (*sample_buffer)[i] = (int16_t)lrintf(inp);
-        }
+        hDecoder->dsp->pcm16_mono(input[hDecoder->internal_channel[0]],
+            *sample_buffer, frame_len);
         break;
     case CONV(2,0):
-        if (hDecoder->upMatrix)
-        {
-            ch  = hDecoder->internal_channel[0];
-            for(i = 0; i < frame_len; i++)
-            {
-                real_t inp0 = input[ch][i];
-
-                CLIP(inp0, 32767.0f, -32768.0f);
-
-                (*sample_buffer)[(i*2)+0] = (int16_t)lrintf(inp0);
-                (*sample_buffer)[(i*2)+1] = (int16_t)lrintf(inp0);
-            }
-        } else {
-            ch  = hDecoder->internal_channel[0];
-            ch1 = hDecoder->internal_channel[1];
-            for(i = 0; i < frame_len; i++)
-            {
-                real_t inp0 = input[ch ][i];
-                real_t inp1 = input[ch1][i];
-
-                CLIP(inp0, 32767.0f, -32768.0f);
-                CLIP(inp1, 32767.0f, -32768.0f);
-
-                (*sample_buffer)[(i*2)+0] = (int16_t)lrintf(inp0);
-                (*sample_buffer)[(i*2)+1] = (int16_t)lrintf(inp1);
-            }
-        }
+        ch  = hDecoder->internal_channel[0];
+        ch1 = hDecoder->upMatrix ? ch : hDecoder->internal_channel[1];
+        hDecoder->dsp->pcm16_stereo(input[ch], input[ch1],
+            *sample_buffer, frame_len);
         break;
     default:
         for (ch = 0; ch < channels; ch++)
@@ -403,10 +408,9 @@ void *output_to_PCM(NeAACDecStruct *hDecoder,
     int32_t   *int_sample_buffer = (int32_t*)sample_buffer;
     float32_t *float_sample_buffer = (float32_t*)sample_buffer;
     double    *double_sample_buffer = (double*)sample_buffer;
+    stats_mark mark;
 
-#ifdef PROFILE
-    int64_t count = faad_get_ts();
-#endif
+    stats_begin(&hDecoder->stats, &mark);
 
     /* Copy output to a standard PCM buffer */
     switch (format)
@@ -428,10 +432,7 @@ void *output_to_PCM(NeAACDecStruct *hDecoder,
         break;
     }
 
-#ifdef PROFILE
-    count = faad_get_ts() - count;
-    hDecoder->output_cycles += count;
-#endif
+    stats_end(&hDecoder->stats, &mark, FAAD_STAGE_OUTPUT);
 
     return sample_buffer;
 }
@@ -473,6 +474,9 @@ void* output_to_PCM(NeAACDecStruct *hDecoder,
     uint16_t i;
     int16_t *short_sample_buffer = (int16_t*)sample_buffer;
     int32_t *int_sample_buffer = (int32_t*)sample_buffer;
+    stats_mark mark;
+
+    stats_begin(&hDecoder->stats, &mark);
 
     /* Copy output to a standard PCM buffer */
     for (ch = 0; ch < channels; ch++)
@@ -553,6 +557,8 @@ void* output_to_PCM(NeAACDecStruct *hDecoder,
         }
     }
 
+    stats_end(&hDecoder->stats, &mark, FAAD_STAGE_OUTPUT);
+
     return sample_buffer;
 }
 
@@ -42,6 +42,12 @@ void* output_to_PCM(NeAACDecStruct *hDecoder,
                     uint16_t frame_len,
                     uint8_t format);
 
+#ifndef FIXED_POINT
+void pcm16_mono_c(const real_t *in, int16_t *out, uint16_t n);
+void pcm16_stereo_c(const real_t *in0, const real_t *in1,
+                    int16_t *out, uint16_t n);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
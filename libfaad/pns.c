@@ -31,6 +31,9 @@
 #include "common.h"
 #include "structs.h"
 
+#include <stdlib.h>
+#include <string.h>
+
 #include "pns.h"
 
 
@@ -155,70 +158,144 @@ static INLINE void gen_rand_vector(real_t *spec, int16_t scale_factor, uint16_t
 #endif
 }
 
-void pns_decode(ic_stream *ics_left, ic_stream *ics_right,
-                real_t *spec_left, real_t *spec_right, uint16_t frame_len,
-                uint8_t channel_pair, uint8_t object_type,
-                /* RNG states */ uint32_t *__r1, uint32_t *__r2)
+#ifndef FIXED_POINT
+/* reference version of dsp->pns_noise(), fills spec with unscaled noise
+   and returns its energy */
+real_t pns_noise_c(real_t *spec, uint16_t size, uint32_t seed, uint32_t counter)
 {
-    uint8_t g, sfb, b;
-    uint16_t size, offs;
+    uint16_t i;
+    uint32_t base = seed * PNS_GOLDEN + counter;
+    real_t acc[8] = {0};
 
-    uint8_t group = 0;
-    uint16_t nshort = frame_len >> 3;
+    for (i = 0; i < size; i++)
+    {
+        real_t tmp = (real_t)(int32_t)pns_hash(base + i);
+        spec[i] = tmp;
+        acc[i & 7] += tmp*tmp;
+    }
 
-    uint8_t sub = 0;
+    return pns_sum8(acc);
+}
 
-#ifdef FIXED_POINT
-    /* IMDCT scaling */
-    if (object_type == LD)
+/* 2^(0.25*scale_factor) without pow(), only used by the fast generator
+   since the result may differ in the last bit */
+static real_t pns_gain(int16_t scale_factor)
+{
+    static const real_t pow2_frac[4] =
     {
-        sub = 9 /*9*/;
-    } else {
-        if (ics_left->window_sequence == EIGHT_SHORT_SEQUENCE)
-            sub = 7 /*7*/;
-        else
-            sub = 10 /*10*/;
+        REAL_CONST(1.0),
+        REAL_CONST(1.18920711500272),
+        REAL_CONST(1.41421356237310),
+        REAL_CONST(1.68179283050743)
+    };
+    int32_t e = scale_factor >> 2;
+    union { uint32_t i; float32_t f; } u;
+
+    if (e < -126 || e > 127)
+        return (real_t)pow(2.0, 0.25 * scale_factor);
+
+    u.i = (uint32_t)(e + 127) << 23;
+
+    return u.f * pow2_frac[scale_factor & 3];
+}
+
+/* FAAD_PNS_FAST version of gen_rand_vector() */
+static void gen_rand_vector_fast(real_t *spec, int16_t scale_factor, uint16_t size,
+                                 uint32_t *__r1, uint32_t *__r2,
+                                 const dsp_funcs *dsp)
+{
+    uint16_t i;
+    real_t energy, scale;
+
+    energy = dsp->pns_noise(spec, size, *__r2, *__r1);
+    *__r1 += size;
+
+    if (energy <= 0)
+        return;
+
+    scale = (real_t)1.0/(real_t)sqrt(energy);
+    scale *= pns_gain(scale_factor);
+    for (i = 0; i < size; i++)
+    {
+        spec[i] *= scale;
     }
+}
 #endif
 
-    for (g = 0; g < ics_left->num_window_groups; g++)
+static INLINE void gen_noise_band(real_t *spec, int16_t scale_factor, uint16_t size,
+                                  uint8_t sub, uint32_t *__r1, uint32_t *__r2,
+                                  uint8_t pns_mode, const dsp_funcs *dsp)
+{
+#ifndef FIXED_POINT
+    if (pns_mode == FAAD_PNS_FAST)
     {
-        /* Do perceptual noise substitution decoding */
-        for (b = 0; b < ics_left->window_group_length[g]; b++)
-        {
-            for (sfb = 0; sfb < ics_left->max_sfb; sfb++)
-            {
-                uint32_t r1_dep = 0, r2_dep = 0;
+        gen_rand_vector_fast(spec, scale_factor, size, __r1, __r2, dsp);
+        return;
+    }
+#else
+    (void)pns_mode;
+    (void)dsp;
+#endif
+
+    gen_rand_vector(spec, scale_factor, size, sub, __r1, __r2);
+}
+
+/* generator used by new decoder instances, the FAAD_PNS environment
+   variable can select the fast one */
+uint8_t pns_default_mode(void)
+{
+#if !defined(FIXED_POINT) && !defined(_WIN32_WCE)
+    const char *env = getenv("FAAD_PNS");
+
+    if (env != NULL && (strcmp(env, "fast") == 0 || strcmp(env, "1") == 0))
+        return FAAD_PNS_FAST;
+#endif
 
-                if (is_noise(ics_left, g, sfb))
-                {
+    return FAAD_PNS_REFERENCE;
+}
+
+/* PNS decoding of scalefactor band sfb in window group g, base is the
+   offset of the window in the spectrum */
+void pns_decode_band(ic_stream *ics_left, ic_stream *ics_right,
+                     real_t *spec_left, real_t *spec_right,
+                     uint8_t g, uint8_t sfb, uint16_t base,
+                     uint8_t channel_pair, uint8_t sub,
+                     /* RNG states */ uint32_t *__r1, uint32_t *__r2,
+                     uint8_t pns_mode, const dsp_funcs *dsp)
+{
+    uint16_t size, offs;
+    uint32_t r1_dep = 0, r2_dep = 0;
+
+    if (is_noise(ics_left, g, sfb))
+    {
 #ifdef LTP_DEC
-                    /* Simultaneous use of LTP and PNS is not prevented in the
-                       syntax. If both LTP, and PNS are enabled on the same
-                       scalefactor band, PNS takes precedence, and no prediction
-                       is applied to this band.
-                    */
-                    ics_left->ltp.long_used[sfb] = 0;
-                    ics_left->ltp2.long_used[sfb] = 0;
+        /* Simultaneous use of LTP and PNS is not prevented in the
+           syntax. If both LTP, and PNS are enabled on the same
+           scalefactor band, PNS takes precedence, and no prediction
+           is applied to this band.
+        */
+        ics_left->ltp.long_used[sfb] = 0;
+        ics_left->ltp2.long_used[sfb] = 0;
 #endif
 
 #ifdef MAIN_DEC
-                    /* For scalefactor bands coded using PNS the corresponding
-                       predictors are switched to "off".
-                    */
-                    ics_left->pred.prediction_used[sfb] = 0;
+        /* For scalefactor bands coded using PNS the corresponding
+           predictors are switched to "off".
+        */
+        ics_left->pred.prediction_used[sfb] = 0;
 #endif
 
-                    offs = ics_left->swb_offset[sfb];
-                    size = min(ics_left->swb_offset[sfb+1], ics_left->swb_offset_max) - offs;
+        offs = ics_left->swb_offset[sfb];
+        size = min(ics_left->swb_offset[sfb+1], ics_left->swb_offset_max) - offs;
 
-                    r1_dep = *__r1;
-                    r2_dep = *__r2;
+        r1_dep = *__r1;
+        r2_dep = *__r2;
 
-                    /* Generate random vector */
-                    gen_rand_vector(&spec_left[(group*nshort)+offs],
-                        ics_left->scale_factors[g][sfb], size, sub, __r1, __r2);
-                }
+        /* Generate random vector */
+        gen_noise_band(&spec_left[base+offs],
+            ics_left->scale_factors[g][sfb], size, sub, __r1, __r2,
+            pns_mode, dsp);
+    }
 
 /* From the spec:
    If the same scalefactor band and group is coded by perceptual noise
@@ -233,43 +310,83 @@ void pns_decode(ic_stream *ics_left, ic_stream *ics_right,
    substitution in only one channel of a channel pair the setting of ms_used[]
    is not evaluated.
 */
-                if ((ics_right != NULL)
-                    && is_noise(ics_right, g, sfb))
-                {
+    if ((ics_right != NULL) && (g < ics_right->num_window_groups) &&
+        (sfb < ics_right->max_sfb) && is_noise(ics_right, g, sfb))
+    {
 #ifdef LTP_DEC
-                    /* See comment above. */
-                    ics_right->ltp.long_used[sfb] = 0;
-                    ics_right->ltp2.long_used[sfb] = 0;
+        /* See comment above. */
+        ics_right->ltp.long_used[sfb] = 0;
+        ics_right->ltp2.long_used[sfb] = 0;
 #endif
 #ifdef MAIN_DEC
-                    /* See comment above. */
-                    ics_right->pred.prediction_used[sfb] = 0;
+        /* See comment above. */
+        ics_right->pred.prediction_used[sfb] = 0;
 #endif
 
-                    if (channel_pair && is_noise(ics_left, g, sfb) &&
-                        (((ics_left->ms_mask_present == 1) &&
-                        (ics_left->ms_used[g][sfb])) ||
-                        (ics_left->ms_mask_present == 2)))
-                    {
-                        /*uint16_t c;*/
+        if (channel_pair && is_noise(ics_left, g, sfb) &&
+            (((ics_left->ms_mask_present == 1) &&
+            (ics_left->ms_used[g][sfb])) ||
+            (ics_left->ms_mask_present == 2)))
+        {
+            /*uint16_t c;*/
+
+            offs = ics_right->swb_offset[sfb];
+            size = min(ics_right->swb_offset[sfb+1], ics_right->swb_offset_max) - offs;
 
-                        offs = ics_right->swb_offset[sfb];
-                        size = min(ics_right->swb_offset[sfb+1], ics_right->swb_offset_max) - offs;
+            /* Generate random vector dependent on left channel*/
+            gen_noise_band(&spec_right[base+offs],
+                ics_right->scale_factors[g][sfb], size, sub, &r1_dep, &r2_dep,
+                pns_mode, dsp);
 
-                        /* Generate random vector dependent on left channel*/
-                        gen_rand_vector(&spec_right[(group*nshort)+offs],
-                            ics_right->scale_factors[g][sfb], size, sub, &r1_dep, &r2_dep);
+        } else /*if (ics_left->ms_mask_present == 0)*/ {
 
-                    } else /*if (ics_left->ms_mask_present == 0)*/ {
+            offs = ics_right->swb_offset[sfb];
+            size = min(ics_right->swb_offset[sfb+1], ics_right->swb_offset_max) - offs;
 
-                        offs = ics_right->swb_offset[sfb];
-                        size = min(ics_right->swb_offset[sfb+1], ics_right->swb_offset_max) - offs;
+            /* Generate random vector */
+            gen_noise_band(&spec_right[base+offs],
+                ics_right->scale_factors[g][sfb], size, sub, __r1, __r2,
+                pns_mode, dsp);
+        }
+    }
+}
+
+void pns_decode(ic_stream *ics_left, ic_stream *ics_right,
+                real_t *spec_left, real_t *spec_right, uint16_t frame_len,
+                uint8_t channel_pair, uint8_t object_type,
+                /* RNG states */ uint32_t *__r1, uint32_t *__r2,
+                uint8_t pns_mode, const dsp_funcs *dsp)
+{
+    uint8_t g, sfb, b;
 
-                        /* Generate random vector */
-                        gen_rand_vector(&spec_right[(group*nshort)+offs],
-                            ics_right->scale_factors[g][sfb], size, sub, __r1, __r2);
-                    }
-                }
+    uint8_t group = 0;
+    uint16_t nshort = frame_len >> 3;
+
+    uint8_t sub = 0;
+
+#ifdef FIXED_POINT
+    /* IMDCT scaling */
+    if (object_type == LD)
+    {
+        sub = 9 /*9*/;
+    } else {
+        if (ics_left->window_sequence == EIGHT_SHORT_SEQUENCE)
+            sub = 7 /*7*/;
+        else
+            sub = 10 /*10*/;
+    }
+#endif
+
+    for (g = 0; g < ics_left->num_window_groups; g++)
+    {
+        /* Do perceptual noise substitution decoding */
+        for (b = 0; b < ics_left->window_group_length[g]; b++)
+        {
+            for (sfb = 0; sfb < ics_left->max_sfb; sfb++)
+            {
+                pns_decode_band(ics_left, ics_right, spec_left, spec_right,
+                    g, sfb, group*nshort, channel_pair, sub, __r1, __r2,
+                    pns_mode, dsp);
             } /* sfb */
             group++;
         } /* b */
@@ -39,10 +39,45 @@ extern "C" {
 
 #define NOISE_OFFSET 90
 
+void pns_decode_band(ic_stream *ics_left, ic_stream *ics_right,
+                     real_t *spec_left, real_t *spec_right,
+                     uint8_t g, uint8_t sfb, uint16_t base,
+                     uint8_t channel_pair, uint8_t sub,
+                     /* RNG states */ uint32_t *__r1, uint32_t *__r2,
+                     uint8_t pns_mode, const dsp_funcs *dsp);
 void pns_decode(ic_stream *ics_left, ic_stream *ics_right,
                 real_t *spec_left, real_t *spec_right, uint16_t frame_len,
                 uint8_t channel_pair, uint8_t object_type,
-                /* RNG states */ uint32_t *__r1, uint32_t *__r2);
+                /* RNG states */ uint32_t *__r1, uint32_t *__r2,
+                uint8_t pns_mode, const dsp_funcs *dsp);
+uint8_t pns_default_mode(void);
+
+#ifndef FIXED_POINT
+/* FAAD_PNS_FAST generator: value i of a band is a hash of the counter
+   __r1 + i and the seed __r2, so any number of values can be made at once.
+   The energy is summed in 8 interleaved partial sums, the SIMD versions of
+   pns_noise_c() use the same order. */
+#define PNS_GOLDEN 0x9E3779B9u
+
+static INLINE uint32_t pns_hash(uint32_t x)
+{
+    x ^= x >> 16;
+    x *= 0x85EBCA6Bu;
+    x ^= x >> 13;
+    x *= 0xC2B2AE35u;
+    x ^= x >> 16;
+
+    return x;
+}
+
+static INLINE real_t pns_sum8(const real_t *acc)
+{
+    return ((acc[0] + acc[4]) + (acc[2] + acc[6])) +
+        ((acc[1] + acc[5]) + (acc[3] + acc[7]));
+}
+
+real_t pns_noise_c(real_t *spec, uint16_t size, uint32_t seed, uint32_t counter);
+#endif
 
 static INLINE uint8_t is_noise(ic_stream *ics, uint8_t group, uint8_t sfb)
 {
@@ -55,20 +55,43 @@
 
 //#define PRINT_RVLC
 
+/* length_of_rvlc_sf is at most 11 bits, length_of_rvlc_escapes 8 bits */
+#define RVLC_SF_BYTES   256
+#define RVLC_ESC_BYTES  32
+/* the shortest escape codeword is 2 bits */
+#define RVLC_MAX_ESC    128
+
+/* RVLC data is copied out of the bitstream into a small zero padded
+   buffer, so both directions can be read with plain byte loads */
+typedef struct
+{
+    const uint8_t *buf;
+    uint32_t bytes; /* bytes of data, followed by 4 zero bytes */
+    uint32_t pos;   /* current bit position */
+} rvlc_bits;
+
+/* escape values, decoded in forward order from the escape data.
+   The forward pass takes them from the front, the reverse pass from
+   the back. */
+typedef struct
+{
+    int8_t value[RVLC_MAX_ESC];
+    uint8_t first;
+    uint8_t last;
+} rvlc_esc;
+
 /* static function declarations */
 static uint8_t rvlc_decode_sf_forward(ic_stream *ics,
-                                      bitfile *ld_sf,
-                                      bitfile *ld_esc,
-                                      uint8_t *is_used);
-#if 0
-static uint8_t rvlc_decode_sf_reverse(ic_stream *ics,
-                                      bitfile *ld_sf,
-                                      bitfile *ld_esc,
-                                      uint8_t is_used);
-#endif
-static int8_t rvlc_huffman_sf(bitfile *ld_sf, bitfile *ld_esc,
+                                      rvlc_bits *ld_sf,
+                                      rvlc_esc *esc,
+                                      uint16_t *error_pos);
+static void rvlc_decode_sf_reverse(ic_stream *ics,
+                                   rvlc_bits *ld_sf,
+                                   rvlc_esc *esc,
+                                   uint16_t error_pos);
+static int8_t rvlc_huffman_sf(rvlc_bits *ld_sf, rvlc_esc *esc,
                               int8_t direction);
-static int8_t rvlc_huffman_esc(bitfile *ld_esc, int8_t direction);
+static int8_t rvlc_huffman_esc(rvlc_bits *ld_esc);
 
 
 uint8_t rvlc_scale_factor_data(ic_stream *ics, bitfile *ld)
@@ -113,61 +136,110 @@ uint8_t rvlc_scale_factor_data(ic_stream *ics, bitfile *ld)
     return 0;
 }
 
-uint8_t rvlc_decode_scale_factors(ic_stream *ics, bitfile *ld)
+/* copy bits of RVLC data out of the bitstream, returns the number of bytes */
+static uint32_t rvlc_read_buffer(bitfile *ld, uint8_t *buffer, uint16_t bits)
 {
-    uint8_t result;
-    uint8_t intensity_used = 0;
-    uint8_t *rvlc_sf_buffer = NULL;
-    uint8_t *rvlc_esc_buffer = NULL;
-    bitfile ld_rvlc_sf, ld_rvlc_esc;
-//    bitfile ld_rvlc_sf_rev, ld_rvlc_esc_rev;
+    uint32_t i;
+    uint32_t bytes = bits >> 3;
+    uint8_t remainder = bits & 0x7;
 
-    if (ics->length_of_rvlc_sf > 0)
+    for (i = 0; i < bytes; i++)
     {
-        /* We read length_of_rvlc_sf bits here to put it in a
-           seperate bitfile.
-        */
-        rvlc_sf_buffer = faad_getbitbuffer(ld, ics->length_of_rvlc_sf
-            DEBUGVAR(1,156,"rvlc_decode_scale_factors(): bitbuffer: length_of_rvlc_sf"));
-
-        faad_initbits(&ld_rvlc_sf, (void*)rvlc_sf_buffer, bit2byte(ics->length_of_rvlc_sf));
-//        faad_initbits_rev(&ld_rvlc_sf_rev, (void*)rvlc_sf_buffer,
-//            ics->length_of_rvlc_sf);
+        buffer[i] = (uint8_t)faad_getbits(ld, 8
+            DEBUGVAR(1,156,"rvlc_decode_scale_factors(): bitbuffer"));
     }
 
+    if (remainder)
+    {
+        buffer[bytes++] = (uint8_t)(faad_getbits(ld, remainder
+            DEBUGVAR(1,157,"rvlc_decode_scale_factors(): bitbuffer")) << (8-remainder));
+    }
+
+    for (i = 0; i < 4; i++)
+        buffer[bytes + i] = 0;
+
+    return bytes;
+}
+
+/* reverse the bit order of bits of data, so the reverse pass can
+   use the same reader and tables as the forward pass */
+static uint32_t rvlc_reverse_buffer(const uint8_t *in, uint8_t *out, uint16_t bits)
+{
+    uint16_t i;
+    uint32_t bytes = bit2byte(bits);
+
+    memset(out, 0, bytes + 4);
+
+    for (i = 0; i < bits; i++)
+    {
+        uint16_t j = bits - 1 - i;
+
+        if (in[i >> 3] & (0x80 >> (i & 7)))
+            out[j >> 3] |= (uint8_t)(0x80 >> (j & 7));
+    }
+
+    return bytes;
+}
+
+uint8_t rvlc_decode_scale_factors(ic_stream *ics, bitfile *ld)
+{
+    uint8_t result;
+    uint16_t error_pos;
+    uint8_t rvlc_sf_buffer[RVLC_SF_BYTES + 4];
+    uint8_t rvlc_esc_buffer[RVLC_ESC_BYTES + 4];
+    rvlc_bits ld_rvlc_sf, ld_rvlc_esc;
+    rvlc_esc esc;
+
+    /* dpcm_noise_nrg is taken from length_of_rvlc_sf, on a bit error
+       this can wrap around */
+    if (ics->length_of_rvlc_sf >= 8*RVLC_SF_BYTES)
+        return 8;
+
+    ld_rvlc_sf.buf = rvlc_sf_buffer;
+    ld_rvlc_sf.bytes = rvlc_read_buffer(ld, rvlc_sf_buffer, ics->length_of_rvlc_sf);
+    ld_rvlc_sf.pos = 0;
+
+    esc.first = 0;
+    esc.last = 0;
+
     if (ics->sf_escapes_present)
     {
-        /* We read length_of_rvlc_escapes bits here to put it in a
-           seperate bitfile.
-        */
-        rvlc_esc_buffer = faad_getbitbuffer(ld, ics->length_of_rvlc_escapes
-            DEBUGVAR(1,157,"rvlc_decode_scale_factors(): bitbuffer: length_of_rvlc_escapes"));
-
-        faad_initbits(&ld_rvlc_esc, (void*)rvlc_esc_buffer, bit2byte(ics->length_of_rvlc_escapes));
-//        faad_initbits_rev(&ld_rvlc_esc_rev, (void*)rvlc_esc_buffer,
-//            ics->length_of_rvlc_escapes);
+        ld_rvlc_esc.buf = rvlc_esc_buffer;
+        ld_rvlc_esc.bytes = rvlc_read_buffer(ld, rvlc_esc_buffer, ics->length_of_rvlc_escapes);
+        ld_rvlc_esc.pos = 0;
+
+        /* the escapes are needed from both ends, decode them all here */
+        while (ld_rvlc_esc.pos < ics->length_of_rvlc_escapes &&
+            esc.last < RVLC_MAX_ESC)
+        {
+            esc.value[esc.last++] = rvlc_huffman_esc(&ld_rvlc_esc);
+        }
     }
 
     /* decode the rvlc scale factors and escapes */
-    result = rvlc_decode_sf_forward(ics, &ld_rvlc_sf,
-        &ld_rvlc_esc, &intensity_used);
-//    result = rvlc_decode_sf_reverse(ics, &ld_rvlc_sf_rev,
-//        &ld_rvlc_esc_rev, intensity_used);
+    result = rvlc_decode_sf_forward(ics, &ld_rvlc_sf, &esc, &error_pos);
 
+    /* on a bit error decode from the other end of the data, to find
+       the scalefactors behind the error position */
+    if (result == 0 && ics->length_of_rvlc_sf > 0 &&
+        error_pos < ics->num_window_groups*ics->max_sfb)
+    {
+        uint8_t rvlc_sf_buffer_rev[RVLC_SF_BYTES + 4];
+        rvlc_bits ld_rvlc_sf_rev;
 
-    if (rvlc_esc_buffer) faad_free(rvlc_esc_buffer);
-    if (rvlc_sf_buffer) faad_free(rvlc_sf_buffer);
+        ld_rvlc_sf_rev.buf = rvlc_sf_buffer_rev;
+        ld_rvlc_sf_rev.bytes = rvlc_reverse_buffer(rvlc_sf_buffer,
+            rvlc_sf_buffer_rev, ics->length_of_rvlc_sf);
+        ld_rvlc_sf_rev.pos = 0;
 
-    if (ics->length_of_rvlc_sf > 0)
-        faad_endbits(&ld_rvlc_sf);
-    if (ics->sf_escapes_present)
-        faad_endbits(&ld_rvlc_esc);
+        rvlc_decode_sf_reverse(ics, &ld_rvlc_sf_rev, &esc, error_pos);
+    }
 
     return result;
 }
 
-static uint8_t rvlc_decode_sf_forward(ic_stream *ics, bitfile *ld_sf, bitfile *ld_esc,
-                                      uint8_t *intensity_used)
+static uint8_t rvlc_decode_sf_forward(ic_stream *ics, rvlc_bits *ld_sf, rvlc_esc *esc,
+                                      uint16_t *error_pos)
 {
     int8_t g, sfb;
     int8_t t = 0;
@@ -182,6 +254,8 @@ static uint8_t rvlc_decode_sf_forward(ic_stream *ics, bitfile *ld_sf, bitfile *l
     printf("\nglobal_gain: %d\n", ics->global_gain);
 #endif
 
+    *error_pos = ics->num_window_groups*ics->max_sfb;
+
     for (g = 0; g < ics->num_window_groups; g++)
     {
         for (sfb = 0; sfb < ics->max_sfb; sfb++)
@@ -198,10 +272,8 @@ static uint8_t rvlc_decode_sf_forward(ic_stream *ics, bitfile *ld_sf, bitfile *l
                 case INTENSITY_HCB: /* intensity books */
                 case INTENSITY_HCB2:
 
-                    *intensity_used = 1;
-
                     /* decode intensity position */
-                    t = rvlc_huffman_sf(ld_sf, ld_esc, +1);
+                    t = rvlc_huffman_sf(ld_sf, esc, +1);
 
                     is_position += t;
                     ics->scale_factors[g][sfb] = is_position;
@@ -216,7 +288,7 @@ static uint8_t rvlc_decode_sf_forward(ic_stream *ics, bitfile *ld_sf, bitfile *l
                         noise_pcm_flag = 0;
                         noise_energy += n;
                     } else {
-                        t = rvlc_huffman_sf(ld_sf, ld_esc, +1);
+                        t = rvlc_huffman_sf(ld_sf, esc, +1);
                         noise_energy += t;
                     }
 
@@ -226,7 +298,7 @@ static uint8_t rvlc_decode_sf_forward(ic_stream *ics, bitfile *ld_sf, bitfile *l
                 default: /* spectral books */
 
                     /* decode scale factor */
-                    t = rvlc_huffman_sf(ld_sf, ld_esc, +1);
+                    t = rvlc_huffman_sf(ld_sf, esc, +1);
 
                     scale_factor += t;
                     if (scale_factor < 0)
@@ -243,6 +315,7 @@ static uint8_t rvlc_decode_sf_forward(ic_stream *ics, bitfile *ld_sf, bitfile *l
                 if (t == 99)
                 {
                     error = 1;
+                    *error_pos = g*ics->max_sfb + sfb;
                 }
             }
         }
@@ -254,26 +327,52 @@ static uint8_t rvlc_decode_sf_forward(ic_stream *ics, bitfile *ld_sf, bitfile *l
     return 0;
 }
 
-#if 0 // not used right now, doesn't work correctly yet
-static uint8_t rvlc_decode_sf_reverse(ic_stream *ics, bitfile *ld_sf, bitfile *ld_esc,
-                                      uint8_t intensity_used)
+/* Decodes the scalefactors from the end of the data back to error_pos,
+   the band where the forward pass found a bit error. Everything before
+   error_pos is kept from the forward pass. If this pass runs into an
+   error too, the band at error_pos is cleared like the ones behind it.
+ */
+static void rvlc_decode_sf_reverse(ic_stream *ics, rvlc_bits *ld_sf, rvlc_esc *esc,
+                                   uint16_t error_pos)
 {
     int8_t g, sfb;
     int8_t t = 0;
-    int8_t error = 0;
-    int8_t noise_pcm_flag = 1, is_pcm_flag = 1, sf_pcm_flag = 1;
+    uint8_t intensity_used = 0;
+    uint16_t pos = ics->num_window_groups*ics->max_sfb;
+    uint16_t first_noise = pos;
 
     int16_t scale_factor = ics->rev_global_gain;
     int16_t is_position = 0;
-    int16_t noise_energy = ics->rev_global_gain;
+    int16_t noise_energy = ics->rev_global_gain - 90 - 256 + ics->dpcm_noise_last_position;
 
 #ifdef PRINT_RVLC
     printf("\nrev_global_gain: %d\n", ics->rev_global_gain);
 #endif
 
+    /* the first noise energy is PCM coded, and the intensity positions
+       are followed by a codeword for the last position */
+    for (g = ics->num_window_groups-1; g >= 0; g--)
+    {
+        for (sfb = ics->max_sfb-1; sfb >= 0; sfb--)
+        {
+            switch (ics->sfb_cb[g][sfb])
+            {
+            case INTENSITY_HCB:
+            case INTENSITY_HCB2:
+                intensity_used = 1;
+                break;
+            case NOISE_HCB:
+                first_noise = g*ics->max_sfb + sfb;
+                break;
+            }
+        }
+    }
+
     if (intensity_used)
     {
-        is_position = rvlc_huffman_sf(ld_sf, ld_esc, -1);
+        is_position = rvlc_huffman_sf(ld_sf, esc, -1);
+        if (is_position == 99)
+            goto error;
 #ifdef PRINT_RVLC
         printf("is_position: %d\n", is_position);
 #endif
@@ -283,251 +382,375 @@ static uint8_t rvlc_decode_sf_reverse(ic_stream *ics, bitfile *ld_sf, bitfile *l
     {
         for (sfb = ics->max_sfb-1; sfb >= 0; sfb--)
         {
-            if (error)
+            pos--;
+
+            switch (ics->sfb_cb[g][sfb])
             {
+            case ZERO_HCB: /* zero book */
                 ics->scale_factors[g][sfb] = 0;
-            } else {
-                switch (ics->sfb_cb[g][sfb])
-                {
-                case ZERO_HCB: /* zero book */
-                    ics->scale_factors[g][sfb] = 0;
-                    break;
-                case INTENSITY_HCB: /* intensity books */
-                case INTENSITY_HCB2:
+                break;
+            case INTENSITY_HCB: /* intensity books */
+            case INTENSITY_HCB2:
 
-                    if (is_pcm_flag)
-                    {
-                        is_pcm_flag = 0;
-                        ics->scale_factors[g][sfb] = is_position;
-                    } else {
-                        t = rvlc_huffman_sf(ld_sf, ld_esc, -1);
-                        is_position -= t;
+                ics->scale_factors[g][sfb] = is_position;
 
-                        ics->scale_factors[g][sfb] = (uint8_t)is_position;
-                    }
-                    break;
-                case NOISE_HCB: /* noise books */
+                t = rvlc_huffman_sf(ld_sf, esc, -1);
+                is_position -= t;
 
-                    /* decode noise energy */
-                    if (noise_pcm_flag)
-                    {
-                        noise_pcm_flag = 0;
-                        noise_energy = ics->dpcm_noise_last_position;
-                    } else {
-                        t = rvlc_huffman_sf(ld_sf, ld_esc, -1);
-                        noise_energy -= t;
-                    }
+                break;
+            case NOISE_HCB: /* noise books */
 
-                    ics->scale_factors[g][sfb] = (uint8_t)noise_energy;
-                    break;
-                default: /* spectral books */
+                ics->scale_factors[g][sfb] = noise_energy;
 
-                    if (sf_pcm_flag || (sfb == 0))
-                    {
-                        sf_pcm_flag = 0;
-                        if (sfb == 0)
-                            scale_factor = ics->global_gain;
-                    } else {
-                        /* decode scale factor */
-                        t = rvlc_huffman_sf(ld_sf, ld_esc, -1);
-                        scale_factor -= t;
-                    }
+                if (pos != first_noise)
+                {
+                    t = rvlc_huffman_sf(ld_sf, esc, -1);
+                    noise_energy -= t;
+                }
 
-                    if (scale_factor < 0)
-                        return 4;
+                break;
+            default: /* spectral books */
 
-                    ics->scale_factors[g][sfb] = (uint8_t)scale_factor;
-                    break;
-                }
+                if (scale_factor < 0)
+                    goto error;
+
+                ics->scale_factors[g][sfb] = scale_factor;
+
+                t = rvlc_huffman_sf(ld_sf, esc, -1);
+                scale_factor -= t;
+
+                break;
+            }
 #ifdef PRINT_RVLC
-                printf("%3d:%4d%4d\n", sfb, ics->sfb_cb[g][sfb],
-                    ics->scale_factors[g][sfb]);
+            printf("%3d:%4d%4d\n", sfb, ics->sfb_cb[g][sfb],
+                ics->scale_factors[g][sfb]);
 #endif
-                if (t == 99)
-                {
-                    error = 1;
-                }
-            }
+            if (pos == error_pos)
+                return;
+
+            if (t == 99 || ld_sf->pos > ics->length_of_rvlc_sf)
+                goto error;
         }
     }
 
-#ifdef PRINT_RVLC
-    printf("\n\n");
-#endif
+    return;
 
-    return 0;
+error:
+    ics->scale_factors[error_pos / ics->max_sfb][error_pos % ics->max_sfb] = 0;
 }
-#endif
 
-/* index == 99 means not allowed codeword */
-static rvlc_huff_table book_rvlc[] = {
-    /*index  length  codeword */
-    {  0, 1,   0 }, /*         0 */
-    { -1, 3,   5 }, /*       101 */
-    {  1, 3,   7 }, /*       111 */
-    { -2, 4,   9 }, /*      1001 */
-    { -3, 5,  17 }, /*     10001 */
-    {  2, 5,  27 }, /*     11011 */
-    { -4, 6,  33 }, /*    100001 */
-    { 99, 6,  50 }, /*    110010 */
-    {  3, 6,  51 }, /*    110011 */
-    { 99, 6,  52 }, /*    110100 */
-    { -7, 7,  65 }, /*   1000001 */
-    { 99, 7,  96 }, /*   1100000 */
-    { 99, 7,  98 }, /*   1100010 */
-    {  7, 7,  99 }, /*   1100011 */
-    {  4, 7, 107 }, /*   1101011 */
-    { -5, 8, 129 }, /*  10000001 */
-    { 99, 8, 194 }, /*  11000010 */
-    {  5, 8, 195 }, /*  11000011 */
-    { 99, 8, 212 }, /*  11010100 */
-    { 99, 9, 256 }, /* 100000000 */
-    { -6, 9, 257 }, /* 100000001 */
-    { 99, 9, 426 }, /* 110101010 */
-    {  6, 9, 427 }, /* 110101011 */
-    { 99, 10,  0 } /* Shouldn't come this far */
+/* multi-step lookup tables for the RVLC codewords, an entry with len 0
+   continues in the sub table at offset using the next index bits.
+   index == 99 means not allowed codeword */
+static const rvlc_lut rvlc_sf_lut[] = {
+    /* 1st step: 5 bits */
+    { /* 0             */  1,   0,   0 },
+    { /*               */  1,   0,   0 },
+    { /*               */  1,   0,   0 },
+    { /*               */  1,   0,   0 },
+    { /*               */  1,   0,   0 },
+    { /*               */  1,   0,   0 },
+    { /*               */  1,   0,   0 },
+    { /*               */  1,   0,   0 },
+    { /*               */  1,   0,   0 },
+    { /*               */  1,   0,   0 },
+    { /*               */  1,   0,   0 },
+    { /*               */  1,   0,   0 },
+    { /*               */  1,   0,   0 },
+    { /*               */  1,   0,   0 },
+    { /*               */  1,   0,   0 },
+    { /*               */  1,   0,   0 },
+    { /* 10000...      */  0,   4,  32 },
+    { /* 10001         */  5,  -3,   0 },
+    { /* 1001          */  4,  -2,   0 },
+    { /*               */  4,  -2,   0 },
+    { /* 101           */  3,  -1,   0 },
+    { /*               */  3,  -1,   0 },
+    { /*               */  3,  -1,   0 },
+    { /*               */  3,  -1,   0 },
+    { /* 11000...      */  0,   3,  48 },
+    { /* 11001...      */  0,   1,  56 },
+    { /* 11010...      */  0,   4,  58 },
+    { /* 11011         */  5,   2,   0 },
+    { /* 111           */  3,   1,   0 },
+    { /*               */  3,   1,   0 },
+    { /*               */  3,   1,   0 },
+    { /*               */  3,   1,   0 },
+
+    /* sub tables */
+    { /* 100000000     */  9,  99,   0 },
+    { /* 100000001     */  9,  -6,   0 },
+    { /* 10000001      */  8,  -5,   0 },
+    { /*               */  8,  -5,   0 },
+    { /* 1000001       */  7,  -7,   0 },
+    { /*               */  7,  -7,   0 },
+    { /*               */  7,  -7,   0 },
+    { /*               */  7,  -7,   0 },
+    { /* 100001        */  6,  -4,   0 },
+    { /*               */  6,  -4,   0 },
+    { /*               */  6,  -4,   0 },
+    { /*               */  6,  -4,   0 },
+    { /*               */  6,  -4,   0 },
+    { /*               */  6,  -4,   0 },
+    { /*               */  6,  -4,   0 },
+    { /*               */  6,  -4,   0 },
+    { /* 1100000       */  7,  99,   0 },
+    { /*               */  7,  99,   0 },
+    { /* 11000010      */  8,  99,   0 },
+    { /* 11000011      */  8,   5,   0 },
+    { /* 1100010       */  7,  99,   0 },
+    { /*               */  7,  99,   0 },
+    { /* 1100011       */  7,   7,   0 },
+    { /*               */  7,   7,   0 },
+    { /* 110010        */  6,  99,   0 },
+    { /* 110011        */  6,   3,   0 },
+    { /* 110100        */  6,  99,   0 },
+    { /*               */  6,  99,   0 },
+    { /*               */  6,  99,   0 },
+    { /*               */  6,  99,   0 },
+    { /*               */  6,  99,   0 },
+    { /*               */  6,  99,   0 },
+    { /*               */  6,  99,   0 },
+    { /*               */  6,  99,   0 },
+    { /* 11010100      */  8,  99,   0 },
+    { /*               */  8,  99,   0 },
+    { /* 110101010     */  9,  99,   0 },
+    { /* 110101011     */  9,   6,   0 },
+    { /* 1101011       */  7,   4,   0 },
+    { /*               */  7,   4,   0 },
+    { /*               */  7,   4,   0 },
+    { /*               */  7,   4,   0 }
 };
 
-static rvlc_huff_table book_escape[] = {
-    /*index  length  codeword */
-    { 1, 2, 0 },
-    { 0, 2, 2 },
-    { 3, 3, 2 },
-    { 2, 3, 6 },
-    { 4, 4, 14 },
-    { 7, 5, 13 },
-    { 6, 5, 15 },
-    { 5, 5, 31 },
-    { 11, 6, 24 },
-    { 10, 6, 25 },
-    { 9, 6, 29 },
-    { 8, 6, 61 },
-    { 13, 7, 56  },
-    { 12, 7, 120 },
-    { 15, 8, 114 },
-    { 14, 8, 242 },
-    { 17, 9, 230 },
-    { 16, 9, 486 },
-    { 19, 10, 463  },
-    { 18, 10, 974  },
-    { 22, 11, 925  },
-    { 20, 11, 1950 },
-    { 21, 11, 1951 },
-    { 23, 12, 1848 },
-    { 25, 13, 3698 },
-    { 24, 14, 7399 },
-    { 26, 15, 14797 },
-    { 49, 19, 236736 },
-    { 50, 19, 236737 },
-    { 51, 19, 236738 },
-    { 52, 19, 236739 },
-    { 53, 19, 236740 },
-    { 27, 20, 473482 },
-    { 28, 20, 473483 },
-    { 29, 20, 473484 },
-    { 30, 20, 473485 },
-    { 31, 20, 473486 },
-    { 32, 20, 473487 },
-    { 33, 20, 473488 },
-    { 34, 20, 473489 },
-    { 35, 20, 473490 },
-    { 36, 20, 473491 },
-    { 37, 20, 473492 },
-    { 38, 20, 473493 },
-    { 39, 20, 473494 },
-    { 40, 20, 473495 },
-    { 41, 20, 473496 },
-    { 42, 20, 473497 },
-    { 43, 20, 473498 },
-    { 44, 20, 473499 },
-    { 45, 20, 473500 },
-    { 46, 20, 473501 },
-    { 47, 20, 473502 },
-    { 48, 20, 473503 },
-    { 99, 21,  0 } /* Shouldn't come this far */
+static const rvlc_lut rvlc_esc_lut[] = {
+    /* 1st step: 6 bits */
+    { /* 00                       */  2,   1,   0 },
+    { /*                          */  2,   1,   0 },
+    { /*                          */  2,   1,   0 },
+    { /*                          */  2,   1,   0 },
+    { /*                          */  2,   1,   0 },
+    { /*                          */  2,   1,   0 },
+    { /*                          */  2,   1,   0 },
+    { /*                          */  2,   1,   0 },
+    { /*                          */  2,   1,   0 },
+    { /*                          */  2,   1,   0 },
+    { /*                          */  2,   1,   0 },
+    { /*                          */  2,   1,   0 },
+    { /*                          */  2,   1,   0 },
+    { /*                          */  2,   1,   0 },
+    { /*                          */  2,   1,   0 },
+    { /*                          */  2,   1,   0 },
+    { /* 010                      */  3,   3,   0 },
+    { /*                          */  3,   3,   0 },
+    { /*                          */  3,   3,   0 },
+    { /*                          */  3,   3,   0 },
+    { /*                          */  3,   3,   0 },
+    { /*                          */  3,   3,   0 },
+    { /*                          */  3,   3,   0 },
+    { /*                          */  3,   3,   0 },
+    { /* 011000                   */  6,  11,   0 },
+    { /* 011001                   */  6,  10,   0 },
+    { /* 01101                    */  5,   7,   0 },
+    { /*                          */  5,   7,   0 },
+    { /* 011100...                */  0,   4,  64 },
+    { /* 011101                   */  6,   9,   0 },
+    { /* 01111                    */  5,   6,   0 },
+    { /*                          */  5,   6,   0 },
+    { /* 10                       */  2,   0,   0 },
+    { /*                          */  2,   0,   0 },
+    { /*                          */  2,   0,   0 },
+    { /*                          */  2,   0,   0 },
+    { /*                          */  2,   0,   0 },
+    { /*                          */  2,   0,   0 },
+    { /*                          */  2,   0,   0 },
+    { /*                          */  2,   0,   0 },
+    { /*                          */  2,   0,   0 },
+    { /*                          */  2,   0,   0 },
+    { /*                          */  2,   0,   0 },
+    { /*                          */  2,   0,   0 },
+    { /*                          */  2,   0,   0 },
+    { /*                          */  2,   0,   0 },
+    { /*                          */  2,   0,   0 },
+    { /*                          */  2,   0,   0 },
+    { /* 110                      */  3,   2,   0 },
+    { /*                          */  3,   2,   0 },
+    { /*                          */  3,   2,   0 },
+    { /*                          */  3,   2,   0 },
+    { /*                          */  3,   2,   0 },
+    { /*                          */  3,   2,   0 },
+    { /*                          */  3,   2,   0 },
+    { /*                          */  3,   2,   0 },
+    { /* 1110                     */  4,   4,   0 },
+    { /*                          */  4,   4,   0 },
+    { /*                          */  4,   4,   0 },
+    { /*                          */  4,   4,   0 },
+    { /* 111100...                */  0,   4, 140 },
+    { /* 111101                   */  6,   8,   0 },
+    { /* 11111                    */  5,   5,   0 },
+    { /*                          */  5,   5,   0 },
+
+    /* sub tables */
+    { /* 0111000                  */  7,  13,   0 },
+    { /*                          */  7,  13,   0 },
+    { /*                          */  7,  13,   0 },
+    { /*                          */  7,  13,   0 },
+    { /*                          */  7,  13,   0 },
+    { /*                          */  7,  13,   0 },
+    { /*                          */  7,  13,   0 },
+    { /*                          */  7,  13,   0 },
+    { /* 01110010                 */  8,  15,   0 },
+    { /*                          */  8,  15,   0 },
+    { /*                          */  8,  15,   0 },
+    { /*                          */  8,  15,   0 },
+    { /* 011100110                */  9,  17,   0 },
+    { /*                          */  9,  17,   0 },
+    { /* 0111001110...            */  0,   4,  80 },
+    { /* 0111001111               */ 10,  19,   0 },
+    { /* 011100111000             */ 12,  23,   0 },
+    { /*                          */ 12,  23,   0 },
+    { /*                          */ 12,  23,   0 },
+    { /*                          */ 12,  23,   0 },
+    { /* 0111001110010            */ 13,  25,   0 },
+    { /*                          */ 13,  25,   0 },
+    { /* 01110011100110...        */  0,   4,  96 },
+    { /* 01110011100111           */ 14,  24,   0 },
+    { /* 01110011101              */ 11,  22,   0 },
+    { /*                          */ 11,  22,   0 },
+    { /*                          */ 11,  22,   0 },
+    { /*                          */ 11,  22,   0 },
+    { /*                          */ 11,  22,   0 },
+    { /*                          */ 11,  22,   0 },
+    { /*                          */ 11,  22,   0 },
+    { /*                          */ 11,  22,   0 },
+    { /* 011100111001100000...    */  0,   1, 112 },
+    { /* 011100111001100001...    */  0,   1, 114 },
+    { /* 011100111001100010...    */  0,   2, 116 },
+    { /* 011100111001100011...    */  0,   2, 120 },
+    { /* 011100111001100100...    */  0,   2, 124 },
+    { /* 011100111001100101...    */  0,   2, 128 },
+    { /* 011100111001100110...    */  0,   2, 132 },
+    { /* 011100111001100111...    */  0,   2, 136 },
+    { /* 011100111001101          */ 15,  26,   0 },
+    { /*                          */ 15,  26,   0 },
+    { /*                          */ 15,  26,   0 },
+    { /*                          */ 15,  26,   0 },
+    { /*                          */ 15,  26,   0 },
+    { /*                          */ 15,  26,   0 },
+    { /*                          */ 15,  26,   0 },
+    { /*                          */ 15,  26,   0 },
+    { /* 0111001110011000000      */ 19,  49,   0 },
+    { /* 0111001110011000001      */ 19,  50,   0 },
+    { /* 0111001110011000010      */ 19,  51,   0 },
+    { /* 0111001110011000011      */ 19,  52,   0 },
+    { /* 0111001110011000100      */ 19,  53,   0 },
+    { /*                          */ 19,  53,   0 },
+    { /* 01110011100110001010     */ 20,  27,   0 },
+    { /* 01110011100110001011     */ 20,  28,   0 },
+    { /* 01110011100110001100     */ 20,  29,   0 },
+    { /* 01110011100110001101     */ 20,  30,   0 },
+    { /* 01110011100110001110     */ 20,  31,   0 },
+    { /* 01110011100110001111     */ 20,  32,   0 },
+    { /* 01110011100110010000     */ 20,  33,   0 },
+    { /* 01110011100110010001     */ 20,  34,   0 },
+    { /* 01110011100110010010     */ 20,  35,   0 },
+    { /* 01110011100110010011     */ 20,  36,   0 },
+    { /* 01110011100110010100     */ 20,  37,   0 },
+    { /* 01110011100110010101     */ 20,  38,   0 },
+    { /* 01110011100110010110     */ 20,  39,   0 },
+    { /* 01110011100110010111     */ 20,  40,   0 },
+    { /* 01110011100110011000     */ 20,  41,   0 },
+    { /* 01110011100110011001     */ 20,  42,   0 },
+    { /* 01110011100110011010     */ 20,  43,   0 },
+    { /* 01110011100110011011     */ 20,  44,   0 },
+    { /* 01110011100110011100     */ 20,  45,   0 },
+    { /* 01110011100110011101     */ 20,  46,   0 },
+    { /* 01110011100110011110     */ 20,  47,   0 },
+    { /* 01110011100110011111     */ 20,  48,   0 },
+    { /* 1111000                  */  7,  12,   0 },
+    { /*                          */  7,  12,   0 },
+    { /*                          */  7,  12,   0 },
+    { /*                          */  7,  12,   0 },
+    { /*                          */  7,  12,   0 },
+    { /*                          */  7,  12,   0 },
+    { /*                          */  7,  12,   0 },
+    { /*                          */  7,  12,   0 },
+    { /* 11110010                 */  8,  14,   0 },
+    { /*                          */  8,  14,   0 },
+    { /*                          */  8,  14,   0 },
+    { /*                          */  8,  14,   0 },
+    { /* 111100110                */  9,  16,   0 },
+    { /*                          */  9,  16,   0 },
+    { /* 1111001110               */ 10,  18,   0 },
+    { /* 1111001111...            */  0,   1, 156 },
+    { /* 11110011110              */ 11,  20,   0 },
+    { /* 11110011111              */ 11,  21,   0 }
 };
 
-static int8_t rvlc_huffman_sf(bitfile *ld_sf, bitfile *ld_esc,
-                              int8_t direction)
+/* peek 32 bits, at least 25 of them are valid */
+static INLINE uint32_t rvlc_showbits(rvlc_bits *ld)
 {
-    uint8_t i, j;
-    int8_t index;
-    uint32_t cw;
-    rvlc_huff_table *h = book_rvlc;
-
-    i = h->len;
-    if (direction > 0)
-        cw = faad_getbits(ld_sf, i DEBUGVAR(1,0,""));
-    else
-        cw = faad_getbits_rev(ld_sf, i DEBUGVAR(1,0,""));
-
-    while ((cw != h->cw)
-        && (i < 10))
-    {
-        h++;
-        j = h->len-i;
-        i += j;
-        cw <<= j;
-        if (direction > 0)
-            cw |= faad_getbits(ld_sf, j DEBUGVAR(1,0,""));
-        else
-            cw |= faad_getbits_rev(ld_sf, j DEBUGVAR(1,0,""));
-    }
+    uint32_t i = ld->pos >> 3;
+    const uint8_t *p = ld->buf + i;
 
-    index = h->index;
+    if (i >= ld->bytes)
+        return 0;
 
-    if (index == +ESC_VAL)
+    return (((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+        ((uint32_t)p[2] << 8) | (uint32_t)p[3]) << (ld->pos & 7);
+}
+
+static INLINE int8_t rvlc_lookup(rvlc_bits *ld, const rvlc_lut *lut, uint8_t bits)
+{
+    uint32_t cw = rvlc_showbits(ld);
+    const rvlc_lut *h = &lut[cw >> (32 - bits)];
+
+    while (h->len == 0)
     {
-        int8_t esc = rvlc_huffman_esc(ld_esc, direction);
-        if (esc == 99)
-            return 99;
-        index += esc;
-#ifdef PRINT_RVLC
-        printf("esc: %d - ", esc);
-#endif
+        uint8_t extra_bits = (uint8_t)h->index;
+
+        h = &lut[h->offset + ((cw << bits) >> (32 - extra_bits))];
+        bits += extra_bits;
     }
-    if (index == -ESC_VAL)
+
+    ld->pos += h->len;
+
+    return h->index;
+}
+
+/* the scalefactor codewords are symmetric, so the same table is used
+   for both directions */
+static int8_t rvlc_huffman_sf(rvlc_bits *ld_sf, rvlc_esc *esc,
+                              int8_t direction)
+{
+    int8_t index = rvlc_lookup(ld_sf, rvlc_sf_lut, 5);
+
+    if (index == +ESC_VAL || index == -ESC_VAL)
     {
-        int8_t esc = rvlc_huffman_esc(ld_esc, direction);
-        if (esc == 99)
+        int8_t e;
+
+        if (esc->first == esc->last)
             return 99;
-        index -= esc;
+
+        if (direction > 0)
+            e = esc->value[esc->first++];
+        else
+            e = esc->value[--esc->last];
 #ifdef PRINT_RVLC
-        printf("esc: %d - ", esc);
+        printf("esc: %d - ", e);
 #endif
+
+        if (index > 0)
+            index += e;
+        else
+            index -= e;
     }
 
     return index;
 }
 
-static int8_t rvlc_huffman_esc(bitfile *ld,
-                               int8_t direction)
+static int8_t rvlc_huffman_esc(rvlc_bits *ld_esc)
 {
-    uint8_t i, j;
-    uint32_t cw;
-    rvlc_huff_table *h = book_escape;
-
-    i = h->len;
-    if (direction > 0)
-        cw = faad_getbits(ld, i DEBUGVAR(1,0,""));
-    else
-        cw = faad_getbits_rev(ld, i DEBUGVAR(1,0,""));
-
-    while ((cw != h->cw)
-        && (i < 21))
-    {
-        h++;
-        j = h->len-i;
-        i += j;
-        cw <<= j;
-        if (direction > 0)
-            cw |= faad_getbits(ld, j DEBUGVAR(1,0,""));
-        else
-            cw |= faad_getbits_rev(ld, j DEBUGVAR(1,0,""));
-    }
-
-    return h->index;
+    return rvlc_lookup(ld_esc, rvlc_esc_lut, 6);
 }
 
 #endif
-
@@ -37,10 +37,10 @@ extern "C" {
 
 typedef struct
 {
-    int8_t index;
-    uint8_t len;
-    uint32_t cw;
-} rvlc_huff_table;
+    uint8_t len;    /* codeword length, 0 for a sub table entry */
+    int8_t index;   /* decoded value, or bits to index the sub table */
+    uint8_t offset; /* start of the sub table */
+} rvlc_lut;
 
 
 #define ESC_VAL 7
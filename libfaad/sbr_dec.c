@@ -63,6 +63,7 @@ sbr_info *sbrDecodeInit(uint16_t framelength, uint8_t id_aac,
     /* save id of the parent element */
     sbr->id_aac = id_aac;
     sbr->sample_rate = sample_rate;
+    sbr->dsp = dsp_select(FAAD_CPU_AUTO);
 
     sbr->bs_freq_scale = 2;
     sbr->bs_alter_scale = 1;
@@ -479,6 +480,7 @@ uint8_t sbrDecodeCoupleFrame(sbr_info *sbr, real_t *left_chan, real_t *right_cha
     if (just_seeked)
     {
         sbr->just_seeked = 1;
+        sbr->phase_sync = (sbr->id_aac == ID_CPE) ? 3 : 1;
     } else {
         sbr->just_seeked = 0;
     }
@@ -562,6 +564,7 @@ uint8_t sbrDecodeSingleFrame(sbr_info *sbr, real_t *channel,
     if (just_seeked)
     {
         sbr->just_seeked = 1;
+        sbr->phase_sync = (sbr->id_aac == ID_CPE) ? 3 : 1;
     } else {
         sbr->just_seeked = 0;
     }
@@ -609,6 +612,7 @@ uint8_t sbrDecodeSingleFramePS(sbr_info *sbr, real_t *left_channel, real_t *righ
     uint8_t l, k;
     uint8_t dont_process = 0;
     uint8_t ret = 0;
+    stats_mark ps_mark;
     ALIGN qmf_t X_left[38][64] = {{0}};
     ALIGN qmf_t X_right[38][64] = {{0}}; /* must set this to 0 */
 
@@ -632,6 +636,7 @@ uint8_t sbrDecodeSingleFramePS(sbr_info *sbr, real_t *left_channel, real_t *righ
     if (just_seeked)
     {
         sbr->just_seeked = 1;
+        sbr->phase_sync = (sbr->id_aac == ID_CPE) ? 3 : 1;
     } else {
         sbr->just_seeked = 0;
     }
@@ -654,6 +659,7 @@ uint8_t sbrDecodeSingleFramePS(sbr_info *sbr, real_t *left_channel, real_t *righ
     }
 
     /* perform parametric stereo */
+    stats_begin(sbr->stats, &ps_mark);
 #ifdef DRM_PS
     if (sbr->Is_DRM_SBR)
     {
@@ -666,6 +672,7 @@ uint8_t sbrDecodeSingleFramePS(sbr_info *sbr, real_t *left_channel, real_t *righ
 #ifdef DRM_PS
     }
 #endif
+    stats_end(sbr->stats, &ps_mark, FAAD_STAGE_PS);
 
     /* subband synthesis */
     if (downSampledSBR)
@@ -35,6 +35,8 @@
 extern "C" {
 #endif
 
+#include "dsp.h"
+#include "stats.h"
 #ifdef PS_DEC
 #include "ps_dec.h"
 #endif
@@ -143,6 +145,8 @@ typedef struct
 
     uint16_t index_noise_prev[2];
     uint8_t psi_is_prev[2];
+    /* channels whose phases are set from frame after a seek */
+    uint8_t phase_sync;
 
     uint8_t bs_start_freq_prev;
     uint8_t bs_stop_freq_prev;
@@ -167,6 +171,9 @@ typedef struct
     qmfa_info *qmfa[2];
     qmfs_info *qmfs[2];
 
+    const dsp_funcs *dsp;
+    faad_stats *stats;
+
     qmf_t Xsbr[2][MAX_NTSRHFG][64];
 
 #ifdef DRM
@@ -1560,6 +1560,19 @@ static void hf_assembly(sbr_info *sbr, sbr_hfadj_info *adj,
     }
     fIndexSine = sbr->psi_is_prev[ch];
 
+    /* after a seek the phases continue where a decode from the start has
+       them: both take one step per band and time slot from the first
+       frame on, and the envelopes of a frame start where the ones of the
+       frame before it end */
+    if (sbr->phase_sync & (1 << ch))
+    {
+        uint32_t slots = sbr->frame * sbr->numTimeSlotsRate + sbr->t_E[ch][0];
+
+        fIndexNoise = (uint16_t)((slots * sbr->M) & 511);
+        fIndexSine = (uint8_t)(slots & 3);
+        sbr->phase_sync &= ~(1 << ch);
+    }
+
 
     for (l = 0; l < sbr->L_E[ch]; l++)
     {
@@ -66,6 +66,21 @@ void qmfa_end(qmfa_info *qmfa)
     }
 }
 
+/* analysis window, reference version of dsp->qmfa_window */
+void qmfa_window_c(const real_t *x, const real_t *c, real_t *u)
+{
+    uint8_t n;
+
+    for (n = 0; n < 64; n++)
+    {
+        u[n] = MUL_F(x[n], c[2*n]) +
+            MUL_F(x[n + 64], c[2*(n + 64)]) +
+            MUL_F(x[n + 128], c[2*(n + 128)]) +
+            MUL_F(x[n + 192], c[2*(n + 192)]) +
+            MUL_F(x[n + 256], c[2*(n + 256)]);
+    }
+}
+
 void sbr_qmf_analysis_32(sbr_info *sbr, qmfa_info *qmfa, const real_t *input,
                          qmf_t X[MAX_NTSRHFG][64], uint8_t offset, uint8_t kx)
 {
@@ -98,14 +113,7 @@ void sbr_qmf_analysis_32(sbr_info *sbr, qmfa_info *qmfa, const real_t *input,
         }
 
         /* window and summation to create array u */
-        for (n = 0; n < 64; n++)
-        {
-            u[n] = MUL_F(qmfa->x[qmfa->x_index + n], qmf_c[2*n]) +
-                MUL_F(qmfa->x[qmfa->x_index + n + 64], qmf_c[2*(n + 64)]) +
-                MUL_F(qmfa->x[qmfa->x_index + n + 128], qmf_c[2*(n + 128)]) +
-                MUL_F(qmfa->x[qmfa->x_index + n + 192], qmf_c[2*(n + 192)]) +
-                MUL_F(qmfa->x[qmfa->x_index + n + 256], qmf_c[2*(n + 256)]);
-        }
+        sbr->dsp->qmfa_window(qmfa->x + qmfa->x_index, qmf_c, u);
 
 		/* update ringbuffer index */
 		qmfa->x_index -= 32;
@@ -187,6 +195,64 @@ void sbr_qmf_analysis_32(sbr_info *sbr, qmfa_info *qmfa, const real_t *input,
     }
 }
 
+/* synthesis window, reference version of dsp->qmfs_window */
+void qmfs_window_c(const real_t *v, const real_t *c, real_t *out)
+{
+#ifdef PREFER_POINTERS
+    // These pointers are used if target platform has autoinc address generators
+    const real_t * pring_buffer_1 = v;
+    const real_t * pring_buffer_2 = v + 192;
+    const real_t * pring_buffer_3 = v + 256;
+    const real_t * pring_buffer_4 = v + (256 + 192);
+    const real_t * pring_buffer_5 = v + 512;
+    const real_t * pring_buffer_6 = v + (512 + 192);
+    const real_t * pring_buffer_7 = v + 768;
+    const real_t * pring_buffer_8 = v + (768 + 192);
+    const real_t * pring_buffer_9 = v + 1024;
+    const real_t * pring_buffer_10 = v + (1024 + 192);
+    const real_t * pqmf_c_1 = c;
+    const real_t * pqmf_c_2 = c + 64;
+    const real_t * pqmf_c_3 = c + 128;
+    const real_t * pqmf_c_4 = c + 192;
+    const real_t * pqmf_c_5 = c + 256;
+    const real_t * pqmf_c_6 = c + 320;
+    const real_t * pqmf_c_7 = c + 384;
+    const real_t * pqmf_c_8 = c + 448;
+    const real_t * pqmf_c_9 = c + 512;
+    const real_t * pqmf_c_10 = c + 576;
+#endif // #ifdef PREFER_POINTERS
+    uint8_t k;
+
+    for (k = 0; k < 64; k++)
+    {
+#ifdef PREFER_POINTERS
+        out[k] =
+            MUL_F(*pring_buffer_1++,  *pqmf_c_1++) +
+            MUL_F(*pring_buffer_2++,  *pqmf_c_2++) +
+            MUL_F(*pring_buffer_3++,  *pqmf_c_3++) +
+            MUL_F(*pring_buffer_4++,  *pqmf_c_4++) +
+            MUL_F(*pring_buffer_5++,  *pqmf_c_5++) +
+            MUL_F(*pring_buffer_6++,  *pqmf_c_6++) +
+            MUL_F(*pring_buffer_7++,  *pqmf_c_7++) +
+            MUL_F(*pring_buffer_8++,  *pqmf_c_8++) +
+            MUL_F(*pring_buffer_9++,  *pqmf_c_9++) +
+            MUL_F(*pring_buffer_10++, *pqmf_c_10++);
+#else // #ifdef PREFER_POINTERS
+        out[k] =
+            MUL_F(v[k+0],          c[k+0])   +
+            MUL_F(v[k+192],        c[k+64])  +
+            MUL_F(v[k+256],        c[k+128]) +
+            MUL_F(v[k+(256+192)],  c[k+192]) +
+            MUL_F(v[k+512],        c[k+256]) +
+            MUL_F(v[k+(512+192)],  c[k+320]) +
+            MUL_F(v[k+768],        c[k+384]) +
+            MUL_F(v[k+(768+192)],  c[k+448]) +
+            MUL_F(v[k+1024],       c[k+512]) +
+            MUL_F(v[k+(1024+192)], c[k+576]);
+#endif // #ifdef PREFER_POINTERS
+    }
+}
+
 static const complex_t qmf32_pre_twiddle[] =
 {
     { FRAC_CONST(0.999924701839145), FRAC_CONST(-0.012271538285720) },
@@ -468,12 +534,6 @@ void sbr_qmf_synthesis_64(sbr_info *sbr, qmfs_info *qmfs, qmf_t X[MAX_NTSRHFG][6
 #ifdef PREFER_POINTERS
     // These pointers are used if target platform has autoinc address generators
     real_t * pring_buffer_2, * pring_buffer_4;
-    real_t * pring_buffer_5, * pring_buffer_6;
-    real_t * pring_buffer_7, * pring_buffer_8;
-    real_t * pring_buffer_9, * pring_buffer_10;
-    const real_t * pqmf_c_1, * pqmf_c_2, * pqmf_c_3, * pqmf_c_4;
-    const real_t * pqmf_c_5, * pqmf_c_6, * pqmf_c_7, * pqmf_c_8;
-    const real_t * pqmf_c_9, * pqmf_c_10;
 #endif // #ifdef PREFER_POINTERS
 #ifndef FIXED_POINT
     real_t scale = 1.f/64.f;
@@ -570,60 +630,11 @@ void sbr_qmf_synthesis_64(sbr_info *sbr, qmfs_info *qmfs, qmf_t X[MAX_NTSRHFG][6
             pring_buffer_1[127-(2*n+1)] = pring_buffer_3[127-(2*n+1)] = out_imag2[31-n] - out_imag1[31-n];
         }
 
-#endif // #ifdef PREFER_POINTERS
-
-        pring_buffer_1 = qmfs->v + qmfs->v_index;
-#ifdef PREFER_POINTERS
-        pring_buffer_2 = pring_buffer_1 + 192;
-        pring_buffer_3 = pring_buffer_1 + 256;
-        pring_buffer_4 = pring_buffer_1 + (256 + 192);
-        pring_buffer_5 = pring_buffer_1 + 512;
-        pring_buffer_6 = pring_buffer_1 + (512 + 192);
-        pring_buffer_7 = pring_buffer_1 + 768;
-        pring_buffer_8 = pring_buffer_1 + (768 + 192);
-        pring_buffer_9 = pring_buffer_1 + 1024;
-        pring_buffer_10 = pring_buffer_1 + (1024 + 192);
-        pqmf_c_1 = qmf_c;
-        pqmf_c_2 = qmf_c + 64;
-        pqmf_c_3 = qmf_c + 128;
-        pqmf_c_4 = qmf_c + 192;
-        pqmf_c_5 = qmf_c + 256;
-        pqmf_c_6 = qmf_c + 320;
-        pqmf_c_7 = qmf_c + 384;
-        pqmf_c_8 = qmf_c + 448;
-        pqmf_c_9 = qmf_c + 512;
-        pqmf_c_10 = qmf_c + 576;
 #endif // #ifdef PREFER_POINTERS
 
         /* calculate 64 output samples and window */
-        for (k = 0; k < 64; k++)
-        {
-#ifdef PREFER_POINTERS
-            output[out++] =
-                MUL_F(*pring_buffer_1++,  *pqmf_c_1++) +
-                MUL_F(*pring_buffer_2++,  *pqmf_c_2++) +
-                MUL_F(*pring_buffer_3++,  *pqmf_c_3++) +
-                MUL_F(*pring_buffer_4++,  *pqmf_c_4++) +
-                MUL_F(*pring_buffer_5++,  *pqmf_c_5++) +
-                MUL_F(*pring_buffer_6++,  *pqmf_c_6++) +
-                MUL_F(*pring_buffer_7++,  *pqmf_c_7++) +
-                MUL_F(*pring_buffer_8++,  *pqmf_c_8++) +
-                MUL_F(*pring_buffer_9++,  *pqmf_c_9++) +
-                MUL_F(*pring_buffer_10++, *pqmf_c_10++);
-#else // #ifdef PREFER_POINTERS
-            output[out++] =
-                MUL_F(pring_buffer_1[k+0],          qmf_c[k+0])   +
-                MUL_F(pring_buffer_1[k+192],        qmf_c[k+64])  +
-                MUL_F(pring_buffer_1[k+256],        qmf_c[k+128]) +
-                MUL_F(pring_buffer_1[k+(256+192)],  qmf_c[k+192]) +
-                MUL_F(pring_buffer_1[k+512],        qmf_c[k+256]) +
-                MUL_F(pring_buffer_1[k+(512+192)],  qmf_c[k+320]) +
-                MUL_F(pring_buffer_1[k+768],        qmf_c[k+384]) +
-                MUL_F(pring_buffer_1[k+(768+192)],  qmf_c[k+448]) +
-                MUL_F(pring_buffer_1[k+1024],       qmf_c[k+512]) +
-                MUL_F(pring_buffer_1[k+(1024+192)], qmf_c[k+576]);
-#endif // #ifdef PREFER_POINTERS
-        }
+        sbr->dsp->qmfs_window(qmfs->v + qmfs->v_index, qmf_c, output + out);
+        out += 64;
 
         /* update ringbuffer index */
         qmfs->v_index -= 128;
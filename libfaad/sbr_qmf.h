@@ -47,6 +47,9 @@ void sbr_qmf_synthesis_32(sbr_info *sbr, qmfs_info *qmfs, qmf_t X[MAX_NTSRHFG][6
 void sbr_qmf_synthesis_64(sbr_info *sbr, qmfs_info *qmfs, qmf_t X[MAX_NTSRHFG][64],
                           real_t *output);
 
+void qmfa_window_c(const real_t *x, const real_t *c, real_t *u);
+void qmfs_window_c(const real_t *v, const real_t *c, real_t *out);
+
 
 #ifdef __cplusplus
 }
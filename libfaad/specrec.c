@@ -43,7 +43,7 @@
 #include "specrec.h"
 #include "filtbank.h"
 #include "syntax.h"
-#include "iq_table.h"
+#include "tables.h"
 #include "ms.h"
 #include "is.h"
 #include "pns.h"
@@ -61,6 +61,7 @@
 static uint8_t quant_to_spec(NeAACDecStruct *hDecoder,
                              ic_stream *ics, int16_t *quant_data,
                              real_t *spec_data, uint16_t frame_len);
+static uint8_t sbr_channel_pair(NeAACDecStruct *hDecoder, element *cpe);
 
 
 #ifdef LD_DEC
@@ -498,6 +499,26 @@ static INLINE real_t iquant(int16_t q, const real_t *tab, uint8_t *error)
 }
 
 #ifndef FIXED_POINT
+/* inverse quantisation and scaling of one window of a scalefactor band,
+ * reference version of dsp->requant
+ */
+uint8_t requant_c(const int16_t *q, real_t *spec, uint16_t width,
+                  real_t scf, const real_t *tab)
+{
+    uint16_t bin;
+    uint8_t error = 0;
+
+    for (bin = 0; bin < width; bin += 4)
+    {
+        spec[bin+0] = iquant(q[bin+0], tab, &error) * scf;
+        spec[bin+1] = iquant(q[bin+1], tab, &error) * scf;
+        spec[bin+2] = iquant(q[bin+2], tab, &error) * scf;
+        spec[bin+3] = iquant(q[bin+3], tab, &error) * scf;
+    }
+
+    return error;
+}
+
 ALIGN static const real_t pow2sf_tab[] = {
     2.9802322387695313E-008, 5.9604644775390625E-008, 1.1920928955078125E-007,
     2.384185791015625E-007, 4.76837158203125E-007, 9.5367431640625E-007,
@@ -557,13 +578,15 @@ static uint8_t quant_to_spec(NeAACDecStruct *hDecoder,
         COEF_CONST(1.4142135623730950488016887242097), /* 2^0.5 */
         COEF_CONST(1.6817928305074290860622509524664) /* 2^0.75 */
     };
-    const real_t *tab = iq_table;
+    const real_t *tab = table_iq();
 
     uint8_t g, sfb, win;
-    uint16_t width, bin, k, gindex, wa, wb;
+    uint16_t width, k, gindex, wa;
     uint8_t error = 0; /* Init error flag */
 #ifndef FIXED_POINT
     real_t scf;
+#else
+    uint16_t bin, wb;
 #endif
 
     k = 0;
@@ -582,8 +605,9 @@ static uint8_t quant_to_spec(NeAACDecStruct *hDecoder,
             width = ics->swb_offset[sfb+1] - ics->swb_offset[sfb];
 
             /* this could be scalefactor for IS or PNS, those can be negative or bigger then 255 */
-            /* just ignore them */
-            if (ics->scale_factors[g][sfb] < 0 || ics->scale_factors[g][sfb] > 255)
+            /* just ignore them, bands above max_sfb have no scalefactor */
+            if (sfb >= ics->max_sfb ||
+                ics->scale_factors[g][sfb] < 0 || ics->scale_factors[g][sfb] > 255)
             {
                 exp = 0;
                 frac = 0;
@@ -616,17 +640,17 @@ static uint8_t quant_to_spec(NeAACDecStruct *hDecoder,
 
             for (win = 0; win < ics->window_group_length[g]; win++)
             {
-                for (bin = 0; bin < width; bin += 4)
-                {
 #ifndef FIXED_POINT
-                    wb = wa + bin;
-
-                    spec_data[wb+0] = iquant(quant_data[k+0], tab, &error) * scf;
-                    spec_data[wb+1] = iquant(quant_data[k+1], tab, &error) * scf;
-                    spec_data[wb+2] = iquant(quant_data[k+2], tab, &error) * scf;
-                    spec_data[wb+3] = iquant(quant_data[k+3], tab, &error) * scf;
-
+                if (hDecoder->dsp->requant(quant_data + k, spec_data + wa,
+                    width, scf, tab))
+                {
+                    error = 17;
+                }
+                gincrease += width;
+                k += width;
 #else
+                for (bin = 0; bin < width; bin += 4)
+                {
                     real_t iq0 = iquant(quant_data[k+0], tab, &error);
                     real_t iq1 = iquant(quant_data[k+1], tab, &error);
                     real_t iq2 = iquant(quant_data[k+2], tab, &error);
@@ -664,12 +688,12 @@ static uint8_t quant_to_spec(NeAACDecStruct *hDecoder,
                     //printf("0x%.8X\n", spec_data[gindex+(win*win_inc)+j+bin+1]);
                     //printf("0x%.8X\n", spec_data[gindex+(win*win_inc)+j+bin+2]);
                     //printf("0x%.8X\n", spec_data[gindex+(win*win_inc)+j+bin+3]);
-#endif
 #endif
 
                     gincrease += 4;
                     k += 4;
                 }
+#endif
                 wa += win_inc;
             }
             j += width;
@@ -680,6 +704,137 @@ static uint8_t quant_to_spec(NeAACDecStruct *hDecoder,
     return error;
 }
 
+#ifndef FIXED_POINT
+/* dequantisation of scalefactor band sfb of a long window, a long window is
+ * a single group of one window in spectral order so the band maps straight
+ * to its swb_offset
+ */
+static INLINE uint8_t requant_long_band(const dsp_funcs *dsp, ic_stream *ics, uint8_t sfb,
+                                        const int16_t *quant_data, real_t *spec_data,
+                                        const real_t *tab)
+{
+    ALIGN static const real_t pow2_table[] =
+    {
+        COEF_CONST(1.0),
+        COEF_CONST(1.1892071150027210667174999705605), /* 2^0.25 */
+        COEF_CONST(1.4142135623730950488016887242097), /* 2^0.5 */
+        COEF_CONST(1.6817928305074290860622509524664) /* 2^0.75 */
+    };
+    int16_t sf = (sfb < ics->max_sfb) ? ics->scale_factors[0][sfb] : 0;
+    uint16_t offset = ics->swb_offset[sfb];
+    real_t scf;
+
+    /* IS and PNS scalefactors are out of range, those bands are
+       dequantised with scale 1 like in quant_to_spec() */
+    if (sf < 0 || sf > 255)
+        sf = 0;
+    scf = pow2sf_tab[sf >> 2] * pow2_table[sf & 3];
+
+    return dsp->requant(quant_data + offset, spec_data + offset,
+        ics->swb_offset[sfb+1] - offset, scf, tab);
+}
+
+/* dequantisation, PNS, M/S and intensity stereo of a long window channel
+ * pair in a single pass over the scalefactor bands. Every tool only touches
+ * the band it works on and the bands are visited in the same order as in
+ * the separate passes, so the output and the PNS random sequence are the
+ * same. Bands that PNS or IS overwrite completely are not dequantised.
+ */
+static uint8_t spectral_pair_long(NeAACDecStruct *hDecoder, ic_stream *ics1, ic_stream *ics2,
+                                  int16_t *quant_data1, int16_t *quant_data2,
+                                  real_t *spec_coef1, real_t *spec_coef2)
+{
+    const real_t *tab = table_iq();
+    const dsp_funcs *dsp = hDecoder->dsp;
+    uint8_t channel_pair = ics1->ms_mask_present ? 1 : 0;
+    uint8_t num_swb = max(ics1->num_swb, ics2->num_swb);
+    uint8_t sfb;
+    uint8_t error = 0;
+
+    for (sfb = 0; sfb < num_swb; sfb++)
+    {
+        uint8_t tools1 = (sfb < ics1->max_sfb);
+        uint8_t tools2 = (sfb < ics2->max_sfb);
+
+        if (sfb < ics1->num_swb &&
+            !(tools1 && is_noise(ics1, 0, sfb) &&
+            ics1->swb_offset[sfb+1] <= ics1->swb_offset_max))
+        {
+            error |= requant_long_band(dsp, ics1, sfb, quant_data1, spec_coef1, tab);
+        }
+        if (sfb < ics2->num_swb &&
+            !(tools2 && (is_intensity(ics2, 0, sfb) || (tools1 && is_noise(ics2, 0, sfb))) &&
+            ics2->swb_offset[sfb+1] <= min(ics1->swb_offset_max, ics2->swb_offset_max)))
+        {
+            error |= requant_long_band(dsp, ics2, sfb, quant_data2, spec_coef2, tab);
+        }
+
+        if (tools1)
+        {
+            pns_decode_band(ics1, ics2, spec_coef1, spec_coef2, 0, sfb, 0,
+                channel_pair, 0, &(hDecoder->__r1), &(hDecoder->__r2),
+                hDecoder->pns_mode, dsp);
+            if (ics1->ms_mask_present >= 1)
+                ms_decode_band(ics1, ics2, spec_coef1, spec_coef2, 0, sfb, 0);
+        }
+        if (tools2)
+            is_decode_band(ics1, ics2, spec_coef1, spec_coef2, 0, sfb, 0);
+    }
+
+    return error ? 17 : 0;
+}
+#endif
+
+/* dequantisation, PNS, M/S and intensity stereo of a channel pair */
+static uint8_t spectral_pair(NeAACDecStruct *hDecoder, ic_stream *ics1, ic_stream *ics2,
+                             int16_t *spec_data1, int16_t *spec_data2,
+                             real_t *spec_coef1, real_t *spec_coef2)
+{
+    uint8_t retval;
+    stats_mark mark;
+
+#ifndef FIXED_POINT
+    if (ics1->window_sequence != EIGHT_SHORT_SEQUENCE &&
+        ics2->window_sequence != EIGHT_SHORT_SEQUENCE)
+    {
+        /* the fused tools are counted as dequantisation */
+        stats_begin(&hDecoder->stats, &mark);
+        retval = spectral_pair_long(hDecoder, ics1, ics2, spec_data1, spec_data2,
+            spec_coef1, spec_coef2);
+        stats_end(&hDecoder->stats, &mark, FAAD_STAGE_REQUANT);
+
+        return retval;
+    }
+#endif
+
+    /* dequantisation and scaling */
+    stats_begin(&hDecoder->stats, &mark);
+    retval = quant_to_spec(hDecoder, ics1, spec_data1, spec_coef1, hDecoder->frameLength);
+    if (retval == 0)
+        retval = quant_to_spec(hDecoder, ics2, spec_data2, spec_coef2, hDecoder->frameLength);
+    stats_end(&hDecoder->stats, &mark, FAAD_STAGE_REQUANT);
+    if (retval > 0)
+        return retval;
+
+    stats_begin(&hDecoder->stats, &mark);
+
+    /* pns decoding */
+    pns_decode(ics1, ics2, spec_coef1, spec_coef2, hDecoder->frameLength,
+        ics1->ms_mask_present ? 1 : 0, hDecoder->object_type,
+        &(hDecoder->__r1), &(hDecoder->__r2),
+        hDecoder->pns_mode, hDecoder->dsp);
+
+    /* mid/side decoding */
+    ms_decode(ics1, ics2, spec_coef1, spec_coef2, hDecoder->frameLength);
+
+    /* intensity stereo decoding */
+    is_decode(ics1, ics2, spec_coef1, spec_coef2, hDecoder->frameLength);
+
+    stats_end(&hDecoder->stats, &mark, FAAD_STAGE_TOOLS);
+
+    return 0;
+}
+
 static uint8_t allocate_single_channel(NeAACDecStruct *hDecoder, uint8_t channel,
                                        uint8_t output_channels)
 {
@@ -696,7 +851,7 @@ static uint8_t allocate_single_channel(NeAACDecStruct *hDecoder, uint8_t channel
             hDecoder->pred_stat[channel] = NULL;
         }
 
-        hDecoder->pred_stat[channel] = (pred_state*)faad_malloc(hDecoder->frameLength * sizeof(pred_state));
+        hDecoder->pred_stat[channel] = (pred_state*)faad_malloc(sizeof(pred_state));
         reset_all_predictors(hDecoder->pred_stat[channel], hDecoder->frameLength);
     }
 #endif
@@ -793,12 +948,12 @@ static uint8_t allocate_channel_pair(NeAACDecStruct *hDecoder,
         /* allocate the state only when needed */
         if (hDecoder->pred_stat[channel] == NULL)
         {
-            hDecoder->pred_stat[channel] = (pred_state*)faad_malloc(hDecoder->frameLength * sizeof(pred_state));
+            hDecoder->pred_stat[channel] = (pred_state*)faad_malloc(sizeof(pred_state));
             reset_all_predictors(hDecoder->pred_stat[channel], hDecoder->frameLength);
         }
         if (hDecoder->pred_stat[paired_channel] == NULL)
         {
-            hDecoder->pred_stat[paired_channel] = (pred_state*)faad_malloc(hDecoder->frameLength * sizeof(pred_state));
+            hDecoder->pred_stat[paired_channel] = (pred_state*)faad_malloc(sizeof(pred_state));
             reset_all_predictors(hDecoder->pred_stat[paired_channel], hDecoder->frameLength);
         }
     }
@@ -891,13 +1046,9 @@ uint8_t reconstruct_single_channel(NeAACDecStruct *hDecoder, ic_stream *ics,
 {
     uint8_t retval;
     int output_channels;
+    stats_mark mark;
     ALIGN real_t spec_coef[1024];
 
-#ifdef PROFILE
-    int64_t count = faad_get_ts();
-#endif
-
-
     /* always allocate 2 channels, PS can always "suddenly" turn up */
 #if ( (defined(DRM) && defined(DRM_PS)) )
     output_channels = 2;
@@ -947,19 +1098,18 @@ uint8_t reconstruct_single_channel(NeAACDecStruct *hDecoder, ic_stream *ics,
         return 15;
 
     /* dequantisation and scaling */
+    stats_begin(&hDecoder->stats, &mark);
     retval = quant_to_spec(hDecoder, ics, spec_data, spec_coef, hDecoder->frameLength);
+    stats_end(&hDecoder->stats, &mark, FAAD_STAGE_REQUANT);
     if (retval > 0)
         return retval;
 
-#ifdef PROFILE
-    count = faad_get_ts() - count;
-    hDecoder->requant_cycles += count;
-#endif
-
+    stats_begin(&hDecoder->stats, &mark);
 
     /* pns decoding */
     pns_decode(ics, NULL, spec_coef, NULL, hDecoder->frameLength, 0, hDecoder->object_type,
-        &(hDecoder->__r1), &(hDecoder->__r2));
+        &(hDecoder->__r1), &(hDecoder->__r2),
+        hDecoder->pns_mode, hDecoder->dsp);
 
 #ifdef MAIN_DEC
     /* MAIN object type prediction */
@@ -970,7 +1120,7 @@ uint8_t reconstruct_single_channel(NeAACDecStruct *hDecoder, ic_stream *ics,
 
         /* intra channel prediction */
         ic_prediction(ics, spec_coef, hDecoder->pred_stat[sce->channel], hDecoder->frameLength,
-            hDecoder->sf_index);
+            hDecoder->sf_index, hDecoder->dsp);
 
         /* In addition, for scalefactor bands coded by perceptual
            noise substitution the predictors belonging to the
@@ -1002,18 +1152,25 @@ uint8_t reconstruct_single_channel(NeAACDecStruct *hDecoder, ic_stream *ics,
     }
 #endif
 
+    stats_end(&hDecoder->stats, &mark, FAAD_STAGE_TOOLS);
+
     /* tns decoding */
+    stats_begin(&hDecoder->stats, &mark);
     tns_decode_frame(ics, &(ics->tns), hDecoder->sf_index, hDecoder->object_type,
-        spec_coef, hDecoder->frameLength);
+        spec_coef, hDecoder->frameLength, hDecoder->dsp);
+    stats_end(&hDecoder->stats, &mark, FAAD_STAGE_TNS);
 
     /* drc decoding */
     if (hDecoder->drc->present)
     {
+        stats_begin(&hDecoder->stats, &mark);
         if (!hDecoder->drc->exclude_mask[sce->channel] || !hDecoder->drc->excluded_chns_present)
             drc_decode(hDecoder->drc, spec_coef);
+        stats_end(&hDecoder->stats, &mark, FAAD_STAGE_TOOLS);
     }
 
     /* filter bank */
+    stats_begin(&hDecoder->stats, &mark);
 #ifdef SSR_DEC
     if (hDecoder->object_type != SSR)
     {
@@ -1041,6 +1198,7 @@ uint8_t reconstruct_single_channel(NeAACDecStruct *hDecoder, ic_stream *ics,
             hDecoder->fb_intermed[sce->channel], hDecoder->frameLength, hDecoder->object_type);
     }
 #endif
+    stats_end(&hDecoder->stats, &mark, FAAD_STAGE_FILTERBANK);
 
 #ifdef SBR_DEC
     if (((hDecoder->sbr_present_flag == 1) || (hDecoder->forceUpSampling == 1))
@@ -1062,6 +1220,12 @@ uint8_t reconstruct_single_channel(NeAACDecStruct *hDecoder, ic_stream *ics,
         }
         if (!hDecoder->sbr[ele])
             return 19;
+        hDecoder->sbr[ele]->dsp = hDecoder->dsp;
+        hDecoder->sbr[ele]->stats = &hDecoder->stats;
+
+        /* the SBR phases after a seek follow from the stream position */
+        if (hDecoder->postSeekResetFlag)
+            hDecoder->sbr[ele]->frame = hDecoder->frame;
 
         if (sce->ics1.window_sequence == EIGHT_SHORT_SEQUENCE)
             hDecoder->sbr[ele]->maxAACLine = 8*min(sce->ics1.swb_offset[max(sce->ics1.max_sfb-1, 0)], sce->ics1.swb_offset_max);
@@ -1069,6 +1233,7 @@ uint8_t reconstruct_single_channel(NeAACDecStruct *hDecoder, ic_stream *ics,
             hDecoder->sbr[ele]->maxAACLine = min(sce->ics1.swb_offset[max(sce->ics1.max_sfb-1, 0)], sce->ics1.swb_offset_max);
 
         /* check if any of the PS tools is used */
+        stats_begin(&hDecoder->stats, &mark);
 #if (defined(PS_DEC) || defined(DRM_PS))
         if (hDecoder->ps_used[ele] == 0)
         {
@@ -1082,6 +1247,7 @@ uint8_t reconstruct_single_channel(NeAACDecStruct *hDecoder, ic_stream *ics,
                 hDecoder->downSampledSBR);
         }
 #endif
+        stats_end(&hDecoder->stats, &mark, FAAD_STAGE_SBR);
         if (retval > 0)
             return retval;
     } else if (((hDecoder->sbr_present_flag == 1) || (hDecoder->forceUpSampling == 1))
@@ -1108,16 +1274,10 @@ uint8_t reconstruct_single_channel(NeAACDecStruct *hDecoder, ic_stream *ics,
     return 0;
 }
 
-uint8_t reconstruct_channel_pair(NeAACDecStruct *hDecoder, ic_stream *ics1, ic_stream *ics2,
-                                 element *cpe, int16_t *spec_data1, int16_t *spec_data2)
+static uint8_t prepare_channel_pair(NeAACDecStruct *hDecoder, element *cpe)
 {
     uint8_t retval;
-    ALIGN real_t spec_coef1[1024];
-    ALIGN real_t spec_coef2[1024];
 
-#ifdef PROFILE
-    int64_t count = faad_get_ts();
-#endif
     if (hDecoder->element_alloced[hDecoder->fr_ch_ele] != 2)
     {
         retval = allocate_channel_pair(hDecoder, cpe->channel, (uint8_t)cpe->paired_channel);
@@ -1133,66 +1293,76 @@ uint8_t reconstruct_channel_pair(NeAACDecStruct *hDecoder, ic_stream *ics1, ic_s
     if(!hDecoder->fb_intermed[cpe->channel] || !hDecoder->fb_intermed[cpe->paired_channel])
         return 15;
 
-    /* dequantisation and scaling */
-    retval = quant_to_spec(hDecoder, ics1, spec_data1, spec_coef1, hDecoder->frameLength);
-    if (retval > 0)
-        return retval;
-    retval = quant_to_spec(hDecoder, ics2, spec_data2, spec_coef2, hDecoder->frameLength);
+    return 0;
+}
+
+/* AAC LC channel pair with 1024 sample frames: no prediction, SSR or LD
+   windows, so those checks are left out and the frame length is constant */
+static uint8_t reconstruct_channel_pair_lc(NeAACDecStruct *hDecoder, ic_stream *ics1, ic_stream *ics2,
+                                           element *cpe, int16_t *spec_data1, int16_t *spec_data2)
+{
+    uint8_t retval;
+    ALIGN real_t spec_coef1[1024];
+    stats_mark mark;
+    ALIGN real_t spec_coef2[1024];
+
+    retval = spectral_pair(hDecoder, ics1, ics2, spec_data1, spec_data2,
+        spec_coef1, spec_coef2);
     if (retval > 0)
         return retval;
 
-#ifdef PROFILE
-    count = faad_get_ts() - count;
-    hDecoder->requant_cycles += count;
-#endif
+    stats_begin(&hDecoder->stats, &mark);
+    tns_decode_pair(ics1, ics2, hDecoder->sf_index, LC, spec_coef1, spec_coef2,
+        1024, hDecoder->dsp);
+    stats_end(&hDecoder->stats, &mark, FAAD_STAGE_TNS);
 
-    /* pns decoding */
-    if (ics1->ms_mask_present)
+    if (hDecoder->drc->present)
     {
-        pns_decode(ics1, ics2, spec_coef1, spec_coef2, hDecoder->frameLength, 1, hDecoder->object_type,
-            &(hDecoder->__r1), &(hDecoder->__r2));
-    } else {
-        pns_decode(ics1, ics2, spec_coef1, spec_coef2, hDecoder->frameLength, 0, hDecoder->object_type,
-            &(hDecoder->__r1), &(hDecoder->__r2));
+        stats_begin(&hDecoder->stats, &mark);
+        if (!hDecoder->drc->exclude_mask[cpe->channel] || !hDecoder->drc->excluded_chns_present)
+            drc_decode(hDecoder->drc, spec_coef1);
+        if (!hDecoder->drc->exclude_mask[cpe->paired_channel] || !hDecoder->drc->excluded_chns_present)
+            drc_decode(hDecoder->drc, spec_coef2);
+        stats_end(&hDecoder->stats, &mark, FAAD_STAGE_TOOLS);
     }
 
-    /* mid/side decoding */
-    ms_decode(ics1, ics2, spec_coef1, spec_coef2, hDecoder->frameLength);
+    stats_begin(&hDecoder->stats, &mark);
+    ifilter_bank_lc(hDecoder->fb, ics1->window_sequence, ics1->window_shape,
+        hDecoder->window_shape_prev[cpe->channel], spec_coef1,
+        hDecoder->time_out[cpe->channel], hDecoder->fb_intermed[cpe->channel]);
+    ifilter_bank_lc(hDecoder->fb, ics2->window_sequence, ics2->window_shape,
+        hDecoder->window_shape_prev[cpe->paired_channel], spec_coef2,
+        hDecoder->time_out[cpe->paired_channel], hDecoder->fb_intermed[cpe->paired_channel]);
 
-#if 0
-    {
-        int i;
-        for (i = 0; i < 1024; i++)
-        {
-            //printf("%d\n", spec_coef1[i]);
-            printf("0x%.8X\n", spec_coef1[i]);
-        }
-        for (i = 0; i < 1024; i++)
-        {
-            //printf("%d\n", spec_coef2[i]);
-            printf("0x%.8X\n", spec_coef2[i]);
-        }
-    }
-#endif
+    /* save window shape for next frame */
+    hDecoder->window_shape_prev[cpe->channel] = ics1->window_shape;
+    hDecoder->window_shape_prev[cpe->paired_channel] = ics2->window_shape;
+    stats_end(&hDecoder->stats, &mark, FAAD_STAGE_FILTERBANK);
 
-    /* intensity stereo decoding */
-    is_decode(ics1, ics2, spec_coef1, spec_coef2, hDecoder->frameLength);
+    return sbr_channel_pair(hDecoder, cpe);
+}
 
-#if 0
-    {
-        int i;
-        for (i = 0; i < 1024; i++)
-        {
-            printf("%d\n", spec_coef1[i]);
-            //printf("0x%.8X\n", spec_coef1[i]);
-        }
-        for (i = 0; i < 1024; i++)
-        {
-            printf("%d\n", spec_coef2[i]);
-            //printf("0x%.8X\n", spec_coef2[i]);
-        }
-    }
-#endif
+uint8_t reconstruct_channel_pair(NeAACDecStruct *hDecoder, ic_stream *ics1, ic_stream *ics2,
+                                 element *cpe, int16_t *spec_data1, int16_t *spec_data2)
+{
+    uint8_t retval;
+    ALIGN real_t spec_coef1[1024];
+    stats_mark mark;
+    ALIGN real_t spec_coef2[1024];
+
+    retval = prepare_channel_pair(hDecoder, cpe);
+    if (retval > 0)
+        return retval;
+
+    if (hDecoder->lc_fast)
+        return reconstruct_channel_pair_lc(hDecoder, ics1, ics2, cpe, spec_data1, spec_data2);
+
+    retval = spectral_pair(hDecoder, ics1, ics2, spec_data1, spec_data2,
+        spec_coef1, spec_coef2);
+    if (retval > 0)
+        return retval;
+
+    stats_begin(&hDecoder->stats, &mark);
 
 #ifdef MAIN_DEC
     /* MAIN object type prediction */
@@ -1200,9 +1370,9 @@ uint8_t reconstruct_channel_pair(NeAACDecStruct *hDecoder, ic_stream *ics1, ic_s
     {
         /* intra channel prediction */
         ic_prediction(ics1, spec_coef1, hDecoder->pred_stat[cpe->channel], hDecoder->frameLength,
-            hDecoder->sf_index);
+            hDecoder->sf_index, hDecoder->dsp);
         ic_prediction(ics2, spec_coef2, hDecoder->pred_stat[cpe->paired_channel], hDecoder->frameLength,
-            hDecoder->sf_index);
+            hDecoder->sf_index, hDecoder->dsp);
 
         /* In addition, for scalefactor bands coded by perceptual
            noise substitution the predictors belonging to the
@@ -1246,22 +1416,27 @@ uint8_t reconstruct_channel_pair(NeAACDecStruct *hDecoder, ic_stream *ics1, ic_s
     }
 #endif
 
+    stats_end(&hDecoder->stats, &mark, FAAD_STAGE_TOOLS);
+
     /* tns decoding */
-    tns_decode_frame(ics1, &(ics1->tns), hDecoder->sf_index, hDecoder->object_type,
-        spec_coef1, hDecoder->frameLength);
-    tns_decode_frame(ics2, &(ics2->tns), hDecoder->sf_index, hDecoder->object_type,
-        spec_coef2, hDecoder->frameLength);
+    stats_begin(&hDecoder->stats, &mark);
+    tns_decode_pair(ics1, ics2, hDecoder->sf_index, hDecoder->object_type,
+        spec_coef1, spec_coef2, hDecoder->frameLength, hDecoder->dsp);
+    stats_end(&hDecoder->stats, &mark, FAAD_STAGE_TNS);
 
     /* drc decoding */
     if (hDecoder->drc->present)
     {
+        stats_begin(&hDecoder->stats, &mark);
         if (!hDecoder->drc->exclude_mask[cpe->channel] || !hDecoder->drc->excluded_chns_present)
             drc_decode(hDecoder->drc, spec_coef1);
         if (!hDecoder->drc->exclude_mask[cpe->paired_channel] || !hDecoder->drc->excluded_chns_present)
             drc_decode(hDecoder->drc, spec_coef2);
+        stats_end(&hDecoder->stats, &mark, FAAD_STAGE_TOOLS);
     }
 
     /* filter bank */
+    stats_begin(&hDecoder->stats, &mark);
 #ifdef SSR_DEC
     if (hDecoder->object_type != SSR)
     {
@@ -1300,8 +1475,17 @@ uint8_t reconstruct_channel_pair(NeAACDecStruct *hDecoder, ic_stream *ics1, ic_s
             hDecoder->fb_intermed[cpe->paired_channel], hDecoder->frameLength, hDecoder->object_type);
     }
 #endif
+    stats_end(&hDecoder->stats, &mark, FAAD_STAGE_FILTERBANK);
+
+    return sbr_channel_pair(hDecoder, cpe);
+}
 
+static uint8_t sbr_channel_pair(NeAACDecStruct *hDecoder, element *cpe)
+{
 #ifdef SBR_DEC
+    uint8_t retval;
+    stats_mark mark;
+
     if (((hDecoder->sbr_present_flag == 1) || (hDecoder->forceUpSampling == 1))
         && hDecoder->sbr_alloced[hDecoder->fr_ch_ele])
     {
@@ -1322,15 +1506,23 @@ uint8_t reconstruct_channel_pair(NeAACDecStruct *hDecoder, ic_stream *ics1, ic_s
         }
         if (!hDecoder->sbr[ele])
             return 19;
+        hDecoder->sbr[ele]->dsp = hDecoder->dsp;
+        hDecoder->sbr[ele]->stats = &hDecoder->stats;
+
+        /* the SBR phases after a seek follow from the stream position */
+        if (hDecoder->postSeekResetFlag)
+            hDecoder->sbr[ele]->frame = hDecoder->frame;
 
         if (cpe->ics1.window_sequence == EIGHT_SHORT_SEQUENCE)
             hDecoder->sbr[ele]->maxAACLine = 8*min(cpe->ics1.swb_offset[max(cpe->ics1.max_sfb-1, 0)], cpe->ics1.swb_offset_max);
         else
             hDecoder->sbr[ele]->maxAACLine = min(cpe->ics1.swb_offset[max(cpe->ics1.max_sfb-1, 0)], cpe->ics1.swb_offset_max);
 
+        stats_begin(&hDecoder->stats, &mark);
         retval = sbrDecodeCoupleFrame(hDecoder->sbr[ele],
             hDecoder->time_out[ch0], hDecoder->time_out[ch1],
             hDecoder->postSeekResetFlag, hDecoder->downSampledSBR);
+        stats_end(&hDecoder->stats, &mark, FAAD_STAGE_SBR);
         if (retval > 0)
             return retval;
     } else if (((hDecoder->sbr_present_flag == 1) || (hDecoder->forceUpSampling == 1))
@@ -42,6 +42,10 @@ uint8_t reconstruct_channel_pair(NeAACDecStruct *hDecoder, ic_stream *ics1, ic_s
                                  element *cpe, int16_t *spec_data1, int16_t *spec_data2);
 uint8_t reconstruct_single_channel(NeAACDecStruct *hDecoder, ic_stream *ics, element *sce,
                                 int16_t *spec_data);
+#ifndef FIXED_POINT
+uint8_t requant_c(const int16_t *q, real_t *spec, uint16_t width,
+                  real_t scf, const real_t *tab);
+#endif
 
 #ifdef __cplusplus
 }
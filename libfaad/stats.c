@@ -0,0 +1,104 @@
+/*
+** FAAD2 - Freeware Advanced Audio (AAC) Decoder including SBR decoding
+** Copyright (C) 2003-2005 M. Bakker, Nero AG, http://www.nero.com
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+**
+** Any non-GPL usage of this software or parts of this software is strictly
+** forbidden.
+**
+** The "appropriate copyright message" mentioned in section 2c of the GPLv2
+** must read: "Code from FAAD2 is copyright (c) Nero AG, www.nero.com"
+**
+** Commercial non-GPL licensing of this software is possible.
+** For more info contact Nero AG through Mpeg4AAClicense@nero.com.
+**
+** $Id$
+**/
+
+/* per stage decoder statistics, see stats.h */
+
+#include "common.h"
+#include "structs.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "stats.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+
+/* monotonic clock in nanoseconds */
+int64_t faad_clock_ns(void)
+{
+#if defined(_WIN32)
+    static LONGLONG freq = 0;
+    LARGE_INTEGER now;
+
+    if (freq == 0)
+    {
+        LARGE_INTEGER f;
+        QueryPerformanceFrequency(&f);
+        freq = f.QuadPart;
+    }
+    QueryPerformanceCounter(&now);
+
+    /* split to avoid overflowing the multiplication */
+    return (int64_t)((now.QuadPart / freq) * 1000000000 +
+        ((now.QuadPart % freq) * 1000000000) / freq);
+#elif defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#else
+    return (int64_t)clock() * (1000000000 / CLOCKS_PER_SEC);
+#endif
+}
+
+void stats_init(faad_stats *st)
+{
+#ifndef _WIN32_WCE
+    const char *env = getenv("FAAD_STATS");
+#endif
+
+    memset(st, 0, sizeof(faad_stats));
+
+#ifndef _WIN32_WCE
+    if (env != NULL && env[0] != '\0' && strcmp(env, "0") != 0)
+        st->enabled = 1;
+#endif
+}
+
+void stats_frame_end(faad_stats *st, int64_t t0, unsigned long bytes,
+                     uint8_t error)
+{
+    /* t0 is 0 when stats were enabled during the call */
+    if (!st->enabled || t0 == 0)
+        return;
+
+    st->s.total_ns += (uint64_t)(faad_clock_ns() - t0);
+    st->s.bytes += bytes;
+    if (error)
+        st->s.errors++;
+    else
+        st->s.frames++;
+}
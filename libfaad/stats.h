@@ -0,0 +1,115 @@
+/*
+** FAAD2 - Freeware Advanced Audio (AAC) Decoder including SBR decoding
+** Copyright (C) 2003-2005 M. Bakker, Nero AG, http://www.nero.com
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+**
+** Any non-GPL usage of this software or parts of this software is strictly
+** forbidden.
+**
+** The "appropriate copyright message" mentioned in section 2c of the GPLv2
+** must read: "Code from FAAD2 is copyright (c) Nero AG, www.nero.com"
+**
+** Commercial non-GPL licensing of this software is possible.
+** For more info contact Nero AG through Mpeg4AAClicense@nero.com.
+**
+** $Id$
+**/
+
+#ifndef __STATS_H__
+#define __STATS_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Per stage decoder statistics, see NeAACDecGetStats().
+ *
+ * Each instrumented stage is bracketed by stats_begin()/stats_end(). When
+ * collection is disabled this costs one predictable branch per stage, the
+ * clock is only read when it is enabled.
+ *
+ * Stages nest (parsing calls reconstruction, reconstruction calls SBR, SBR
+ * calls PS), so stats_end() subtracts the time the nested stages added in
+ * the meantime: every nanosecond is attributed to exactly one stage.
+ */
+
+typedef struct
+{
+    uint8_t enabled;
+    NeAACDecStats s;
+} faad_stats;
+
+typedef struct
+{
+    uint8_t enabled; /* stats were enabled at stats_begin() */
+    int64_t t0;
+    uint64_t nested0;
+} stats_mark;
+
+int64_t faad_clock_ns(void);
+void stats_init(faad_stats *st);
+void stats_frame_end(faad_stats *st, int64_t t0, unsigned long bytes,
+                     uint8_t error);
+
+/* brackets a complete NeAACDecDecode() call */
+static INLINE int64_t stats_frame_begin(const faad_stats *st)
+{
+    return st->enabled ? faad_clock_ns() : 0;
+}
+
+static INLINE uint64_t stats_stage_sum(const faad_stats *st)
+{
+    uint64_t sum = 0;
+    uint8_t i;
+
+    for (i = 0; i < FAAD_STAGE_COUNT; i++)
+        sum += st->s.stage_ns[i];
+
+    return sum;
+}
+
+static INLINE void stats_begin(const faad_stats *st, stats_mark *m)
+{
+    m->enabled = (st != NULL && st->enabled);
+    m->t0 = 0;
+    m->nested0 = 0;
+
+    if (m->enabled)
+    {
+        m->nested0 = stats_stage_sum(st);
+        m->t0 = faad_clock_ns();
+    }
+}
+
+/* a stage is only counted when stats were enabled at both ends */
+static INLINE void stats_end(faad_stats *st, stats_mark *m, uint8_t stage)
+{
+    if (m->enabled && st->enabled)
+    {
+        int64_t elapsed = faad_clock_ns() - m->t0;
+        int64_t nested = (int64_t)(stats_stage_sum(st) - m->nested0);
+
+        /* can only go negative when stats were enabled in a nested stage */
+        if (elapsed > nested)
+            st->s.stage_ns[stage] += (uint64_t)(elapsed - nested);
+        st->s.stage_calls[stage]++;
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,336 @@
+/*
+** FAAD2 - Freeware Advanced Audio (AAC) Decoder including SBR decoding
+** Copyright (C) 2003-2005 M. Bakker, Nero AG, http://www.nero.com
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+**
+** Any non-GPL usage of this software or parts of this software is strictly
+** forbidden.
+**
+** The "appropriate copyright message" mentioned in section 2c of the GPLv2
+** must read: "Code from FAAD2 is copyright (c) Nero AG, www.nero.com"
+**
+** Commercial non-GPL licensing of this software is possible.
+** For more info contact Nero AG through Mpeg4AAClicense@nero.com.
+**
+** $Id$
+**/
+
+/* input buffering for the streaming interface, see stream.h */
+
+#include "common.h"
+#include "structs.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "stream.h"
+#include "adts.h"
+
+/* input needed to parse an ADIF header, including its program config
+   elements */
+#define ADIF_HEADER_MAX  1024
+
+
+stream_buffer *stream_init(void)
+{
+    stream_buffer *sb = (stream_buffer*)faad_malloc(sizeof(stream_buffer));
+
+    if (sb == NULL)
+        return NULL;
+
+    memset(sb, 0, sizeof(stream_buffer));
+    sb->buf = (uint8_t*)faad_malloc(STREAM_BUFFER_SIZE + STREAM_WINDOW);
+    if (sb->buf == NULL)
+    {
+        faad_free(sb);
+        return NULL;
+    }
+
+    return sb;
+}
+
+void stream_end(stream_buffer *sb)
+{
+    if (sb)
+    {
+        faad_free(sb->buf);
+        faad_free(sb);
+    }
+}
+
+void stream_reset(stream_buffer *sb)
+{
+    sb->read = sb->write = 0;
+    sb->mirrored = 0;
+    sb->eof = 0;
+    sb->locked = 0;
+}
+
+uint32_t stream_feed(stream_buffer *sb, const uint8_t *data, uint32_t size)
+{
+    uint32_t pos = sb->write & (STREAM_BUFFER_SIZE - 1);
+    uint32_t n = min(size, STREAM_BUFFER_SIZE - (sb->write - sb->read));
+    uint32_t first = min(n, STREAM_BUFFER_SIZE - pos);
+
+    memcpy(sb->buf + pos, data, first);
+    memcpy(sb->buf, data + first, n - first);
+    sb->write += n;
+
+    return n;
+}
+
+static INLINE uint32_t stream_avail(const stream_buffer *sb)
+{
+    return sb->write - sb->read;
+}
+
+/* returns n contiguous bytes at the read position, n must not exceed
+   STREAM_WINDOW or the buffered amount */
+static uint8_t *stream_peek(stream_buffer *sb, uint32_t n)
+{
+    uint32_t pos = sb->read & (STREAM_BUFFER_SIZE - 1);
+
+    if (pos + n > STREAM_BUFFER_SIZE)
+    {
+        uint32_t wrapped = pos + n - STREAM_BUFFER_SIZE;
+
+        /* only copy what earlier calls did not */
+        if (wrapped > sb->mirrored)
+        {
+            memcpy(sb->buf + STREAM_BUFFER_SIZE + sb->mirrored,
+                sb->buf + sb->mirrored, wrapped - sb->mirrored);
+            sb->mirrored = wrapped;
+        }
+    }
+
+    return sb->buf + pos;
+}
+
+static void stream_consume(stream_buffer *sb, uint32_t n)
+{
+    uint32_t pos = sb->read & (STREAM_BUFFER_SIZE - 1);
+
+    /* the mirrored bytes belong to the lap the read position enters */
+    if (pos + n >= STREAM_BUFFER_SIZE)
+        sb->mirrored = 0;
+
+    sb->read += n;
+}
+
+/* skips to the next possible ADTS syncword, returns 0 when the buffer ran
+   out */
+static uint8_t stream_skip_to_sync(stream_buffer *sb, const dsp_funcs *dsp)
+{
+    /* the first byte is the one that failed to sync */
+    stream_consume(sb, 1);
+
+    while (stream_avail(sb) >= 2)
+    {
+        uint32_t pos = sb->read & (STREAM_BUFFER_SIZE - 1);
+        /* up to the end of the ring plus the first wrapped byte, so a
+           syncword across the boundary is found too */
+        uint32_t n = min(min(stream_avail(sb), STREAM_BUFFER_SIZE - pos + 1),
+            STREAM_WINDOW);
+        uint32_t i = dsp->adts_sync(stream_peek(sb, n), n);
+
+        if (i < n)
+        {
+            stream_consume(sb, i);
+            return 1;
+        }
+        stream_consume(sb, n - 1);
+    }
+
+    return 0;
+}
+
+/* finds the next ADTS frame, returns its length or 0 when more input is
+   needed. Before the stream is locked a header is only accepted when the
+   next header follows it, so stray syncwords in damaged data or in tags
+   are skipped. */
+static uint32_t stream_sync_adts(stream_buffer *sb, const dsp_funcs *dsp,
+                                 uint8_t old_format)
+{
+    /* one byte more, the old format header is 2 bits longer */
+    uint8_t hdr[ADTS_PROBE_SIZE];
+
+    for (;;)
+    {
+        uint32_t len, next;
+
+        if (stream_avail(sb) < ADTS_PROBE_SIZE)
+            return 0;
+
+        len = adts_frame_length(stream_peek(sb, ADTS_PROBE_SIZE), old_format);
+        if (len == 0 || len > STREAM_WINDOW)
+        {
+            sb->locked = 0;
+            if (!stream_skip_to_sync(sb, dsp))
+                return 0;
+            continue;
+        }
+        if (stream_avail(sb) < len)
+        {
+            /* drop a truncated frame at the end of the stream */
+            if (sb->eof)
+                stream_consume(sb, stream_avail(sb));
+            return 0;
+        }
+        if (sb->locked)
+            return len;
+
+        if (stream_avail(sb) < len + ADTS_PROBE_SIZE)
+        {
+            /* the last frame of the stream */
+            if (sb->eof)
+                return len;
+            if (len + ADTS_PROBE_SIZE > STREAM_WINDOW)
+            {
+                if (!stream_skip_to_sync(sb, dsp))
+                    return 0;
+                continue;
+            }
+            return 0;
+        }
+
+        memcpy(hdr, stream_peek(sb, len + ADTS_PROBE_SIZE) + len,
+            ADTS_PROBE_SIZE);
+        next = adts_frame_length(hdr, old_format);
+        if (next != 0)
+        {
+            sb->locked = 1;
+            return len;
+        }
+
+        if (!stream_skip_to_sync(sb, dsp))
+            return 0;
+    }
+}
+
+/* the decoder has been set up by NeAACDecInit(), NeAACDecInit2() or by the
+   streaming interface itself */
+static INLINE uint8_t decoder_ready(const NeAACDecStruct *hDecoder)
+{
+    return hDecoder->fb != NULL;
+}
+
+static uint8_t stream_init_decoder(NeAACDecStruct *hDecoder, stream_buffer *sb)
+{
+    unsigned long samplerate;
+    unsigned char channels;
+    uint32_t avail = stream_avail(sb);
+    uint32_t len;
+    long bytes;
+
+    if (avail < 4)
+        return 0;
+
+    /* ADIF has a single header at the start of the stream */
+    if (memcmp(stream_peek(sb, 4), "ADIF", 4) == 0)
+    {
+        if (avail < ADIF_HEADER_MAX && !sb->eof)
+            return 0;
+
+        len = min(avail, ADIF_HEADER_MAX);
+        bytes = NeAACDecInit(hDecoder, stream_peek(sb, len), len,
+            &samplerate, &channels);
+        if (bytes < 0)
+        {
+            /* nothing to decode */
+            stream_consume(sb, avail);
+            return 0;
+        }
+        stream_consume(sb, (uint32_t)bytes);
+        return 1;
+    }
+
+    len = stream_sync_adts(sb, hDecoder->dsp, hDecoder->config.useOldADTSFormat);
+    if (len == 0)
+        return 0;
+
+    if (NeAACDecInit(hDecoder, stream_peek(sb, len), len,
+        &samplerate, &channels) < 0)
+    {
+        sb->locked = 0;
+        stream_skip_to_sync(sb, hDecoder->dsp);
+        return 0;
+    }
+
+    return 1;
+}
+
+void *stream_pull(NeAACDecStruct *hDecoder, NeAACDecFrameInfo *hInfo,
+                  void **sample_buffer, unsigned long sample_buffer_size)
+{
+    stream_buffer *sb = hDecoder->stream;
+    uint8_t *frame;
+    void *out;
+    uint32_t len;
+
+    memset(hInfo, 0, sizeof(NeAACDecFrameInfo));
+
+    if (sb == NULL)
+        return NULL;
+
+    if (!decoder_ready(hDecoder))
+    {
+        if (!stream_init_decoder(hDecoder, sb))
+            return NULL;
+    }
+
+    if (hDecoder->adts_header_present)
+    {
+        len = stream_sync_adts(sb, hDecoder->dsp, hDecoder->config.useOldADTSFormat);
+        if (len == 0)
+            return NULL;
+    } else {
+        /* raw data blocks carry no length, buffer as much as the largest
+           possible frame */
+        uint32_t channels = hDecoder->pce_set ?
+            hDecoder->pce.channels : hDecoder->channelConfiguration;
+
+        len = min(FAAD_MIN_STREAMSIZE * max(channels, 2), STREAM_WINDOW);
+        if (stream_avail(sb) < len)
+        {
+            if (!sb->eof || stream_avail(sb) == 0)
+                return NULL;
+            len = stream_avail(sb);
+        }
+    }
+
+    frame = stream_peek(sb, len);
+    if (sample_buffer)
+    {
+        out = NeAACDecDecode2(hDecoder, hInfo, frame, len,
+            sample_buffer, sample_buffer_size);
+    } else {
+        out = NeAACDecDecode(hDecoder, hInfo, frame, len);
+    }
+
+    if (hDecoder->adts_header_present)
+    {
+        /* the header knows best, there may be padding after the raw data */
+        hInfo->bytesconsumed = len;
+    } else if (hInfo->bytesconsumed == 0 || hInfo->bytesconsumed > len) {
+        /* without framing there is no way to resync */
+        hInfo->bytesconsumed = stream_avail(sb);
+        if (hInfo->error == 0)
+            hInfo->error = 14;
+    }
+    stream_consume(sb, hInfo->bytesconsumed);
+
+    return out;
+}
@@ -0,0 +1,74 @@
+/*
+** FAAD2 - Freeware Advanced Audio (AAC) Decoder including SBR decoding
+** Copyright (C) 2003-2005 M. Bakker, Nero AG, http://www.nero.com
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+**
+** Any non-GPL usage of this software or parts of this software is strictly
+** forbidden.
+**
+** The "appropriate copyright message" mentioned in section 2c of the GPLv2
+** must read: "Code from FAAD2 is copyright (c) Nero AG, www.nero.com"
+**
+** Commercial non-GPL licensing of this software is possible.
+** For more info contact Nero AG through Mpeg4AAClicense@nero.com.
+**
+** $Id$
+**/
+
+#ifndef __STREAM_H__
+#define __STREAM_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Input buffering for the streaming interface, see NeAACDecFeed().
+ *
+ * The input is kept in a ring buffer, so accepting new data never moves
+ * the bytes already buffered. The buffer is followed by a spare area of
+ * STREAM_WINDOW bytes: when a frame wraps around the end of the ring, the
+ * wrapped part is copied behind the end so the frame can be handed to the
+ * decoder in one piece. This happens once per lap of the ring.
+ */
+
+/* must be a power of 2 */
+#define STREAM_BUFFER_SIZE (64*1024)
+/* largest contiguous block the decoder is handed */
+#define STREAM_WINDOW      (STREAM_BUFFER_SIZE/2)
+
+typedef struct stream_buffer
+{
+    uint8_t *buf;       /* STREAM_BUFFER_SIZE + STREAM_WINDOW bytes */
+    uint32_t read;      /* total bytes consumed */
+    uint32_t write;     /* total bytes fed, write - read are buffered */
+    uint32_t mirrored;  /* bytes from the start copied behind the end */
+
+    uint8_t eof;        /* no more input will follow */
+    uint8_t locked;     /* in sync with the ADTS frame headers */
+} stream_buffer;
+
+stream_buffer *stream_init(void);
+void stream_end(stream_buffer *sb);
+void stream_reset(stream_buffer *sb);
+
+uint32_t stream_feed(stream_buffer *sb, const uint8_t *data, uint32_t size);
+void *stream_pull(NeAACDecStruct *hDecoder, NeAACDecFrameInfo *hInfo,
+                  void **sample_buffer, unsigned long sample_buffer_size);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -36,6 +36,8 @@ extern "C" {
 #endif
 
 #include "cfft.h"
+#include "dsp.h"
+#include "stats.h"
 #ifdef SBR_DEC
 #include "sbr_dec.h"
 #endif
@@ -47,21 +49,21 @@ extern "C" {
 #define MAX_LTP_SFB         40
 #define MAX_LTP_SFB_S        8
 
-/* used to save the prediction state */
-typedef struct {
-    int16_t r[2];
-    int16_t COR[2];
-    int16_t VAR[2];
+/* used to save the prediction state, one array per state variable so
+   the predictors of neighbouring bins are updated together */
+#define MAX_PRED_BINS 1024
+
+typedef struct pred_state {
+    int16_t r[2][MAX_PRED_BINS];
+    int16_t COR[2][MAX_PRED_BINS];
+    int16_t VAR[2][MAX_PRED_BINS];
 } pred_state;
 
 typedef struct {
     uint16_t N;
     cfft_info *cfft;
-    complex_t *sincos;
-#ifdef PROFILE
-    int64_t cycles;
-    int64_t fft_cycles;
-#endif
+    const complex_t *sincos;
+    const dsp_funcs *dsp;
 } mdct_info;
 
 typedef struct
@@ -77,9 +79,6 @@ typedef struct
     mdct_info *mdct1024;
 #endif
     mdct_info *mdct2048;
-#ifdef PROFILE
-    int64_t cycles;
-#endif
 } fb_info;
 
 typedef struct
@@ -98,6 +97,14 @@ typedef struct
 
     real_t ctrl1;
     real_t ctrl2;
+
+#ifndef FIXED_POINT
+    /* gain factors indexed by dyn_rng_sgn and dyn_rng_ctl, filled on
+       first use and valid for gain_ref_level only */
+    uint8_t gain_ref_level;
+    uint32_t gain_ready[2][4];
+    real_t gain[2][128];
+#endif
 } drc_info;
 
 typedef struct
@@ -239,6 +246,7 @@ typedef struct
 
 typedef struct
 {
+    /* Cleared for every element. ics_info() fields and per channel flags */
     uint8_t max_sfb;
 
     uint8_t num_swb;
@@ -248,21 +256,21 @@ typedef struct
     uint8_t window_group_length[8];
     uint8_t window_shape;
     uint8_t scale_factor_grouping;
-    uint16_t sect_sfb_offset[8][15*8];
-    uint16_t swb_offset[52];
     uint16_t swb_offset_max;
 
-    uint8_t sect_cb[8][15*8];
-    uint16_t sect_start[8][15*8];
-    uint16_t sect_end[8][15*8];
-    uint8_t sfb_cb[8][8*15];
-    uint8_t num_sec[8]; /* number of sections in a group */
+    uint8_t ms_mask_present;
 
-    uint8_t global_gain;
-    int16_t scale_factors[8][51]; /* [0..255] */
+    uint8_t predictor_data_present;
+#ifdef MAIN_DEC
+    pred_info pred;
+#endif
+#ifdef LTP_DEC
+    ltp_info ltp;
+    ltp_info ltp2;
+#endif
 
-    uint8_t ms_mask_present;
-    uint8_t ms_used[MAX_WINDOW_GROUPS][MAX_SFB];
+    uint8_t global_gain;
+    uint8_t num_sec[8]; /* number of sections in a group */
 
     uint8_t noise_used;
     uint8_t is_used;
@@ -270,20 +278,8 @@ typedef struct
     uint8_t pulse_data_present;
     uint8_t tns_data_present;
     uint8_t gain_control_data_present;
-    uint8_t predictor_data_present;
 
     pulse_info pul;
-    tns_info tns;
-#ifdef MAIN_DEC
-    pred_info pred;
-#endif
-#ifdef LTP_DEC
-    ltp_info ltp;
-    ltp_info ltp2;
-#endif
-#ifdef SSR_DEC
-    ssr_info ssr;
-#endif
 
 #ifdef ERROR_RESILIENCE
     /* ER HCR data */
@@ -298,6 +294,24 @@ typedef struct
     uint8_t length_of_rvlc_escapes;
     uint16_t dpcm_noise_last_position;
 #endif
+
+    /* Not cleared, only read within max_sfb and num_window_groups. Up to
+       sect_cb this is shared by both channels of a common window pair */
+    uint16_t swb_offset[52];
+    uint16_t sect_sfb_offset[MAX_WINDOW_GROUPS][MAX_SFB+1];
+    uint8_t ms_used[MAX_WINDOW_GROUPS][MAX_SFB];
+
+    uint8_t sect_cb[MAX_WINDOW_GROUPS][MAX_SFB];
+    uint8_t sect_start[MAX_WINDOW_GROUPS][MAX_SFB];
+    uint8_t sect_end[MAX_WINDOW_GROUPS][MAX_SFB];
+    uint8_t sfb_cb[MAX_WINDOW_GROUPS][MAX_SFB];
+    int16_t scale_factors[MAX_WINDOW_GROUPS][MAX_SFB]; /* [0..255] */
+
+    /* only read when tns_data_present / gain_control_data_present is set */
+    tns_info tns;
+#ifdef SSR_DEC
+    ssr_info ssr;
+#endif
 } ic_stream; /* individual channel stream */
 
 typedef struct
@@ -312,23 +326,6 @@ typedef struct
     ic_stream ics2;
 } element; /* syntax element (SCE, CPE, LFE) */
 
-#define MAX_ASC_BYTES 64
-typedef struct {
-    int inited;
-    int version, versionA;
-    int framelen_type;
-    int useSameStreamMux;
-    int allStreamsSameTimeFraming;
-    int numSubFrames;
-    int numPrograms;
-    int numLayers;
-    int otherDataPresent;
-    uint32_t otherDataLenBits;
-    uint32_t frameLength;
-    uint8_t ASC[MAX_ASC_BYTES];
-    uint32_t ASCbits;
-} latm_header;
-
 typedef struct
 {
     uint8_t adts_header_present;
@@ -343,6 +340,9 @@ typedef struct
     uint8_t aacSpectralDataResilienceFlag;
 #endif
     uint16_t frameLength;
+    /* AAC LC with 1024 sample frames, channel pairs take the
+       reconstruct_channel_pair_lc() path */
+    uint8_t lc_fast;
     uint8_t postSeekResetFlag;
 
     uint32_t frame;
@@ -378,6 +378,7 @@ typedef struct
 #endif
     fb_info *fb;
     drc_info *drc;
+    const dsp_funcs *dsp;
 
     real_t *time_out[MAX_CHANNELS];
     real_t *fb_intermed[MAX_CHANNELS];
@@ -416,6 +417,7 @@ typedef struct
     /* RNG states */
     uint32_t __r1;
     uint32_t __r2;
+    uint8_t pns_mode;
 
     /* Program Config Element */
     uint8_t pce_set;
@@ -426,14 +428,16 @@ typedef struct
     /* Configuration data */
     NeAACDecConfiguration config;
 
-#ifdef PROFILE
-    int64_t cycles;
-    int64_t spectral_cycles;
-    int64_t output_cycles;
-    int64_t scalefac_cycles;
-    int64_t requant_cycles;
-#endif
-	latm_header latm_config;
+    /* per stage statistics, see NeAACDecGetStats() */
+    faad_stats stats;
+
+    /* input buffer of the streaming interface, allocated on first use */
+    struct stream_buffer *stream;
+
+    /* LOAS demultiplexer, allocated by NeAACDecInit() for LOAS streams */
+    struct latm_mux *latm;
+    uint32_t latm_asc_version; /* of the config the decoder was set up for */
+    uint32_t latm_frame_size;
 	const unsigned char *cmes;
 } NeAACDecStruct;
 
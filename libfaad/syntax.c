@@ -38,6 +38,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <stddef.h>
 
 #include "syntax.h"
 #include "specrec.h"
@@ -647,16 +648,28 @@ void raw_data_block(NeAACDecStruct *hDecoder, NeAACDecFrameInfo *hInfo,
     return;
 }
 
+/* An element only needs the fields of its ic_streams that are read before
+   the bitstream sets them cleared, those are at the start of ic_stream. The
+   large per band arrays behind them are only read within max_sfb. */
+static void element_clear(element *ele)
+{
+    memset(ele, 0, offsetof(element, ics1));
+    memset(&(ele->ics1), 0, offsetof(ic_stream, swb_offset));
+    memset(&(ele->ics2), 0, offsetof(ic_stream, swb_offset));
+}
+
 /* Table 4.4.4 and */
 /* Table 4.4.9 */
 static uint8_t single_lfe_channel_element(NeAACDecStruct *hDecoder, bitfile *ld,
                                           uint8_t channel, uint8_t *tag)
 {
     uint8_t retval = 0;
-    element sce = {0};
+    element sce;
     ic_stream *ics = &(sce.ics1);
     ALIGN int16_t spec_data[1024] = {0};
 
+    element_clear(&sce);
+
     sce.element_instance_tag = (uint8_t)faad_getbits(ld, LEN_TAG
         DEBUGVAR(1,38,"single_lfe_channel_element(): element_instance_tag"));
 
@@ -701,11 +714,13 @@ static uint8_t channel_pair_element(NeAACDecStruct *hDecoder, bitfile *ld,
 {
     ALIGN int16_t spec_data1[1024] = {0};
     ALIGN int16_t spec_data2[1024] = {0};
-    element cpe = {0};
+    element cpe;
     ic_stream *ics1 = &(cpe.ics1);
     ic_stream *ics2 = &(cpe.ics2);
     uint8_t result;
 
+    element_clear(&cpe);
+
     cpe.channel        = channels;
     cpe.paired_channel = channels+1;
 
@@ -761,7 +776,7 @@ static uint8_t channel_pair_element(NeAACDecStruct *hDecoder, bitfile *ld,
         }
 #endif
 
-        memcpy(ics2, ics1, sizeof(ic_stream));
+        memcpy(ics2, ics1, offsetof(ic_stream, sect_cb));
     } else {
         ics1->ms_mask_present = 0;
     }
@@ -803,16 +818,16 @@ static uint8_t channel_pair_element(NeAACDecStruct *hDecoder, bitfile *ld,
 #ifdef SBR_DEC
     /* check if next bitstream element is a fill element */
     /* if so, read it now so SBR decoding can be done in case of a file with SBR */
-    // if (faad_showbits(ld, LEN_SE_ID) == ID_FIL)
-    // {
-    //     faad_flushbits(ld, LEN_SE_ID);
+    if (faad_showbits(ld, LEN_SE_ID) == ID_FIL)
+    {
+        faad_flushbits(ld, LEN_SE_ID);
 
-    //     /* one sbr_info describes a channel_element not a channel! */
-    //     if ((result = fill_element(hDecoder, ld, hDecoder->drc, hDecoder->fr_ch_ele)) > 0)
-    //     {
-    //         return result;
-    //     }
-    // }
+        /* one sbr_info describes a channel_element not a channel! */
+        if ((result = fill_element(hDecoder, ld, hDecoder->drc, hDecoder->fr_ch_ele)) > 0)
+        {
+            return result;
+        }
+    }
 #endif
 
     /* noiseless coding is done, spectral reconstruction is done now */
@@ -1144,6 +1159,8 @@ static uint8_t fill_element(NeAACDecStruct *hDecoder, bitfile *ld, drc_info *drc
             }
             if (!hDecoder->sbr[sbr_ele])
                 return 19;
+            hDecoder->sbr[sbr_ele]->dsp = hDecoder->dsp;
+            hDecoder->sbr[sbr_ele]->stats = &hDecoder->stats;
 
             hDecoder->sbr_present_flag = 1;
 
@@ -1290,13 +1307,15 @@ void DRM_aac_scalable_main_element(NeAACDecStruct *hDecoder, NeAACDecFrameInfo *
     uint8_t channels = hDecoder->fr_channels = 0;
     uint8_t ch;
     uint8_t this_layer_stereo = (hDecoder->channelConfiguration > 1) ? 1 : 0;
-    element cpe = {0};
+    element cpe;
     ic_stream *ics1 = &(cpe.ics1);
     ic_stream *ics2 = &(cpe.ics2);
     int16_t *spec_data;
     ALIGN int16_t spec_data1[1024] = {0};
     ALIGN int16_t spec_data2[1024] = {0};
 
+    element_clear(&cpe);
+
     hDecoder->fr_ch_ele = 0;
 
     hInfo->error = DRM_aac_scalable_main_header(hDecoder, ics1, ics2, ld, this_layer_stereo);
@@ -1418,6 +1437,8 @@ void DRM_aac_scalable_main_element(NeAACDecStruct *hDecoder, NeAACDecFrameInfo *
             hInfo->error = 19;
             return;
         }
+        hDecoder->sbr[0]->dsp = hDecoder->dsp;
+        hDecoder->sbr[0]->stats = &hDecoder->stats;
 
         /* Reverse bit reading of SBR data in DRM audio frame */
         revbuffer = (uint8_t*)faad_malloc(buffer_size*sizeof(uint8_t));
@@ -1557,7 +1578,7 @@ static int8_t DRM_aac_scalable_main_header(NeAACDecStruct *hDecoder, ic_stream *
             }
         }
 
-        memcpy(ics2, ics1, sizeof(ic_stream));
+        memcpy(ics2, ics1, offsetof(ic_stream, sect_cb));
     } else {
         ics1->ms_mask_present = 0;
     }
@@ -1664,6 +1685,7 @@ static uint8_t individual_channel_stream(NeAACDecStruct *hDecoder, element *ele,
                                          int16_t *spec_data)
 {
     uint8_t result;
+    stats_mark mark;
 
     result = side_info(hDecoder, ele, ld, ics, scal_flag);
     if (result > 0)
@@ -1684,24 +1706,22 @@ static uint8_t individual_channel_stream(NeAACDecStruct *hDecoder, element *ele,
     }
 #endif
 
+    stats_begin(&hDecoder->stats, &mark);
 #ifdef ERROR_RESILIENCE
     if (hDecoder->aacSpectralDataResilienceFlag)
     {
         /* error resilient spectral data decoding */
-        if ((result = reordered_spectral_data(hDecoder, ics, ld, spec_data)) > 0)
-        {
-            return result;
-        }
+        result = reordered_spectral_data(hDecoder, ics, ld, spec_data);
     } else {
 #endif
         /* decode the spectral data */
-        if ((result = spectral_data(hDecoder, ics, ld, spec_data)) > 0)
-        {
-            return result;
-        }
+        result = spectral_data(hDecoder, ics, ld, spec_data);
 #ifdef ERROR_RESILIENCE
     }
 #endif
+    stats_end(&hDecoder->stats, &mark, FAAD_STAGE_HUFFMAN);
+    if (result > 0)
+        return result;
 
     /* pulse coding reconstruction */
     if (ics->pulse_data_present)
@@ -1754,6 +1774,8 @@ static uint8_t section_data(NeAACDecStruct *hDecoder, ic_stream *ics, bitfile *l
                incremented and we cannot leave the while loop */
             if (ld->error != 0)
                 return 14;
+            if (i >= MAX_SFB)
+                return 15;
 
 #ifdef ERROR_RESILIENCE
             if (hDecoder->aacSectionDataResilienceFlag)
@@ -1810,31 +1832,30 @@ static uint8_t section_data(NeAACDecStruct *hDecoder, ic_stream *ics, bitfile *l
 
             sect_len += sect_len_incr;
 
-            ics->sect_start[g][i] = k;
-            ics->sect_end[g][i] = k + sect_len;
-
-#if 0
-            printf("%d\n", ics->sect_start[g][i]);
-#endif
-#if 0
-            printf("%d\n", ics->sect_end[g][i]);
-#endif
-
             if (ics->window_sequence == EIGHT_SHORT_SEQUENCE)
             {
                 if (k + sect_len > 8*15)
                     return 15;
-                if (i >= 8*15)
-                    return 15;
             } else {
                 if (k + sect_len > MAX_SFB)
                 {
                     fprintf(stderr, "Out of range: k = %d, sect_len = %d\n", k, sect_len);
                     return 15;
                 }
-                if (i >= MAX_SFB)
-                    return 15;
             }
+            /* the sections of a group end at max_sfb */
+            if (k + sect_len > ics->max_sfb)
+                return 32;
+
+            ics->sect_start[g][i] = (uint8_t)k;
+            ics->sect_end[g][i] = (uint8_t)(k + sect_len);
+
+#if 0
+            printf("%d\n", ics->sect_start[g][i]);
+#endif
+#if 0
+            printf("%d\n", ics->sect_end[g][i]);
+#endif
 
             for (sfb = k; sfb < k + sect_len; sfb++)
             {
@@ -1972,9 +1993,9 @@ static uint8_t decode_scale_factors(ic_stream *ics, bitfile *ld)
 static uint8_t scale_factor_data(NeAACDecStruct *hDecoder, ic_stream *ics, bitfile *ld)
 {
     uint8_t ret = 0;
-#ifdef PROFILE
-    int64_t count = faad_get_ts();
-#endif
+    stats_mark mark;
+
+    stats_begin(&hDecoder->stats, &mark);
 
 #ifdef ERROR_RESILIENCE
     if (!hDecoder->aacScalefactorDataResilienceFlag)
@@ -1991,10 +2012,7 @@ static uint8_t scale_factor_data(NeAACDecStruct *hDecoder, ic_stream *ics, bitfi
     }
 #endif
 
-#ifdef PROFILE
-    count = faad_get_ts() - count;
-    hDecoder->scalefac_cycles += count;
-#endif
+    stats_end(&hDecoder->stats, &mark, FAAD_STAGE_HUFFMAN);
 
     return ret;
 }
@@ -2151,10 +2169,6 @@ static uint8_t spectral_data(NeAACDecStruct *hDecoder, ic_stream *ics, bitfile *
     uint8_t result;
     uint16_t nshort = hDecoder->frameLength/8;
 
-#ifdef PROFILE
-    int64_t count = faad_get_ts();
-#endif
-
     for(g = 0; g < ics->num_window_groups; g++)
     {
         p = groups*nshort;
@@ -2214,11 +2228,6 @@ static uint8_t spectral_data(NeAACDecStruct *hDecoder, ic_stream *ics, bitfile *
         groups += ics->window_group_length[g];
     }
 
-#ifdef PROFILE
-    count = faad_get_ts() - count;
-    hDecoder->spectral_cycles += count;
-#endif
-
     return 0;
 }
 
@@ -2522,188 +2531,3 @@ static void adts_error_check(adts_header *adts, bitfile *ld)
             DEBUGVAR(1,134,"adts_error_check(): crc_check"));
     }
 }
-
-/* LATM parsing functions */
-
-static uint32_t latm_get_value(bitfile *ld)
-{
-    uint32_t l, value;
-    uint8_t bytesForValue;
-
-    bytesForValue = (uint8_t)faad_getbits(ld, 2);
-    value = 0;
-    for(l=0; l<bytesForValue; l++)
-        value = (value << 8) | (uint8_t)faad_getbits(ld, 8);
-
-    return value;
-}
-
-
-static uint32_t latmParsePayload(latm_header *latm, bitfile *ld)
-{
-    //assuming there's only one program with a single layer and 1 subFrame,
-    //allStreamsSametimeframing is set,
-    uint32_t framelen;
-    uint8_t tmp;
-
-    //this should be the payload length field for the current configuration
-    framelen = 0;
-    if(latm->framelen_type==0)
-    {
-        do
-        {
-            tmp = (uint8_t)faad_getbits(ld, 8);
-            framelen += tmp;
-        } while(tmp==0xff);
-    }
-    else if(latm->framelen_type==1)
-        framelen=latm->frameLength;
-
-    return framelen;
-}
-
-
-static uint32_t latmAudioMuxElement(latm_header *latm, bitfile *ld)
-{
-    uint32_t ascLen, asc_bits=0;
-    uint32_t x1, y1, m, n, i;
-    program_config pce;
-    mp4AudioSpecificConfig mp4ASC;
-
-    latm->useSameStreamMux = (uint8_t)faad_getbits(ld, 1);
-    if(!latm->useSameStreamMux)
-    {
-        //parseSameStreamMuxConfig
-        latm->version = (uint8_t) faad_getbits(ld, 1);
-        if(latm->version)
-            latm->versionA = (uint8_t) faad_getbits(ld, 1);
-        if(latm->versionA)
-        {
-            //dunno the payload format for versionA
-            fprintf(stderr, "versionA not supported\n");
-            return 0;
-        }
-        if(latm->version) //read taraBufferFullness
-            latm_get_value(ld);
-        latm->allStreamsSameTimeFraming = (uint8_t)faad_getbits(ld, 1);
-        latm->numSubFrames = (uint8_t)faad_getbits(ld, 6) + 1;
-        latm->numPrograms = (uint8_t)faad_getbits(ld, 4) + 1;
-        latm->numLayers = faad_getbits(ld, 3) + 1;
-        if(latm->numPrograms>1 || !latm->allStreamsSameTimeFraming || latm->numSubFrames>1 || latm->numLayers>1)
-        {
-            fprintf(stderr, "\r\nUnsupported LATM configuration: %d programs/ %d subframes, %d layers, allstreams: %d\n",
-                latm->numPrograms, latm->numSubFrames, latm->numLayers, latm->allStreamsSameTimeFraming);
-            return 0;
-        }
-        ascLen = 0;
-        if(latm->version)
-            ascLen = latm_get_value(ld);
-
-        x1 = faad_get_processed_bits(ld);
-        if(AudioSpecificConfigFromBitfile(ld, &mp4ASC, &pce, 0, 1) < 0)
-            return 0;
-
-        //horrid hack to unread the ASC bits and store them in latm->ASC
-        //the correct code would rely on an ideal faad_ungetbits()
-        y1 = faad_get_processed_bits(ld);
-        if((y1-x1) <= MAX_ASC_BYTES*8)
-        {
-            faad_rewindbits(ld);
-            m = x1;
-            while(m>0)
-            {
-                n = min(m, 32);
-                faad_getbits(ld, n);
-                m -= n;
-            }
-
-            i = 0;
-            m = latm->ASCbits = y1 - x1;
-            while(m > 0)
-            {
-                n = min(m, 8);
-                latm->ASC[i++] = (uint8_t) faad_getbits(ld, n);
-                m -= n;
-            }
-        }
-
-        asc_bits = y1-x1;
-
-        if(ascLen>asc_bits)
-            faad_getbits(ld, ascLen-asc_bits);
-
-        latm->framelen_type = (uint8_t) faad_getbits(ld, 3);
-        if(latm->framelen_type == 0)
-        {
-            latm->frameLength = 0;
-            faad_getbits(ld, 8); //buffer fullness for frame_len_type==0, useless
-        }
-        else if(latm->framelen_type == 1)
-        {
-            latm->frameLength = faad_getbits(ld, 9);
-            if(latm->frameLength==0)
-            {
-                fprintf(stderr, "Invalid frameLength: 0\r\n");
-                return 0;
-            }
-            latm->frameLength = (latm->frameLength+20)*8;
-        }
-        else
-        {   //hellish CELP or HCVX stuff, discard
-            fprintf(stderr, "Unsupported CELP/HCVX framelentype: %d\n", latm->framelen_type);
-            return 0;
-        }
-
-        latm->otherDataLenBits = 0;
-        if(faad_getbits(ld, 1))
-        {   //other data present
-            int esc, tmp;
-            if(latm->version)
-                latm->otherDataLenBits = latm_get_value(ld);
-            else do
-            {
-                esc = faad_getbits(ld, 1);
-                tmp = faad_getbits(ld, 8);
-                latm->otherDataLenBits = (latm->otherDataLenBits << 8) + tmp;
-            } while(esc);
-        }
-        if(faad_getbits(ld, 1)) //crc
-            faad_getbits(ld, 8);
-        latm->inited = 1;
-      }
-
-      //read payload
-      if(latm->inited)
-          return latmParsePayload(latm, ld);
-      else
-          return 0;
-}
-
-
-uint32_t faad_latm_frame(latm_header *latm, bitfile *ld)
-{
-    uint16_t len;
-    uint32_t initpos, endpos, firstpos, ret;
-
-    firstpos = faad_get_processed_bits(ld);
-    while (ld->bytes_left)
-    {
-        faad_byte_align(ld);
-        if(faad_showbits(ld, 11) != 0x2B7)
-        {
-            faad_getbits(ld, 8);
-            continue;
-        }
-        faad_getbits(ld, 11);
-        len = faad_getbits(ld, 13);
-        if(!len)
-            continue;
-        initpos = faad_get_processed_bits(ld);
-        ret = latmAudioMuxElement(latm, ld);
-        endpos = faad_get_processed_bits(ld);
-        if(ret>0)
-            return (len*8)-(endpos-initpos);
-        //faad_getbits(ld, initpos-endpos); //go back to initpos, but is valid a getbits(-N) ?
-    }
-    return 0xFFFFFFFF;
-}
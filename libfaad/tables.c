@@ -0,0 +1,534 @@
+/*
+** FAAD2 - Freeware Advanced Audio (AAC) Decoder including SBR decoding
+** Copyright (C) 2003-2005 M. Bakker, Nero AG, http://www.nero.com
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+**
+** Any non-GPL usage of this software or parts of this software is strictly
+** forbidden.
+**
+** The "appropriate copyright message" mentioned in section 2c of the GPLv2
+** must read: "Code from FAAD2 is copyright (c) Nero AG, www.nero.com"
+**
+** Commercial non-GPL licensing of this software is possible.
+** For more info contact Nero AG through Mpeg4AAClicense@nero.com.
+**
+** $Id$
+**/
+
+#include "common.h"
+#include "structs.h"
+
+#include "tables.h"
+#include "kbd_win.h"
+#ifndef RUNTIME_TABLES
+#include "sine_win.h"
+#include "mdct_tab.h"
+#include "iq_table.h"
+#endif
+#ifdef FIXED_POINT
+#include "cfft_tab.h"
+#endif
+
+
+#ifndef RUNTIME_TABLES
+
+const real_t *table_sine_window(uint16_t len)
+{
+    switch (len)
+    {
+    case 1024: return sine_long_1024;
+    case 128:  return sine_short_128;
+#ifdef ALLOW_SMALL_FRAMELENGTH
+    case 960:  return sine_long_960;
+    case 120:  return sine_short_120;
+#endif
+    }
+
+    return NULL;
+}
+
+const real_t *table_kbd_window(uint16_t len)
+{
+    switch (len)
+    {
+    case 1024: return kbd_long_1024;
+    case 128:  return kbd_short_128;
+#ifdef ALLOW_SMALL_FRAMELENGTH
+    case 960:  return kbd_long_960;
+    case 120:  return kbd_short_120;
+#endif
+    }
+
+    return NULL;
+}
+
+#ifdef LD_DEC
+const real_t *table_ld_sine_window(uint16_t len)
+{
+    switch (len)
+    {
+    case 512: return sine_mid_512;
+#ifdef ALLOW_SMALL_FRAMELENGTH
+    case 480: return sine_mid_480;
+#endif
+    }
+
+    return NULL;
+}
+
+const real_t *table_ld_window(uint16_t len)
+{
+    switch (len)
+    {
+    case 512: return ld_mid_512;
+#ifdef ALLOW_SMALL_FRAMELENGTH
+    case 480: return ld_mid_480;
+#endif
+    }
+
+    return NULL;
+}
+#endif
+
+const complex_t *table_mdct(uint16_t N)
+{
+    switch (N)
+    {
+    case 2048: return mdct_tab_2048;
+    case 256:  return mdct_tab_256;
+#ifdef LD_DEC
+    case 1024: return mdct_tab_1024;
+#endif
+#ifdef ALLOW_SMALL_FRAMELENGTH
+    case 1920: return mdct_tab_1920;
+    case 240:  return mdct_tab_240;
+#ifdef LD_DEC
+    case 960:  return mdct_tab_960;
+#endif
+#endif
+#ifdef SSR_DEC
+    case 512:  return mdct_tab_512;
+    case 64:   return mdct_tab_64;
+#endif
+    }
+
+    return NULL;
+}
+
+const real_t *table_iq(void)
+{
+    return iq_table;
+}
+
+#else
+
+typedef struct
+{
+    uint16_t len;
+    faad_once_t once;
+    real_t *data;
+} gen_table;
+
+/* sin(pi/(2*len)*(i+0.5)), the table values of sine_win.h */
+static void gen_sine(real_t *w, uint16_t len)
+{
+    uint16_t i;
+
+    for (i = 0; i < len; i++)
+        w[i] = (real_t)sin(M_PI/(2.0*len)*(i + 0.5));
+}
+
+#ifdef ALLOW_SMALL_FRAMELENGTH
+/* zeroth order modified Bessel function of the first kind */
+static double bessel_i0(double x)
+{
+    double sum = 1.0, u = 1.0, t;
+    double halfx = x/2.0;
+    int n = 1;
+
+    do {
+        t = halfx/n;
+        n++;
+        t *= t;
+        u *= t;
+        sum += u;
+    } while (u >= 1e-41*sum);
+
+    return sum;
+}
+
+/* Kaiser-Bessel derived window, alpha 4 for long and 6 for short windows */
+static void gen_kbd(real_t *w, uint16_t len)
+{
+    double kaiser[1024+1];
+    double alpha = M_PI * ((len <= 128) ? 6.0 : 4.0);
+    double sum = 0.0, acc = 0.0;
+    uint16_t i;
+
+    for (i = 0; i <= len; i++)
+    {
+        double x = 2.0*i/len - 1.0;
+        kaiser[i] = bessel_i0(alpha*sqrt(1.0 - x*x));
+        sum += kaiser[i];
+    }
+    sum = 1.0/sum;
+
+    for (i = 0; i < len; i++)
+    {
+        acc += kaiser[i];
+        w[i] = (real_t)sqrt(acc*sum);
+    }
+}
+#endif
+
+static const real_t *get_window(gen_table *tabs, uint8_t count, uint16_t len,
+                                void (*gen)(real_t *w, uint16_t len))
+{
+    uint8_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        if (tabs[i].len == len)
+        {
+            if (faad_once_begin(&tabs[i].once))
+            {
+                gen(tabs[i].data, len);
+                faad_once_end(&tabs[i].once);
+            }
+            return tabs[i].data;
+        }
+    }
+
+    return NULL;
+}
+
+TABLE_ALIGN static real_t sine_long_buf[1024];
+TABLE_ALIGN static real_t sine_short_buf[128];
+#ifdef ALLOW_SMALL_FRAMELENGTH
+TABLE_ALIGN static real_t sine_long_960_buf[960];
+TABLE_ALIGN static real_t sine_short_120_buf[120];
+TABLE_ALIGN static real_t kbd_long_960_buf[960];
+TABLE_ALIGN static real_t kbd_short_120_buf[120];
+#endif
+
+static gen_table sine_tabs[] =
+{
+    { 1024, FAAD_ONCE_INIT, sine_long_buf },
+    { 128, FAAD_ONCE_INIT, sine_short_buf },
+#ifdef ALLOW_SMALL_FRAMELENGTH
+    { 960, FAAD_ONCE_INIT, sine_long_960_buf },
+    { 120, FAAD_ONCE_INIT, sine_short_120_buf },
+#endif
+};
+
+#ifdef ALLOW_SMALL_FRAMELENGTH
+static gen_table kbd_tabs[] =
+{
+    { 960, FAAD_ONCE_INIT, kbd_long_960_buf },
+    { 120, FAAD_ONCE_INIT, kbd_short_120_buf },
+};
+#endif
+
+const real_t *table_sine_window(uint16_t len)
+{
+    return get_window(sine_tabs, sizeof(sine_tabs)/sizeof(sine_tabs[0]), len, gen_sine);
+}
+
+/* the stored 1024 and 128 windows were not made by this generator, they
+   differ from it in the last bit of some coefficients and are kept so
+   that both modes decode bit identically */
+const real_t *table_kbd_window(uint16_t len)
+{
+    switch (len)
+    {
+    case 1024: return kbd_long_1024;
+    case 128:  return kbd_short_128;
+    }
+
+#ifdef ALLOW_SMALL_FRAMELENGTH
+    return get_window(kbd_tabs, sizeof(kbd_tabs)/sizeof(kbd_tabs[0]), len, gen_kbd);
+#else
+    return NULL;
+#endif
+}
+
+#ifdef LD_DEC
+/* low overlap window: 3/8 zeros, a sine slope over 1/4 and 3/8 ones */
+static void gen_ld(real_t *w, uint16_t len)
+{
+    uint16_t zeros = 3*len/8;
+    uint16_t slope = len/4;
+    uint16_t i;
+
+    for (i = 0; i < zeros; i++)
+        w[i] = 0;
+    gen_sine(w + zeros, slope);
+    for (i = zeros + slope; i < len; i++)
+        w[i] = 1;
+}
+
+TABLE_ALIGN static real_t ld_sine_buf[512];
+TABLE_ALIGN static real_t ld_buf[512];
+#ifdef ALLOW_SMALL_FRAMELENGTH
+TABLE_ALIGN static real_t ld_sine_480_buf[480];
+TABLE_ALIGN static real_t ld_480_buf[480];
+#endif
+
+static gen_table ld_sine_tabs[] =
+{
+    { 512, FAAD_ONCE_INIT, ld_sine_buf },
+#ifdef ALLOW_SMALL_FRAMELENGTH
+    { 480, FAAD_ONCE_INIT, ld_sine_480_buf },
+#endif
+};
+
+static gen_table ld_tabs[] =
+{
+    { 512, FAAD_ONCE_INIT, ld_buf },
+#ifdef ALLOW_SMALL_FRAMELENGTH
+    { 480, FAAD_ONCE_INIT, ld_480_buf },
+#endif
+};
+
+const real_t *table_ld_sine_window(uint16_t len)
+{
+    return get_window(ld_sine_tabs, sizeof(ld_sine_tabs)/sizeof(ld_sine_tabs[0]), len, gen_sine);
+}
+
+const real_t *table_ld_window(uint16_t len)
+{
+    return get_window(ld_tabs, sizeof(ld_tabs)/sizeof(ld_tabs[0]), len, gen_ld);
+}
+#endif
+
+/* sqrt(2/N)*exp(j*2*pi*(k+1/8)/N), the table values of mdct_tab.h */
+static void gen_mdct(real_t *tab, uint16_t N)
+{
+    complex_t *sincos = (complex_t*)tab;
+    double scale = sqrt(2.0/N);
+    uint16_t k;
+
+    for (k = 0; k < N/4; k++)
+    {
+        RE(sincos[k]) = (real_t)(scale*cos(2.0*M_PI*(k + 1.0/8.0)/N));
+        IM(sincos[k]) = (real_t)(scale*sin(2.0*M_PI*(k + 1.0/8.0)/N));
+    }
+}
+
+TABLE_ALIGN static complex_t mdct_2048_buf[512];
+TABLE_ALIGN static complex_t mdct_256_buf[64];
+#ifdef LD_DEC
+TABLE_ALIGN static complex_t mdct_1024_buf[256];
+#endif
+#ifdef ALLOW_SMALL_FRAMELENGTH
+TABLE_ALIGN static complex_t mdct_1920_buf[480];
+TABLE_ALIGN static complex_t mdct_240_buf[60];
+#ifdef LD_DEC
+TABLE_ALIGN static complex_t mdct_960_buf[240];
+#endif
+#endif
+#ifdef SSR_DEC
+TABLE_ALIGN static complex_t mdct_512_buf[128];
+TABLE_ALIGN static complex_t mdct_64_buf[16];
+#endif
+
+static gen_table mdct_tabs[] =
+{
+    { 2048, FAAD_ONCE_INIT, (real_t*)mdct_2048_buf },
+    { 256, FAAD_ONCE_INIT, (real_t*)mdct_256_buf },
+#ifdef LD_DEC
+    { 1024, FAAD_ONCE_INIT, (real_t*)mdct_1024_buf },
+#endif
+#ifdef ALLOW_SMALL_FRAMELENGTH
+    { 1920, FAAD_ONCE_INIT, (real_t*)mdct_1920_buf },
+    { 240, FAAD_ONCE_INIT, (real_t*)mdct_240_buf },
+#ifdef LD_DEC
+    { 960, FAAD_ONCE_INIT, (real_t*)mdct_960_buf },
+#endif
+#endif
+#ifdef SSR_DEC
+    { 512, FAAD_ONCE_INIT, (real_t*)mdct_512_buf },
+    { 64, FAAD_ONCE_INIT, (real_t*)mdct_64_buf },
+#endif
+};
+
+const complex_t *table_mdct(uint16_t N)
+{
+    return (const complex_t*)get_window(mdct_tabs, sizeof(mdct_tabs)/sizeof(mdct_tabs[0]),
+        N, gen_mdct);
+}
+
+TABLE_ALIGN static real_t iq_buf[IQ_TABLE_SIZE];
+static faad_once_t iq_once = FAAD_ONCE_INIT;
+
+const real_t *table_iq(void)
+{
+    if (faad_once_begin(&iq_once))
+    {
+        uint16_t q;
+
+        for (q = 0; q < IQ_TABLE_SIZE; q++)
+            iq_buf[q] = (real_t)pow(q, 4.0/3.0);
+        faad_once_end(&iq_once);
+    }
+
+    return iq_buf;
+}
+
+#endif
+
+
+#ifndef FIXED_POINT
+/* computed the same way as cffti1() in cfft.c always did, FFT sizes are
+   N/4 of the MDCT sizes */
+static void gen_cfft(complex_t *wa, uint16_t n, const uint16_t *ifac)
+{
+    real_t arg, argh, argld, fi;
+    uint16_t ido, ipm;
+    uint16_t i1, k1, l1, l2;
+    uint16_t ld, ii, ip;
+    uint16_t i, j;
+    uint16_t nf = ifac[1];
+
+    argh = (real_t)2.0*(real_t)M_PI / (real_t)n;
+    i = 0;
+    l1 = 1;
+
+    for (k1 = 1; k1 <= nf; k1++)
+    {
+        ip = ifac[k1+1];
+        ld = 0;
+        l2 = l1*ip;
+        ido = n / l2;
+        ipm = ip - 1;
+
+        for (j = 0; j < ipm; j++)
+        {
+            i1 = i;
+            RE(wa[i]) = 1.0;
+            IM(wa[i]) = 0.0;
+            ld += l1;
+            fi = 0;
+            argld = ld*argh;
+
+            for (ii = 0; ii < ido; ii++)
+            {
+                i++;
+                fi++;
+                arg = fi * argld;
+                RE(wa[i]) = (real_t)cos(arg);
+                IM(wa[i]) = (real_t)sin(arg);
+            }
+
+            if (ip > 5)
+            {
+                RE(wa[i1]) = RE(wa[i]);
+                IM(wa[i1]) = IM(wa[i]);
+            }
+        }
+        l1 = l2;
+    }
+}
+
+TABLE_ALIGN static complex_t cfft_512_buf[512];
+TABLE_ALIGN static complex_t cfft_64_buf[64];
+#ifdef LD_DEC
+TABLE_ALIGN static complex_t cfft_256_buf[256];
+#endif
+#ifdef ALLOW_SMALL_FRAMELENGTH
+TABLE_ALIGN static complex_t cfft_480_buf[480];
+TABLE_ALIGN static complex_t cfft_60_buf[60];
+#ifdef LD_DEC
+TABLE_ALIGN static complex_t cfft_240_buf[240];
+#endif
+#endif
+#ifdef SSR_DEC
+TABLE_ALIGN static complex_t cfft_128_buf[128];
+TABLE_ALIGN static complex_t cfft_16_buf[16];
+#endif
+
+static struct
+{
+    uint16_t n;
+    faad_once_t once;
+    complex_t *data;
+} cfft_tabs[] =
+{
+    { 512, FAAD_ONCE_INIT, cfft_512_buf },
+    { 64, FAAD_ONCE_INIT, cfft_64_buf },
+#ifdef LD_DEC
+    { 256, FAAD_ONCE_INIT, cfft_256_buf },
+#endif
+#ifdef ALLOW_SMALL_FRAMELENGTH
+    { 480, FAAD_ONCE_INIT, cfft_480_buf },
+    { 60, FAAD_ONCE_INIT, cfft_60_buf },
+#ifdef LD_DEC
+    { 240, FAAD_ONCE_INIT, cfft_240_buf },
+#endif
+#endif
+#ifdef SSR_DEC
+    { 128, FAAD_ONCE_INIT, cfft_128_buf },
+    { 16, FAAD_ONCE_INIT, cfft_16_buf },
+#endif
+};
+
+const complex_t *table_cfft(uint16_t n, const uint16_t *ifac)
+{
+    uint8_t i;
+
+    for (i = 0; i < sizeof(cfft_tabs)/sizeof(cfft_tabs[0]); i++)
+    {
+        if (cfft_tabs[i].n == n)
+        {
+            if (faad_once_begin(&cfft_tabs[i].once))
+            {
+                gen_cfft(cfft_tabs[i].data, n, ifac);
+                faad_once_end(&cfft_tabs[i].once);
+            }
+            return cfft_tabs[i].data;
+        }
+    }
+
+    return NULL;
+}
+
+#else
+
+const complex_t *table_cfft(uint16_t n, const uint16_t *ifac)
+{
+    (void)ifac;
+
+    switch (n)
+    {
+    case 64:  return cfft_tab_64;
+    case 512: return cfft_tab_512;
+#ifdef LD_DEC
+    case 256: return cfft_tab_256;
+#endif
+#ifdef ALLOW_SMALL_FRAMELENGTH
+    case 60:  return cfft_tab_60;
+    case 480: return cfft_tab_480;
+#ifdef LD_DEC
+    case 240: return cfft_tab_240;
+#endif
+#endif
+    case 128: return cfft_tab_128;
+    }
+
+    return NULL;
+}
+
+#endif
@@ -0,0 +1,104 @@
+/*
+** FAAD2 - Freeware Advanced Audio (AAC) Decoder including SBR decoding
+** Copyright (C) 2003-2005 M. Bakker, Nero AG, http://www.nero.com
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+**
+** Any non-GPL usage of this software or parts of this software is strictly
+** forbidden.
+**
+** The "appropriate copyright message" mentioned in section 2c of the GPLv2
+** must read: "Code from FAAD2 is copyright (c) Nero AG, www.nero.com"
+**
+** Commercial non-GPL licensing of this software is possible.
+** For more info contact Nero AG through Mpeg4AAClicense@nero.com.
+**
+** $Id$
+**/
+
+#ifndef __TABLES_H__
+#define __TABLES_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Constant tables of the filterbank, the (I)MDCT, the FFT and the inverse
+ * quantisation.
+ *
+ * All users get their tables from here, every table exists once in the
+ * library and is shared by all decoder instances. The 960/480 frame length
+ * variants come from the same generator as the 1024/512 ones.
+ *
+ * By default the tables are compiled in (kbd_win.h, sine_win.h,
+ * mdct_tab.h, iq_table.h and for FIXED_POINT cfft_tab.h). With
+ * RUNTIME_TABLES (floating point only, see common.h) they are computed on
+ * first use into cache line aligned storage instead, which removes about
+ * 65 kB of constant data from the library and only touches the pages of
+ * the tables a stream needs. The generated tables are bit identical to the
+ * stored ones. The KBD windows for 1024 and 128 are the exception and stay
+ * stored.
+ *
+ * Floating point FFT twiddles are always computed on first use.
+ *
+ * Tables filled on first use are guarded by faad_once_begin(), decoders
+ * may be opened and initialised on several threads at the same time.
+ */
+
+#if defined(_MSC_VER)
+#define TABLE_ALIGN __declspec(align(64))
+#elif defined(__GNUC__)
+#define TABLE_ALIGN __attribute__((aligned(64)))
+#else
+#define TABLE_ALIGN
+#endif
+
+/* !!!DON'T CHANGE IQ_TABLE_SIZE!!! */
+#ifndef FIXED_POINT
+#define IQ_TABLE_SIZE  8192
+#else
+#ifdef BIG_IQ_TABLE
+#define IQ_TABLE_SIZE  8192
+#else
+#define IQ_TABLE_SIZE  1026
+#endif
+#endif
+
+/* rising half of a window, len is the frame length (1024, 960) or the
+   short window length (128, 120), NULL for unsupported lengths */
+const real_t *table_sine_window(uint16_t len);
+const real_t *table_kbd_window(uint16_t len);
+#ifdef LD_DEC
+/* AAC LD windows for 512 and 480 sample frames */
+const real_t *table_ld_sine_window(uint16_t len);
+const real_t *table_ld_window(uint16_t len);
+#endif
+
+/* N/4 pre/post twiddle factors of an N point (I)MDCT */
+const complex_t *table_mdct(uint16_t N);
+
+/* twiddle factors of an n point complex FFT with factorisation ifac, see
+   cffti() */
+const complex_t *table_cfft(uint16_t n, const uint16_t *ifac);
+
+/* q^(4/3) for 0 <= q < IQ_TABLE_SIZE, prescaled for
+   FIXED_POINT */
+const real_t *table_iq(void);
+
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -78,19 +78,41 @@ static real_t tns_coef_1_4[] =
 };
 
 
-/* TNS decoding for one channel and frame */
-void tns_decode_frame(ic_stream *ics, tns_info *tns, uint8_t sr_index,
-                      uint8_t object_type, real_t *spec, uint16_t frame_len)
+/* One TNS filter with its decoded coefficients, ready to run.
+ *
+ * The filters of one frame all work on disjoint parts of the spectrum,
+ * so they are collected first and then run in batches: filters of the
+ * same order go through dsp->tns_ar_lanes() side by side, one filter per
+ * lane. Every lane still runs its own recursion with the operations of
+ * tns_ar_filter(), the output does not change.
+ */
+typedef struct
 {
-    uint8_t w, f, tns_order;
+    real_t *spec;
+    uint16_t size;
     int8_t inc;
+    uint8_t order;
+    real_t lpc[TNS_MAX_ORDER+1];
+} tns_job;
+
+/* 2 channels, 8 windows, 4 filters per window */
+#define TNS_MAX_JOBS 64
+
+/* decodes the coefficients of all filters of one channel */
+static uint8_t tns_collect(ic_stream *ics, tns_info *tns, uint8_t sr_index,
+                           uint8_t object_type, real_t *spec, uint16_t frame_len,
+                           tns_job *job, uint8_t n)
+{
+    uint8_t w, f, tns_order;
     int16_t size;
-    uint16_t bottom, top, start, end;
+    uint16_t bottom, top, start, end, max_sfb;
     uint16_t nshort = frame_len/8;
-    real_t lpc[TNS_MAX_ORDER+1];
 
     if (!ics->tns_data_present)
-        return;
+        return n;
+
+    max_sfb = max_tns_sfb(sr_index, object_type, (ics->window_sequence == EIGHT_SHORT_SEQUENCE));
+    max_sfb = min(max_sfb, ics->max_sfb);
 
     for (w = 0; w < ics->num_windows; w++)
     {
@@ -104,34 +126,163 @@ void tns_decode_frame(ic_stream *ics, tns_info *tns, uint8_t sr_index,
             if (!tns_order)
                 continue;
 
-            tns_decode_coef(tns_order, tns->coef_res[w]+3,
-                tns->coef_compress[w][f], tns->coef[w][f], lpc);
-
-            start = min(bottom, max_tns_sfb(sr_index, object_type, (ics->window_sequence == EIGHT_SHORT_SEQUENCE)));
-            start = min(start, ics->max_sfb);
+            start = min(bottom, max_sfb);
             start = min(ics->swb_offset[start], ics->swb_offset_max);
 
-            end = min(top, max_tns_sfb(sr_index, object_type, (ics->window_sequence == EIGHT_SHORT_SEQUENCE)));
-            end = min(end, ics->max_sfb);
+            end = min(top, max_sfb);
             end = min(ics->swb_offset[end], ics->swb_offset_max);
 
             size = end - start;
             if (size <= 0)
                 continue;
 
+            tns_decode_coef(tns_order, tns->coef_res[w]+3,
+                tns->coef_compress[w][f], tns->coef[w][f], job[n].lpc);
+
             if (tns->direction[w][f])
             {
-                inc = -1;
+                job[n].inc = -1;
                 start = end - 1;
             } else {
-                inc = 1;
+                job[n].inc = 1;
             }
 
-            tns_ar_filter(&spec[(w*nshort)+start], size, inc, lpc, tns_order);
+            job[n].spec = &spec[(w*nshort)+start];
+            job[n].size = size;
+            job[n].order = tns_order;
+            n++;
         }
     }
+
+    return n;
 }
 
+/* runs the collected filters, see tns_job */
+static void tns_run(tns_job *job, uint8_t n, const dsp_funcs *dsp)
+{
+    uint8_t i;
+#ifndef FIXED_POINT
+    uint8_t j, k, m, order;
+    uint8_t sorted[TNS_MAX_JOBS];
+    real_t *spec[TNS_LANES];
+    uint16_t size[TNS_LANES];
+    int8_t inc[TNS_LANES];
+    ALIGN real_t lpc[TNS_MAX_ORDER*TNS_LANES];
+
+    /* sort by order, only filters of the same order share a batch */
+    for (i = 0; i < n; i++)
+    {
+        for (j = i; j > 0 && job[sorted[j-1]].order > job[i].order; j--)
+            sorted[j] = sorted[j-1];
+        sorted[j] = i;
+    }
+
+    for (i = 0; i < n; i = j)
+    {
+        order = job[sorted[i]].order;
+        for (j = i + 1; j < n && j < i + TNS_LANES; j++)
+        {
+            if (job[sorted[j]].order != order)
+                break;
+        }
+
+        if (j - i == 1)
+        {
+            tns_job *t = &job[sorted[i]];
+            tns_ar_filter(t->spec, t->size, t->inc, t->lpc, t->order);
+            continue;
+        }
+
+        for (k = 0; k < TNS_LANES; k++)
+        {
+            if (i + k < j)
+            {
+                tns_job *t = &job[sorted[i + k]];
+                spec[k] = t->spec;
+                size[k] = t->size;
+                inc[k] = t->inc;
+                for (m = 0; m < order; m++)
+                    lpc[m*TNS_LANES + k] = t->lpc[m+1];
+            } else {
+                spec[k] = NULL;
+                size[k] = 0;
+                inc[k] = 0;
+                for (m = 0; m < order; m++)
+                    lpc[m*TNS_LANES + k] = 0;
+            }
+        }
+
+        dsp->tns_ar_lanes(spec, size, inc, lpc, order);
+    }
+#else
+    (void)dsp;
+
+    for (i = 0; i < n; i++)
+        tns_ar_filter(job[i].spec, job[i].size, job[i].inc, job[i].lpc, job[i].order);
+#endif
+}
+
+/* TNS decoding for one channel and frame */
+void tns_decode_frame(ic_stream *ics, tns_info *tns, uint8_t sr_index,
+                      uint8_t object_type, real_t *spec, uint16_t frame_len,
+                      const dsp_funcs *dsp)
+{
+    tns_job job[TNS_MAX_JOBS/2];
+    uint8_t n;
+
+    n = tns_collect(ics, tns, sr_index, object_type, spec, frame_len, job, 0);
+    tns_run(job, n, dsp);
+}
+
+/* TNS decoding for both channels of a channel pair, the filters of the
+   two channels are batched together */
+void tns_decode_pair(ic_stream *ics1, ic_stream *ics2, uint8_t sr_index,
+                     uint8_t object_type, real_t *spec1, real_t *spec2,
+                     uint16_t frame_len, const dsp_funcs *dsp)
+{
+    tns_job job[TNS_MAX_JOBS];
+    uint8_t n;
+
+    n = tns_collect(ics1, &ics1->tns, sr_index, object_type, spec1, frame_len, job, 0);
+    n = tns_collect(ics2, &ics2->tns, sr_index, object_type, spec2, frame_len, job, n);
+    tns_run(job, n, dsp);
+}
+
+#ifndef FIXED_POINT
+/* reference version of dsp->tns_ar_lanes(): the lanes one after another,
+   lane k uses the coefficients lpc[j*TNS_LANES + k], j = 0..order-1 */
+void tns_ar_lanes_c(real_t **spec, const uint16_t *size, const int8_t *inc,
+                    const real_t *lpc, uint8_t order)
+{
+    uint8_t j, k;
+    uint16_t i;
+
+    for (k = 0; k < TNS_LANES; k++)
+    {
+        real_t *spectrum = spec[k];
+        real_t y;
+        real_t state[2*TNS_MAX_ORDER] = {0};
+        int8_t state_index = 0;
+
+        for (i = 0; i < size[k]; i++)
+        {
+            y = *spectrum;
+
+            for (j = 0; j < order; j++)
+                y -= MUL_C(state[state_index+j], lpc[j*TNS_LANES + k]);
+
+            state_index--;
+            if (state_index < 0)
+                state_index = order-1;
+            state[state_index] = state[state_index + order] = y;
+
+            *spectrum = y;
+            spectrum += inc[k];
+        }
+    }
+}
+#endif
+
 /* TNS encoding for one channel and frame */
 void tns_encode_frame(ic_stream *ics, tns_info *tns, uint8_t sr_index,
                       uint8_t object_type, real_t *spec, uint16_t frame_len)
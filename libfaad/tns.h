@@ -37,13 +37,24 @@ extern "C" {
 
 
 #define TNS_MAX_ORDER 20
+/* filters run side by side by dsp->tns_ar_lanes() */
+#define TNS_LANES 4
 
 
 void tns_decode_frame(ic_stream *ics, tns_info *tns, uint8_t sr_index,
-                      uint8_t object_type, real_t *spec, uint16_t frame_len);
+                      uint8_t object_type, real_t *spec, uint16_t frame_len,
+                      const dsp_funcs *dsp);
+void tns_decode_pair(ic_stream *ics1, ic_stream *ics2, uint8_t sr_index,
+                     uint8_t object_type, real_t *spec1, real_t *spec2,
+                     uint16_t frame_len, const dsp_funcs *dsp);
 void tns_encode_frame(ic_stream *ics, tns_info *tns, uint8_t sr_index,
                       uint8_t object_type, real_t *spec, uint16_t frame_len);
 
+#ifndef FIXED_POINT
+void tns_ar_lanes_c(real_t **spec, const uint16_t *size, const int8_t *inc,
+                    const real_t *lpc, uint8_t order);
+#endif
+
 
 #ifdef __cplusplus
 }